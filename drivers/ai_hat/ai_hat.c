@@ -7,38 +7,87 @@
  *
  * ───────────────────────────────────────────────────────────────────────────── */
 #include "ai_hat.h"
+#include "ai_hat_protocol.h"
+#include "ai_hat_emu.h"
 #include "../uart.h"
 #include "../i2c.h"
 #include "../spi.h"
 #include "../../kernel/stdio.h"
+#include "../../kernel/timer.h"
+#include "../../kernel/crc32.h"
 #include <stdbool.h>
 
 // AI HAT+ I2C address
 #define AI_HAT_I2C_ADDR     0x42
 
-// AI HAT+ command registers
-#define AI_HAT_REG_VERSION  0x00
-#define AI_HAT_REG_CONTROL  0x01
-#define AI_HAT_REG_STATUS   0x02
-#define AI_HAT_REG_TEMP     0x03
-#define AI_HAT_REG_POWER    0x04
-#define AI_HAT_REG_MODEL    0x10
-#define AI_HAT_REG_INFERENCE 0x20
-
-// AI HAT+ control commands
-#define AI_HAT_CMD_INIT     0x01
-#define AI_HAT_CMD_SHUTDOWN 0x02
-#define AI_HAT_CMD_SET_POWER 0x03
-#define AI_HAT_CMD_LOAD_MODEL 0x10
-#define AI_HAT_CMD_UNLOAD_MODEL 0x11
-#define AI_HAT_CMD_RUN_INFERENCE 0x20
+// How long an inference may keep the HAT busy before we give up
+#define AI_HAT_COMPUTE_TIMEOUT_MS 1000
 
 // Static variables
 static bool ai_hat_initialized = false;
+static const ai_hat_link_t* link = NULL;
+static bool double_buffering = true;
+static ai_hat_stream_stats_t stream_stats;
+
+// Frame header, status word and chunk CRC are read/written by DMA after
+// the transfer has been started, so they cannot live on the stack
+static ai_hat_frame_t frame_header;
+static uint32_t frame_status;
+static uint8_t chunk_trailer[AI_HAT_CHUNK_TRAILER];
+
+// Model upload in progress; one at a time
+typedef struct {
+    bool active;
+    bool resync;                 // Ask the HAT where to continue before sending
+    ai_hat_status_t result;      // AI_HAT_PENDING while running, then the outcome
+    const uint8_t* data;
+    uint32_t size;
+    uint32_t model_id;
+    ai_hat_precision_t precision;
+    uint32_t offset;             // Bytes acknowledged by the HAT
+    uint32_t chunk_size;
+    uint32_t retransmits;
+    uint32_t failed_steps;       // Steps in a row that ended in an error
+    uint32_t next_crc;           // CRC of the chunk at next_crc_offset
+    uint32_t next_crc_offset;
+    uint64_t ticks;              // Time spent in upload steps
+} model_upload_t;
+
+static model_upload_t upload;
+
+// Inference started by ai_hat_inference_start(), until it is collected
+typedef struct {
+    bool active;
+    uint32_t model_id;
+    uint32_t input_size;
+    uint32_t output_size;
+    uint64_t start;
+} pending_inference_t;
+
+static pending_inference_t pending;
+static uint32_t chunk_size = AI_HAT_DEFAULT_CHUNK_SIZE;
+static uint32_t next_model_id = 1;
 static ai_hat_info_t ai_hat_info;
-static ai_hat_model_t loaded_models[8]; // Support up to 8 models
+static ai_hat_model_t loaded_models[AI_HAT_MAX_MODELS];
 static uint32_t num_loaded_models = 0;
 
+// Register reads of the hardware link's current batch, one I2C
+// transaction each
+static i2c_transaction_t reg_batch[AI_HAT_REG_BATCH_MAX];
+static uint8_t reg_batch_addr[AI_HAT_REG_BATCH_MAX];
+static uint32_t reg_batch_count = 0;
+
+// Telemetry batch: temperature, power and status registers
+static bool telemetry_active = false;
+static uint8_t telemetry_temp;
+static uint8_t telemetry_power[2];
+static uint8_t telemetry_status[4];
+static const ai_hat_reg_read_t telemetry_reads[] = {
+    {AI_HAT_REG_TEMP, &telemetry_temp, sizeof(telemetry_temp)},
+    {AI_HAT_REG_POWER, telemetry_power, sizeof(telemetry_power)},
+    {AI_HAT_REG_STATUS, telemetry_status, sizeof(telemetry_status)},
+};
+
 // Delay function - simple busy wait
 static void __attribute__((unused)) delay(int32_t count) {
     while (count--) {
@@ -89,14 +138,30 @@ static ai_hat_status_t init_spi() {
         return AI_HAT_ERROR_INIT;
     }
     
+    // Tensor frames are moved by the DMA engine
+    status = spi_dma_init();
+    if (status != SPI_SUCCESS) {
+        uart_puts("Failed to initialize SPI DMA for AI HAT+\n");
+        return AI_HAT_ERROR_INIT;
+    }
+    
     uart_puts("SPI initialized for AI HAT+\n");
     return AI_HAT_SUCCESS;
 }
 
-// Send command to AI HAT+ via I2C
-static ai_hat_status_t send_command(uint8_t reg, uint8_t cmd, uint8_t* data, uint32_t len) {
-    i2c_status_t status;
+// Write a control register block to the AI HAT+ via I2C
+static ai_hat_status_t hw_write_reg(const uint8_t* data, uint32_t len) {
+    i2c_status_t status = i2c_write(AI_HAT_I2C_ADDR, data, len);
+    if (status != I2C_SUCCESS) {
+        uart_puts("Failed to send command to AI HAT+\n");
+        return AI_HAT_ERROR_COMM;
+    }
     
+    return AI_HAT_SUCCESS;
+}
+
+// Send command to AI HAT+ over the control channel
+static ai_hat_status_t send_command(uint8_t reg, uint8_t cmd, uint8_t* data, uint32_t len) {
     // Prepare command buffer
     uint8_t cmd_buffer[len + 2];
     cmd_buffer[0] = reg;
@@ -107,88 +172,351 @@ static ai_hat_status_t send_command(uint8_t reg, uint8_t cmd, uint8_t* data, uin
         memcpy(&cmd_buffer[2], data, len);
     }
     
-    // Send command via I2C
-    status = i2c_write(AI_HAT_I2C_ADDR, cmd_buffer, len + 2);
+    return link->write_reg(cmd_buffer, len + 2);
+}
+
+// Read data from AI HAT+ via I2C: the register address, a repeated start
+// and the data in one transaction
+static ai_hat_status_t hw_read_reg(uint8_t reg, uint8_t* data, uint32_t len) {
+    i2c_status_t status = i2c_write_read(AI_HAT_I2C_ADDR, &reg, 1, data, len);
     if (status != I2C_SUCCESS) {
-        uart_puts("Failed to send command to AI HAT+\n");
+        uart_puts("Failed to read data from AI HAT+\n");
         return AI_HAT_ERROR_COMM;
     }
     
     return AI_HAT_SUCCESS;
 }
 
-// Read data from AI HAT+ via I2C
-static ai_hat_status_t read_data(uint8_t reg, uint8_t* data, uint32_t len) {
-    i2c_status_t status;
+// Queue a batch of register reads on the I2C controller
+static ai_hat_status_t hw_read_regs_start(const ai_hat_reg_read_t* reads, uint32_t count) {
+    if (reg_batch_count != 0) {
+        return AI_HAT_ERROR_BUSY;
+    }
     
-    // Send register address
-    status = i2c_write(AI_HAT_I2C_ADDR, &reg, 1);
-    if (status != I2C_SUCCESS) {
-        uart_puts("Failed to send register address to AI HAT+\n");
-        return AI_HAT_ERROR_COMM;
+    if (reads == NULL || count == 0 || count > AI_HAT_REG_BATCH_MAX) {
+        return AI_HAT_ERROR_PARAM;
     }
     
-    // Read data
-    status = i2c_read(AI_HAT_I2C_ADDR, data, len);
-    if (status != I2C_SUCCESS) {
-        uart_puts("Failed to read data from AI HAT+\n");
-        return AI_HAT_ERROR_COMM;
+    for (uint32_t i = 0; i < count; i++) {
+        i2c_transaction_t* txn = &reg_batch[i];
+        reg_batch_addr[i] = reads[i].reg;
+        txn->device_addr = AI_HAT_I2C_ADDR;
+        txn->write_data = &reg_batch_addr[i];
+        txn->write_len = 1;
+        txn->read_data = reads[i].data;
+        txn->read_len = reads[i].len;
+        txn->done = NULL;
+        txn->context = NULL;
+        
+        // Queue full: let the reads already queued finish and give up
+        if (i2c_submit(txn) != I2C_SUCCESS) {
+            for (uint32_t j = 0; j < i; j++) {
+                i2c_wait(&reg_batch[j]);
+            }
+            reg_batch_count = 0;
+            return AI_HAT_ERROR_BUSY;
+        }
+        reg_batch_count = i + 1;
     }
     
-    // For simulation purposes, override with simulated data
-    // In a real implementation, this would be removed
-    if (reg == AI_HAT_REG_VERSION) {
-        // Simulate version information
-        data[0] = 1; // Version 1.0
-        data[1] = 0;
-    } else if (reg == AI_HAT_REG_TEMP) {
-        // Simulate temperature reading (45°C)
-        data[0] = 45;
-    } else if (reg == AI_HAT_REG_POWER) {
-        // Simulate power consumption (1200mW)
-        data[0] = 1200 & 0xFF;
-        data[1] = (1200 >> 8) & 0xFF;
+    return AI_HAT_SUCCESS;
+}
+
+static ai_hat_status_t hw_read_regs_poll(void) {
+    ai_hat_status_t result = AI_HAT_SUCCESS;
+    
+    if (reg_batch_count == 0) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    // No interrupt is routed to the controller yet; service it from here
+    i2c_irq_handler();
+    for (uint32_t i = 0; i < reg_batch_count; i++) {
+        if (reg_batch[i].status == I2C_PENDING) {
+            return AI_HAT_PENDING;
+        }
+        if (reg_batch[i].status != I2C_SUCCESS) {
+            result = AI_HAT_ERROR_COMM;
+        }
+    }
+    
+    reg_batch_count = 0;
+    return result;
+}
+
+// Read data from AI HAT+ over the control channel
+static ai_hat_status_t read_data(uint8_t reg, uint8_t* data, uint32_t len) {
+    return link->read_reg(reg, data, len);
+}
+
+static ai_hat_status_t hw_init(void) {
+    ai_hat_status_t status;
+    
+    // Initialize I2C
+    status = init_i2c();
+    if (status != AI_HAT_SUCCESS) {
+        uart_puts("Failed to initialize I2C\n");
+        return status;
+    }
+    
+    // Initialize SPI
+    status = init_spi();
+    if (status != AI_HAT_SUCCESS) {
+        uart_puts("Failed to initialize SPI\n");
+        return status;
     }
     
     return AI_HAT_SUCCESS;
 }
 
-// Transfer data to/from AI HAT+ via SPI
-static ai_hat_status_t __attribute__((unused)) transfer_data(uint8_t* tx_data, uint8_t* rx_data, uint32_t len) {
-    spi_status_t status;
+static ai_hat_status_t hw_stream_start(const spi_segment_t* segments, uint32_t count) {
+    spi_status_t status = spi_dma_start(segments, count);
+    if (status == SPI_ERROR_PARAM) {
+        return AI_HAT_ERROR_PARAM;
+    }
     
-    // Transfer data via SPI
-    status = spi_transfer(tx_data, rx_data, len);
+    return (status == SPI_SUCCESS) ? AI_HAT_SUCCESS : AI_HAT_ERROR_COMM;
+}
+
+static ai_hat_status_t hw_stream_wait(void) {
+    spi_status_t status = spi_dma_wait();
     if (status != SPI_SUCCESS) {
         uart_puts("Failed to transfer data to/from AI HAT+\n");
-        return AI_HAT_ERROR_COMM;
+        return (status == SPI_ERROR_TIMEOUT) ? AI_HAT_ERROR_TIMEOUT : AI_HAT_ERROR_COMM;
     }
     
     return AI_HAT_SUCCESS;
 }
 
-// Initialize the AI HAT+
-ai_hat_status_t ai_hat_init(void) {
+static const ai_hat_link_t hw_link = {
+    "spi-dma",
+    hw_init,
+    hw_write_reg,
+    hw_read_reg,
+    hw_read_regs_start,
+    hw_read_regs_poll,
+    hw_stream_start,
+    spi_dma_busy,
+    hw_stream_wait,
+    spi_get_clock_speed
+};
+
+// ─── Tensor streaming ────────────────────────────────────────────────────────
+
+static void set_frame_header(uint8_t opcode, uint8_t slot, uint32_t model_id, uint32_t len, uint32_t arg) {
+    frame_header.opcode = opcode;
+    frame_header.slot = slot;
+    frame_header.model_id = (uint16_t)model_id;
+    frame_header.length = len;
+    frame_header.arg = arg;
+}
+
+// Start one frame: the header and an optional payload go out as a single
+// chip-select transaction. tx and rx may both point into the payload.
+static ai_hat_status_t frame_start(uint8_t opcode, uint8_t slot, uint32_t model_id,
+                                   const void* tx, void* rx, uint32_t len, uint32_t arg) {
+    spi_segment_t segments[2];
+    uint32_t count = 1;
+    
+    set_frame_header(opcode, slot, model_id, len, arg);
+    segments[0].tx = (const uint8_t*)&frame_header;
+    segments[0].rx = NULL;
+    segments[0].len = sizeof(frame_header);
+    
+    if (len > 0) {
+        segments[1].tx = (const uint8_t*)tx;
+        segments[1].rx = (uint8_t*)rx;
+        segments[1].len = len;
+        count = 2;
+    }
+    
+    return link->stream_start(segments, count);
+}
+
+static ai_hat_status_t frame_transfer(uint8_t opcode, uint8_t slot, uint32_t model_id,
+                                      const void* tx, void* rx, uint32_t len, uint32_t arg) {
+    ai_hat_status_t status = frame_start(opcode, slot, model_id, tx, rx, len, arg);
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    return link->stream_wait();
+}
+
+// Move a tensor to or from a HAT slot in frames that fit one DMA transaction
+static ai_hat_status_t stream_tensor(uint8_t opcode, uint8_t slot, uint32_t model_id,
+                                     const void* tx, void* rx, uint32_t size) {
+    for (uint32_t offset = 0; offset < size; offset += AI_HAT_FRAME_MAX_PAYLOAD) {
+        uint32_t len = size - offset;
+        if (len > AI_HAT_FRAME_MAX_PAYLOAD) {
+            len = AI_HAT_FRAME_MAX_PAYLOAD;
+        }
+        
+        ai_hat_status_t status = frame_transfer(opcode, slot, model_id,
+                                                tx ? (const uint8_t*)tx + offset : NULL,
+                                                rx ? (uint8_t*)rx + offset : NULL, len, offset);
+        if (status != AI_HAT_SUCCESS) {
+            return status;
+        }
+    }
+    
+    return AI_HAT_SUCCESS;
+}
+
+// Poll the status word until the running inference is done. A poll lost
+// on the link is simply repeated.
+static ai_hat_status_t wait_idle(void) {
+    uint64_t deadline = timer_ticks() +
+                        timer_div64(timer_ticks_per_sec() * AI_HAT_COMPUTE_TIMEOUT_MS, 1000);
+    
+    for (;;) {
+        ai_hat_status_t status = frame_transfer(AI_HAT_OP_STATUS, 0, 0, NULL, &frame_status,
+                                                sizeof(frame_status), 0);
+        if (status == AI_HAT_ERROR_TIMEOUT && timer_ticks() <= deadline) {
+            continue;
+        }
+        if (status != AI_HAT_SUCCESS) {
+            return status;
+        }
+        
+        if (frame_status & AI_HAT_STATUS_ERROR) {
+            uart_puts("AI HAT+ rejected a frame\n");
+            return AI_HAT_ERROR_COMM;
+        }
+        
+        if (!(frame_status & AI_HAT_STATUS_BUSY)) {
+            return AI_HAT_SUCCESS;
+        }
+        
+        if (timer_ticks() > deadline) {
+            return AI_HAT_ERROR_TIMEOUT;
+        }
+    }
+}
+
+// Run `count` inferences. With double buffering the HAT's two tensor slots
+// alternate: input n+1 is uploaded while n is computed, and output n is read
+// back while n+1 is computed, so the bus and the accelerator overlap.
+// Without it every tensor is uploaded, computed and read back in turn.
+static ai_hat_status_t stream_batch(uint32_t model_id, const void* const* inputs, uint32_t input_size,
+                                    void* const* outputs, uint32_t output_size, uint32_t count) {
+    bool pipelined = double_buffering && count > 1;
     ai_hat_status_t status;
     
-    // Check if already initialized
-    if (ai_hat_initialized) {
-        return AI_HAT_SUCCESS;
+    status = stream_tensor(AI_HAT_OP_WRITE_INPUT, 0, model_id, inputs[0], NULL, input_size);
+    if (status == AI_HAT_SUCCESS) {
+        status = frame_transfer(AI_HAT_OP_RUN, 0, model_id, NULL, NULL, 0, output_size);
     }
     
-    uart_puts("Initializing AI HAT+...\n");
+    for (uint32_t n = 0; n < count && status == AI_HAT_SUCCESS; n++) {
+        uint8_t slot = pipelined ? (n & 1) : 0;
+        bool next = n + 1 < count;
+        
+        if (pipelined && next) {
+            status = stream_tensor(AI_HAT_OP_WRITE_INPUT, slot ^ 1, model_id, inputs[n + 1], NULL, input_size);
+            if (status != AI_HAT_SUCCESS) {
+                break;
+            }
+        }
+        
+        status = wait_idle();
+        if (status != AI_HAT_SUCCESS) {
+            break;
+        }
+        
+        if (pipelined && next) {
+            status = frame_transfer(AI_HAT_OP_RUN, slot ^ 1, model_id, NULL, NULL, 0, output_size);
+            if (status != AI_HAT_SUCCESS) {
+                break;
+            }
+        }
+        
+        status = stream_tensor(AI_HAT_OP_READ_OUTPUT, slot, model_id, NULL, outputs[n], output_size);
+        
+        if (status == AI_HAT_SUCCESS && !pipelined && next) {
+            status = stream_tensor(AI_HAT_OP_WRITE_INPUT, 0, model_id, inputs[n + 1], NULL, input_size);
+            if (status == AI_HAT_SUCCESS) {
+                status = frame_transfer(AI_HAT_OP_RUN, 0, model_id, NULL, NULL, 0, output_size);
+            }
+        }
+    }
     
-    // Initialize I2C
-    status = init_i2c();
+    return status;
+}
+
+// ─── Telemetry ───────────────────────────────────────────────────────────────
+
+static ai_hat_status_t telemetry_start(void) {
+    if (telemetry_active) {
+        return AI_HAT_ERROR_BUSY;
+    }
+    
+    ai_hat_status_t status = link->read_regs_start(telemetry_reads,
+                                                   sizeof(telemetry_reads) / sizeof(telemetry_reads[0]));
+    if (status == AI_HAT_SUCCESS) {
+        telemetry_active = true;
+    }
+    return status;
+}
+
+static ai_hat_status_t telemetry_poll(ai_hat_telemetry_t* telemetry) {
+    if (!telemetry_active) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    ai_hat_status_t status = link->read_regs_poll();
+    if (status == AI_HAT_PENDING) {
+        return status;
+    }
+    
+    telemetry_active = false;
     if (status != AI_HAT_SUCCESS) {
-        uart_puts("Failed to initialize I2C\n");
         return status;
     }
     
-    // Initialize SPI
-    status = init_spi();
+    ai_hat_info.temperature = telemetry_temp;
+    ai_hat_info.power_consumption = (telemetry_power[1] << 8) | telemetry_power[0];
+    if (telemetry != NULL) {
+        telemetry->temperature = ai_hat_info.temperature;
+        telemetry->power = ai_hat_info.power_consumption;
+        telemetry->busy = (telemetry_status[0] & AI_HAT_STATUS_BUSY) ? 1 : 0;
+    }
+    return AI_HAT_SUCCESS;
+}
+
+// Read the telemetry now, after any batch already under way
+static ai_hat_status_t read_telemetry(ai_hat_telemetry_t* telemetry) {
+    ai_hat_status_t status;
+    
+    while (telemetry_active && telemetry_poll(NULL) == AI_HAT_PENDING) {
+        asm volatile("nop");
+    }
+    
+    status = telemetry_start();
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    while ((status = telemetry_poll(telemetry)) == AI_HAT_PENDING) {
+        asm volatile("nop");
+    }
+    return status;
+}
+
+// Bring up the AI HAT+ over the given link
+static ai_hat_status_t init_over(const ai_hat_link_t* new_link) {
+    ai_hat_status_t status;
+    
+    // Check if already initialized
+    if (ai_hat_initialized) {
+        return AI_HAT_SUCCESS;
+    }
+    
+    uart_puts("Initializing AI HAT+...\n");
+    
+    link = new_link;
+    status = link->init();
     if (status != AI_HAT_SUCCESS) {
-        uart_puts("Failed to initialize SPI\n");
         return status;
     }
     
@@ -210,24 +538,26 @@ ai_hat_status_t ai_hat_init(void) {
     // Initialize AI HAT+ information
     ai_hat_info.version = (version[0] << 8) | version[1];
     ai_hat_info.max_tops = 26; // 26 TOPS for AI HAT+
-    ai_hat_info.memory_size = 4 * 1024 * 1024; // 4GB in MB to avoid overflow
+    ai_hat_info.memory_size = 4 * 1024 * 1024; // 4GB, in KB to avoid overflow
     ai_hat_info.power_mode = AI_HAT_POWER_MEDIUM;
     
-    // Read initial temperature and power consumption
-    uint8_t temp;
-    status = read_data(AI_HAT_REG_TEMP, &temp, 1);
-    if (status == AI_HAT_SUCCESS) {
-        ai_hat_info.temperature = temp;
+    // Model memory, if the firmware reports it
+    uint8_t memory[8];
+    status = read_data(AI_HAT_REG_MEMORY, memory, sizeof(memory));
+    uint32_t memory_kb = (uint32_t)memory[0] | ((uint32_t)memory[1] << 8) |
+                         ((uint32_t)memory[2] << 16) | ((uint32_t)memory[3] << 24);
+    if (status == AI_HAT_SUCCESS && memory_kb != 0) {
+        ai_hat_info.memory_size = memory_kb;
     }
     
-    uint8_t power[2];
-    status = read_data(AI_HAT_REG_POWER, power, 2);
-    if (status == AI_HAT_SUCCESS) {
-        ai_hat_info.power_consumption = (power[1] << 8) | power[0];
-    }
+    // Read initial temperature and power consumption
+    telemetry_active = false;
+    read_telemetry(NULL);
     
     // Initialize model list
     num_loaded_models = 0;
+    pending.active = false;
+    ai_hat_reset_stream_stats();
     
     ai_hat_initialized = true;
     uart_puts("AI HAT+ initialized successfully\n");
@@ -235,6 +565,16 @@ ai_hat_status_t ai_hat_init(void) {
     return AI_HAT_SUCCESS;
 }
 
+// Initialize the AI HAT+
+ai_hat_status_t ai_hat_init(void) {
+    return init_over(&hw_link);
+}
+
+// Initialize the AI HAT+ software emulator
+ai_hat_status_t ai_hat_init_emulator(void) {
+    return init_over(ai_hat_emu_get_link());
+}
+
 // Get AI HAT+ information
 ai_hat_status_t ai_hat_get_info(ai_hat_info_t* info) {
     if (!ai_hat_initialized) {
@@ -246,17 +586,7 @@ ai_hat_status_t ai_hat_get_info(ai_hat_info_t* info) {
     }
     
     // Update temperature and power consumption
-    uint8_t temp;
-    ai_hat_status_t status = read_data(AI_HAT_REG_TEMP, &temp, 1);
-    if (status == AI_HAT_SUCCESS) {
-        ai_hat_info.temperature = temp;
-    }
-    
-    uint8_t power[2];
-    status = read_data(AI_HAT_REG_POWER, power, 2);
-    if (status == AI_HAT_SUCCESS) {
-        ai_hat_info.power_consumption = (power[1] << 8) | power[0];
-    }
+    read_telemetry(NULL);
     
     // Copy information to output
     memcpy(info, &ai_hat_info, sizeof(ai_hat_info_t));
@@ -335,33 +665,46 @@ ai_hat_status_t ai_hat_get_power_consumption(uint32_t* power) {
     return AI_HAT_SUCCESS;
 }
 
-// Load a model to the AI HAT+
-ai_hat_status_t ai_hat_load_model(const void* model_data, uint32_t model_size, uint32_t* model_id) {
+// Queue a telemetry read
+ai_hat_status_t ai_hat_telemetry_start(void) {
     if (!ai_hat_initialized) {
         return AI_HAT_ERROR_INIT;
     }
     
-    if (model_data == NULL || model_id == NULL || model_size == 0) {
-        return AI_HAT_ERROR_PARAM;
+    return telemetry_start();
+}
+
+// Collect a queued telemetry read
+ai_hat_status_t ai_hat_telemetry_poll(ai_hat_telemetry_t* telemetry) {
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
     }
     
-    if (num_loaded_models >= 8) {
-        return AI_HAT_ERROR_MEMORY;
+    return telemetry_poll(telemetry);
+}
+
+// Read telemetry and wait for it
+ai_hat_status_t ai_hat_get_telemetry(ai_hat_telemetry_t* telemetry) {
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
     }
     
-    // TODO: Implement actual model loading via SPI
-    // This is a placeholder for actual model loading code
-    
-    // For now, we'll simulate successful model loading
-    *model_id = num_loaded_models + 1;
+    if (telemetry == NULL) {
+        return AI_HAT_ERROR_PARAM;
+    }
     
-    // Add model to list
+    return read_telemetry(telemetry);
+}
+
+// Add a model to the list once the HAT holds it
+static ai_hat_model_t* register_model(uint32_t model_id, uint32_t model_size, ai_hat_precision_t precision) {
     ai_hat_model_t* model = &loaded_models[num_loaded_models];
-    model->id = *model_id;
+    memset(model, 0, sizeof(*model));
+    model->id = model_id;
     model->size = model_size;
-    model->precision = AI_HAT_PRECISION_FP16; // Default precision
-    model->input_size = 1024; // Example input size
-    model->output_size = 1000; // Example output size
+    model->precision = precision;
+    model->input_size = 0;  // Tensor sizes are not known until the blob
+    model->output_size = 0; // format is parsed; the HAT checks them
     
     // Use a safer method than sprintf to create model name
     char name_prefix[] = "Model_";
@@ -370,7 +713,7 @@ ai_hat_status_t ai_hat_load_model(const void* model_data, uint32_t model_size, u
     // Convert model ID to string
     char id_str[8];
     int i = 0;
-    uint32_t id_copy = *model_id;
+    uint32_t id_copy = model_id;
     do {
         id_str[i++] = '0' + (id_copy % 10);
         id_copy /= 10;
@@ -392,10 +735,311 @@ ai_hat_status_t ai_hat_load_model(const void* model_data, uint32_t model_size, u
     }
     
     num_loaded_models++;
+    return model;
+}
+
+// Read and clear the HAT status word
+static ai_hat_status_t read_status(uint32_t* status_word) {
+    ai_hat_status_t status = frame_transfer(AI_HAT_OP_STATUS, 0, 0, NULL, &frame_status,
+                                            sizeof(frame_status), 0);
+    *status_word = frame_status;
+    return status;
+}
+
+// Ask the HAT how many bytes of the current upload it has accepted
+static ai_hat_status_t query_received(uint32_t* received) {
+    ai_hat_status_t status = frame_transfer(AI_HAT_OP_MODEL_QUERY, 0, upload.model_id, NULL, &frame_status,
+                                            sizeof(frame_status), 0);
+    *received = frame_status;
+    return status;
+}
+
+static uint32_t chunk_length(uint32_t offset) {
+    uint32_t len = upload.size - offset;
+    return (len < upload.chunk_size) ? len : upload.chunk_size;
+}
+
+// Send the chunk at upload.offset with its CRC and wait for the HAT to
+// acknowledge it. The CRC of the next chunk is computed while the DMA
+// engine is moving this one. Returns AI_HAT_PENDING if the HAT dropped
+// the chunk and it has to be sent again.
+static ai_hat_status_t send_chunk(void) {
+    uint32_t offset = upload.offset;
+    uint32_t len = chunk_length(offset);
+    spi_segment_t segments[3];
+    uint32_t received, status_word;
+    
+    uint32_t crc = (upload.next_crc_offset == offset) ? upload.next_crc
+                                                      : crc32(upload.data + offset, len);
+    
+    for (int i = 0; i < AI_HAT_CHUNK_TRAILER; i++) {
+        chunk_trailer[i] = (uint8_t)(crc >> (8 * i));
+    }
+    
+    set_frame_header(AI_HAT_OP_MODEL_CHUNK, 0, upload.model_id, len + AI_HAT_CHUNK_TRAILER, offset);
+    segments[0].tx = (const uint8_t*)&frame_header;
+    segments[0].rx = NULL;
+    segments[0].len = sizeof(frame_header);
+    segments[1].tx = upload.data + offset;
+    segments[1].rx = NULL;
+    segments[1].len = len;
+    segments[2].tx = chunk_trailer;
+    segments[2].rx = NULL;
+    segments[2].len = AI_HAT_CHUNK_TRAILER;
+    
+    ai_hat_status_t status = link->stream_start(segments, 3);
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    uint32_t next = offset + len;
+    if (next < upload.size) {
+        upload.next_crc = crc32(upload.data + next, chunk_length(next));
+        upload.next_crc_offset = next;
+    }
+    
+    status = link->stream_wait();
+    if (status == AI_HAT_SUCCESS) {
+        status = query_received(&received);
+    }
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    if (received == next) {
+        upload.offset = next;
+        return AI_HAT_SUCCESS;
+    }
+    
+    // Dropped: clear the error flag it raised, and resend with the
+    // CRC we already have
+    upload.next_crc_offset = offset;
+    upload.next_crc = crc;
+    upload.retransmits++;
+    status = read_status(&status_word);
+    return (status == AI_HAT_SUCCESS) ? AI_HAT_PENDING : status;
+}
+
+// Commit a fully acknowledged upload and add the model to the list. The
+// HAT reports busy while it places the model in its memory.
+static ai_hat_status_t finish_upload(ai_hat_model_t** model) {
+    ai_hat_status_t status = frame_transfer(AI_HAT_OP_MODEL_COMMIT, 0, upload.model_id, NULL, NULL, 0,
+                                            upload.size);
+    if (status == AI_HAT_SUCCESS) {
+        status = wait_idle();
+    }
+    if (status == AI_HAT_ERROR_COMM && (frame_status & AI_HAT_STATUS_ERROR)) {
+        return AI_HAT_ERROR_MODEL;
+    }
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    *model = register_model(upload.model_id, upload.size, upload.precision);
+    return AI_HAT_SUCCESS;
+}
+
+// Set the model upload chunk size
+ai_hat_status_t ai_hat_set_chunk_size(uint32_t bytes) {
+    if (bytes < AI_HAT_MIN_CHUNK_SIZE || bytes > AI_HAT_MAX_CHUNK_SIZE) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    chunk_size = bytes;
+    return AI_HAT_SUCCESS;
+}
+
+// Start uploading a model
+ai_hat_status_t ai_hat_load_model_start(const void* model_data, uint32_t model_size, ai_hat_precision_t precision,
+                                        uint32_t* model_id) {
+    uint32_t status_word;
+    
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
+    }
+    
+    if (model_data == NULL || model_id == NULL || model_size == 0 || precision > AI_HAT_PRECISION_INT4) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    if (upload.active) {
+        return AI_HAT_ERROR_BUSY;
+    }
+    
+    if (num_loaded_models >= AI_HAT_MAX_MODELS) {
+        return AI_HAT_ERROR_MEMORY;
+    }
+    
+    memset(&upload, 0, sizeof(upload));
+    upload.data = (const uint8_t*)model_data;
+    upload.size = model_size;
+    upload.model_id = next_model_id;
+    upload.precision = precision;
+    upload.chunk_size = chunk_size;
+    upload.next_crc_offset = model_size;  // Nothing computed ahead yet
+    
+    ai_hat_status_t status = frame_transfer(AI_HAT_OP_MODEL_BEGIN, (uint8_t)precision, upload.model_id, NULL, NULL, 0,
+                                            model_size);
+    if (status == AI_HAT_SUCCESS) {
+        status = read_status(&status_word);
+    }
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    if (status_word & AI_HAT_STATUS_ERROR) {
+        return AI_HAT_ERROR_MEMORY;
+    }
+    
+    // Ids are 16 bits on the wire and never 0
+    next_model_id = (next_model_id % 0xFFFF) + 1;
+    
+    *model_id = upload.model_id;
+    upload.active = true;
+    upload.result = AI_HAT_PENDING;
+    return AI_HAT_SUCCESS;
+}
+
+// Discard what the HAT has received of the current upload
+static void drop_upload(void) {
+    if (ai_hat_initialized && upload.active) {
+        frame_transfer(AI_HAT_OP_MODEL_UNLOAD, 0, upload.model_id, NULL, NULL, 0, 0);
+    }
+    
+    upload.active = false;
+    upload.resync = false;
+    upload.data = NULL;
+}
+
+// Continue the upload from wherever the HAT says it got to
+static ai_hat_status_t resync_upload(void) {
+    uint32_t received;
+    ai_hat_status_t status = query_received(&received);
+    
+    if (status == AI_HAT_SUCCESS && received != upload.offset) {
+        upload.offset = (received < upload.size) ? received : upload.size;
+        upload.next_crc_offset = upload.size;
+    }
+    return status;
+}
+
+// Send chunks of the current upload for about budget_us microseconds
+ai_hat_status_t ai_hat_load_model_step(uint32_t budget_us) {
+    uint64_t start = timer_ticks();
+    uint64_t budget = timer_div64((uint64_t)budget_us * timer_ticks_per_sec(), 1000000);
+    uint32_t failures = 0;
+    ai_hat_model_t* model = NULL;
+    ai_hat_status_t status = AI_HAT_SUCCESS;
+    
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
+    }
+    
+    if (!upload.active) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    // After a failed step the HAT is the authority on what arrived
+    if (upload.resync) {
+        status = resync_upload();
+    }
+    
+    while (status == AI_HAT_SUCCESS && upload.offset < upload.size) {
+        status = send_chunk();
+        
+        // A frame lost on the link is handled like a dropped chunk
+        if (status == AI_HAT_ERROR_TIMEOUT) {
+            upload.retransmits++;
+            status = resync_upload();
+            if (status == AI_HAT_SUCCESS) {
+                status = AI_HAT_PENDING;
+            }
+        }
+        
+        if (status == AI_HAT_PENDING) {
+            status = (++failures > AI_HAT_UPLOAD_RETRIES) ? AI_HAT_ERROR_COMM : AI_HAT_SUCCESS;
+            continue;
+        }
+        failures = 0;
+        
+        if (budget_us != 0 && timer_ticks() - start >= budget) {
+            break;
+        }
+    }
+    
+    if (status == AI_HAT_SUCCESS && upload.offset == upload.size) {
+        status = finish_upload(&model);
+    }
+    
+    upload.ticks += timer_ticks() - start;
+    
+    if (status != AI_HAT_SUCCESS) {
+        // Keep the upload so the next step can resume it, unless it keeps
+        // failing; then the error is its outcome
+        if (++upload.failed_steps > AI_HAT_UPLOAD_RETRIES) {
+            drop_upload();
+            upload.result = status;
+        } else {
+            upload.resync = true;
+        }
+        return status;
+    }
+    
+    upload.failed_steps = 0;
+    upload.resync = false;
+    if (upload.offset < upload.size) {
+        upload.result = AI_HAT_PENDING;
+        return AI_HAT_PENDING;
+    }
     
+    model->load_us = (uint32_t)timer_div64(timer_ticks_to_ns(upload.ticks), 1000);
+    model->retransmits = upload.retransmits;
+    upload.active = false;
+    upload.result = AI_HAT_SUCCESS;
     return AI_HAT_SUCCESS;
 }
 
+// Get the progress of the current or last upload
+ai_hat_status_t ai_hat_get_load_progress(ai_hat_load_progress_t* progress) {
+    if (progress != NULL) {
+        progress->model_id = upload.model_id;
+        progress->size = upload.size;
+        progress->sent = upload.offset;
+        progress->chunk_size = upload.chunk_size;
+        progress->retransmits = upload.retransmits;
+        progress->ticks = upload.ticks;
+    }
+    
+    return upload.result;
+}
+
+// Abandon the current upload
+void ai_hat_load_model_abort(void) {
+    drop_upload();
+    memset(&upload, 0, sizeof(upload));
+}
+
+// Load a model to the AI HAT+
+ai_hat_status_t ai_hat_load_model(const void* model_data, uint32_t model_size, ai_hat_precision_t precision,
+                                  uint32_t* model_id) {
+    ai_hat_status_t status = ai_hat_load_model_start(model_data, model_size, precision, model_id);
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    // A step that fails on a link timeout is resumed from where the HAT got to
+    uint32_t timeouts = 0;
+    do {
+        status = ai_hat_load_model_step(0);
+    } while (status == AI_HAT_PENDING || (status == AI_HAT_ERROR_TIMEOUT && ++timeouts <= AI_HAT_UPLOAD_RETRIES));
+    
+    if (status != AI_HAT_SUCCESS) {
+        ai_hat_load_model_abort();
+    }
+    
+    return status;
+}
+
 // Unload a model from the AI HAT+
 ai_hat_status_t ai_hat_unload_model(uint32_t model_id) {
     if (!ai_hat_initialized) {
@@ -415,8 +1059,9 @@ ai_hat_status_t ai_hat_unload_model(uint32_t model_id) {
         return AI_HAT_ERROR_PARAM;
     }
     
-    // TODO: Implement actual model unloading
-    // This is a placeholder for actual model unloading code
+    // Free it on the HAT; the entry goes either way, a HAT that did not
+    // answer has to be reinitialized anyway
+    ai_hat_status_t status = frame_transfer(AI_HAT_OP_MODEL_UNLOAD, 0, model_id, NULL, NULL, 0, 0);
     
     // Remove model from list by shifting remaining models
     for (uint32_t i = model_index; i < num_loaded_models - 1; i++) {
@@ -425,17 +1070,18 @@ ai_hat_status_t ai_hat_unload_model(uint32_t model_id) {
     
     num_loaded_models--;
     
-    return AI_HAT_SUCCESS;
+    return status;
 }
 
 // Run inference on a loaded model
 ai_hat_status_t ai_hat_run_inference(uint32_t model_id, const void* input, uint32_t input_size, void* output, uint32_t output_size) {
-    if (!ai_hat_initialized) {
-        return AI_HAT_ERROR_INIT;
-    }
-    
-    if (input == NULL || output == NULL) {
-        return AI_HAT_ERROR_PARAM;
+    return ai_hat_run_inference_batch(model_id, &input, input_size, &output, output_size, 1);
+}
+
+// Check an inference against the model's declared tensor sizes
+static ai_hat_status_t check_inference(uint32_t model_id, uint32_t input_size, uint32_t output_size) {
+    if (pending.active) {
+        return AI_HAT_ERROR_BUSY;
     }
     
     // Find model in list
@@ -451,21 +1097,135 @@ ai_hat_status_t ai_hat_run_inference(uint32_t model_id, const void* input, uint3
         return AI_HAT_ERROR_PARAM;
     }
     
-    // Check input and output sizes
-    if (input_size != loaded_models[model_index].input_size ||
-        output_size != loaded_models[model_index].output_size) {
+    // Check input and output sizes where the model declares them
+    const ai_hat_model_t* model = &loaded_models[model_index];
+    if (input_size == 0 || output_size == 0 ||
+        (model->input_size != 0 && input_size != model->input_size) ||
+        (model->output_size != 0 && output_size != model->output_size)) {
         return AI_HAT_ERROR_PARAM;
     }
     
-    // TODO: Implement actual inference via SPI
-    // This is a placeholder for actual inference code
+    return AI_HAT_SUCCESS;
+}
+
+// Run inference on several inputs in one transaction
+ai_hat_status_t ai_hat_run_inference_batch(uint32_t model_id, const void* const* inputs, uint32_t input_size,
+                                           void* const* outputs, uint32_t output_size, uint32_t count) {
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
+    }
     
-    // For now, we'll simulate successful inference with dummy output
-    memset(output, 0, output_size);
+    if (inputs == NULL || outputs == NULL || count == 0 || count > AI_HAT_MAX_BATCH) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        if (inputs[i] == NULL || outputs[i] == NULL) {
+            return AI_HAT_ERROR_PARAM;
+        }
+    }
+    
+    ai_hat_status_t status = check_inference(model_id, input_size, output_size);
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    uint64_t start = timer_ticks();
+    status = stream_batch(model_id, inputs, input_size, outputs, output_size, count);
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    stream_stats.bytes += (uint64_t)(input_size + output_size) * count;
+    stream_stats.ticks += timer_ticks() - start;
+    stream_stats.tensors += count;
     
     return AI_HAT_SUCCESS;
 }
 
+// Upload the input and start computing, without waiting for the result
+ai_hat_status_t ai_hat_inference_start(uint32_t model_id, const void* input, uint32_t input_size,
+                                       uint32_t output_size) {
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
+    }
+    
+    if (input == NULL) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    ai_hat_status_t status = check_inference(model_id, input_size, output_size);
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    pending.start = timer_ticks();
+    status = stream_tensor(AI_HAT_OP_WRITE_INPUT, 0, model_id, input, NULL, input_size);
+    if (status == AI_HAT_SUCCESS) {
+        status = frame_transfer(AI_HAT_OP_RUN, 0, model_id, NULL, NULL, 0, output_size);
+    }
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    pending.active = true;
+    pending.model_id = model_id;
+    pending.input_size = input_size;
+    pending.output_size = output_size;
+    return AI_HAT_SUCCESS;
+}
+
+// Wait for the started inference and read its output
+ai_hat_status_t ai_hat_inference_finish(void* output) {
+    if (!pending.active) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    // The HAT is free again whatever happens here
+    pending.active = false;
+    ai_hat_status_t status = wait_idle();
+    if (status == AI_HAT_SUCCESS && output != NULL) {
+        status = stream_tensor(AI_HAT_OP_READ_OUTPUT, 0, pending.model_id, NULL, output, pending.output_size);
+    }
+    if (status != AI_HAT_SUCCESS) {
+        return status;
+    }
+    
+    stream_stats.bytes += pending.input_size + pending.output_size;
+    stream_stats.ticks += timer_ticks() - pending.start;
+    stream_stats.tensors++;
+    
+    return AI_HAT_SUCCESS;
+}
+
+// Enable or disable overlapping tensor transfers with computation
+ai_hat_status_t ai_hat_set_double_buffering(int enable) {
+    double_buffering = enable != 0;
+    return AI_HAT_SUCCESS;
+}
+
+// Get tensor streaming statistics
+ai_hat_status_t ai_hat_get_stream_stats(ai_hat_stream_stats_t* stats) {
+    if (!ai_hat_initialized) {
+        return AI_HAT_ERROR_INIT;
+    }
+    
+    if (stats == NULL) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    *stats = stream_stats;
+    stats->link = link->name;
+    stats->bus_clock = link->bus_clock();
+    
+    return AI_HAT_SUCCESS;
+}
+
+// Reset tensor streaming statistics
+void ai_hat_reset_stream_stats(void) {
+    memset(&stream_stats, 0, sizeof(stream_stats));
+}
+
 // Get list of loaded models
 ai_hat_status_t ai_hat_get_models(ai_hat_model_t* models, uint32_t max_models, uint32_t* num_models) {
     if (!ai_hat_initialized) {
@@ -493,6 +1253,11 @@ void ai_hat_shutdown(void) {
         return;
     }
     
+    // Let a telemetry read finish, its registers are read into static buffers
+    while (telemetry_active && telemetry_poll(NULL) == AI_HAT_PENDING) {
+        asm volatile("nop");
+    }
+    
     // Send shutdown command
     send_command(AI_HAT_REG_CONTROL, AI_HAT_CMD_SHUTDOWN, NULL, 0);
     
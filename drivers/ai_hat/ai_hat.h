@@ -11,15 +11,29 @@
 
 #include "../../kernel/types.h"
 
+// Most inputs accepted by one batched inference call
+#define AI_HAT_MAX_BATCH 16
+
+// Models resident on the HAT
+#define AI_HAT_MAX_MODELS 8
+
+// Model upload chunking
+#define AI_HAT_DEFAULT_CHUNK_SIZE  4096
+#define AI_HAT_MIN_CHUNK_SIZE      256
+#define AI_HAT_MAX_CHUNK_SIZE      (60 * 1024 - 4)  // One DMA transaction with header and CRC
+#define AI_HAT_UPLOAD_RETRIES      3                // Resends of one chunk before giving up
+
 // AI HAT+ status codes
 typedef enum {
+    AI_HAT_PENDING = 1,           // Model upload not finished yet
     AI_HAT_SUCCESS = 0,
     AI_HAT_ERROR_INIT = -1,
     AI_HAT_ERROR_COMM = -2,
     AI_HAT_ERROR_PARAM = -3,
     AI_HAT_ERROR_MODEL = -4,
     AI_HAT_ERROR_MEMORY = -5,
-    AI_HAT_ERROR_TIMEOUT = -6
+    AI_HAT_ERROR_TIMEOUT = -6,
+    AI_HAT_ERROR_BUSY = -7        // Another model upload or a started inference is in progress
 } ai_hat_status_t;
 
 // AI HAT+ power modes
@@ -43,7 +57,7 @@ typedef enum {
 typedef struct {
     uint32_t version;
     uint32_t max_tops;
-    uint32_t memory_size;
+    uint32_t memory_size;        // Device memory in KB
     uint32_t temperature;
     uint32_t power_consumption;
     ai_hat_power_mode_t power_mode;
@@ -55,13 +69,45 @@ typedef struct {
     uint32_t id;
     uint32_t size;
     ai_hat_precision_t precision;
-    uint32_t input_size;
+    uint32_t input_size;     // Tensor sizes in bytes, 0 if not declared
     uint32_t output_size;
+    uint32_t load_us;        // Time spent uploading
+    uint32_t retransmits;    // Chunks resent after a CRC or link error
 } ai_hat_model_t;
 
+// Progress of a model upload
+typedef struct {
+    uint32_t model_id;
+    uint32_t size;
+    uint32_t sent;           // Bytes acknowledged by the HAT
+    uint32_t chunk_size;
+    uint32_t retransmits;
+    uint64_t ticks;          // timer ticks spent in upload steps
+} ai_hat_load_progress_t;
+
+// Telemetry registers, read in one batch
+typedef struct {
+    uint32_t temperature;  // Celsius
+    uint32_t power;        // mW
+    uint32_t busy;         // Non-zero while the HAT is computing or placing a model
+} ai_hat_telemetry_t;
+
+// Tensor streaming statistics, accumulated over inference calls
+typedef struct {
+    const char* link;      // "spi-dma" or "emulator"
+    uint32_t bus_clock;    // SPI clock in Hz
+    uint32_t tensors;      // Inferences completed
+    uint64_t bytes;        // Input and output bytes moved
+    uint64_t ticks;        // timer ticks spent in inference calls
+} ai_hat_stream_stats_t;
+
 // Initialize the AI HAT+
 ai_hat_status_t ai_hat_init(void);
 
+// Initialize against the software emulator instead of the I2C/SPI hardware
+// (QEMU and bring-up). Both return success if the HAT is already up.
+ai_hat_status_t ai_hat_init_emulator(void);
+
 // Get AI HAT+ information
 ai_hat_status_t ai_hat_get_info(ai_hat_info_t* info);
 
@@ -74,8 +120,38 @@ ai_hat_status_t ai_hat_get_temperature(uint32_t* temperature);
 // Get AI HAT+ power consumption (in mW)
 ai_hat_status_t ai_hat_get_power_consumption(uint32_t* power);
 
-// Load a model to the AI HAT+
-ai_hat_status_t ai_hat_load_model(const void* model_data, uint32_t model_size, uint32_t* model_id);
+// Telemetry without stalling: start queues reads of the temperature, power
+// and status registers on the I2C bus and returns at once (AI_HAT_ERROR_BUSY
+// while a read is outstanding); poll returns AI_HAT_PENDING until they have
+// completed, then fills in telemetry (may be NULL). get waits for a read.
+// All three update ai_hat_get_info().
+ai_hat_status_t ai_hat_telemetry_start(void);
+ai_hat_status_t ai_hat_telemetry_poll(ai_hat_telemetry_t* telemetry);
+ai_hat_status_t ai_hat_get_telemetry(ai_hat_telemetry_t* telemetry);
+
+// Load a model to the AI HAT+ (blocks until the upload is done). The HAT
+// sizes the model's buffers and its compute time by precision.
+ai_hat_status_t ai_hat_load_model(const void* model_data, uint32_t model_size, ai_hat_precision_t precision,
+                                  uint32_t* model_id);
+
+// Incremental upload, so large blobs do not hold up everything else.
+// Start assigns the id; each step sends CRC-checked chunks for about
+// budget_us (0 = until done) and returns AI_HAT_PENDING until the model is
+// loaded. After an error the upload is kept: the next step asks the HAT how
+// far it got and resumes from there, or abort discards it. After
+// AI_HAT_UPLOAD_RETRIES failed steps in a row the upload is dropped. The
+// blob must stay in place until the upload ends.
+ai_hat_status_t ai_hat_load_model_start(const void* model_data, uint32_t model_size, ai_hat_precision_t precision,
+                                        uint32_t* model_id);
+ai_hat_status_t ai_hat_load_model_step(uint32_t budget_us);
+void ai_hat_load_model_abort(void);
+
+// Progress of the current or last upload; returns AI_HAT_PENDING while it
+// is running or waiting to be resumed, otherwise its outcome
+ai_hat_status_t ai_hat_get_load_progress(ai_hat_load_progress_t* progress);
+
+// Chunk size for uploads started from now on (AI_HAT_MIN/MAX_CHUNK_SIZE)
+ai_hat_status_t ai_hat_set_chunk_size(uint32_t bytes);
 
 // Unload a model from the AI HAT+
 ai_hat_status_t ai_hat_unload_model(uint32_t model_id);
@@ -83,6 +159,27 @@ ai_hat_status_t ai_hat_unload_model(uint32_t model_id);
 // Run inference on a loaded model
 ai_hat_status_t ai_hat_run_inference(uint32_t model_id, const void* input, uint32_t input_size, void* output, uint32_t output_size);
 
+// Run inference on up to AI_HAT_MAX_BATCH inputs in one transaction.
+// inputs[i] produces outputs[i]; all tensors of a batch have the same size.
+ai_hat_status_t ai_hat_run_inference_batch(uint32_t model_id, const void* const* inputs, uint32_t input_size,
+                                           void* const* outputs, uint32_t output_size, uint32_t count);
+
+// Split inference, so the caller can work while the HAT computes: start
+// uploads the input and starts the model, finish waits for it and reads
+// the output (NULL discards it). One inference may be outstanding; other
+// inference calls return AI_HAT_ERROR_BUSY until it is finished.
+ai_hat_status_t ai_hat_inference_start(uint32_t model_id, const void* input, uint32_t input_size,
+                                       uint32_t output_size);
+ai_hat_status_t ai_hat_inference_finish(void* output);
+
+// Overlap uploading input n+1 and reading output n with computing on the
+// HAT (default on). Off, every tensor is uploaded, run and read in turn.
+ai_hat_status_t ai_hat_set_double_buffering(int enable);
+
+// Get or reset tensor streaming statistics
+ai_hat_status_t ai_hat_get_stream_stats(ai_hat_stream_stats_t* stats);
+void ai_hat_reset_stream_stats(void);
+
 // Get list of loaded models
 ai_hat_status_t ai_hat_get_models(ai_hat_model_t* models, uint32_t max_models, uint32_t* num_models);
 
@@ -0,0 +1,680 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI HAT+ Software Emulator
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "ai_hat_emu.h"
+#include "../../kernel/timer.h"
+#include "../../kernel/crc32.h"
+#include "../../kernel/stdio.h"
+#include <stdbool.h>
+
+#define EMU_MC_PER_W        15          // Thermal resistance, millidegrees per mW
+
+#define EMU_NO_SLOT         0xFF
+
+// Register file answered over the emulated I2C bus, AI_HAT_REG_VERSION to
+// AI_HAT_REG_MEMORY; other addresses read as zero
+#define EMU_REGISTERS       (AI_HAT_REG_MEMORY + 1)
+#define EMU_REGISTER_BYTES  8
+
+static uint8_t registers[EMU_REGISTERS][EMU_REGISTER_BYTES];
+
+static uint8_t input_slots[AI_HAT_TENSOR_SLOTS][AI_HAT_EMU_SLOT_SIZE];
+static uint32_t input_length[AI_HAT_TENSOR_SLOTS];
+static uint32_t output_length[AI_HAT_TENSOR_SLOTS];  // Set by RUN
+static uint16_t output_model[AI_HAT_TENSOR_SLOTS];
+
+// Model store: only sizes and progress are kept, the blob itself is
+// checked and dropped. Memory is reserved for the whole blob at MODEL_BEGIN.
+typedef struct {
+    bool used;
+    bool committed;
+    uint16_t id;
+    ai_hat_precision_t precision;
+    uint32_t size;
+    uint32_t received;
+    uint32_t reserved_kb;
+} emu_model_t;
+
+static emu_model_t models[AI_HAT_EMU_MAX_MODELS];
+static uint8_t chunk_buffer[AI_HAT_FRAME_MAX_PAYLOAD];
+static uint32_t memory_kb = AI_HAT_EMU_MEMORY_KB;
+static uint32_t memory_used_kb = 0;
+
+// Fault injection, counted per kind of event
+static ai_hat_emu_faults_t faults;
+static uint32_t register_accesses = 0;
+static uint32_t transactions = 0;
+static uint32_t chunks_seen = 0;
+static bool transaction_lost = false;
+
+static uint32_t bus_clock_hz = AI_HAT_EMU_DEFAULT_CLOCK;
+static uint32_t compute_us = AI_HAT_EMU_DEFAULT_COMPUTE_US;
+
+// Per power mode: idle and fully busy draw in mW, and inference time as a
+// percentage of compute_us
+static const struct {
+    uint32_t idle_mw;
+    uint32_t active_mw;
+    uint32_t speed_percent;
+} power_modes[] = {
+    {0, 0, 0},              // OFF: inferences are refused
+    {250, 1000, 300},       // LOW
+    {400, 2000, 100},       // MEDIUM
+    {600, 3200, 70},        // HIGH
+    {800, 4600, 50},        // MAX
+};
+
+// Inference time per precision, as a percentage of FP16
+static const uint32_t precision_percent[] = {
+    200,    // FP32
+    100,    // FP16
+    50,     // INT8
+    33,     // INT4
+};
+
+static int32_t ambient_mc = AI_HAT_EMU_AMBIENT_C * 1000;
+static uint32_t time_constant_ms = AI_HAT_EMU_TIME_CONSTANT_MS;
+static ai_hat_emu_thermal_t thermal;
+static uint64_t thermal_updated = 0;     // Tick of the last thermal update
+static uint64_t busy_ticks = 0;          // Compute time started since then
+
+static uint64_t link_busy_until = 0;     // Tick at which the current frame leaves the wire
+static uint64_t compute_busy_until = 0;  // Tick at which the running inference finishes
+static uint64_t commit_busy_until = 0;   // Tick at which the last committed model is in place
+static uint64_t regs_busy_until = 0;     // Tick at which the queued register reads complete
+static bool regs_active = false;
+static bool regs_failed = false;
+static uint8_t computing_slot = EMU_NO_SLOT;
+static uint32_t status_flags = 0;
+static bool stream_active = false;
+
+// Walks the gathered segments of one SPI transaction byte by byte
+typedef struct {
+    const spi_segment_t* segments;
+    uint32_t count;
+    uint32_t index;
+    uint32_t offset;
+} emu_cursor_t;
+
+static uint64_t ticks_for_bytes(uint32_t bytes) {
+    return timer_div64((uint64_t)bytes * 8 * timer_ticks_per_sec(), bus_clock_hz);
+}
+
+static uint64_t ticks_for_us(uint32_t us) {
+    return timer_div64((uint64_t)us * timer_ticks_per_sec(), 1000000);
+}
+
+// Clock `len` bytes through the cursor. What the host sends is copied to
+// `from_host`, what the HAT sends back comes from `to_host`; either may be
+// NULL to discard or to answer with zeros.
+static void exchange(emu_cursor_t* cursor, uint8_t* from_host, const uint8_t* to_host, uint32_t len) {
+    while (len > 0 && cursor->index < cursor->count) {
+        const spi_segment_t* segment = &cursor->segments[cursor->index];
+        uint32_t chunk = segment->len - cursor->offset;
+        if (chunk > len) {
+            chunk = len;
+        }
+        
+        if (from_host != NULL) {
+            if (segment->tx != NULL) {
+                memcpy(from_host, segment->tx + cursor->offset, chunk);
+            } else {
+                memset(from_host, 0, chunk);
+            }
+            from_host += chunk;
+        }
+        
+        if (segment->rx != NULL) {
+            if (to_host != NULL) {
+                memcpy(segment->rx + cursor->offset, to_host, chunk);
+            } else {
+                memset(segment->rx + cursor->offset, 0, chunk);
+            }
+        }
+        if (to_host != NULL) {
+            to_host += chunk;
+        }
+        
+        cursor->offset += chunk;
+        len -= chunk;
+        if (cursor->offset == segment->len) {
+            cursor->index++;
+            cursor->offset = 0;
+        }
+    }
+}
+
+// Stand-in for the accelerator: output byte i is a cheap, checkable
+// function of the slot's input. Only the first AI_HAT_EMU_SLOT_SIZE input
+// bytes are kept, so outputs are produced as they are read instead of
+// being stored.
+static void produce_output(uint8_t slot, uint32_t offset, uint8_t* out, uint32_t len) {
+    const uint8_t* in = input_slots[slot];
+    uint32_t in_len = input_length[slot];
+    
+    if (in_len > AI_HAT_EMU_SLOT_SIZE) {
+        in_len = AI_HAT_EMU_SLOT_SIZE;
+    }
+    
+    for (uint32_t i = 0; i < len; i++) {
+        out[i] = in_len ? (uint8_t)(in[(offset + i) % in_len] ^ output_model[slot]) : 0;
+    }
+}
+
+static void read_output(emu_cursor_t* cursor, uint8_t slot, uint32_t offset, uint32_t len) {
+    uint8_t buffer[256];
+    
+    while (len > 0) {
+        uint32_t chunk = (len < sizeof(buffer)) ? len : sizeof(buffer);
+        produce_output(slot, offset, buffer, chunk);
+        exchange(cursor, NULL, buffer, chunk);
+        offset += chunk;
+        len -= chunk;
+    }
+}
+
+static emu_model_t* find_model(uint16_t id) {
+    for (int i = 0; i < AI_HAT_EMU_MAX_MODELS; i++) {
+        if (models[i].used && models[i].id == id) {
+            return &models[i];
+        }
+    }
+    
+    return NULL;
+}
+
+static void model_free(emu_model_t* model) {
+    memory_used_kb -= model->reserved_kb;
+    model->reserved_kb = 0;
+    model->used = false;
+}
+
+// Reserve memory for a new upload; a restarted one gives its old
+// reservation back first
+static bool model_begin(uint16_t id, uint32_t size, uint8_t precision) {
+    emu_model_t* model = find_model(id);
+    uint32_t pages = (uint32_t)timer_div64((uint64_t)size + AI_HAT_EMU_PAGE - 1, AI_HAT_EMU_PAGE);
+    uint32_t need_kb = pages * (AI_HAT_EMU_PAGE / 1024);
+    
+    if (model != NULL) {
+        model_free(model);
+    }
+    for (int i = 0; model == NULL && i < AI_HAT_EMU_MAX_MODELS; i++) {
+        if (!models[i].used) {
+            model = &models[i];
+        }
+    }
+    
+    if (model == NULL || size == 0 || precision > AI_HAT_PRECISION_INT4 ||
+        memory_used_kb > memory_kb || need_kb > memory_kb - memory_used_kb) {
+        return false;
+    }
+    
+    model->used = true;
+    model->committed = false;
+    model->id = id;
+    model->precision = (ai_hat_precision_t)precision;
+    model->size = size;
+    model->received = 0;
+    model->reserved_kb = need_kb;
+    memory_used_kb += need_kb;
+    return true;
+}
+
+// Accept a chunk only if it is the next one in order and its CRC matches
+static bool model_chunk(emu_cursor_t* cursor, const ai_hat_frame_t* frame) {
+    emu_model_t* model = find_model(frame->model_id);
+    uint32_t len = frame->length - AI_HAT_CHUNK_TRAILER;
+    uint8_t trailer[AI_HAT_CHUNK_TRAILER];
+    
+    if (model == NULL || model->committed || frame->length <= AI_HAT_CHUNK_TRAILER ||
+        len > sizeof(chunk_buffer) || frame->arg != model->received || len > model->size - model->received) {
+        return false;
+    }
+    
+    exchange(cursor, chunk_buffer, NULL, len);
+    exchange(cursor, trailer, NULL, sizeof(trailer));
+    
+    if (faults.crc_every != 0 && ++chunks_seen % faults.crc_every == 0) {
+        chunk_buffer[len / 2] ^= 0x01;
+        faults.crc_errors++;
+    }
+    
+    uint32_t expected = (uint32_t)trailer[0] | ((uint32_t)trailer[1] << 8) |
+                        ((uint32_t)trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+    if (crc32(chunk_buffer, len) != expected) {
+        return false;
+    }
+    
+    model->received += len;
+    return true;
+}
+
+static bool computing(uint64_t now) {
+    return computing_slot != EMU_NO_SLOT && now < compute_busy_until;
+}
+
+static bool device_busy(uint64_t now) {
+    return computing(now) || now < commit_busy_until;
+}
+
+static void thermal_reset(void) {
+    thermal.power_mode = AI_HAT_POWER_MEDIUM;   // What the driver assumes after init
+    thermal.power_mw = power_modes[AI_HAT_POWER_MEDIUM].idle_mw;
+    thermal.temperature_mc = (uint32_t)(ambient_mc + (int32_t)(thermal.power_mw * EMU_MC_PER_W));
+    thermal.throttled = 0;
+    thermal_updated = timer_ticks();
+    busy_ticks = 0;
+}
+
+// Advance the thermal model to now. Updates closer together than 1 ms
+// are folded into the next one so back-to-back register reads agree.
+static void thermal_update(uint64_t now) {
+    uint64_t elapsed = now - thermal_updated;
+    uint32_t elapsed_ms = (uint32_t)timer_div64(timer_ticks_to_ns(elapsed), 1000000);
+    
+    if (elapsed_ms == 0) {
+        return;
+    }
+    
+    uint32_t busy_permille = (busy_ticks >= elapsed) ? 1000 : (uint32_t)timer_div64(busy_ticks * 1000, elapsed);
+    uint32_t idle = power_modes[thermal.power_mode].idle_mw;
+    uint32_t active = power_modes[thermal.power_mode].active_mw;
+    thermal.power_mw = idle + (active - idle) * busy_permille / 1000;
+    
+    // First-order step towards the steady state for this power, divided
+    // unsigned since 32-bit targets have no signed 64-bit divide
+    int32_t target = ambient_mc + (int32_t)(thermal.power_mw * EMU_MC_PER_W);
+    int32_t current = (int32_t)thermal.temperature_mc;
+    uint64_t gap = (uint64_t)((target > current) ? target - current : current - target);
+    int32_t step = (int32_t)timer_div64(gap * elapsed_ms, (uint64_t)time_constant_ms + elapsed_ms);
+    current += (target > current) ? step : -step;
+    thermal.temperature_mc = (current > 0) ? (uint32_t)current : 0;
+    
+    thermal_updated = now;
+    busy_ticks = (busy_ticks > elapsed) ? busy_ticks - elapsed : 0;
+}
+
+// Inference time for the model's precision in the current power mode,
+// doubled while overheated
+static uint64_t inference_ticks(uint64_t now, ai_hat_precision_t precision) {
+    uint64_t ticks = timer_div64(ticks_for_us(compute_us) * power_modes[thermal.power_mode].speed_percent *
+                                  precision_percent[precision], 100 * 100);
+    
+    thermal_update(now);
+    if (thermal.temperature_mc >= AI_HAT_EMU_THROTTLE_C * 1000) {
+        thermal.throttled++;
+        ticks *= 2;
+    }
+    return ticks;
+}
+
+static bool execute_frame(emu_cursor_t* cursor, const ai_hat_frame_t* frame, uint64_t frame_end) {
+    uint64_t now = timer_ticks();
+    uint8_t slot = frame->slot;
+    
+    if (slot >= AI_HAT_TENSOR_SLOTS && frame->opcode != AI_HAT_OP_MODEL_BEGIN) {
+        return false;
+    }
+    
+    switch (frame->opcode) {
+    case AI_HAT_OP_WRITE_INPUT:
+        if (frame->arg > AI_HAT_EMU_TENSOR_MAX || frame->length > AI_HAT_EMU_TENSOR_MAX - frame->arg) {
+            return false;
+        }
+        
+        // The first chunk of a tensor starts a new input
+        if (frame->arg == 0) {
+            input_length[slot] = 0;
+        }
+        if (frame->arg < AI_HAT_EMU_SLOT_SIZE) {
+            uint32_t kept = AI_HAT_EMU_SLOT_SIZE - frame->arg;
+            kept = (kept < frame->length) ? kept : frame->length;
+            exchange(cursor, input_slots[slot] + frame->arg, NULL, kept);
+        }
+        if (frame->arg + frame->length > input_length[slot]) {
+            input_length[slot] = frame->arg + frame->length;
+        }
+        return true;
+    
+    case AI_HAT_OP_RUN: {
+        emu_model_t* model = find_model(frame->model_id);
+        if (model == NULL || !model->committed || device_busy(now) || frame->arg > AI_HAT_EMU_TENSOR_MAX ||
+            thermal.power_mode == AI_HAT_POWER_OFF) {
+            return false;
+        }
+        
+        // Reported busy from the end of this frame for as long as the
+        // accelerator would take
+        uint64_t duration = inference_ticks(now, model->precision);
+        output_length[slot] = frame->arg;
+        output_model[slot] = frame->model_id;
+        computing_slot = slot;
+        compute_busy_until = frame_end + duration;
+        busy_ticks += duration;
+        return true;
+    }
+    
+    case AI_HAT_OP_READ_OUTPUT:
+        if ((computing(now) && computing_slot == slot) ||
+            frame->arg > output_length[slot] || frame->length > output_length[slot] - frame->arg) {
+            return false;
+        }
+        read_output(cursor, slot, frame->arg, frame->length);
+        return true;
+    
+    case AI_HAT_OP_STATUS: {
+        uint32_t word = status_flags | (device_busy(now) ? AI_HAT_STATUS_BUSY : 0);
+        status_flags = 0;
+        exchange(cursor, NULL, (const uint8_t*)&word, frame->length < sizeof(word) ? frame->length : sizeof(word));
+        return true;
+    }
+    
+    case AI_HAT_OP_MODEL_BEGIN:
+        return model_begin(frame->model_id, frame->arg, slot);
+    
+    case AI_HAT_OP_MODEL_CHUNK:
+        return model_chunk(cursor, frame);
+    
+    case AI_HAT_OP_MODEL_QUERY: {
+        emu_model_t* model = find_model(frame->model_id);
+        uint32_t received = model ? model->received : 0;
+        exchange(cursor, NULL, (const uint8_t*)&received, frame->length < sizeof(received) ? frame->length : sizeof(received));
+        return true;
+    }
+    
+    case AI_HAT_OP_MODEL_COMMIT: {
+        emu_model_t* model = find_model(frame->model_id);
+        if (model != NULL && model->committed) {
+            return true;    // Resent after its acknowledgement was lost
+        }
+        if (model == NULL || model->received != model->size || device_busy(now) ||
+            thermal.power_mode == AI_HAT_POWER_OFF) {
+            return false;
+        }
+        
+        // Busy while the model is placed in memory, at the power mode's speed
+        uint64_t duration = timer_div64(ticks_for_us(model->size / AI_HAT_EMU_COMMIT_BYTES_PER_US) *
+                                         power_modes[thermal.power_mode].speed_percent, 100);
+        thermal_update(now);
+        commit_busy_until = frame_end + duration;
+        busy_ticks += duration;
+        model->committed = true;
+        return true;
+    }
+    
+    case AI_HAT_OP_MODEL_UNLOAD: {
+        emu_model_t* model = find_model(frame->model_id);
+        if (model == NULL) {
+            return false;
+        }
+        model_free(model);
+        return true;
+    }
+    
+    default:
+        return false;
+    }
+}
+
+static ai_hat_status_t emu_init(void) {
+    memset(input_length, 0, sizeof(input_length));
+    memset(output_length, 0, sizeof(output_length));
+    memset(models, 0, sizeof(models));
+    memory_used_kb = 0;
+    register_accesses = 0;
+    transactions = 0;
+    chunks_seen = 0;
+    transaction_lost = false;
+    link_busy_until = 0;
+    compute_busy_until = 0;
+    commit_busy_until = 0;
+    regs_active = false;
+    computing_slot = EMU_NO_SLOT;
+    status_flags = 0;
+    stream_active = false;
+    thermal_reset();
+    
+    return AI_HAT_SUCCESS;
+}
+
+static void put_le32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+// Bring the live registers up to date with the device model
+static void refresh_registers(void) {
+    uint64_t now = timer_ticks();
+    uint32_t celsius;
+    
+    thermal_update(now);
+    celsius = thermal.temperature_mc / 1000;
+    
+    memset(registers, 0, sizeof(registers));
+    registers[AI_HAT_REG_VERSION][0] = 1;  // Version 1.0
+    registers[AI_HAT_REG_CONTROL][0] = (uint8_t)thermal.power_mode;
+    put_le32(registers[AI_HAT_REG_STATUS], status_flags | (device_busy(now) ? AI_HAT_STATUS_BUSY : 0));
+    registers[AI_HAT_REG_TEMP][0] = (celsius > 255) ? 255 : (uint8_t)celsius;
+    registers[AI_HAT_REG_POWER][0] = thermal.power_mw & 0xFF;
+    registers[AI_HAT_REG_POWER][1] = (thermal.power_mw >> 8) & 0xFF;
+    put_le32(registers[AI_HAT_REG_MEMORY], memory_kb);
+    put_le32(registers[AI_HAT_REG_MEMORY] + 4, (memory_used_kb < memory_kb) ? memory_kb - memory_used_kb : 0);
+}
+
+// The device does not acknowledge every n'th register access
+static bool register_nack(void) {
+    if (faults.nack_every != 0 && ++register_accesses % faults.nack_every == 0) {
+        faults.nacks++;
+        return true;
+    }
+    return false;
+}
+
+static ai_hat_status_t emu_write_reg(const uint8_t* data, uint32_t len) {
+    if (data == NULL || len < 1) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    if (register_nack()) {
+        return AI_HAT_ERROR_COMM;
+    }
+    
+    // Only the power mode changes emulated state; init and shutdown do not,
+    // and the other registers are read-only
+    if (len >= 3 && data[0] == AI_HAT_REG_CONTROL && data[1] == AI_HAT_CMD_SET_POWER) {
+        if (data[2] > AI_HAT_POWER_MAX) {
+            return AI_HAT_ERROR_PARAM;
+        }
+        thermal_update(timer_ticks());
+        thermal.power_mode = (ai_hat_power_mode_t)data[2];
+    }
+    return AI_HAT_SUCCESS;
+}
+
+static ai_hat_status_t emu_read_reg(uint8_t reg, uint8_t* data, uint32_t len) {
+    if (data == NULL) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    if (register_nack()) {
+        return AI_HAT_ERROR_COMM;
+    }
+    
+    memset(data, 0, len);
+    if (reg < EMU_REGISTERS) {
+        refresh_registers();
+        memcpy(data, registers[reg], (len < EMU_REGISTER_BYTES) ? len : EMU_REGISTER_BYTES);
+    }
+    
+    return AI_HAT_SUCCESS;
+}
+
+// Each read is the device address, the register, a repeated start, the
+// address again and the data, at nine clocks per byte
+static ai_hat_status_t emu_read_regs_start(const ai_hat_reg_read_t* reads, uint32_t count) {
+    uint64_t bits = 0;
+    
+    if (regs_active) {
+        return AI_HAT_ERROR_BUSY;
+    }
+    
+    if (reads == NULL || count == 0 || count > AI_HAT_REG_BATCH_MAX) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    regs_failed = false;
+    for (uint32_t i = 0; i < count; i++) {
+        if (emu_read_reg(reads[i].reg, reads[i].data, reads[i].len) != AI_HAT_SUCCESS) {
+            regs_failed = true;
+        }
+        bits += ((uint64_t)reads[i].len + 3) * 9;
+    }
+    
+    regs_busy_until = timer_ticks() + timer_div64(bits * timer_ticks_per_sec(), AI_HAT_EMU_I2C_CLOCK);
+    regs_active = true;
+    return AI_HAT_SUCCESS;
+}
+
+static ai_hat_status_t emu_read_regs_poll(void) {
+    if (!regs_active) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    if (timer_ticks() < regs_busy_until) {
+        return AI_HAT_PENDING;
+    }
+    
+    regs_active = false;
+    return regs_failed ? AI_HAT_ERROR_COMM : AI_HAT_SUCCESS;
+}
+
+static ai_hat_status_t emu_stream_start(const spi_segment_t* segments, uint32_t count) {
+    emu_cursor_t cursor = { segments, count, 0, 0 };
+    ai_hat_frame_t frame;
+    uint64_t total = 0;
+    
+    if (stream_active) {
+        return AI_HAT_ERROR_COMM;
+    }
+    
+    if (segments == NULL || count == 0 || count > SPI_DMA_MAX_SEGMENTS) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        total += segments[i].len;
+    }
+    
+    if (total < sizeof(frame) || total > SPI_DMA_MAX_LEN) {
+        return AI_HAT_ERROR_PARAM;
+    }
+    
+    // The transfer occupies the wire from whenever the previous one ended
+    uint64_t now = timer_ticks();
+    uint64_t start = link_busy_until > now ? link_busy_until : now;
+    link_busy_until = start + ticks_for_bytes((uint32_t)total);
+    
+    // A lost transaction never reaches the HAT; the host sees a DMA timeout
+    if (faults.timeout_every != 0 && ++transactions % faults.timeout_every == 0) {
+        faults.timeouts++;
+        transaction_lost = true;
+    } else {
+        exchange(&cursor, (uint8_t*)&frame, NULL, sizeof(frame));
+        if (frame.length != total - sizeof(frame) || !execute_frame(&cursor, &frame, link_busy_until)) {
+            status_flags |= AI_HAT_STATUS_ERROR;
+        }
+    }
+    
+    stream_active = true;
+    return AI_HAT_SUCCESS;
+}
+
+static int emu_stream_busy(void) {
+    return stream_active && timer_ticks() < link_busy_until;
+}
+
+static ai_hat_status_t emu_stream_wait(void) {
+    while (emu_stream_busy()) {
+        asm volatile("nop");
+    }
+    
+    stream_active = false;
+    if (transaction_lost) {
+        transaction_lost = false;
+        return AI_HAT_ERROR_TIMEOUT;
+    }
+    return AI_HAT_SUCCESS;
+}
+
+static uint32_t emu_bus_clock(void) {
+    return bus_clock_hz;
+}
+
+static const ai_hat_link_t emu_link = {
+    "emulator",
+    emu_init,
+    emu_write_reg,
+    emu_read_reg,
+    emu_read_regs_start,
+    emu_read_regs_poll,
+    emu_stream_start,
+    emu_stream_busy,
+    emu_stream_wait,
+    emu_bus_clock
+};
+
+const ai_hat_link_t* ai_hat_emu_get_link(void) {
+    return &emu_link;
+}
+
+void ai_hat_emu_configure(uint32_t bus_clock, uint32_t inference_us) {
+    if (bus_clock > 0) {
+        bus_clock_hz = bus_clock;
+    }
+    compute_us = inference_us;
+}
+
+void ai_hat_emu_set_thermal(int32_t ambient_c, uint32_t time_constant) {
+    thermal_update(timer_ticks());
+    ambient_mc = ambient_c * 1000;
+    time_constant_ms = time_constant;
+}
+
+void ai_hat_emu_get_thermal(ai_hat_emu_thermal_t* state) {
+    thermal_update(timer_ticks());
+    *state = thermal;
+}
+
+void ai_hat_emu_set_memory(uint32_t total_kb) {
+    memory_kb = total_kb;
+}
+
+void ai_hat_emu_get_memory(ai_hat_emu_memory_t* memory) {
+    memory->total_kb = memory_kb;
+    memory->free_kb = (memory_used_kb < memory_kb) ? memory_kb - memory_used_kb : 0;
+    memory->models = 0;
+    for (int i = 0; i < AI_HAT_EMU_MAX_MODELS; i++) {
+        if (models[i].used) {
+            memory->models++;
+        }
+    }
+}
+
+void ai_hat_emu_set_faults(const ai_hat_emu_faults_t* config) {
+    memset(&faults, 0, sizeof(faults));
+    faults.nack_every = config->nack_every;
+    faults.timeout_every = config->timeout_every;
+    faults.crc_every = config->crc_every;
+    register_accesses = 0;
+    transactions = 0;
+    chunks_seen = 0;
+}
+
+void ai_hat_emu_get_faults(ai_hat_emu_faults_t* state) {
+    *state = faults;
+}
@@ -0,0 +1,83 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI HAT+ Software Emulator
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef AI_HAT_EMU_H
+#define AI_HAT_EMU_H
+
+#include "ai_hat_protocol.h"
+
+#define AI_HAT_EMU_SLOT_SIZE          (16 * 1024)  // Input bytes kept per tensor slot
+#define AI_HAT_EMU_TENSOR_MAX         (16 * 1024 * 1024)  // Largest tensor accepted
+#define AI_HAT_EMU_DEFAULT_CLOCK      20000000     // Same SPI clock as the hardware link
+#define AI_HAT_EMU_I2C_CLOCK          400000       // Same I2C clock as the hardware link
+#define AI_HAT_EMU_DEFAULT_COMPUTE_US 400
+#define AI_HAT_EMU_MAX_MODELS         8
+#define AI_HAT_EMU_AMBIENT_C          25
+#define AI_HAT_EMU_TIME_CONSTANT_MS   2000         // Thermal settling time of the board
+#define AI_HAT_EMU_THROTTLE_C         85           // Above this the HAT halves its own speed
+#define AI_HAT_EMU_MEMORY_KB          (64 * 1024)  // Model memory
+#define AI_HAT_EMU_PAGE               4096         // Model memory allocation unit
+#define AI_HAT_EMU_COMMIT_BYTES_PER_US 50          // Placing a committed model, AI_HAT_POWER_MEDIUM
+
+// Modelled thermal and power state
+typedef struct {
+    uint32_t temperature_mc;     // Millidegrees Celsius
+    uint32_t power_mw;           // Average since the previous update
+    ai_hat_power_mode_t power_mode;
+    uint32_t throttled;          // Inferences started while above AI_HAT_EMU_THROTTLE_C
+} ai_hat_emu_thermal_t;
+
+// Model memory
+typedef struct {
+    uint32_t total_kb;
+    uint32_t free_kb;
+    uint32_t models;             // Uploads begun or committed
+} ai_hat_emu_memory_t;
+
+// Injected faults: every n'th event of a kind fails (0 disables), so runs
+// are repeatable. Counters report what has been injected since the last
+// ai_hat_emu_set_faults().
+typedef struct {
+    uint32_t nack_every;         // I2C register accesses, refused as a NACK
+    uint32_t timeout_every;      // SPI transactions, lost so the DMA times out
+    uint32_t crc_every;          // Model chunks, corrupted on arrival
+    uint32_t nacks;
+    uint32_t timeouts;
+    uint32_t crc_errors;
+} ai_hat_emu_faults_t;
+
+// Emulated HAT for QEMU, CI and bring-up. Frames are executed as soon as
+// they are sent, but the link and the accelerator report busy for as long
+// as the real hardware would: bytes * 8 / bus clock on the wire, compute_us
+// per inference scaled by the model's precision and the power mode, and
+// AI_HAT_EMU_COMMIT_BYTES_PER_US to place a model. The I2C registers are a
+// register file refreshed from this model; a batch of register reads is
+// answered when it is queued and completes after its bytes' time on the
+// I2C bus. Timing uses the timer counter.
+const ai_hat_link_t* ai_hat_emu_get_link(void);
+
+// Change the modelled SPI clock and inference latency. compute_us applies
+// to FP16 models in AI_HAT_POWER_MEDIUM: FP32 takes twice as long, INT8
+// half and INT4 a third; lower power modes are slower and higher ones faster.
+void ai_hat_emu_configure(uint32_t bus_clock_hz, uint32_t compute_us);
+
+// Model memory size. Uploads that do not fit are refused at MODEL_BEGIN.
+// The driver reads the size at init; models already placed are kept.
+void ai_hat_emu_set_memory(uint32_t total_kb);
+void ai_hat_emu_get_memory(ai_hat_emu_memory_t* memory);
+
+// The TEMP and POWER registers follow a first-order thermal model: power
+// is the idle draw of the power mode plus its active draw times the share
+// of time spent computing, and the temperature settles towards ambient
+// plus 15 C per watt with the given time constant.
+void ai_hat_emu_set_thermal(int32_t ambient_c, uint32_t time_constant_ms);
+void ai_hat_emu_get_thermal(ai_hat_emu_thermal_t* thermal);
+
+// Set the fault rates from the *_every fields and clear the counters
+void ai_hat_emu_set_faults(const ai_hat_emu_faults_t* faults);
+void ai_hat_emu_get_faults(ai_hat_emu_faults_t* faults);
+
+#endif // AI_HAT_EMU_H
@@ -0,0 +1,99 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI HAT+ Link Protocol
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef AI_HAT_PROTOCOL_H
+#define AI_HAT_PROTOCOL_H
+
+#include "ai_hat.h"
+#include "../spi.h"
+
+// I2C control registers. Reads return the register's bytes, zero padded;
+// a write to AI_HAT_REG_CONTROL is a command byte and its arguments.
+#define AI_HAT_REG_VERSION  0x00  // Major, minor
+#define AI_HAT_REG_CONTROL  0x01
+#define AI_HAT_REG_STATUS   0x02  // AI_HAT_STATUS_* word, not cleared by reading
+#define AI_HAT_REG_TEMP     0x03  // Celsius
+#define AI_HAT_REG_POWER    0x04  // mW, little endian
+#define AI_HAT_REG_MEMORY   0x05  // Model memory in KB, total then free, little endian
+#define AI_HAT_REG_MODEL    0x10
+#define AI_HAT_REG_INFERENCE 0x20
+
+// AI HAT+ control commands
+#define AI_HAT_CMD_INIT     0x01
+#define AI_HAT_CMD_SHUTDOWN 0x02
+#define AI_HAT_CMD_SET_POWER 0x03  // Argument: ai_hat_power_mode_t
+#define AI_HAT_CMD_LOAD_MODEL 0x10
+#define AI_HAT_CMD_UNLOAD_MODEL 0x11
+#define AI_HAT_CMD_RUN_INFERENCE 0x20
+
+// The HAT holds two input/output tensor pairs so one can be uploaded
+// while the other is being computed.
+#define AI_HAT_TENSOR_SLOTS     2
+
+// SPI frame opcodes. Every SPI transaction is one frame: a header followed
+// by `length` payload bytes.
+#define AI_HAT_OP_WRITE_INPUT   0x01  // Payload: input bytes at offset `arg` of a slot
+#define AI_HAT_OP_RUN           0x02  // Run the model on a slot; `arg` = output bytes
+#define AI_HAT_OP_READ_OUTPUT   0x03  // Payload (read): output bytes at offset `arg`
+#define AI_HAT_OP_STATUS        0x04  // Payload (read): one AI_HAT_STATUS_* word
+
+// Model upload. A blob is sent in order as MODEL_CHUNK frames whose payload
+// is the chunk followed by its CRC32 (little endian). The HAT drops a chunk
+// whose CRC or offset does not match; MODEL_QUERY reports how many bytes it
+// has accepted, which acknowledges chunks and lets an upload resume.
+#define AI_HAT_OP_MODEL_BEGIN   0x10  // Start (or restart) model `model_id`; `arg` = blob size,
+                                      // `slot` = ai_hat_precision_t. Refused if it does not fit
+#define AI_HAT_OP_MODEL_CHUNK   0x11  // Payload: chunk + CRC32; `arg` = blob offset
+#define AI_HAT_OP_MODEL_QUERY   0x12  // Payload (read): bytes accepted so far
+#define AI_HAT_OP_MODEL_COMMIT  0x13  // Finish the upload; error unless complete
+#define AI_HAT_OP_MODEL_UNLOAD  0x14  // Free the model
+
+#define AI_HAT_CHUNK_TRAILER    4     // CRC32 after each chunk
+
+// Status word bits
+#define AI_HAT_STATUS_BUSY      0x01  // Computing
+#define AI_HAT_STATUS_ERROR     0x02  // A frame was rejected since the last status read
+
+typedef struct __attribute__((packed)) {
+    uint8_t opcode;
+    uint8_t slot;
+    uint16_t model_id;
+    uint32_t length;
+    uint32_t arg;
+} ai_hat_frame_t;
+
+// One register read of a batch
+typedef struct {
+    uint8_t reg;
+    uint8_t* data;
+    uint32_t len;
+} ai_hat_reg_read_t;
+
+// Most register reads in one batch
+#define AI_HAT_REG_BATCH_MAX      4
+
+// Largest payload that fits one DMA transaction together with its header
+#define AI_HAT_FRAME_MAX_PAYLOAD  (60 * 1024)
+
+// Transport between the driver and a HAT: the I2C/SPI hardware or the
+// software emulator. Control registers go over I2C, frames over SPI DMA.
+// A batch of register reads is queued on the I2C bus as one combined
+// write-then-read transaction per register and completes in the
+// background; read_regs_poll returns AI_HAT_PENDING until it has.
+typedef struct {
+    const char* name;
+    ai_hat_status_t (*init)(void);
+    ai_hat_status_t (*write_reg)(const uint8_t* data, uint32_t len);
+    ai_hat_status_t (*read_reg)(uint8_t reg, uint8_t* data, uint32_t len);
+    ai_hat_status_t (*read_regs_start)(const ai_hat_reg_read_t* reads, uint32_t count);
+    ai_hat_status_t (*read_regs_poll)(void);
+    ai_hat_status_t (*stream_start)(const spi_segment_t* segments, uint32_t count);
+    int (*stream_busy)(void);
+    ai_hat_status_t (*stream_wait)(void);
+    uint32_t (*bus_clock)(void);   // SPI clock in Hz
+} ai_hat_link_t;
+
+#endif // AI_HAT_PROTOCOL_H
@@ -0,0 +1,171 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — DMA Controller (BCM2835/BCM2711 style)
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "dma.h"
+#include "uart.h"
+
+// Raspberry Pi 5 legacy DMA registers (RP1 exposes the same block layout)
+#define RPI5_PERIPHERAL_BASE 0xFE000000
+#define PERIPHERAL_BUS_BASE  0x7E000000
+#define DMA_MEMORY_BUS_ALIAS 0xC0000000  // Uncached alias of the first 1 GB
+
+#define DMA_BASE            (RPI5_PERIPHERAL_BASE + 0x007000)
+#define DMA_CHANNEL(n)      ((uintptr_t)DMA_BASE + (n) * 0x100)
+#define DMA_CS(n)           ((volatile uint32_t*)(DMA_CHANNEL(n) + 0x00))
+#define DMA_CONBLK_AD(n)    ((volatile uint32_t*)(DMA_CHANNEL(n) + 0x04))
+#define DMA_DEBUG(n)        ((volatile uint32_t*)(DMA_CHANNEL(n) + 0x20))
+#define DMA_ENABLE          ((volatile uint32_t*)(DMA_BASE + 0xFF0))
+
+// Channel CS register bits
+#define DMA_CS_ACTIVE       (1 << 0)
+#define DMA_CS_END          (1 << 1)
+#define DMA_CS_INT          (1 << 2)
+#define DMA_CS_ERROR        (1 << 8)
+#define DMA_CS_PRIORITY(p)  ((uint32_t)(p) << 16)
+#define DMA_CS_PANIC_PRIORITY(p) ((uint32_t)(p) << 20)
+#define DMA_CS_WAIT_WRITES  (1 << 28)
+#define DMA_CS_ABORT        (1 << 30)
+#define DMA_CS_RESET        (1u << 31)
+
+// Debug register error bits (write 1 to clear)
+#define DMA_DEBUG_ERRORS    0x7
+
+#define DMA_CACHE_LINE      64
+
+static uint32_t enabled_channels = 0;
+
+// Delay function - simple busy wait
+static void delay(int32_t count) {
+    while (count--) {
+        asm volatile("nop");
+    }
+}
+
+dma_status_t dma_init(uint32_t channel) {
+    if (channel >= DMA_NUM_CHANNELS) {
+        return DMA_ERROR_PARAM;
+    }
+    
+    if (enabled_channels & (1u << channel)) {
+        return DMA_SUCCESS;
+    }
+    
+    *DMA_ENABLE = *DMA_ENABLE | (1u << channel);
+    *DMA_CS(channel) = DMA_CS_RESET;
+    delay(100);
+    *DMA_DEBUG(channel) = DMA_DEBUG_ERRORS;
+    
+    enabled_channels |= 1u << channel;
+    return DMA_SUCCESS;
+}
+
+uint32_t dma_bus_address(const volatile void* ptr) {
+    return ((uint32_t)(uintptr_t)ptr & 0x3FFFFFFF) | DMA_MEMORY_BUS_ALIAS;
+}
+
+uint32_t dma_peripheral_bus_address(uintptr_t phys) {
+    return (uint32_t)(phys - RPI5_PERIPHERAL_BASE) + PERIPHERAL_BUS_BASE;
+}
+
+void dma_cb_init(dma_cb_t* cb, uint32_t ti, uint32_t source_ad, uint32_t dest_ad, uint32_t len) {
+    cb->ti = ti | DMA_TI_WAIT_RESP;
+    cb->source_ad = source_ad;
+    cb->dest_ad = dest_ad;
+    cb->txfr_len = len;
+    cb->stride = 0;
+    cb->next_cb = 0;
+    cb->reserved[0] = 0;
+    cb->reserved[1] = 0;
+}
+
+void dma_cb_link(dma_cb_t* cb, const dma_cb_t* next) {
+    cb->next_cb = next ? dma_bus_address(next) : 0;
+}
+
+dma_status_t dma_start(uint32_t channel, const dma_cb_t* first) {
+    if (channel >= DMA_NUM_CHANNELS || first == NULL) {
+        return DMA_ERROR_PARAM;
+    }
+    
+    if (!(enabled_channels & (1u << channel))) {
+        return DMA_ERROR_INIT;
+    }
+    
+    if (*DMA_CS(channel) & DMA_CS_ACTIVE) {
+        return DMA_ERROR_BUSY;
+    }
+    
+    // Clear END/INT from the previous chain, then load and go
+    *DMA_CS(channel) = DMA_CS_END | DMA_CS_INT;
+    *DMA_CONBLK_AD(channel) = dma_bus_address(first);
+    *DMA_CS(channel) = DMA_CS_WAIT_WRITES | DMA_CS_PANIC_PRIORITY(15) |
+                       DMA_CS_PRIORITY(8) | DMA_CS_ACTIVE;
+    
+    return DMA_SUCCESS;
+}
+
+int dma_busy(uint32_t channel) {
+    if (channel >= DMA_NUM_CHANNELS) {
+        return 0;
+    }
+    
+    return (*DMA_CS(channel) & DMA_CS_ACTIVE) != 0;
+}
+
+dma_status_t dma_wait(uint32_t channel) {
+    int timeout = 1000000;
+    
+    if (channel >= DMA_NUM_CHANNELS) {
+        return DMA_ERROR_PARAM;
+    }
+    
+    while (*DMA_CS(channel) & DMA_CS_ACTIVE) {
+        if (--timeout <= 0) {
+            *DMA_CS(channel) = DMA_CS_ABORT;
+            uart_puts("DMA transfer timed out\n");
+            return DMA_ERROR_TIMEOUT;
+        }
+        delay(10);
+    }
+    
+    if (*DMA_CS(channel) & DMA_CS_ERROR) {
+        *DMA_DEBUG(channel) = DMA_DEBUG_ERRORS;
+        return DMA_ERROR_BUS;
+    }
+    
+    return DMA_SUCCESS;
+}
+
+void dma_sync_for_device(const void* ptr, uint32_t len) {
+#if defined(__aarch64__)
+    uintptr_t line = (uintptr_t)ptr & ~(uintptr_t)(DMA_CACHE_LINE - 1);
+    uintptr_t end = (uintptr_t)ptr + len;
+    
+    for (; line < end; line += DMA_CACHE_LINE) {
+        asm volatile("dc cvac, %0" : : "r"(line) : "memory");
+    }
+    asm volatile("dsb sy" : : : "memory");
+#else
+    // x86 and the RISC-V targets we run on keep DMA coherent
+    (void)ptr;
+    (void)len;
+#endif
+}
+
+void dma_sync_for_cpu(void* ptr, uint32_t len) {
+#if defined(__aarch64__)
+    uintptr_t line = (uintptr_t)ptr & ~(uintptr_t)(DMA_CACHE_LINE - 1);
+    uintptr_t end = (uintptr_t)ptr + len;
+    
+    for (; line < end; line += DMA_CACHE_LINE) {
+        asm volatile("dc civac, %0" : : "r"(line) : "memory");
+    }
+    asm volatile("dsb sy" : : : "memory");
+#else
+    (void)ptr;
+    (void)len;
+#endif
+}
@@ -0,0 +1,76 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — DMA Controller (BCM2835/BCM2711 style)
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef DMA_H
+#define DMA_H
+
+#include "../kernel/types.h"
+
+#define DMA_NUM_CHANNELS    15
+#define DMA_CB_MAX_LEN      65532   // Largest transfer per block on lite channels
+
+// Transfer information (TI) bits of a control block
+#define DMA_TI_INTEN        (1 << 0)
+#define DMA_TI_WAIT_RESP    (1 << 3)
+#define DMA_TI_DEST_INC     (1 << 4)
+#define DMA_TI_DEST_DREQ    (1 << 6)
+#define DMA_TI_SRC_INC      (1 << 8)
+#define DMA_TI_SRC_DREQ     (1 << 10)
+#define DMA_TI_PERMAP(p)    ((uint32_t)(p) << 16)
+#define DMA_TI_NO_WIDE_BURSTS (1 << 26)
+
+// Peripheral DREQ lines
+#define DMA_DREQ_SPI0_TX    6
+#define DMA_DREQ_SPI0_RX    7
+
+// DMA status codes
+typedef enum {
+    DMA_SUCCESS = 0,
+    DMA_ERROR_INIT = -1,
+    DMA_ERROR_BUSY = -2,
+    DMA_ERROR_TIMEOUT = -3,
+    DMA_ERROR_PARAM = -4,
+    DMA_ERROR_BUS = -5      // Channel reported a bus or read error
+} dma_status_t;
+
+// Control block as read by the engine. Blocks form a chain through
+// next_cb; the engine walks it without CPU involvement.
+typedef struct {
+    uint32_t ti;
+    uint32_t source_ad;
+    uint32_t dest_ad;
+    uint32_t txfr_len;
+    uint32_t stride;
+    uint32_t next_cb;       // Bus address of the next block, 0 ends the chain
+    uint32_t reserved[2];
+} __attribute__((aligned(32))) dma_cb_t;
+
+// Initialize the controller and enable the given channel
+dma_status_t dma_init(uint32_t channel);
+
+// Bus addresses as seen by the DMA engine
+uint32_t dma_bus_address(const volatile void* ptr);
+uint32_t dma_peripheral_bus_address(uintptr_t phys);
+
+// Fill a control block; the chain is terminated until dma_cb_link() is called
+void dma_cb_init(dma_cb_t* cb, uint32_t ti, uint32_t source_ad, uint32_t dest_ad, uint32_t len);
+void dma_cb_link(dma_cb_t* cb, const dma_cb_t* next);
+
+// Start a chain on a channel; returns immediately
+dma_status_t dma_start(uint32_t channel, const dma_cb_t* first);
+
+// Non-zero while the channel is still walking its chain
+int dma_busy(uint32_t channel);
+
+// Spin until the channel finishes or times out
+dma_status_t dma_wait(uint32_t channel);
+
+// Cache maintenance around transfers: write back before the engine reads
+// memory, discard stale lines before the CPU reads what the engine wrote.
+void dma_sync_for_device(const void* ptr, uint32_t len);
+void dma_sync_for_cpu(void* ptr, uint32_t len);
+
+#endif // DMA_H
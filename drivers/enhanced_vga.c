@@ -33,6 +33,9 @@ typedef enum {
 } vga_color_t;
 
 static volatile uint16_t* vga_buffer = (volatile uint16_t*)VGA_MEMORY;
+// Copy of the screen in RAM. The VGA window is mapped write-combining, so
+// reads from it are uncached and slow; scrolling works from this copy.
+static uint16_t vga_shadow[VGA_WIDTH * VGA_HEIGHT];
 static size_t vga_row = 0;
 static size_t vga_column = 0;
 static uint8_t vga_color = 0x07; // Light grey on black
@@ -48,6 +51,12 @@ static inline uint16_t vga_entry(unsigned char uc, uint8_t color) {
     return (uint16_t) uc | (uint16_t) color << 8;
 }
 
+// Write one cell to the screen and its shadow
+static inline void vga_write_cell(size_t index, uint16_t entry) {
+    vga_shadow[index] = entry;
+    vga_buffer[index] = entry;
+}
+
 // Enhanced VGA initialization
 void vga_init(void) {
     vga_row = 0;
@@ -58,7 +67,7 @@ void vga_init(void) {
     for (size_t y = 0; y < VGA_HEIGHT; y++) {
         for (size_t x = 0; x < VGA_WIDTH; x++) {
             const size_t index = y * VGA_WIDTH + x;
-            vga_buffer[index] = vga_entry(' ', vga_color);
+            vga_write_cell(index, vga_entry(' ', vga_color));
         }
     }
     
@@ -77,16 +86,16 @@ void vga_set_colors(vga_color_t fg, vga_color_t bg) {
 
 // Enhanced scrolling
 static void vga_scroll(void) {
-    // Move all lines up by one
+    // Move all lines up by one, reading only the shadow
     for (size_t y = 0; y < VGA_HEIGHT - 1; y++) {
         for (size_t x = 0; x < VGA_WIDTH; x++) {
-            vga_buffer[y * VGA_WIDTH + x] = vga_buffer[(y + 1) * VGA_WIDTH + x];
+            vga_write_cell(y * VGA_WIDTH + x, vga_shadow[(y + 1) * VGA_WIDTH + x]);
         }
     }
     
     // Clear the last line
     for (size_t x = 0; x < VGA_WIDTH; x++) {
-        vga_buffer[(VGA_HEIGHT - 1) * VGA_WIDTH + x] = vga_entry(' ', vga_color);
+        vga_write_cell((VGA_HEIGHT - 1) * VGA_WIDTH + x, vga_entry(' ', vga_color));
     }
     
     vga_row = VGA_HEIGHT - 1;
@@ -114,7 +123,7 @@ void vga_putc(char c) {
     if (c == '\b') {
         if (vga_column > 0) {
             vga_column--;
-            vga_buffer[vga_row * VGA_WIDTH + vga_column] = vga_entry(' ', vga_color);
+            vga_write_cell(vga_row * VGA_WIDTH + vga_column, vga_entry(' ', vga_color));
         }
         return;
     }
@@ -123,7 +132,7 @@ void vga_putc(char c) {
         // Tab to next 4-character boundary
         size_t next_tab = (vga_column + 4) & ~3;
         while (vga_column < next_tab && vga_column < VGA_WIDTH) {
-            vga_buffer[vga_row * VGA_WIDTH + vga_column] = vga_entry(' ', vga_color);
+            vga_write_cell(vga_row * VGA_WIDTH + vga_column, vga_entry(' ', vga_color));
             vga_column++;
         }
         if (vga_column >= VGA_WIDTH) {
@@ -136,7 +145,7 @@ void vga_putc(char c) {
     }
     
     // Regular character
-    vga_buffer[vga_row * VGA_WIDTH + vga_column] = vga_entry(c, vga_color);
+    vga_write_cell(vga_row * VGA_WIDTH + vga_column, vga_entry(c, vga_color));
     
     if (++vga_column == VGA_WIDTH) {
         vga_column = 0;
@@ -208,7 +217,7 @@ void vga_draw_box(size_t x, size_t y, size_t width, size_t height, uint8_t color
                 ch = ' '; // Inside the box
             }
             
-            vga_buffer[row * VGA_WIDTH + col] = vga_entry(ch, color);
+            vga_write_cell(row * VGA_WIDTH + col, vga_entry(ch, color));
         }
     }
     
@@ -226,14 +235,14 @@ void vga_draw_status_bar(const char* text) {
     
     // Clear the bottom line
     for (size_t x = 0; x < VGA_WIDTH; x++) {
-        vga_buffer[(VGA_HEIGHT - 1) * VGA_WIDTH + x] = vga_entry(' ', vga_color);
+        vga_write_cell((VGA_HEIGHT - 1) * VGA_WIDTH + x, vga_entry(' ', vga_color));
     }
     
     // Write the status text
     if (text) {
         size_t len = 0;
         while (text[len] && len < VGA_WIDTH) {
-            vga_buffer[(VGA_HEIGHT - 1) * VGA_WIDTH + len] = vga_entry(text[len], vga_color);
+            vga_write_cell((VGA_HEIGHT - 1) * VGA_WIDTH + len, vga_entry(text[len], vga_color));
             len++;
         }
     }
@@ -7,6 +7,7 @@
  * ───────────────────────────────────────────────────────────────────────────── */
 #include "i2c.h"
 #include "uart.h"
+#include "../kernel/timer.h"
 #include <stdbool.h>
 
 // Raspberry Pi 5 I2C registers
@@ -47,8 +48,32 @@
 // I2C clock divider
 #define I2C_CLOCK_FREQ      150000000  // 150 MHz
 
+// Bytes the controller FIFO holds
+#define I2C_FIFO_SIZE       16
+
+// Polls of the status register while a write gets under way (a start
+// condition, a few microseconds) before the read that follows it is queued
+#define I2C_START_SPINS     10000
+
 // Static variables
 static bool i2c_initialized = false;
+static uint32_t bus_speed = I2C_SPEED_STANDARD;
+
+// Submitted transactions; the one at queue_head is on the bus
+static i2c_transaction_t* queue[I2C_QUEUE_DEPTH];
+static uint32_t queue_head = 0;
+static uint32_t queue_tail = 0;
+
+// Progress of the transaction on the bus
+typedef struct {
+    bool running;
+    bool reading;           // The read phase has been programmed
+    uint32_t sent;          // Bytes put into the FIFO
+    uint32_t received;      // Bytes taken out of it
+    uint64_t deadline;
+} bus_transfer_t;
+
+static bus_transfer_t transfer;
 
 // Delay function - simple busy wait
 static void delay(int32_t count) {
@@ -57,27 +82,136 @@ static void delay(int32_t count) {
     }
 }
 
-// Wait for I2C transfer to complete
-static i2c_status_t i2c_wait_done() {
-    int timeout = 1000000;  // Timeout in microseconds
+// Bus time of a transaction: its bytes at nine clocks each, twice over
+static uint64_t transaction_ticks(const i2c_transaction_t* txn) {
+    uint64_t bytes = (uint64_t)txn->write_len + txn->read_len + 2;
+    uint64_t us = I2C_TIMEOUT_US + timer_div64(bytes * 9 * 2 * 1000000, bus_speed);
     
-    while (!(*I2C_S & I2C_S_DONE)) {
-        if (--timeout <= 0) {
-            return I2C_ERROR_TIMEOUT;
-        }
-        
-        if (*I2C_S & I2C_S_ERR) {
-            return I2C_ERROR_NACK;
+    return timer_div64(us * timer_ticks_per_sec(), 1000000);
+}
+
+// Top up the FIFO with bytes still to be written
+static void fill_fifo(const i2c_transaction_t* txn) {
+    while (transfer.sent < txn->write_len && (*I2C_S & I2C_S_TXD)) {
+        *I2C_FIFO = txn->write_data[transfer.sent++];
+    }
+}
+
+// Take received bytes out of the FIFO
+static void drain_fifo(i2c_transaction_t* txn) {
+    while (transfer.received < txn->read_len && (*I2C_S & I2C_S_RXD)) {
+        txn->read_data[transfer.received++] = (uint8_t)*I2C_FIFO;
+    }
+}
+
+static void start_read(const i2c_transaction_t* txn) {
+    *I2C_DLEN = txn->read_len;
+    *I2C_C = I2C_C_I2CEN | I2C_C_ST | I2C_C_READ | I2C_C_INTR | I2C_C_INTD;
+    transfer.reading = true;
+}
+
+// Put a transaction on the bus
+static void start_transaction(const i2c_transaction_t* txn) {
+    transfer.running = true;
+    transfer.reading = false;
+    transfer.sent = 0;
+    transfer.received = 0;
+    transfer.deadline = timer_ticks() + transaction_ticks(txn);
+    
+    // Clear FIFO and status, then address the device
+    *I2C_C = I2C_C_I2CEN | I2C_C_CLEAR;
+    *I2C_S = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
+    *I2C_A = txn->device_addr;
+    
+    if (txn->write_len == 0 && txn->read_len > 0) {
+        start_read(txn);
+        return;
+    }
+    
+    *I2C_DLEN = txn->write_len;
+    fill_fifo(txn);
+    *I2C_C = I2C_C_I2CEN | I2C_C_ST | I2C_C_INTT | I2C_C_INTD;
+    
+    // Repeated start: a read programmed while the write is active follows
+    // it without a stop. The write must fit the FIFO, since the read takes
+    // over the FIFO interrupts; longer writes stop and read afterwards.
+    if (txn->read_len > 0 && txn->write_len <= I2C_FIFO_SIZE) {
+        for (int spins = 0; spins < I2C_START_SPINS; spins++) {
+            uint32_t status = *I2C_S;
+            if (status & (I2C_S_ERR | I2C_S_CLKT)) {
+                return;     // Reported by the interrupt handler
+            }
+            if (status & (I2C_S_TA | I2C_S_DONE)) {
+                break;
+            }
         }
         
-        if (*I2C_S & I2C_S_CLKT) {
-            return I2C_ERROR_TIMEOUT;
+        *I2C_S = I2C_S_DONE;
+        start_read(txn);
+    }
+}
+
+// Complete the transaction on the bus and start the next one
+static void finish_transaction(i2c_status_t status) {
+    i2c_transaction_t* txn = queue[queue_head % I2C_QUEUE_DEPTH];
+    
+    *I2C_C = I2C_C_I2CEN | I2C_C_CLEAR;
+    *I2C_S = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
+    transfer.running = false;
+    queue_head++;
+    
+    txn->status = status;
+    if (txn->done != NULL) {
+        txn->done(txn);
+    }
+    
+    // The callback may have submitted, and so started, another one
+    if (!transfer.running && queue_head != queue_tail) {
+        start_transaction(queue[queue_head % I2C_QUEUE_DEPTH]);
+    }
+}
+
+// Controller interrupt handler
+void i2c_irq_handler(void) {
+    if (!i2c_initialized || !transfer.running) {
+        return;
+    }
+    
+    i2c_transaction_t* txn = queue[queue_head % I2C_QUEUE_DEPTH];
+    uint32_t status = *I2C_S;
+    
+    if (status & I2C_S_ERR) {
+        finish_transaction(I2C_ERROR_NACK);
+        return;
+    }
+    
+    if (status & I2C_S_CLKT) {
+        finish_transaction(I2C_ERROR_TIMEOUT);
+        return;
+    }
+    
+    if (transfer.reading) {
+        drain_fifo(txn);
+    } else {
+        fill_fifo(txn);
+    }
+    
+    if (status & I2C_S_DONE) {
+        // A write too long for a repeated start is followed by its read now
+        if (!transfer.reading && txn->read_len > 0) {
+            *I2C_S = I2C_S_DONE;
+            start_read(txn);
+            return;
         }
         
-        delay(10);
+        drain_fifo(txn);
+        finish_transaction(transfer.received == txn->read_len ? I2C_SUCCESS : I2C_ERROR_NACK);
+        return;
     }
     
-    return I2C_SUCCESS;
+    if (timer_ticks() > transfer.deadline) {
+        finish_transaction(I2C_ERROR_TIMEOUT);
+    }
 }
 
 // Initialize I2C controller
@@ -105,144 +239,108 @@ i2c_status_t i2c_init(i2c_speed_t speed) {
     // Enable I2C controller
     *I2C_C = I2C_C_I2CEN;
     
+    bus_speed = speed;
+    queue_head = 0;
+    queue_tail = 0;
+    transfer.running = false;
     i2c_initialized = true;
     uart_printf("I2C initialized at %d Hz\n", speed);
     
     return I2C_SUCCESS;
 }
 
-// Write data to I2C device
-i2c_status_t i2c_write(uint8_t device_addr, const uint8_t* data, uint32_t len) {
+// Queue a transaction
+i2c_status_t i2c_submit(i2c_transaction_t* txn) {
     if (!i2c_initialized) {
         return I2C_ERROR_INIT;
     }
     
-    if (data == NULL || len == 0) {
+    if (txn == NULL || (txn->write_len > 0 && txn->write_data == NULL) ||
+        (txn->read_len > 0 && txn->read_data == NULL)) {
         return I2C_ERROR_PARAM;
     }
     
-    // Wait if I2C is busy
-    if (*I2C_S & I2C_S_TA) {
+    if (queue_tail - queue_head >= I2C_QUEUE_DEPTH) {
         return I2C_ERROR_BUSY;
     }
     
-    // Clear FIFO
-    *I2C_C = I2C_C_I2CEN | I2C_C_CLEAR;
-    
-    // Clear status
-    *I2C_S = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
+    txn->status = I2C_PENDING;
+    queue[queue_tail % I2C_QUEUE_DEPTH] = txn;
+    queue_tail++;
     
-    // Set slave address
-    *I2C_A = device_addr;
+    if (!transfer.running) {
+        start_transaction(txn);
+    }
     
-    // Set data length
-    *I2C_DLEN = len;
+    return I2C_SUCCESS;
+}
+
+int i2c_busy(void) {
+    return queue_head != queue_tail;
+}
+
+// Service the controller until the transaction completes
+i2c_status_t i2c_wait(i2c_transaction_t* txn) {
+    while (txn->status == I2C_PENDING) {
+        i2c_irq_handler();
+    }
     
-    // Fill FIFO with data (up to 16 bytes)
-    uint32_t fifo_count = (len > 16) ? 16 : len;
-    for (uint32_t i = 0; i < fifo_count; i++) {
-        *I2C_FIFO = data[i];
+    return txn->status;
+}
+
+// Queue a transaction and wait for it
+static i2c_status_t transfer_sync(uint8_t device_addr, const uint8_t* write_data, uint32_t write_len,
+                                  uint8_t* read_data, uint32_t read_len) {
+    i2c_transaction_t txn;
+    
+    txn.device_addr = device_addr;
+    txn.write_data = write_data;
+    txn.write_len = write_len;
+    txn.read_data = read_data;
+    txn.read_len = read_len;
+    txn.done = NULL;
+    txn.context = NULL;
+    
+    // Make room behind transactions queued by others
+    i2c_status_t status = i2c_submit(&txn);
+    while (status == I2C_ERROR_BUSY) {
+        i2c_irq_handler();
+        status = i2c_submit(&txn);
     }
     
-    // Start transfer (write)
-    *I2C_C = I2C_C_I2CEN | I2C_C_ST;
+    if (status != I2C_SUCCESS) {
+        return status;
+    }
     
-    // Send remaining data
-    uint32_t sent = fifo_count;
-    while (sent < len) {
-        // Wait for space in FIFO
-        while (!(*I2C_S & I2C_S_TXW)) {
-            if (*I2C_S & I2C_S_ERR) {
-                return I2C_ERROR_NACK;
-            }
-            
-            if (*I2C_S & I2C_S_CLKT) {
-                return I2C_ERROR_TIMEOUT;
-            }
-            
-            if (*I2C_S & I2C_S_DONE) {
-                break;
-            }
-        }
-        
-        // Send data
-        *I2C_FIFO = data[sent++];
+    return i2c_wait(&txn);
+}
+
+// Write data to I2C device. A zero-length write only addresses the
+// device, which probes whether it is present.
+i2c_status_t i2c_write(uint8_t device_addr, const uint8_t* data, uint32_t len) {
+    if (data == NULL) {
+        return I2C_ERROR_PARAM;
     }
     
-    // Wait for transfer to complete
-    return i2c_wait_done();
+    return transfer_sync(device_addr, data, len, NULL, 0);
 }
 
 // Read data from I2C device
 i2c_status_t i2c_read(uint8_t device_addr, uint8_t* data, uint32_t len) {
-    if (!i2c_initialized) {
-        return I2C_ERROR_INIT;
-    }
-    
     if (data == NULL || len == 0) {
         return I2C_ERROR_PARAM;
     }
     
-    // Wait if I2C is busy
-    if (*I2C_S & I2C_S_TA) {
-        return I2C_ERROR_BUSY;
-    }
-    
-    // Clear FIFO
-    *I2C_C = I2C_C_I2CEN | I2C_C_CLEAR;
-    
-    // Clear status
-    *I2C_S = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
-    
-    // Set slave address
-    *I2C_A = device_addr;
-    
-    // Set data length
-    *I2C_DLEN = len;
-    
-    // Start transfer (read)
-    *I2C_C = I2C_C_I2CEN | I2C_C_ST | I2C_C_READ;
-    
-    // Read data
-    uint32_t received = 0;
-    while (received < len) {
-        // Wait for data in FIFO
-        while (!(*I2C_S & I2C_S_RXD)) {
-            if (*I2C_S & I2C_S_ERR) {
-                return I2C_ERROR_NACK;
-            }
-            
-            if (*I2C_S & I2C_S_CLKT) {
-                return I2C_ERROR_TIMEOUT;
-            }
-            
-            if (*I2C_S & I2C_S_DONE) {
-                break;
-            }
-        }
-        
-        // Read data
-        data[received++] = *I2C_FIFO;
-    }
-    
-    // Wait for transfer to complete
-    return i2c_wait_done();
+    return transfer_sync(device_addr, NULL, 0, data, len);
 }
 
 // Write register and then read data from I2C device
 i2c_status_t i2c_write_read(uint8_t device_addr, const uint8_t* write_data, uint32_t write_len, uint8_t* read_data, uint32_t read_len) {
-    i2c_status_t status;
-    
-    // Write data
-    status = i2c_write(device_addr, write_data, write_len);
-    if (status != I2C_SUCCESS) {
-        return status;
+    if (write_data == NULL || write_len == 0 || read_data == NULL || read_len == 0) {
+        return I2C_ERROR_PARAM;
     }
     
-    // Read data
-    status = i2c_read(device_addr, read_data, read_len);
-    
-    return status;
+    return transfer_sync(device_addr, write_data, write_len, read_data, read_len);
 }
 
 // Write register to I2C device
@@ -253,18 +351,7 @@ i2c_status_t i2c_write_reg(uint8_t device_addr, uint8_t reg, uint8_t value) {
 
 // Read register from I2C device
 i2c_status_t i2c_read_reg(uint8_t device_addr, uint8_t reg, uint8_t* value) {
-    i2c_status_t status;
-    
-    // Write register address
-    status = i2c_write(device_addr, &reg, 1);
-    if (status != I2C_SUCCESS) {
-        return status;
-    }
-    
-    // Read register value
-    status = i2c_read(device_addr, value, 1);
-    
-    return status;
+    return i2c_write_read(device_addr, &reg, 1, value, 1);
 }
 
 // Scan I2C bus for devices
@@ -13,6 +13,7 @@
 
 // I2C status codes
 typedef enum {
+    I2C_PENDING = 1,          // Transaction queued or on the bus
     I2C_SUCCESS = 0,
     I2C_ERROR_INIT = -1,
     I2C_ERROR_BUSY = -2,
@@ -28,16 +29,55 @@ typedef enum {
     I2C_SPEED_FAST_PLUS = 1000000 // 1 MHz
 } i2c_speed_t;
 
+// Transactions waiting for the bus, the one on it included
+#define I2C_QUEUE_DEPTH 8
+
+// Bus time allowed per transaction on top of its bytes at the bus clock
+#define I2C_TIMEOUT_US 10000
+
+// One queued transaction: write_len bytes, then read_len bytes after a
+// repeated start, so a register address and its value need no stop in
+// between. Either length may be 0; both 0 only addresses the device.
+typedef struct i2c_transaction {
+    uint8_t device_addr;
+    const uint8_t* write_data;
+    uint32_t write_len;
+    uint8_t* read_data;
+    uint32_t read_len;
+    void (*done)(struct i2c_transaction* txn);  // Called on completion, may be NULL
+    void* context;                              // For the owner
+    volatile i2c_status_t status;               // I2C_PENDING until completed
+} i2c_transaction_t;
+
 // Initialize I2C controller
 i2c_status_t i2c_init(i2c_speed_t speed);
 
+// Queue a transaction and return at once; it runs after the ones already
+// queued. The transaction must stay in place until its status is no
+// longer I2C_PENDING. I2C_ERROR_BUSY if the queue is full.
+i2c_status_t i2c_submit(i2c_transaction_t* txn);
+
+// Controller interrupt handler: moves FIFO data, completes the transaction
+// on the bus and starts the next. No interrupt controller is programmed
+// yet, so it is called from the owners' poll paths and i2c_wait(); it must
+// not run concurrently with itself or with i2c_submit().
+void i2c_irq_handler(void);
+
+// Non-zero while transactions are queued
+int i2c_busy(void);
+
+// Service the controller until the transaction completes; returns its status
+i2c_status_t i2c_wait(i2c_transaction_t* txn);
+
+// The calls below queue a transaction and wait for it
+
 // Write data to I2C device
 i2c_status_t i2c_write(uint8_t device_addr, const uint8_t* data, uint32_t len);
 
 // Read data from I2C device
 i2c_status_t i2c_read(uint8_t device_addr, uint8_t* data, uint32_t len);
 
-// Write register and then read data from I2C device
+// Write register and then read data from I2C device, with a repeated start
 i2c_status_t i2c_write_read(uint8_t device_addr, const uint8_t* write_data, uint32_t write_len, uint8_t* read_data, uint32_t read_len);
 
 // Write register to I2C device
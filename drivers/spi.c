@@ -8,6 +8,7 @@
  * ───────────────────────────────────────────────────────────────────────────── */
 #include "spi.h"
 #include "uart.h"
+#include "dma.h"
 #include <stdbool.h>
 
 // Raspberry Pi 5 SPI registers
@@ -50,10 +51,29 @@
 // SPI clock divider
 #define SPI_CLOCK_FREQ      250000000  // 250 MHz
 
+// DMA channels feeding and draining the FIFO
+#define SPI_DMA_TX_CHANNEL  4
+#define SPI_DMA_RX_CHANNEL  5
+
+// A segment longer than DMA_CB_MAX_LEN takes two blocks; TX adds a header
+#define SPI_DMA_MAX_CBS     (SPI_DMA_MAX_SEGMENTS * 2 + 1)
+
 // Static variables
 static bool spi_initialized = false;
 static spi_config_t current_config;
 
+// DMA state. Control blocks and the words they point at must stay put
+// while the engine walks them, so they live here rather than on the stack.
+static bool spi_dma_ready = false;
+static bool spi_dma_active = false;
+static dma_cb_t tx_cbs[SPI_DMA_MAX_CBS];
+static dma_cb_t rx_cbs[SPI_DMA_MAX_CBS];
+static uint32_t dma_header __attribute__((aligned(64)));
+static uint32_t dma_zero __attribute__((aligned(64)));
+static uint32_t dma_discard __attribute__((aligned(64)));
+static spi_segment_t active_segments[SPI_DMA_MAX_SEGMENTS];
+static uint32_t active_count = 0;
+
 // Delay function - simple busy wait
 static void delay(int32_t count) {
     while (count--) {
@@ -359,4 +379,161 @@ spi_status_t spi_set_mode(spi_cpol_t cpol, spi_cpha_t cpha) {
     current_config.cpha = cpha;
     
     return SPI_SUCCESS;
-}
\ No newline at end of file
+}
+
+// Effective bus clock in Hz after the divider is applied
+uint32_t spi_get_clock_speed(void) {
+    if (!spi_initialized || current_config.clock_speed == 0) {
+        return 0;
+    }
+    
+    uint32_t divider = SPI_CLOCK_FREQ / current_config.clock_speed;
+    if (divider < 2) divider = 2;
+    if (divider > 65536) divider = 65536;
+    
+    return SPI_CLOCK_FREQ / divider;
+}
+
+// Claim the TX and RX DMA channels
+spi_status_t spi_dma_init(void) {
+    if (!spi_initialized) {
+        return SPI_ERROR_INIT;
+    }
+    
+    if (dma_init(SPI_DMA_TX_CHANNEL) != DMA_SUCCESS ||
+        dma_init(SPI_DMA_RX_CHANNEL) != DMA_SUCCESS) {
+        uart_puts("Failed to claim DMA channels for SPI\n");
+        return SPI_ERROR_INIT;
+    }
+    
+    spi_dma_ready = true;
+    return SPI_SUCCESS;
+}
+
+// Start a gathered DMA transaction
+spi_status_t spi_dma_start(const spi_segment_t* segments, uint32_t count) {
+    if (!spi_initialized || !spi_dma_ready) {
+        return SPI_ERROR_INIT;
+    }
+    
+    if (segments == NULL || count == 0 || count > SPI_DMA_MAX_SEGMENTS) {
+        return SPI_ERROR_PARAM;
+    }
+    
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        total += segments[i].len;
+    }
+    if (total == 0 || total > SPI_DMA_MAX_LEN) {
+        return SPI_ERROR_PARAM;
+    }
+    
+    if (spi_dma_active || (*SPI_CS & SPI_CS_TA)) {
+        return SPI_ERROR_BUSY;
+    }
+    
+    uint32_t fifo = dma_peripheral_bus_address((uintptr_t)SPI_FIFO);
+    uint32_t tx_ti = DMA_TI_DEST_DREQ | DMA_TI_PERMAP(DMA_DREQ_SPI0_TX);
+    uint32_t rx_ti = DMA_TI_SRC_DREQ | DMA_TI_PERMAP(DMA_DREQ_SPI0_RX);
+    
+    // In DMA mode the first word written to the FIFO loads DLEN and CS[7:0]
+    dma_header = (total << 16) | (*SPI_CS & 0xFF) | SPI_CS_TA;
+    dma_zero = 0;
+    dma_cb_init(&tx_cbs[0], tx_ti | DMA_TI_SRC_INC, dma_bus_address(&dma_header), fifo, sizeof(dma_header));
+    
+    uint32_t num_tx = 1;
+    uint32_t num_rx = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const spi_segment_t* segment = &segments[i];
+        
+        for (uint32_t offset = 0; offset < segment->len; offset += DMA_CB_MAX_LEN) {
+            uint32_t len = segment->len - offset;
+            if (len > DMA_CB_MAX_LEN) {
+                len = DMA_CB_MAX_LEN;
+            }
+            
+            if (segment->tx != NULL) {
+                dma_cb_init(&tx_cbs[num_tx], tx_ti | DMA_TI_SRC_INC,
+                            dma_bus_address(segment->tx + offset), fifo, len);
+            } else {
+                dma_cb_init(&tx_cbs[num_tx], tx_ti, dma_bus_address(&dma_zero), fifo, len);
+            }
+            dma_cb_link(&tx_cbs[num_tx - 1], &tx_cbs[num_tx]);
+            num_tx++;
+            
+            if (segment->rx != NULL) {
+                dma_cb_init(&rx_cbs[num_rx], rx_ti | DMA_TI_DEST_INC,
+                            fifo, dma_bus_address(segment->rx + offset), len);
+            } else {
+                dma_cb_init(&rx_cbs[num_rx], rx_ti, fifo, dma_bus_address(&dma_discard), len);
+            }
+            if (num_rx > 0) {
+                dma_cb_link(&rx_cbs[num_rx - 1], &rx_cbs[num_rx]);
+            }
+            num_rx++;
+        }
+        
+        // Write back what the engine reads; drop lines it will overwrite
+        if (segment->tx != NULL) {
+            dma_sync_for_device(segment->tx, segment->len);
+        }
+        if (segment->rx != NULL) {
+            dma_sync_for_cpu(segment->rx, segment->len);
+        }
+        active_segments[i] = *segment;
+    }
+    active_count = count;
+    
+    dma_sync_for_device(&dma_header, sizeof(dma_header));
+    dma_sync_for_device(&dma_zero, sizeof(dma_zero));
+    dma_sync_for_device(tx_cbs, num_tx * sizeof(dma_cb_t));
+    dma_sync_for_device(rx_cbs, num_rx * sizeof(dma_cb_t));
+    
+    // Hand the FIFO to the DMA engine; RX must be listening before TX feeds it
+    *SPI_CS = (*SPI_CS & ~SPI_CS_TA) | SPI_CS_CLEAR_RX | SPI_CS_CLEAR_TX |
+              SPI_CS_DMAEN | SPI_CS_ADCS;
+    
+    if (dma_start(SPI_DMA_RX_CHANNEL, &rx_cbs[0]) != DMA_SUCCESS ||
+        dma_start(SPI_DMA_TX_CHANNEL, &tx_cbs[0]) != DMA_SUCCESS) {
+        *SPI_CS = *SPI_CS & ~(SPI_CS_DMAEN | SPI_CS_ADCS);
+        return SPI_ERROR_BUSY;
+    }
+    
+    spi_dma_active = true;
+    return SPI_SUCCESS;
+}
+
+// Non-zero while a DMA transaction is in flight
+int spi_dma_busy(void) {
+    // Every received byte has landed once the RX chain ends
+    return spi_dma_active && dma_busy(SPI_DMA_RX_CHANNEL);
+}
+
+// Finish the current DMA transaction
+spi_status_t spi_dma_wait(void) {
+    if (!spi_dma_active) {
+        return SPI_SUCCESS;
+    }
+    
+    spi_status_t status = SPI_SUCCESS;
+    if (dma_wait(SPI_DMA_TX_CHANNEL) != DMA_SUCCESS ||
+        dma_wait(SPI_DMA_RX_CHANNEL) != DMA_SUCCESS) {
+        status = SPI_ERROR_TIMEOUT;
+    } else {
+        status = spi_wait_done();
+    }
+    
+    // Release the bus and leave DMA mode
+    *SPI_CS = *SPI_CS & ~(SPI_CS_TA | SPI_CS_DMAEN | SPI_CS_ADCS);
+    
+    for (uint32_t i = 0; i < active_count; i++) {
+        if (active_segments[i].rx != NULL) {
+            dma_sync_for_cpu(active_segments[i].rx, active_segments[i].len);
+        }
+    }
+    
+    spi_dma_active = false;
+    active_count = 0;
+    
+    return status;
+}
@@ -38,6 +38,18 @@ typedef enum {
     SPI_CS_POL_HIGH = 1   // CS active high
 } spi_cs_pol_t;
 
+// DMA transfers: DLEN is 16 bits when the DMA engine feeds the FIFO
+#define SPI_DMA_MAX_LEN       65535
+#define SPI_DMA_MAX_SEGMENTS  8
+
+// One piece of a gathered DMA transfer. tx NULL sends zeros, rx NULL
+// discards the bytes received.
+typedef struct {
+    const uint8_t* tx;
+    uint8_t* rx;
+    uint32_t len;
+} spi_segment_t;
+
 // SPI configuration
 typedef struct {
     uint32_t clock_speed;  // Clock speed in Hz
@@ -69,4 +81,23 @@ spi_status_t spi_set_clock_speed(uint32_t clock_speed);
 // Set SPI mode (CPOL and CPHA)
 spi_status_t spi_set_mode(spi_cpol_t cpol, spi_cpha_t cpha);
 
+// Effective bus clock in Hz after the divider is applied
+uint32_t spi_get_clock_speed(void);
+
+// Claim the TX and RX DMA channels; call once after spi_init()
+spi_status_t spi_dma_init(void);
+
+// Start one chip-select transaction made of up to SPI_DMA_MAX_SEGMENTS
+// segments. Every segment becomes a DMA control block, so headers and
+// payloads are sent back to back without being copied together. Returns
+// as soon as the DMA engine is running.
+spi_status_t spi_dma_start(const spi_segment_t* segments, uint32_t count);
+
+// Non-zero while a DMA transaction is in flight
+int spi_dma_busy(void);
+
+// Finish the current DMA transaction (always call it, even after
+// spi_dma_busy() turned 0: it releases the bus and syncs RX buffers)
+spi_status_t spi_dma_wait(void);
+
 #endif // SPI_H
\ No newline at end of file
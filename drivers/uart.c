@@ -204,6 +204,21 @@ unsigned char uart_getc() {
 #endif
 }
 
+// Receive a character if one is waiting
+int uart_try_getc(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (!(inb(0x3F8 + 5) & 1)) {
+        return -1;
+    }
+    return inb(0x3F8);
+#else
+    if (*UART0_FR & (1 << 4)) {
+        return -1;
+    }
+    return *UART0_DR & 0xFF;
+#endif
+}
+
 // Send a string
 void uart_puts(const char* str) {
     while (*str) {
@@ -80,6 +80,9 @@ void uart_putc(unsigned char c);
 // Receive a character
 unsigned char uart_getc();
 
+// Receive a character if one is waiting; returns -1 without waiting if not
+int uart_try_getc(void);
+
 // Send a string
 void uart_puts(const char* str);
 
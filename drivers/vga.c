@@ -12,6 +12,9 @@
 
 // VGA text mode buffer
 static volatile uint16_t* vga_buffer = (uint16_t*)0xB8000;
+// Copy of the screen in RAM. The VGA window is mapped write-combining, so
+// reads from it are uncached and slow; scrolling works from this copy.
+static uint16_t vga_shadow[VGA_WIDTH * VGA_HEIGHT];
 static int vga_row = 0;
 static int vga_col = 0;
 static uint8_t vga_color = VGA_COLOR_LIGHT_GREY | (VGA_COLOR_BLACK << 4);
@@ -22,6 +25,25 @@ static inline uint16_t vga_entry(unsigned char uc, uint8_t color) {
     return (uint16_t) uc | (uint16_t) color << 8;
 }
 
+// Write one cell to the screen and its shadow
+static inline void vga_write_cell(int index, uint16_t entry) {
+    vga_shadow[index] = entry;
+    vga_buffer[index] = entry;
+}
+
+// Move all lines up by one, reading only the shadow, and clear the last
+static void vga_scroll(void) {
+    for (int y = 0; y < VGA_HEIGHT - 1; y++) {
+        for (int x = 0; x < VGA_WIDTH; x++) {
+            vga_write_cell(y * VGA_WIDTH + x, vga_shadow[(y + 1) * VGA_WIDTH + x]);
+        }
+    }
+    for (int x = 0; x < VGA_WIDTH; x++) {
+        vga_write_cell((VGA_HEIGHT - 1) * VGA_WIDTH + x, vga_entry(' ', vga_color));
+    }
+    vga_row = VGA_HEIGHT - 1;
+}
+
 void vga_init(void) {
     vga_row = 0;
     vga_col = 0;
@@ -31,7 +53,7 @@ void vga_init(void) {
     for (int y = 0; y < VGA_HEIGHT; y++) {
         for (int x = 0; x < VGA_WIDTH; x++) {
             const int index = y * VGA_WIDTH + x;
-            vga_buffer[index] = vga_entry(' ', vga_color);
+            vga_write_cell(index, vga_entry(' ', vga_color));
         }
     }
 }
@@ -44,37 +66,17 @@ void vga_putc(char c) {
     if (c == '\n') {
         vga_col = 0;
         if (++vga_row == VGA_HEIGHT) {
-            // Scroll up
-            for (int y = 0; y < VGA_HEIGHT - 1; y++) {
-                for (int x = 0; x < VGA_WIDTH; x++) {
-                    vga_buffer[y * VGA_WIDTH + x] = vga_buffer[(y + 1) * VGA_WIDTH + x];
-                }
-            }
-            // Clear last line
-            for (int x = 0; x < VGA_WIDTH; x++) {
-                vga_buffer[(VGA_HEIGHT - 1) * VGA_WIDTH + x] = vga_entry(' ', vga_color);
-            }
-            vga_row = VGA_HEIGHT - 1;
+            vga_scroll();
         }
     } else if (c == '\r') {
         vga_col = 0;
     } else {
         const int index = vga_row * VGA_WIDTH + vga_col;
-        vga_buffer[index] = vga_entry(c, vga_color);
+        vga_write_cell(index, vga_entry(c, vga_color));
         if (++vga_col == VGA_WIDTH) {
             vga_col = 0;
             if (++vga_row == VGA_HEIGHT) {
-                // Scroll up
-                for (int y = 0; y < VGA_HEIGHT - 1; y++) {
-                    for (int x = 0; x < VGA_WIDTH; x++) {
-                        vga_buffer[y * VGA_WIDTH + x] = vga_buffer[(y + 1) * VGA_WIDTH + x];
-                    }
-                }
-                // Clear last line
-                for (int x = 0; x < VGA_WIDTH; x++) {
-                    vga_buffer[(VGA_HEIGHT - 1) * VGA_WIDTH + x] = vga_entry(' ', vga_color);
-                }
-                vga_row = VGA_HEIGHT - 1;
+                vga_scroll();
             }
         }
     }
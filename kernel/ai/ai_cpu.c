@@ -0,0 +1,712 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — CPU Inference Engine
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "ai_cpu.h"
+#include "ai_planner.h"
+#include "../stdio.h"
+#include "../timer.h"
+#include <stdbool.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#define ARENA_ALIGN 16
+#define FP16_MAX    65504.0f
+
+// One layer with its shapes resolved and parameters located in the arena
+typedef struct {
+    ai_cpu_op_t op;
+    ai_cpu_window_t window;
+    uint32_t out_channels;
+    uint32_t k;                 // GEMM reduction length
+    uint32_t tile_rows;         // Output pixels per GEMM tile
+    bool direct;                // GEMM reads the input as is, no im2col
+    uint32_t out_offset;        // Output in the activation arena, unless last
+    const void* weights;
+    const void* bias;
+    ai_cpu_requant_t quant;
+    int8_t in_zero_point;       // INT8 value of padded taps
+    float in_scale;
+    float min;                  // FP16 activation clamp
+    float max;
+    uint32_t fused;             // Model layers folded into this one
+    uint64_t macs;
+    uint32_t runs;              // Profile
+    uint64_t ticks;
+    uint64_t max_ticks;
+} cpu_layer_t;
+
+typedef struct {
+    bool used;
+    uint32_t offset;            // Blob copy in the arena
+    uint32_t size;
+    ai_cpu_model_info_t info;
+    cpu_layer_t layers[AI_CPU_MAX_LAYERS];   // info.ops of them, after fusion
+} cpu_model_t;
+
+static cpu_model_t models[AI_CPU_MAX_MODELS];
+static uint8_t arena[AI_CPU_ARENA_SIZE] __attribute__((aligned(ARENA_ALIGN)));
+static uint8_t activations[AI_CPU_ACTIVATION_SIZE] __attribute__((aligned(ARENA_ALIGN)));
+static ai_plan_tensor_t activation_plan[AI_CPU_MAX_LAYERS];
+static bool fusion_enabled = true;
+static uint8_t im2col_tile[AI_CPU_TILE_SIZE] __attribute__((aligned(ARENA_ALIGN)));
+static uint8_t acc_tile[AI_CPU_TILE_SIZE] __attribute__((aligned(ARENA_ALIGN)));
+
+// The kernels use SSE/AVX and NEON registers and the softmax uses floating
+// point, none of which the boot code enables. There is no preemption, so
+// the extended state never needs saving.
+static void enable_simd(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned long cr0, cr4;
+    unsigned int eax, ebx, ecx = 0, edx;
+    
+    __asm__ volatile ("mov %%cr0, %0" : "=r"(cr0));
+    cr0 = (cr0 & ~(1UL << 2)) | (1UL << 1);                // EM off, MP on
+    __asm__ volatile ("mov %0, %%cr0" : : "r"(cr0));
+    
+    __asm__ volatile ("mov %%cr4, %0" : "=r"(cr4));
+    cr4 |= (1UL << 9) | (1UL << 10);                        // OSFXSR, OSXMMEXCPT
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    if (ecx & bit_XSAVE) {
+        cr4 |= 1UL << 18;                                   // OSXSAVE
+    }
+    __asm__ volatile ("mov %0, %%cr4" : : "r"(cr4));
+    
+    if (ecx & bit_XSAVE) {
+        // x87 and SSE state, plus the upper YMM halves when there are any
+        uint32_t xcr0 = 0x3 | ((ecx & bit_AVX) ? 0x4 : 0);
+        __asm__ volatile ("xsetbv" : : "c"(0), "a"(xcr0), "d"(0));
+    }
+    __asm__ volatile ("fninit");
+#elif defined(__aarch64__)
+    uint64_t cpacr;
+    __asm__ volatile ("mrs %0, cpacr_el1" : "=r"(cpacr));
+    cpacr |= 3UL << 20;                                     // FPEN: no FP/SIMD traps
+    __asm__ volatile ("msr cpacr_el1, %0; isb" : : "r"(cpacr));
+#elif defined(__riscv) && defined(__riscv_flen)
+    __asm__ volatile ("csrs sstatus, %0" : : "r"(1UL << 13));  // FS = Initial
+#endif
+}
+
+void ai_cpu_init(void) {
+    static bool initialized = false;
+    
+    if (!initialized) {
+        enable_simd();
+        ai_cpu_set_isa(ai_cpu_detect_isa());
+        initialized = true;
+    }
+}
+
+void ai_cpu_set_fusion(int enabled) {
+    fusion_enabled = (enabled != 0);
+}
+
+int ai_cpu_probe(const void* data, uint32_t size) {
+    const ai_cpu_model_header_t* header = (const ai_cpu_model_header_t*)data;
+    return data != NULL && size >= sizeof(*header) && header->magic == AI_CPU_MODEL_MAGIC;
+}
+
+// First fit over the gaps between loaded models
+static bool arena_alloc(uint32_t size, uint32_t* offset) {
+    uint32_t need = (size + ARENA_ALIGN - 1) & ~(uint32_t)(ARENA_ALIGN - 1);
+    uint32_t candidate = 0;
+    
+    for (;;) {
+        int blocking = -1;
+        for (int i = 0; i < AI_CPU_MAX_MODELS; i++) {
+            if (models[i].used && models[i].offset < candidate + need &&
+                candidate < models[i].offset + models[i].size) {
+                blocking = i;
+                break;
+            }
+        }
+        
+        if (blocking < 0) {
+            if (need > AI_CPU_ARENA_SIZE || candidate > AI_CPU_ARENA_SIZE - need) {
+                return false;
+            }
+            *offset = candidate;
+            return true;
+        }
+        
+        candidate = (models[blocking].offset + models[blocking].size + ARENA_ALIGN - 1) &
+                    ~(uint32_t)(ARENA_ALIGN - 1);
+    }
+}
+
+static uint32_t align4(uint32_t value) {
+    return (value + 3) & ~3u;
+}
+
+// Resolve one layer against its input shape. Returns the parameter bytes
+// it expects, or a negative error code.
+static int compile_layer(cpu_layer_t* layer, const ai_cpu_layer_t* desc, ai_cpu_dtype_t dtype,
+                         uint32_t h, uint32_t w, uint32_t c, uint64_t* macs) {
+    uint32_t element = (dtype == AI_CPU_DTYPE_INT8) ? 1 : 2;
+    ai_cpu_window_t* window = &layer->window;
+    uint32_t weights = 0;
+    
+    layer->op = (ai_cpu_op_t)desc->op;
+    window->in_h = h;
+    window->in_w = w;
+    window->channels = c;
+    window->kernel_h = desc->kernel_h;
+    window->kernel_w = desc->kernel_w;
+    window->stride = desc->stride;
+    window->pad = desc->pad;
+    window->out_h = 1;
+    window->out_w = 1;
+    layer->out_channels = c;
+    
+    switch (layer->op) {
+        case AI_CPU_OP_CONV2D:
+        case AI_CPU_OP_DEPTHWISE:
+        case AI_CPU_OP_MAX_POOL:
+        case AI_CPU_OP_AVG_POOL:
+            if (desc->kernel_h == 0 || desc->kernel_w == 0 || desc->stride == 0 ||
+                desc->pad >= desc->kernel_h || desc->pad >= desc->kernel_w ||
+                h + 2 * desc->pad < desc->kernel_h || w + 2 * desc->pad < desc->kernel_w) {
+                return AI_CPU_ERROR_FORMAT;
+            }
+            window->out_h = (h + 2 * desc->pad - desc->kernel_h) / desc->stride + 1;
+            window->out_w = (w + 2 * desc->pad - desc->kernel_w) / desc->stride + 1;
+            break;
+        case AI_CPU_OP_FULLY_CONNECTED:
+        case AI_CPU_OP_SOFTMAX:
+        case AI_CPU_OP_ACTIVATION:
+        case AI_CPU_OP_RESHAPE:
+            break;
+        case AI_CPU_OP_BATCH_NORM:
+            if (dtype != AI_CPU_DTYPE_FP16) {
+                return AI_CPU_ERROR_FORMAT;     // Quantizers fold it into the weights already
+            }
+            break;
+        default:
+            return AI_CPU_ERROR_FORMAT;
+    }
+    
+    uint32_t pixels = window->out_h * window->out_w;
+    switch (layer->op) {
+        case AI_CPU_OP_CONV2D:
+            layer->out_channels = desc->out_channels;
+            layer->k = desc->kernel_h * desc->kernel_w * c;
+            layer->direct = (desc->kernel_h == 1 && desc->kernel_w == 1 && desc->stride == 1 && desc->pad == 0);
+            weights = layer->out_channels * layer->k * element;
+            *macs += (uint64_t)pixels * layer->out_channels * layer->k;
+            break;
+        case AI_CPU_OP_FULLY_CONNECTED:
+            layer->out_channels = desc->out_channels;
+            layer->k = h * w * c;
+            layer->direct = true;
+            weights = layer->out_channels * layer->k * element;
+            *macs += (uint64_t)layer->out_channels * layer->k;
+            break;
+        case AI_CPU_OP_DEPTHWISE:
+            weights = desc->kernel_h * desc->kernel_w * c * element;
+            *macs += (uint64_t)pixels * c * desc->kernel_h * desc->kernel_w;
+            break;
+        case AI_CPU_OP_BATCH_NORM:
+            window->out_h = h;
+            window->out_w = w;
+            weights = c * 4;
+            *macs += (uint64_t)h * w * c;
+            break;
+        case AI_CPU_OP_ACTIVATION:
+            window->out_h = h;
+            window->out_w = w;
+            break;
+        case AI_CPU_OP_RESHAPE:
+            layer->out_channels = h * w * c;
+            break;
+        default:
+            break;
+    }
+    
+    if (layer->out_channels == 0) {
+        return AI_CPU_ERROR_FORMAT;
+    }
+    
+    // GEMM tiles: as many output pixels as fit both scratch buffers
+    if (layer->op == AI_CPU_OP_CONV2D || layer->op == AI_CPU_OP_FULLY_CONNECTED) {
+        uint32_t rows = AI_CPU_TILE_SIZE / (layer->out_channels * 4);
+        if (!layer->direct && AI_CPU_TILE_SIZE / (layer->k * element) < rows) {
+            rows = AI_CPU_TILE_SIZE / (layer->k * element);
+        }
+        if (rows == 0) {
+            return AI_CPU_ERROR_MEMORY;
+        }
+        layer->tile_rows = rows;
+    }
+    
+    if (weights == 0) {
+        return 0;
+    }
+    return (int)(align4(weights) + layer->out_channels * 4);
+}
+
+// Fold a layer into the kernel that produces its input. Activations merge
+// into the output clamp, batch norm into the weights and bias (while no
+// clamp sits between them), and a reshape needs no kernel at all.
+static bool fuse_layer(cpu_layer_t* prev, const cpu_layer_t* layer, ai_cpu_dtype_t dtype) {
+    if (layer->op == AI_CPU_OP_RESHAPE) {
+        prev->fused++;
+        return true;
+    }
+    if (prev->op != AI_CPU_OP_CONV2D && prev->op != AI_CPU_OP_DEPTHWISE &&
+        prev->op != AI_CPU_OP_FULLY_CONNECTED) {
+        return false;
+    }
+    
+    if (layer->op == AI_CPU_OP_ACTIVATION) {
+        if (dtype == AI_CPU_DTYPE_INT8) {
+            prev->quant.min = (layer->quant.min > prev->quant.min) ? layer->quant.min : prev->quant.min;
+            prev->quant.max = (layer->quant.max < prev->quant.max) ? layer->quant.max : prev->quant.max;
+        } else {
+            prev->min = (layer->min > prev->min) ? layer->min : prev->min;
+            prev->max = (layer->max < prev->max) ? layer->max : prev->max;
+        }
+        prev->fused++;
+        return true;
+    }
+    
+    if (layer->op == AI_CPU_OP_BATCH_NORM && prev->min == -FP16_MAX && prev->max == FP16_MAX) {
+        const float* scale = (const float*)layer->weights;
+        const float* shift = (const float*)layer->bias;
+        uint16_t* weights = (uint16_t*)prev->weights;      // The model's arena copy
+        float* bias = (float*)prev->bias;
+        uint32_t n = prev->out_channels;
+        uint32_t count = (prev->op == AI_CPU_OP_DEPTHWISE) ? prev->window.kernel_h * prev->window.kernel_w * n
+                                                           : n * prev->k;
+        
+        // GEMM weights hold one output channel per row, depthwise weights
+        // cycle through the channels
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t channel = (prev->op == AI_CPU_OP_DEPTHWISE) ? i % n : i / prev->k;
+            weights[i] = ai_cpu_float_to_half(ai_cpu_half_to_float(weights[i]) * scale[channel]);
+        }
+        for (uint32_t channel = 0; channel < n; channel++) {
+            bias[channel] = bias[channel] * scale[channel] + shift[channel];
+        }
+        prev->min = layer->min;
+        prev->max = layer->max;
+        prev->macs += layer->macs;
+        prev->fused++;
+        return true;
+    }
+    
+    return false;
+}
+
+static int compile_model(cpu_model_t* model, const uint8_t* blob, uint32_t size) {
+    const ai_cpu_model_header_t* header = (const ai_cpu_model_header_t*)blob;
+    ai_cpu_model_info_t* info = &model->info;
+    
+    if (header->version != AI_CPU_MODEL_VERSION || header->dtype > AI_CPU_DTYPE_FP16 ||
+        header->num_layers == 0 || header->num_layers > AI_CPU_MAX_LAYERS ||
+        header->input_h == 0 || header->input_w == 0 || header->input_c == 0 ||
+        header->input_zero_point < -128 || header->input_zero_point > 127) {
+        return AI_CPU_ERROR_FORMAT;
+    }
+    
+    ai_cpu_dtype_t dtype = (ai_cpu_dtype_t)header->dtype;
+    uint32_t element = (dtype == AI_CPU_DTYPE_INT8) ? 1 : 2;
+    uint32_t h = header->input_h, w = header->input_w, c = header->input_c;
+    int32_t zero_point = header->input_zero_point;
+    uint32_t offset = sizeof(*header);
+    
+    memset(info, 0, sizeof(*info));
+    info->dtype = dtype;
+    info->input_dims[0] = h;
+    info->input_dims[1] = w;
+    info->input_dims[2] = c;
+    info->input_bytes = h * w * c * element;
+    info->layers = header->num_layers;
+    
+    uint32_t ops = 0;
+    for (uint32_t i = 0; i < header->num_layers; i++) {
+        if (size - offset < sizeof(ai_cpu_layer_t)) {
+            return AI_CPU_ERROR_FORMAT;
+        }
+        const ai_cpu_layer_t* desc = (const ai_cpu_layer_t*)(blob + offset);
+        offset += sizeof(ai_cpu_layer_t);
+        if ((desc->weights_size & 3) || desc->weights_size > size - offset) {
+            return AI_CPU_ERROR_FORMAT;
+        }
+        
+        cpu_layer_t* layer = &model->layers[ops];
+        uint64_t macs = info->macs;
+        memset(layer, 0, sizeof(*layer));
+        int expected = compile_layer(layer, desc, dtype, h, w, c, &info->macs);
+        if (expected < 0) {
+            return expected;
+        }
+        layer->macs = info->macs - macs;
+        if ((uint32_t)expected != desc->weights_size) {
+            return AI_CPU_ERROR_FORMAT;
+        }
+        if (expected > 0) {
+            layer->weights = blob + offset;
+            layer->bias = blob + offset + desc->weights_size - layer->out_channels * 4;
+        }
+        offset += desc->weights_size;
+        
+        // Quantization follows the tensor from layer to layer
+        layer->in_zero_point = (int8_t)zero_point;
+        layer->in_scale = desc->in_scale;
+        if (dtype == AI_CPU_DTYPE_INT8) {
+            if (layer->op == AI_CPU_OP_SOFTMAX) {
+                if (!(desc->in_scale > 0.0f)) {
+                    return AI_CPU_ERROR_FORMAT;
+                }
+                zero_point = -128;
+            } else if (layer->op == AI_CPU_OP_CONV2D || layer->op == AI_CPU_OP_DEPTHWISE ||
+                       layer->op == AI_CPU_OP_FULLY_CONNECTED) {
+                if (desc->act_min > desc->act_max || desc->shift < -31 || desc->shift > 30) {
+                    return AI_CPU_ERROR_FORMAT;
+                }
+                layer->quant.multiplier = desc->multiplier;
+                layer->quant.shift = desc->shift;
+                layer->quant.zero_point = desc->out_zero_point;
+                layer->quant.min = desc->act_min;
+                layer->quant.max = desc->act_max;
+                zero_point = desc->out_zero_point;
+            } else if (layer->op == AI_CPU_OP_ACTIVATION) {
+                if (desc->act_min > desc->act_max) {
+                    return AI_CPU_ERROR_FORMAT;
+                }
+                layer->quant.min = desc->act_min;
+                layer->quant.max = desc->act_max;
+            }
+        } else {
+            layer->min = (desc->activation == AI_CPU_ACT_NONE) ? -FP16_MAX : 0.0f;
+            layer->max = (desc->activation == AI_CPU_ACT_RELU6) ? 6.0f : FP16_MAX;
+        }
+        
+        h = layer->window.out_h;
+        w = layer->window.out_w;
+        c = layer->out_channels;
+        
+        // Keep it as a kernel unless it folds into the previous one
+        if (!fusion_enabled || ops == 0 || !fuse_layer(&model->layers[ops - 1], layer, dtype)) {
+            ops++;
+        }
+    }
+    
+    if (offset != size) {
+        return AI_CPU_ERROR_FORMAT;
+    }
+    
+    // Each intermediate tensor is written by one kernel and read by the
+    // next, so tensors two kernels apart can share memory
+    for (uint32_t i = 0; i + 1 < ops; i++) {
+        const cpu_layer_t* layer = &model->layers[i];
+        activation_plan[i].size = layer->window.out_h * layer->window.out_w * layer->out_channels * element;
+        activation_plan[i].first_use = i;
+        activation_plan[i].last_use = i + 1;
+    }
+    uint32_t peak;
+    if (ai_planner_plan(activation_plan, ops - 1, &peak) != 0 || peak > AI_CPU_ACTIVATION_SIZE) {
+        return AI_CPU_ERROR_MEMORY;
+    }
+    for (uint32_t i = 0; i + 1 < ops; i++) {
+        model->layers[i].out_offset = activation_plan[i].offset;
+    }
+    info->arena_bytes = peak;
+    info->ops = ops;
+    
+    info->output_dims[0] = h;
+    info->output_dims[1] = w;
+    info->output_dims[2] = c;
+    info->output_bytes = h * w * c * element;
+    return 0;
+}
+
+int ai_cpu_load_model(const void* data, uint32_t size, ai_cpu_model_info_t* info) {
+    int handle = -1;
+    uint32_t offset;
+    
+    if (!ai_cpu_probe(data, size)) {
+        return AI_CPU_ERROR_FORMAT;
+    }
+    
+    for (int i = 0; i < AI_CPU_MAX_MODELS; i++) {
+        if (!models[i].used) {
+            handle = i;
+            break;
+        }
+    }
+    if (handle < 0 || !arena_alloc(size, &offset)) {
+        return AI_CPU_ERROR_MEMORY;
+    }
+    
+    // Compile against the arena copy so the layers point at it
+    cpu_model_t* model = &models[handle];
+    memcpy(arena + offset, data, size);
+    int result = compile_model(model, arena + offset, size);
+    if (result != 0) {
+        return result;
+    }
+    
+    model->offset = offset;
+    model->size = size;
+    model->used = true;
+    if (info != NULL) {
+        *info = model->info;
+    }
+    return handle;
+}
+
+int ai_cpu_slice_model(const void* data, uint32_t size, uint32_t first_layer, uint32_t num_layers,
+                       void* out, uint32_t out_size) {
+    static cpu_layer_t scratch;
+    const ai_cpu_model_header_t* header = (const ai_cpu_model_header_t*)data;
+    const uint8_t* blob = (const uint8_t*)data;
+    
+    if (!ai_cpu_probe(data, size) || out == NULL || num_layers == 0 ||
+        first_layer + num_layers > header->num_layers || header->dtype > AI_CPU_DTYPE_FP16) {
+        return AI_CPU_ERROR_PARAM;
+    }
+    
+    // Follow the shape and input zero point up to the first layer, and find
+    // where the layers to keep start and end in the blob
+    ai_cpu_dtype_t dtype = (ai_cpu_dtype_t)header->dtype;
+    uint32_t h = header->input_h, w = header->input_w, c = header->input_c;
+    int32_t zero_point = header->input_zero_point;
+    uint32_t offset = sizeof(*header);
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < first_layer + num_layers; i++) {
+        if (i == first_layer) {
+            start = offset;
+        }
+        if (size - offset < sizeof(ai_cpu_layer_t)) {
+            return AI_CPU_ERROR_FORMAT;
+        }
+        const ai_cpu_layer_t* desc = (const ai_cpu_layer_t*)(blob + offset);
+        offset += sizeof(ai_cpu_layer_t);
+        if (desc->weights_size > size - offset) {
+            return AI_CPU_ERROR_FORMAT;
+        }
+        offset += desc->weights_size;
+        if (i >= first_layer) {
+            continue;
+        }
+        
+        uint64_t macs = 0;
+        if (compile_layer(&scratch, desc, dtype, h, w, c, &macs) < 0) {
+            return AI_CPU_ERROR_FORMAT;
+        }
+        h = scratch.window.out_h;
+        w = scratch.window.out_w;
+        c = scratch.out_channels;
+        if (dtype == AI_CPU_DTYPE_INT8 && desc->op == AI_CPU_OP_SOFTMAX) {
+            zero_point = -128;
+        } else if (dtype == AI_CPU_DTYPE_INT8 && (desc->op == AI_CPU_OP_CONV2D || desc->op == AI_CPU_OP_DEPTHWISE ||
+                                                  desc->op == AI_CPU_OP_FULLY_CONNECTED)) {
+            zero_point = desc->out_zero_point;
+        }
+    }
+    
+    ai_cpu_model_header_t slice = *header;
+    if (h > 0xFFFF || w > 0xFFFF || c > 0xFFFF) {
+        return AI_CPU_ERROR_FORMAT;
+    }
+    if (sizeof(slice) + (offset - start) > out_size) {
+        return AI_CPU_ERROR_MEMORY;
+    }
+    slice.num_layers = (uint8_t)num_layers;
+    slice.input_h = (uint16_t)h;
+    slice.input_w = (uint16_t)w;
+    slice.input_c = (uint16_t)c;
+    slice.input_zero_point = (int16_t)zero_point;
+    memcpy(out, &slice, sizeof(slice));
+    memcpy((uint8_t*)out + sizeof(slice), blob + start, offset - start);
+    return (int)(sizeof(slice) + (offset - start));
+}
+
+int ai_cpu_unload_model(int handle) {
+    if (handle < 0 || handle >= AI_CPU_MAX_MODELS || !models[handle].used) {
+        return AI_CPU_ERROR_PARAM;
+    }
+    models[handle].used = false;
+    return 0;
+}
+
+int ai_cpu_get_model_info(int handle, ai_cpu_model_info_t* info) {
+    if (handle < 0 || handle >= AI_CPU_MAX_MODELS || !models[handle].used || info == NULL) {
+        return AI_CPU_ERROR_PARAM;
+    }
+    *info = models[handle].info;
+    return 0;
+}
+
+// Convolution and fully connected layers: im2col (unless the input already
+// is the patch matrix) and GEMM one tile of output pixels at a time
+static void gemm_layer_s8(const cpu_layer_t* layer, const int8_t* in, int8_t* out) {
+    uint32_t pixels = layer->window.out_h * layer->window.out_w;
+    uint32_t n = layer->out_channels;
+    int32_t* acc = (int32_t*)acc_tile;
+    
+    for (uint32_t first = 0; first < pixels; first += layer->tile_rows) {
+        uint32_t count = (pixels - first < layer->tile_rows) ? pixels - first : layer->tile_rows;
+        const int8_t* rows = in + first * layer->k;
+        if (!layer->direct) {
+            ai_cpu_im2col_s8(in, &layer->window, first, count, layer->in_zero_point, (int8_t*)im2col_tile);
+            rows = (const int8_t*)im2col_tile;
+        }
+        ai_cpu_gemm_s8(rows, (const int8_t*)layer->weights, acc, count, n, layer->k);
+        ai_cpu_requantize_s8(acc, (const int32_t*)layer->bias, out + first * n, count, n, &layer->quant);
+    }
+}
+
+static void gemm_layer_f16(const cpu_layer_t* layer, const uint16_t* in, uint16_t* out) {
+    uint32_t pixels = layer->window.out_h * layer->window.out_w;
+    uint32_t n = layer->out_channels;
+    float* acc = (float*)acc_tile;
+    
+    for (uint32_t first = 0; first < pixels; first += layer->tile_rows) {
+        uint32_t count = (pixels - first < layer->tile_rows) ? pixels - first : layer->tile_rows;
+        const uint16_t* rows = in + first * layer->k;
+        if (!layer->direct) {
+            ai_cpu_im2col_f16(in, &layer->window, first, count, (uint16_t*)im2col_tile);
+            rows = (const uint16_t*)im2col_tile;
+        }
+        ai_cpu_gemm_f16(rows, (const uint16_t*)layer->weights, acc, count, n, layer->k);
+        ai_cpu_narrow_f16(acc, (const float*)layer->bias, out + first * n, count, n, layer->min, layer->max);
+    }
+}
+
+static void run_layer_s8(const cpu_layer_t* layer, const int8_t* in, int8_t* out) {
+    const ai_cpu_window_t* window = &layer->window;
+    
+    switch (layer->op) {
+        case AI_CPU_OP_CONV2D:
+        case AI_CPU_OP_FULLY_CONNECTED:
+            gemm_layer_s8(layer, in, out);
+            break;
+        case AI_CPU_OP_DEPTHWISE:
+            ai_cpu_depthwise_s8(in, window, (const int8_t*)layer->weights, (const int32_t*)layer->bias,
+                                layer->in_zero_point, &layer->quant, out);
+            break;
+        case AI_CPU_OP_MAX_POOL:
+        case AI_CPU_OP_AVG_POOL:
+            ai_cpu_pool_s8(in, window, layer->op == AI_CPU_OP_AVG_POOL, out);
+            break;
+        case AI_CPU_OP_SOFTMAX:
+            ai_cpu_softmax_s8(in, window->in_h * window->in_w, window->channels, layer->in_scale, out);
+            break;
+        case AI_CPU_OP_ACTIVATION:
+            ai_cpu_clamp_s8(in, window->in_h * window->in_w * window->channels, layer->quant.min,
+                            layer->quant.max, out);
+            break;
+        case AI_CPU_OP_RESHAPE:
+            memcpy(out, in, window->in_h * window->in_w * window->channels);
+            break;
+        default:
+            break;
+    }
+}
+
+static void run_layer_f16(const cpu_layer_t* layer, const uint16_t* in, uint16_t* out) {
+    const ai_cpu_window_t* window = &layer->window;
+    
+    switch (layer->op) {
+        case AI_CPU_OP_CONV2D:
+        case AI_CPU_OP_FULLY_CONNECTED:
+            gemm_layer_f16(layer, in, out);
+            break;
+        case AI_CPU_OP_DEPTHWISE:
+            ai_cpu_depthwise_f16(in, window, (const uint16_t*)layer->weights, (const float*)layer->bias,
+                                 layer->min, layer->max, out);
+            break;
+        case AI_CPU_OP_MAX_POOL:
+        case AI_CPU_OP_AVG_POOL:
+            ai_cpu_pool_f16(in, window, layer->op == AI_CPU_OP_AVG_POOL, out);
+            break;
+        case AI_CPU_OP_SOFTMAX:
+            ai_cpu_softmax_f16(in, window->in_h * window->in_w, window->channels, out);
+            break;
+        case AI_CPU_OP_BATCH_NORM:
+            ai_cpu_scale_shift_f16(in, window->in_h * window->in_w, window->channels, (const float*)layer->weights,
+                                   (const float*)layer->bias, layer->min, layer->max, out);
+            break;
+        case AI_CPU_OP_ACTIVATION:
+            ai_cpu_clamp_f16(in, window->in_h * window->in_w * window->channels, layer->min, layer->max, out);
+            break;
+        case AI_CPU_OP_RESHAPE:
+            memcpy(out, in, window->in_h * window->in_w * window->channels * 2);
+            break;
+        default:
+            break;
+    }
+}
+
+int ai_cpu_run(int handle, const void* input, void* output) {
+    if (handle < 0 || handle >= AI_CPU_MAX_MODELS || !models[handle].used || input == NULL || output == NULL) {
+        return AI_CPU_ERROR_PARAM;
+    }
+    
+    cpu_model_t* model = &models[handle];
+    const void* src = input;
+    
+    // Intermediate tensors sit where the model's plan put them; the last
+    // kernel writes straight into the caller's output
+    for (uint32_t i = 0; i < model->info.ops; i++) {
+        cpu_layer_t* layer = &model->layers[i];
+        void* dst = (i + 1 == model->info.ops) ? output : activations + layer->out_offset;
+        uint64_t start = timer_ticks();
+        if (model->info.dtype == AI_CPU_DTYPE_INT8) {
+            run_layer_s8(layer, (const int8_t*)src, (int8_t*)dst);
+        } else {
+            run_layer_f16(layer, (const uint16_t*)src, (uint16_t*)dst);
+        }
+        uint64_t elapsed = timer_ticks() - start;
+        layer->ticks += elapsed;
+        layer->runs++;
+        if (elapsed > layer->max_ticks) {
+            layer->max_ticks = elapsed;
+        }
+        src = dst;
+    }
+    
+    return 0;
+}
+
+int ai_cpu_get_profile(int handle, ai_cpu_op_profile_t* ops, uint32_t max_ops, uint32_t* num_ops) {
+    if (handle < 0 || handle >= AI_CPU_MAX_MODELS || !models[handle].used || num_ops == NULL ||
+        (ops == NULL && max_ops > 0)) {
+        return AI_CPU_ERROR_PARAM;
+    }
+    
+    const cpu_model_t* model = &models[handle];
+    uint32_t count = (model->info.ops < max_ops) ? model->info.ops : max_ops;
+    for (uint32_t i = 0; i < count; i++) {
+        const cpu_layer_t* layer = &model->layers[i];
+        ops[i].op = layer->op;
+        ops[i].fused = layer->fused;
+        ops[i].out_dims[0] = layer->window.out_h;
+        ops[i].out_dims[1] = layer->window.out_w;
+        ops[i].out_dims[2] = layer->out_channels;
+        ops[i].macs = layer->macs;
+        ops[i].runs = layer->runs;
+        ops[i].ticks = layer->ticks;
+        ops[i].max_ticks = layer->max_ticks;
+    }
+    *num_ops = model->info.ops;
+    return 0;
+}
+
+int ai_cpu_reset_profile(int handle) {
+    if (handle < 0 || handle >= AI_CPU_MAX_MODELS || !models[handle].used) {
+        return AI_CPU_ERROR_PARAM;
+    }
+    for (uint32_t i = 0; i < models[handle].info.ops; i++) {
+        models[handle].layers[i].runs = 0;
+        models[handle].layers[i].ticks = 0;
+        models[handle].layers[i].max_ticks = 0;
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — CPU Inference Engine
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef AI_CPU_H
+#define AI_CPU_H
+
+#include "../types.h"
+#include "ai_cpu_kernels.h"
+
+#define AI_CPU_MODEL_MAGIC       0x4D434753          // "SGCM"
+#define AI_CPU_MODEL_VERSION     1
+#define AI_CPU_MAX_MODELS        8
+#define AI_CPU_MAX_LAYERS        64                  // Per model
+#define AI_CPU_ARENA_SIZE        (1024 * 1024)       // Weights of all loaded models
+#define AI_CPU_ACTIVATION_SIZE   (512 * 1024)        // Intermediate tensors, packed per model by ai_planner
+#define AI_CPU_TILE_SIZE         (64 * 1024)         // im2col rows and accumulators per GEMM tile
+
+// Error codes
+#define AI_CPU_ERROR_PARAM       -1
+#define AI_CPU_ERROR_FORMAT      -2   // Not a CPU model, or malformed
+#define AI_CPU_ERROR_MEMORY      -3   // Model table, arena or scratch buffers too small
+
+// Element type of every tensor in a model
+typedef enum {
+    AI_CPU_DTYPE_INT8 = 0,
+    AI_CPU_DTYPE_FP16 = 1
+} ai_cpu_dtype_t;
+
+typedef enum {
+    AI_CPU_OP_CONV2D = 1,
+    AI_CPU_OP_DEPTHWISE = 2,
+    AI_CPU_OP_FULLY_CONNECTED = 3,
+    AI_CPU_OP_MAX_POOL = 4,
+    AI_CPU_OP_AVG_POOL = 5,
+    AI_CPU_OP_SOFTMAX = 6,
+    AI_CPU_OP_BATCH_NORM = 7,
+    AI_CPU_OP_ACTIVATION = 8,
+    AI_CPU_OP_RESHAPE = 9
+} ai_cpu_op_t;
+
+typedef enum {
+    AI_CPU_ACT_NONE = 0,
+    AI_CPU_ACT_RELU = 1,
+    AI_CPU_ACT_RELU6 = 2
+} ai_cpu_activation_t;
+
+// Model blob: this header, then num_layers records, each followed by its
+// weights_size bytes of parameters. Tensors are HWC with batch 1.
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t dtype;              // ai_cpu_dtype_t
+    uint8_t num_layers;
+    uint16_t input_h;
+    uint16_t input_w;
+    uint16_t input_c;
+    int16_t input_zero_point;   // INT8 only
+} ai_cpu_model_header_t;
+
+// Layer parameters:
+//   CONV2D           weights [out_channels][kernel_h][kernel_w][in_channels]
+//   DEPTHWISE        weights [kernel_h][kernel_w][channels]
+//   FULLY_CONNECTED  weights [out_channels][h * w * c of the input]
+// followed, from the next 4-byte boundary, by one bias per output channel
+// (int32 for INT8 models, float for FP16). Int8 biases have the input zero
+// point folded in (bias - zero_point * sum(weights)), so padded taps read
+// the zero point.
+//   BATCH_NORM       float scale[channels], then float shift[channels]; FP16 only
+// Pooling, softmax, ACTIVATION (a standalone clamp) and RESHAPE (flatten to
+// 1 x 1 x h * w * c) take no parameters.
+//
+// At load time ACTIVATION and BATCH_NORM layers that follow a convolution,
+// depthwise or fully connected layer are folded into it, and RESHAPE layers
+// are dropped, so each fused group runs as one kernel.
+typedef struct __attribute__((packed)) {
+    uint8_t op;                 // ai_cpu_op_t
+    uint8_t kernel_h;
+    uint8_t kernel_w;
+    uint8_t stride;
+    uint8_t pad;                // Top and left; see ai_cpu_window_t
+    uint8_t activation;         // ai_cpu_activation_t, FP16 layers
+    uint16_t out_channels;      // CONV2D and FULLY_CONNECTED
+    int32_t multiplier;         // INT8 requantization, see ai_cpu_requant_t
+    int8_t shift;
+    int8_t out_zero_point;
+    int8_t act_min;             // INT8 clamp, encodes the activation
+    int8_t act_max;
+    float in_scale;             // INT8 softmax: input scale times beta
+    uint32_t weights_size;      // Parameter bytes that follow, a multiple of 4
+} ai_cpu_layer_t;
+
+typedef struct {
+    ai_cpu_dtype_t dtype;
+    uint32_t input_dims[3];     // H, W, C
+    uint32_t output_dims[3];
+    uint32_t input_bytes;
+    uint32_t output_bytes;
+    uint32_t layers;            // In the model blob
+    uint32_t ops;               // Kernels run per inference, after fusion
+    uint64_t macs;              // Multiply-accumulates per inference
+    uint32_t arena_bytes;       // Planned peak of the intermediate tensors
+} ai_cpu_model_info_t;
+
+// Time spent in one kernel of a loaded model
+typedef struct {
+    ai_cpu_op_t op;
+    uint32_t fused;             // Model layers folded into this kernel
+    uint32_t out_dims[3];
+    uint64_t macs;
+    uint32_t runs;
+    uint64_t ticks;             // timer_ticks() over all runs
+    uint64_t max_ticks;         // Slowest run
+} ai_cpu_op_profile_t;
+
+// Enable the FPU/SIMD units and pick the best kernels for this CPU
+void ai_cpu_init(void);
+
+// Layer fusion at load time, on by default. Applies to models loaded
+// afterwards; turning it off runs every model layer as its own kernel.
+void ai_cpu_set_fusion(int enabled);
+
+// Whether a blob is a CPU model (checks the header only)
+int ai_cpu_probe(const void* data, uint32_t size);
+
+// Validate and copy a model into the arena, so the caller's buffer is free
+// once this returns. Returns a handle, or a negative error code.
+int ai_cpu_load_model(const void* data, uint32_t size, ai_cpu_model_info_t* info);
+int ai_cpu_unload_model(int handle);
+int ai_cpu_get_model_info(int handle, ai_cpu_model_info_t* info);
+
+// Write layers [first_layer, first_layer + num_layers) of a model blob to
+// out as a model of their own, whose input is the tensor entering
+// first_layer. Returns its size, or a negative error code.
+int ai_cpu_slice_model(const void* data, uint32_t size, uint32_t first_layer, uint32_t num_layers,
+                       void* out, uint32_t out_size);
+
+// Run one inference. input and output hold input_bytes and output_bytes.
+int ai_cpu_run(int handle, const void* input, void* output);
+
+// Per-kernel timings accumulated by ai_cpu_run, in execution order
+int ai_cpu_get_profile(int handle, ai_cpu_op_profile_t* ops, uint32_t max_ops, uint32_t* num_ops);
+int ai_cpu_reset_profile(int handle);
+
+#endif // AI_CPU_H
@@ -0,0 +1,991 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — CPU Inference Kernels
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "ai_cpu_kernels.h"
+#include <stdbool.h>
+
+// The kernel has no libc headers for intrinsics (immintrin.h pulls in
+// stdlib.h), so the x86 paths use GCC vector extensions and builtins and
+// are compiled per function for the instruction set they need. NEON is
+// part of the aarch64 baseline and arm_neon.h is freestanding.
+#if defined(__x86_64__) || defined(__i386__)
+#define AI_CPU_X86 1
+#include <cpuid.h>
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2  __attribute__((target("avx2,fma,f16c")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define AI_CPU_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef void (*dot4_s8_func_t)(const int8_t* a, const int8_t* b, uint32_t k, int32_t* c);
+typedef int32_t (*dot1_s8_func_t)(const int8_t* a, const int8_t* b, uint32_t k);
+typedef void (*dot4_f16_func_t)(const uint16_t* a, const uint16_t* b, uint32_t k, float* c);
+typedef float (*dot1_f16_func_t)(const uint16_t* a, const uint16_t* b, uint32_t k);
+
+static ai_cpu_isa_t active_isa = AI_CPU_ISA_SCALAR;
+static int detected_isa = -1;
+
+// ── Scalar reference ────────────────────────────────────────────────────────
+
+static int32_t dot1_s8_scalar(const int8_t* a, const int8_t* b, uint32_t k) {
+    int32_t sum = 0;
+    for (uint32_t p = 0; p < k; p++) {
+        sum += a[p] * b[p];
+    }
+    return sum;
+}
+
+static void dot4_s8_scalar(const int8_t* a, const int8_t* b, uint32_t k, int32_t* c) {
+    for (uint32_t j = 0; j < 4; j++) {
+        c[j] = dot1_s8_scalar(a, b + j * k, k);
+    }
+}
+
+static float dot1_f16_scalar(const uint16_t* a, const uint16_t* b, uint32_t k) {
+    float sum = 0.0f;
+    for (uint32_t p = 0; p < k; p++) {
+        sum += ai_cpu_half_to_float(a[p]) * ai_cpu_half_to_float(b[p]);
+    }
+    return sum;
+}
+
+static void dot4_f16_scalar(const uint16_t* a, const uint16_t* b, uint32_t k, float* c) {
+    for (uint32_t j = 0; j < 4; j++) {
+        c[j] = dot1_f16_scalar(a, b + j * k, k);
+    }
+}
+
+// ── x86: SSE4.1 and AVX2 ────────────────────────────────────────────────────
+
+#ifdef AI_CPU_X86
+typedef int8_t  v16qi_t __attribute__((vector_size(16)));
+typedef int8_t  v8qi_t  __attribute__((vector_size(8)));
+typedef int16_t v8hi_t  __attribute__((vector_size(16)));
+typedef int32_t v4si_t  __attribute__((vector_size(16)));
+typedef int16_t v16hi_t __attribute__((vector_size(32)));
+typedef int32_t v8si_t  __attribute__((vector_size(32)));
+typedef float   v8sf_t  __attribute__((vector_size(32)));
+
+// Unaligned loads
+typedef int8_t  v16qi_u_t __attribute__((vector_size(16), aligned(1), may_alias));
+typedef int16_t v8hi_u_t  __attribute__((vector_size(16), aligned(1), may_alias));
+
+#define load_s8x16(p) ((v16qi_t)*(const v16qi_u_t*)(p))
+#define load_f16x8(p) ((v8hi_t)*(const v8hi_u_t*)(p))
+
+static uint64_t read_xcr0(void) {
+    uint32_t lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static ai_cpu_isa_t detect_x86(void) {
+    unsigned int eax, ebx, ecx, edx;
+    ai_cpu_isa_t isa = AI_CPU_ISA_SCALAR;
+    
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return isa;
+    }
+    if (ecx & bit_SSE4_1) {
+        isa = AI_CPU_ISA_SSE41;
+    }
+    
+    // AVX state must also be enabled in XCR0 by whoever owns the CPU
+    const unsigned int avx_bits = bit_OSXSAVE | bit_AVX | bit_FMA | bit_F16C;
+    if ((ecx & avx_bits) != avx_bits || (read_xcr0() & 0x6) != 0x6) {
+        return isa;
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2)) {
+        isa = AI_CPU_ISA_AVX2;
+    }
+    return isa;
+}
+
+// Remainders are loaded zero-padded into a full vector rather than finished
+// by the scalar code: mixing legacy SSE and VEX code with dirty upper YMM
+// halves costs a state transition on every call.
+TARGET_SSE41 static inline v16qi_t load_s8_tail(const int8_t* p, uint32_t count) {
+    v16qi_t v = {0};
+    for (uint32_t i = 0; i < count; i++) {
+        v[i] = p[i];
+    }
+    return v;
+}
+
+TARGET_SSE41 static inline v8hi_t load_f16_tail(const uint16_t* p, uint32_t count) {
+    v8hi_t v = {0};
+    for (uint32_t i = 0; i < count; i++) {
+        v[i] = (int16_t)p[i];
+    }
+    return v;
+}
+
+// Sign-extend 16 int8 lanes and multiply-add adjacent pairs into 4 int32
+TARGET_SSE41 static inline v8hi_t widen_lo_sse41(v16qi_t v) {
+    return __builtin_convertvector(__builtin_shufflevector(v, v, 0, 1, 2, 3, 4, 5, 6, 7), v8hi_t);
+}
+
+TARGET_SSE41 static inline v8hi_t widen_hi_sse41(v16qi_t v) {
+    return __builtin_convertvector(__builtin_shufflevector(v, v, 8, 9, 10, 11, 12, 13, 14, 15), v8hi_t);
+}
+
+TARGET_SSE41 static int32_t dot1_s8_sse41(const int8_t* a, const int8_t* b, uint32_t k) {
+    v4si_t acc = {0, 0, 0, 0};
+    uint32_t p = 0;
+    
+    for (; p < k; p += 16) {
+        v16qi_t va = (k - p >= 16) ? load_s8x16(a + p) : load_s8_tail(a + p, k - p);
+        v16qi_t vb = (k - p >= 16) ? load_s8x16(b + p) : load_s8_tail(b + p, k - p);
+        acc += __builtin_ia32_pmaddwd128(widen_lo_sse41(va), widen_lo_sse41(vb));
+        acc += __builtin_ia32_pmaddwd128(widen_hi_sse41(va), widen_hi_sse41(vb));
+    }
+    
+    return acc[0] + acc[1] + acc[2] + acc[3];
+}
+
+TARGET_SSE41 static void dot4_s8_sse41(const int8_t* a, const int8_t* b, uint32_t k, int32_t* c) {
+    v4si_t acc[4] = {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}};
+    uint32_t p = 0;
+    
+    for (; p < k; p += 16) {
+        bool full = (k - p >= 16);
+        v16qi_t va = full ? load_s8x16(a + p) : load_s8_tail(a + p, k - p);
+        v8hi_t a_lo = widen_lo_sse41(va);
+        v8hi_t a_hi = widen_hi_sse41(va);
+        for (uint32_t j = 0; j < 4; j++) {
+            v16qi_t vb = full ? load_s8x16(b + j * k + p) : load_s8_tail(b + j * k + p, k - p);
+            acc[j] += __builtin_ia32_pmaddwd128(a_lo, widen_lo_sse41(vb));
+            acc[j] += __builtin_ia32_pmaddwd128(a_hi, widen_hi_sse41(vb));
+        }
+    }
+    
+    for (uint32_t j = 0; j < 4; j++) {
+        c[j] = acc[j][0] + acc[j][1] + acc[j][2] + acc[j][3];
+    }
+}
+
+TARGET_AVX2 static inline int32_t hsum_avx2(v8si_t v) {
+    return v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+}
+
+TARGET_AVX2 static inline float hsum_f32_avx2(v8sf_t v) {
+    return ((v[0] + v[4]) + (v[1] + v[5])) + ((v[2] + v[6]) + (v[3] + v[7]));
+}
+
+TARGET_AVX2 static int32_t dot1_s8_avx2(const int8_t* a, const int8_t* b, uint32_t k) {
+    v8si_t acc = {0, 0, 0, 0, 0, 0, 0, 0};
+    uint32_t p = 0;
+    
+    for (; p + 16 <= k; p += 16) {
+        v16hi_t va = __builtin_convertvector(load_s8x16(a + p), v16hi_t);
+        v16hi_t vb = __builtin_convertvector(load_s8x16(b + p), v16hi_t);
+        acc += __builtin_ia32_pmaddwd256(va, vb);
+    }
+    if (p < k) {
+        v16hi_t va = __builtin_convertvector(load_s8_tail(a + p, k - p), v16hi_t);
+        v16hi_t vb = __builtin_convertvector(load_s8_tail(b + p, k - p), v16hi_t);
+        acc += __builtin_ia32_pmaddwd256(va, vb);
+    }
+    
+    return hsum_avx2(acc);
+}
+
+TARGET_AVX2 static void dot4_s8_avx2(const int8_t* a, const int8_t* b, uint32_t k, int32_t* c) {
+    v8si_t acc0 = {0, 0, 0, 0, 0, 0, 0, 0};
+    v8si_t acc1 = acc0, acc2 = acc0, acc3 = acc0;
+    const int8_t* b0 = b;
+    const int8_t* b1 = b + k;
+    const int8_t* b2 = b + 2 * k;
+    const int8_t* b3 = b + 3 * k;
+    uint32_t p = 0;
+    
+    for (; p + 16 <= k; p += 16) {
+        v16hi_t va = __builtin_convertvector(load_s8x16(a + p), v16hi_t);
+        acc0 += __builtin_ia32_pmaddwd256(va, __builtin_convertvector(load_s8x16(b0 + p), v16hi_t));
+        acc1 += __builtin_ia32_pmaddwd256(va, __builtin_convertvector(load_s8x16(b1 + p), v16hi_t));
+        acc2 += __builtin_ia32_pmaddwd256(va, __builtin_convertvector(load_s8x16(b2 + p), v16hi_t));
+        acc3 += __builtin_ia32_pmaddwd256(va, __builtin_convertvector(load_s8x16(b3 + p), v16hi_t));
+    }
+    
+    if (p < k) {
+        uint32_t n = k - p;
+        v16hi_t va = __builtin_convertvector(load_s8_tail(a + p, n), v16hi_t);
+        acc0 += __builtin_ia32_pmaddwd256(va, __builtin_convertvector(load_s8_tail(b0 + p, n), v16hi_t));
+        acc1 += __builtin_ia32_pmaddwd256(va, __builtin_convertvector(load_s8_tail(b1 + p, n), v16hi_t));
+        acc2 += __builtin_ia32_pmaddwd256(va, __builtin_convertvector(load_s8_tail(b2 + p, n), v16hi_t));
+        acc3 += __builtin_ia32_pmaddwd256(va, __builtin_convertvector(load_s8_tail(b3 + p, n), v16hi_t));
+    }
+    
+    c[0] = hsum_avx2(acc0);
+    c[1] = hsum_avx2(acc1);
+    c[2] = hsum_avx2(acc2);
+    c[3] = hsum_avx2(acc3);
+}
+
+// F16C widens 8 halves per instruction; products accumulate with FMA
+TARGET_AVX2 static float dot1_f16_avx2(const uint16_t* a, const uint16_t* b, uint32_t k) {
+    v8sf_t acc = {0, 0, 0, 0, 0, 0, 0, 0};
+    uint32_t p = 0;
+    
+    for (; p < k; p += 8) {
+        v8hi_t va = (k - p >= 8) ? load_f16x8(a + p) : load_f16_tail(a + p, k - p);
+        v8hi_t vb = (k - p >= 8) ? load_f16x8(b + p) : load_f16_tail(b + p, k - p);
+        acc = __builtin_ia32_vfmaddps256(__builtin_ia32_vcvtph2ps256(va), __builtin_ia32_vcvtph2ps256(vb), acc);
+    }
+    
+    return hsum_f32_avx2(acc);
+}
+
+TARGET_AVX2 static void dot4_f16_avx2(const uint16_t* a, const uint16_t* b, uint32_t k, float* c) {
+    v8sf_t acc0 = {0, 0, 0, 0, 0, 0, 0, 0};
+    v8sf_t acc1 = acc0, acc2 = acc0, acc3 = acc0;
+    const uint16_t* b0 = b;
+    const uint16_t* b1 = b + k;
+    const uint16_t* b2 = b + 2 * k;
+    const uint16_t* b3 = b + 3 * k;
+    uint32_t p = 0;
+    
+    for (; p + 8 <= k; p += 8) {
+        v8sf_t va = __builtin_ia32_vcvtph2ps256(load_f16x8(a + p));
+        acc0 = __builtin_ia32_vfmaddps256(va, __builtin_ia32_vcvtph2ps256(load_f16x8(b0 + p)), acc0);
+        acc1 = __builtin_ia32_vfmaddps256(va, __builtin_ia32_vcvtph2ps256(load_f16x8(b1 + p)), acc1);
+        acc2 = __builtin_ia32_vfmaddps256(va, __builtin_ia32_vcvtph2ps256(load_f16x8(b2 + p)), acc2);
+        acc3 = __builtin_ia32_vfmaddps256(va, __builtin_ia32_vcvtph2ps256(load_f16x8(b3 + p)), acc3);
+    }
+    
+    if (p < k) {
+        uint32_t n = k - p;
+        v8sf_t va = __builtin_ia32_vcvtph2ps256(load_f16_tail(a + p, n));
+        acc0 = __builtin_ia32_vfmaddps256(va, __builtin_ia32_vcvtph2ps256(load_f16_tail(b0 + p, n)), acc0);
+        acc1 = __builtin_ia32_vfmaddps256(va, __builtin_ia32_vcvtph2ps256(load_f16_tail(b1 + p, n)), acc1);
+        acc2 = __builtin_ia32_vfmaddps256(va, __builtin_ia32_vcvtph2ps256(load_f16_tail(b2 + p, n)), acc2);
+        acc3 = __builtin_ia32_vfmaddps256(va, __builtin_ia32_vcvtph2ps256(load_f16_tail(b3 + p, n)), acc3);
+    }
+    
+    c[0] = hsum_f32_avx2(acc0);
+    c[1] = hsum_f32_avx2(acc1);
+    c[2] = hsum_f32_avx2(acc2);
+    c[3] = hsum_f32_avx2(acc3);
+}
+#endif // AI_CPU_X86
+
+// ── aarch64: NEON ───────────────────────────────────────────────────────────
+
+#ifdef AI_CPU_NEON
+// Two int8 products summed in int16 stay in range because weights are
+// limited to [-127, 127]
+static inline int32x4_t madd_s8_neon(int32x4_t acc, int8x16_t a, int8x16_t b) {
+    int16x8_t prod = vmull_s8(vget_low_s8(a), vget_low_s8(b));
+    prod = vmlal_high_s8(prod, a, b);
+    return vpadalq_s16(acc, prod);
+}
+
+static int32_t dot1_s8_neon(const int8_t* a, const int8_t* b, uint32_t k) {
+    int32x4_t acc = vdupq_n_s32(0);
+    uint32_t p = 0;
+    
+    for (; p + 16 <= k; p += 16) {
+        acc = madd_s8_neon(acc, vld1q_s8(a + p), vld1q_s8(b + p));
+    }
+    
+    return vaddvq_s32(acc) + dot1_s8_scalar(a + p, b + p, k - p);
+}
+
+static void dot4_s8_neon(const int8_t* a, const int8_t* b, uint32_t k, int32_t* c) {
+    int32x4_t acc0 = vdupq_n_s32(0);
+    int32x4_t acc1 = acc0, acc2 = acc0, acc3 = acc0;
+    const int8_t* b0 = b;
+    const int8_t* b1 = b + k;
+    const int8_t* b2 = b + 2 * k;
+    const int8_t* b3 = b + 3 * k;
+    uint32_t p = 0;
+    
+    for (; p + 16 <= k; p += 16) {
+        int8x16_t va = vld1q_s8(a + p);
+        acc0 = madd_s8_neon(acc0, va, vld1q_s8(b0 + p));
+        acc1 = madd_s8_neon(acc1, va, vld1q_s8(b1 + p));
+        acc2 = madd_s8_neon(acc2, va, vld1q_s8(b2 + p));
+        acc3 = madd_s8_neon(acc3, va, vld1q_s8(b3 + p));
+    }
+    
+    c[0] = vaddvq_s32(acc0) + dot1_s8_scalar(a + p, b0 + p, k - p);
+    c[1] = vaddvq_s32(acc1) + dot1_s8_scalar(a + p, b1 + p, k - p);
+    c[2] = vaddvq_s32(acc2) + dot1_s8_scalar(a + p, b2 + p, k - p);
+    c[3] = vaddvq_s32(acc3) + dot1_s8_scalar(a + p, b3 + p, k - p);
+}
+
+static inline float32x4_t load_f16x4_neon(const uint16_t* p) {
+    return vcvt_f32_f16(vld1_f16((const float16_t*)p));
+}
+
+static float dot1_f16_neon(const uint16_t* a, const uint16_t* b, uint32_t k) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    uint32_t p = 0;
+    
+    for (; p + 4 <= k; p += 4) {
+        acc = vfmaq_f32(acc, load_f16x4_neon(a + p), load_f16x4_neon(b + p));
+    }
+    
+    return vaddvq_f32(acc) + dot1_f16_scalar(a + p, b + p, k - p);
+}
+
+static void dot4_f16_neon(const uint16_t* a, const uint16_t* b, uint32_t k, float* c) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = acc0, acc2 = acc0, acc3 = acc0;
+    const uint16_t* b0 = b;
+    const uint16_t* b1 = b + k;
+    const uint16_t* b2 = b + 2 * k;
+    const uint16_t* b3 = b + 3 * k;
+    uint32_t p = 0;
+    
+    for (; p + 4 <= k; p += 4) {
+        float32x4_t va = load_f16x4_neon(a + p);
+        acc0 = vfmaq_f32(acc0, va, load_f16x4_neon(b0 + p));
+        acc1 = vfmaq_f32(acc1, va, load_f16x4_neon(b1 + p));
+        acc2 = vfmaq_f32(acc2, va, load_f16x4_neon(b2 + p));
+        acc3 = vfmaq_f32(acc3, va, load_f16x4_neon(b3 + p));
+    }
+    
+    c[0] = vaddvq_f32(acc0) + dot1_f16_scalar(a + p, b0 + p, k - p);
+    c[1] = vaddvq_f32(acc1) + dot1_f16_scalar(a + p, b1 + p, k - p);
+    c[2] = vaddvq_f32(acc2) + dot1_f16_scalar(a + p, b2 + p, k - p);
+    c[3] = vaddvq_f32(acc3) + dot1_f16_scalar(a + p, b3 + p, k - p);
+}
+#endif // AI_CPU_NEON
+
+// ── Instruction set selection ───────────────────────────────────────────────
+
+ai_cpu_isa_t ai_cpu_detect_isa(void) {
+    if (detected_isa < 0) {
+#if defined(AI_CPU_X86)
+        detected_isa = detect_x86();
+#elif defined(AI_CPU_NEON)
+        detected_isa = AI_CPU_ISA_NEON;
+#else
+        detected_isa = AI_CPU_ISA_SCALAR;
+#endif
+    }
+    return (ai_cpu_isa_t)detected_isa;
+}
+
+ai_cpu_isa_t ai_cpu_set_isa(ai_cpu_isa_t isa) {
+    ai_cpu_isa_t best = ai_cpu_detect_isa();
+    
+    // NEON and the x86 sets never coexist, so either the request is
+    // available or it lowers to the best set there is
+    if (isa == AI_CPU_ISA_SCALAR || (isa != AI_CPU_ISA_NEON && best != AI_CPU_ISA_NEON && isa <= best)) {
+        active_isa = isa;
+    } else {
+        active_isa = best;
+    }
+    return active_isa;
+}
+
+ai_cpu_isa_t ai_cpu_get_isa(void) {
+    return active_isa;
+}
+
+const char* ai_cpu_isa_name(ai_cpu_isa_t isa) {
+    switch (isa) {
+        case AI_CPU_ISA_SSE41: return "sse4.1";
+        case AI_CPU_ISA_AVX2:  return "avx2";
+        case AI_CPU_ISA_NEON:  return "neon";
+        default:               return "scalar";
+    }
+}
+
+// ── Half precision ──────────────────────────────────────────────────────────
+
+float ai_cpu_half_to_float(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t bits;
+    float value;
+    
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Subnormal half: normalize into a float exponent
+        exponent = 113;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+    }
+    
+    __builtin_memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint16_t ai_cpu_float_to_half(float value) {
+    uint32_t bits;
+    __builtin_memcpy(&bits, &value, sizeof(bits));
+    
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t biased = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    int32_t exponent = (int32_t)biased - 112;
+    
+    if (biased == 0xFF) {
+        return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    }
+    if (exponent >= 31) {
+        return (uint16_t)(sign | 0x7C00);
+    }
+    
+    uint32_t shift = 13;
+    if (exponent <= 0) {
+        // Subnormal half, or zero once shifted out entirely
+        if (exponent < -10) {
+            return (uint16_t)sign;
+        }
+        mantissa |= 0x800000;
+        shift = (uint32_t)(14 - exponent);
+        exponent = 0;
+    }
+    
+    uint32_t half = ((uint32_t)exponent << 10) + (mantissa >> shift);
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    
+    // A carry out of the mantissa correctly bumps the exponent
+    if (rest > halfway || (rest == halfway && (half & 1))) {
+        half++;
+    }
+    return (uint16_t)(sign | half);
+}
+
+// ── GEMM ────────────────────────────────────────────────────────────────────
+
+// Column blocks of B small enough to stay cached while every row of A
+// passes over them
+static uint32_t gemm_block(uint32_t k, uint32_t element_size) {
+    uint32_t block = AI_CPU_GEMM_BLOCK_BYTES / (k * element_size);
+    block &= ~3u;
+    return (block < 4) ? 4 : block;
+}
+
+void ai_cpu_gemm_s8(const int8_t* a, const int8_t* b, int32_t* c, uint32_t m, uint32_t n, uint32_t k) {
+    dot4_s8_func_t dot4 = dot4_s8_scalar;
+    dot1_s8_func_t dot1 = dot1_s8_scalar;
+    
+#if defined(AI_CPU_X86)
+    if (active_isa == AI_CPU_ISA_AVX2) {
+        dot4 = dot4_s8_avx2;
+        dot1 = dot1_s8_avx2;
+    } else if (active_isa == AI_CPU_ISA_SSE41) {
+        dot4 = dot4_s8_sse41;
+        dot1 = dot1_s8_sse41;
+    }
+#elif defined(AI_CPU_NEON)
+    if (active_isa == AI_CPU_ISA_NEON) {
+        dot4 = dot4_s8_neon;
+        dot1 = dot1_s8_neon;
+    }
+#endif
+    
+    if (k == 0) {
+        for (uint32_t i = 0; i < m * n; i++) {
+            c[i] = 0;
+        }
+        return;
+    }
+    
+    uint32_t block = gemm_block(k, sizeof(int8_t));
+    for (uint32_t j0 = 0; j0 < n; j0 += block) {
+        uint32_t j_end = (n - j0 < block) ? n : j0 + block;
+        for (uint32_t i = 0; i < m; i++) {
+            const int8_t* row = a + i * k;
+            int32_t* out = c + i * n;
+            uint32_t j = j0;
+            for (; j + 4 <= j_end; j += 4) {
+                dot4(row, b + j * k, k, out + j);
+            }
+            for (; j < j_end; j++) {
+                out[j] = dot1(row, b + j * k, k);
+            }
+        }
+    }
+}
+
+void ai_cpu_gemm_f16(const uint16_t* a, const uint16_t* b, float* c, uint32_t m, uint32_t n, uint32_t k) {
+    dot4_f16_func_t dot4 = dot4_f16_scalar;
+    dot1_f16_func_t dot1 = dot1_f16_scalar;
+    
+    // SSE4.1 has no half conversion; it uses the scalar path
+#if defined(AI_CPU_X86)
+    if (active_isa == AI_CPU_ISA_AVX2) {
+        dot4 = dot4_f16_avx2;
+        dot1 = dot1_f16_avx2;
+    }
+#elif defined(AI_CPU_NEON)
+    if (active_isa == AI_CPU_ISA_NEON) {
+        dot4 = dot4_f16_neon;
+        dot1 = dot1_f16_neon;
+    }
+#endif
+    
+    if (k == 0) {
+        for (uint32_t i = 0; i < m * n; i++) {
+            c[i] = 0.0f;
+        }
+        return;
+    }
+    
+    uint32_t block = gemm_block(k, sizeof(uint16_t));
+    for (uint32_t j0 = 0; j0 < n; j0 += block) {
+        uint32_t j_end = (n - j0 < block) ? n : j0 + block;
+        for (uint32_t i = 0; i < m; i++) {
+            const uint16_t* row = a + i * k;
+            float* out = c + i * n;
+            uint32_t j = j0;
+            for (; j + 4 <= j_end; j += 4) {
+                dot4(row, b + j * k, k, out + j);
+            }
+            for (; j < j_end; j++) {
+                out[j] = dot1(row, b + j * k, k);
+            }
+        }
+    }
+}
+
+// ── Requantization ──────────────────────────────────────────────────────────
+
+// (a * b * 2) >> 32 with rounding, saturating the single overflow case
+static int32_t rounding_doubling_high_mul(int32_t a, int32_t b) {
+    if (a == b && a == INT32_MIN) {
+        return INT32_MAX;
+    }
+    int64_t product = (int64_t)a * b;
+    int64_t nudged = product + ((product >= 0) ? (1 << 30) : (1 - (1 << 30)));
+    
+    // Divide by 2^31 rounding toward zero, without a 64-bit division
+    return (int32_t)((nudged >= 0) ? (nudged >> 31) : -((-nudged) >> 31));
+}
+
+// x / 2^exponent, rounding half away from zero
+static int32_t rounding_divide_by_pot(int32_t x, int32_t exponent) {
+    int32_t mask = (int32_t)((1u << exponent) - 1);
+    int32_t remainder = x & mask;
+    int32_t threshold = (mask >> 1) + ((x < 0) ? 1 : 0);
+    return (x >> exponent) + ((remainder > threshold) ? 1 : 0);
+}
+
+static inline int8_t requantize_one(int32_t acc, const ai_cpu_requant_t* quant) {
+    int32_t left = (quant->shift > 0) ? quant->shift : 0;
+    int32_t right = (quant->shift > 0) ? 0 : -quant->shift;
+    
+    int32_t value = (int32_t)((uint32_t)acc << left);
+    value = rounding_divide_by_pot(rounding_doubling_high_mul(value, quant->multiplier), right);
+    value += quant->zero_point;
+    
+    if (value < quant->min) {
+        value = quant->min;
+    }
+    if (value > quant->max) {
+        value = quant->max;
+    }
+    return (int8_t)value;
+}
+
+#ifdef AI_CPU_NEON
+// vqrdmulh is the same saturating rounding doubling high multiply; the
+// fixup turns vrshl's round-half-up into round-half-away-from-zero
+static void requantize_s8_neon(const int32_t* acc, const int32_t* bias, int8_t* out,
+                               uint32_t m, uint32_t n, const ai_cpu_requant_t* quant) {
+    int32_t left = (quant->shift > 0) ? quant->shift : 0;
+    int32_t right = (quant->shift > 0) ? 0 : -quant->shift;
+    int32x4_t left_shift = vdupq_n_s32(left);
+    int32x4_t right_shift = vdupq_n_s32(-right);
+    int32x4_t zero_point = vdupq_n_s32(quant->zero_point);
+    int32x4_t min = vdupq_n_s32(quant->min);
+    int32x4_t max = vdupq_n_s32(quant->max);
+    
+    for (uint32_t i = 0; i < m; i++) {
+        const int32_t* row = acc + i * n;
+        int8_t* dst = out + i * n;
+        uint32_t j = 0;
+        
+        for (; j + 8 <= n; j += 8) {
+            int32x4_t v[2];
+            for (uint32_t h = 0; h < 2; h++) {
+                int32x4_t x = vaddq_s32(vld1q_s32(row + j + 4 * h), vld1q_s32(bias + j + 4 * h));
+                x = vqrdmulhq_n_s32(vshlq_s32(x, left_shift), quant->multiplier);
+                int32x4_t fixup = vshrq_n_s32(vandq_s32(x, right_shift), 31);
+                x = vrshlq_s32(vqaddq_s32(x, fixup), right_shift);
+                v[h] = vminq_s32(vmaxq_s32(vaddq_s32(x, zero_point), min), max);
+            }
+            int16x8_t narrow = vcombine_s16(vqmovn_s32(v[0]), vqmovn_s32(v[1]));
+            vst1_s8(dst + j, vqmovn_s16(narrow));
+        }
+        
+        for (; j < n; j++) {
+            dst[j] = requantize_one(row[j] + bias[j], quant);
+        }
+    }
+}
+#endif
+
+void ai_cpu_requantize_s8(const int32_t* acc, const int32_t* bias, int8_t* out,
+                          uint32_t m, uint32_t n, const ai_cpu_requant_t* quant) {
+#ifdef AI_CPU_NEON
+    if (active_isa == AI_CPU_ISA_NEON) {
+        requantize_s8_neon(acc, bias, out, m, n, quant);
+        return;
+    }
+#endif
+    
+    for (uint32_t i = 0; i < m; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            out[i * n + j] = requantize_one(acc[i * n + j] + bias[j], quant);
+        }
+    }
+}
+
+static inline float clamp_float(float value, float min, float max) {
+    return (value < min) ? min : ((value > max) ? max : value);
+}
+
+void ai_cpu_narrow_f16(const float* acc, const float* bias, uint16_t* out,
+                       uint32_t m, uint32_t n, float min, float max) {
+    for (uint32_t i = 0; i < m; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            out[i * n + j] = ai_cpu_float_to_half(clamp_float(acc[i * n + j] + bias[j], min, max));
+        }
+    }
+}
+
+// ── Windowed operators ──────────────────────────────────────────────────────
+
+// Input coordinates of tap (ky, kx) for output pixel (oy, ox), or false
+// when the tap falls into the padding
+static inline bool window_tap(const ai_cpu_window_t* window, uint32_t oy, uint32_t ox,
+                              uint32_t ky, uint32_t kx, uint32_t* offset) {
+    int32_t iy = (int32_t)(oy * window->stride + ky) - (int32_t)window->pad;
+    int32_t ix = (int32_t)(ox * window->stride + kx) - (int32_t)window->pad;
+    
+    if (iy < 0 || ix < 0 || (uint32_t)iy >= window->in_h || (uint32_t)ix >= window->in_w) {
+        return false;
+    }
+    *offset = ((uint32_t)iy * window->in_w + (uint32_t)ix) * window->channels;
+    return true;
+}
+
+void ai_cpu_im2col_s8(const int8_t* in, const ai_cpu_window_t* window, uint32_t first, uint32_t count,
+                      int8_t pad_value, int8_t* rows) {
+    uint32_t channels = window->channels;
+    
+    for (uint32_t r = 0; r < count; r++) {
+        uint32_t oy = (first + r) / window->out_w;
+        uint32_t ox = (first + r) % window->out_w;
+        for (uint32_t ky = 0; ky < window->kernel_h; ky++) {
+            for (uint32_t kx = 0; kx < window->kernel_w; kx++) {
+                uint32_t offset;
+                if (window_tap(window, oy, ox, ky, kx, &offset)) {
+                    for (uint32_t c = 0; c < channels; c++) {
+                        rows[c] = in[offset + c];
+                    }
+                } else {
+                    for (uint32_t c = 0; c < channels; c++) {
+                        rows[c] = pad_value;
+                    }
+                }
+                rows += channels;
+            }
+        }
+    }
+}
+
+void ai_cpu_im2col_f16(const uint16_t* in, const ai_cpu_window_t* window, uint32_t first, uint32_t count,
+                       uint16_t* rows) {
+    uint32_t channels = window->channels;
+    
+    for (uint32_t r = 0; r < count; r++) {
+        uint32_t oy = (first + r) / window->out_w;
+        uint32_t ox = (first + r) % window->out_w;
+        for (uint32_t ky = 0; ky < window->kernel_h; ky++) {
+            for (uint32_t kx = 0; kx < window->kernel_w; kx++) {
+                uint32_t offset;
+                if (window_tap(window, oy, ox, ky, kx, &offset)) {
+                    for (uint32_t c = 0; c < channels; c++) {
+                        rows[c] = in[offset + c];
+                    }
+                } else {
+                    for (uint32_t c = 0; c < channels; c++) {
+                        rows[c] = 0;
+                    }
+                }
+                rows += channels;
+            }
+        }
+    }
+}
+
+// Depthwise and pooling accumulate a block of channels per output pixel;
+// the per-channel inner loops are contiguous and left to the vectorizer
+#define CHANNEL_BLOCK 16
+
+void ai_cpu_depthwise_s8(const int8_t* in, const ai_cpu_window_t* window, const int8_t* weights,
+                         const int32_t* bias, int8_t pad_value, const ai_cpu_requant_t* quant, int8_t* out) {
+    uint32_t channels = window->channels;
+    int32_t acc[CHANNEL_BLOCK];
+    
+    for (uint32_t oy = 0; oy < window->out_h; oy++) {
+        for (uint32_t ox = 0; ox < window->out_w; ox++) {
+            int8_t* dst = out + (oy * window->out_w + ox) * channels;
+            for (uint32_t c0 = 0; c0 < channels; c0 += CHANNEL_BLOCK) {
+                uint32_t block = (channels - c0 < CHANNEL_BLOCK) ? channels - c0 : CHANNEL_BLOCK;
+                for (uint32_t c = 0; c < block; c++) {
+                    acc[c] = bias[c0 + c];
+                }
+                for (uint32_t ky = 0; ky < window->kernel_h; ky++) {
+                    for (uint32_t kx = 0; kx < window->kernel_w; kx++) {
+                        const int8_t* w = weights + (ky * window->kernel_w + kx) * channels + c0;
+                        uint32_t offset;
+                        if (window_tap(window, oy, ox, ky, kx, &offset)) {
+                            const int8_t* src = in + offset + c0;
+                            for (uint32_t c = 0; c < block; c++) {
+                                acc[c] += src[c] * w[c];
+                            }
+                        } else {
+                            for (uint32_t c = 0; c < block; c++) {
+                                acc[c] += pad_value * w[c];
+                            }
+                        }
+                    }
+                }
+                for (uint32_t c = 0; c < block; c++) {
+                    dst[c0 + c] = requantize_one(acc[c], quant);
+                }
+            }
+        }
+    }
+}
+
+void ai_cpu_depthwise_f16(const uint16_t* in, const ai_cpu_window_t* window, const uint16_t* weights,
+                          const float* bias, float min, float max, uint16_t* out) {
+    uint32_t channels = window->channels;
+    float acc[CHANNEL_BLOCK];
+    
+    for (uint32_t oy = 0; oy < window->out_h; oy++) {
+        for (uint32_t ox = 0; ox < window->out_w; ox++) {
+            uint16_t* dst = out + (oy * window->out_w + ox) * channels;
+            for (uint32_t c0 = 0; c0 < channels; c0 += CHANNEL_BLOCK) {
+                uint32_t block = (channels - c0 < CHANNEL_BLOCK) ? channels - c0 : CHANNEL_BLOCK;
+                for (uint32_t c = 0; c < block; c++) {
+                    acc[c] = bias[c0 + c];
+                }
+                for (uint32_t ky = 0; ky < window->kernel_h; ky++) {
+                    for (uint32_t kx = 0; kx < window->kernel_w; kx++) {
+                        const uint16_t* w = weights + (ky * window->kernel_w + kx) * channels + c0;
+                        uint32_t offset;
+                        if (!window_tap(window, oy, ox, ky, kx, &offset)) {
+                            continue;
+                        }
+                        const uint16_t* src = in + offset + c0;
+                        for (uint32_t c = 0; c < block; c++) {
+                            acc[c] += ai_cpu_half_to_float(src[c]) * ai_cpu_half_to_float(w[c]);
+                        }
+                    }
+                }
+                for (uint32_t c = 0; c < block; c++) {
+                    dst[c0 + c] = ai_cpu_float_to_half(clamp_float(acc[c], min, max));
+                }
+            }
+        }
+    }
+}
+
+void ai_cpu_pool_s8(const int8_t* in, const ai_cpu_window_t* window, int average, int8_t* out) {
+    uint32_t channels = window->channels;
+    int32_t acc[CHANNEL_BLOCK];
+    
+    for (uint32_t oy = 0; oy < window->out_h; oy++) {
+        for (uint32_t ox = 0; ox < window->out_w; ox++) {
+            int8_t* dst = out + (oy * window->out_w + ox) * channels;
+            for (uint32_t c0 = 0; c0 < channels; c0 += CHANNEL_BLOCK) {
+                uint32_t block = (channels - c0 < CHANNEL_BLOCK) ? channels - c0 : CHANNEL_BLOCK;
+                int32_t taps = 0;
+                for (uint32_t c = 0; c < block; c++) {
+                    acc[c] = average ? 0 : -128;
+                }
+                for (uint32_t ky = 0; ky < window->kernel_h; ky++) {
+                    for (uint32_t kx = 0; kx < window->kernel_w; kx++) {
+                        uint32_t offset;
+                        if (!window_tap(window, oy, ox, ky, kx, &offset)) {
+                            continue;
+                        }
+                        const int8_t* src = in + offset + c0;
+                        taps++;
+                        for (uint32_t c = 0; c < block; c++) {
+                            if (average) {
+                                acc[c] += src[c];
+                            } else if (src[c] > acc[c]) {
+                                acc[c] = src[c];
+                            }
+                        }
+                    }
+                }
+                for (uint32_t c = 0; c < block; c++) {
+                    int32_t value = acc[c];
+                    if (average && taps > 0) {
+                        value = (value + ((value > 0) ? taps / 2 : -taps / 2)) / taps;
+                    }
+                    dst[c0 + c] = (int8_t)value;
+                }
+            }
+        }
+    }
+}
+
+void ai_cpu_pool_f16(const uint16_t* in, const ai_cpu_window_t* window, int average, uint16_t* out) {
+    uint32_t channels = window->channels;
+    float acc[CHANNEL_BLOCK];
+    
+    for (uint32_t oy = 0; oy < window->out_h; oy++) {
+        for (uint32_t ox = 0; ox < window->out_w; ox++) {
+            uint16_t* dst = out + (oy * window->out_w + ox) * channels;
+            for (uint32_t c0 = 0; c0 < channels; c0 += CHANNEL_BLOCK) {
+                uint32_t block = (channels - c0 < CHANNEL_BLOCK) ? channels - c0 : CHANNEL_BLOCK;
+                uint32_t taps = 0;
+                for (uint32_t c = 0; c < block; c++) {
+                    acc[c] = average ? 0.0f : -65504.0f;
+                }
+                for (uint32_t ky = 0; ky < window->kernel_h; ky++) {
+                    for (uint32_t kx = 0; kx < window->kernel_w; kx++) {
+                        uint32_t offset;
+                        if (!window_tap(window, oy, ox, ky, kx, &offset)) {
+                            continue;
+                        }
+                        const uint16_t* src = in + offset + c0;
+                        taps++;
+                        for (uint32_t c = 0; c < block; c++) {
+                            float value = ai_cpu_half_to_float(src[c]);
+                            if (average) {
+                                acc[c] += value;
+                            } else if (value > acc[c]) {
+                                acc[c] = value;
+                            }
+                        }
+                    }
+                }
+                for (uint32_t c = 0; c < block; c++) {
+                    float value = (average && taps > 0) ? acc[c] / (float)taps : acc[c];
+                    dst[c0 + c] = ai_cpu_float_to_half(value);
+                }
+            }
+        }
+    }
+}
+
+// ── Elementwise ─────────────────────────────────────────────────────────────
+
+void ai_cpu_scale_shift_f16(const uint16_t* in, uint32_t pixels, uint32_t channels, const float* scale,
+                            const float* shift, float min, float max, uint16_t* out) {
+    for (uint32_t p = 0; p < pixels; p++) {
+        const uint16_t* src = in + p * channels;
+        uint16_t* dst = out + p * channels;
+        for (uint32_t c = 0; c < channels; c++) {
+            float value = ai_cpu_half_to_float(src[c]) * scale[c] + shift[c];
+            value = (value < min) ? min : (value > max) ? max : value;
+            dst[c] = ai_cpu_float_to_half(value);
+        }
+    }
+}
+
+void ai_cpu_clamp_s8(const int8_t* in, uint32_t count, int8_t min, int8_t max, int8_t* out) {
+    for (uint32_t i = 0; i < count; i++) {
+        int8_t value = in[i];
+        out[i] = (value < min) ? min : (value > max) ? max : value;
+    }
+}
+
+void ai_cpu_clamp_f16(const uint16_t* in, uint32_t count, float min, float max, uint16_t* out) {
+    for (uint32_t i = 0; i < count; i++) {
+        float value = ai_cpu_half_to_float(in[i]);
+        value = (value < min) ? min : (value > max) ? max : value;
+        out[i] = ai_cpu_float_to_half(value);
+    }
+}
+
+// ── Softmax ─────────────────────────────────────────────────────────────────
+
+// e^x for x <= 0: 2^(x log2 e) split into an exponent and a degree-5
+// polynomial for the fraction, good to about 1e-7 relative
+static float exp_nonpositive(float x) {
+    if (x < -87.0f) {
+        return 0.0f;
+    }
+    
+    float t = x * 1.44269504f;
+    int32_t n = (int32_t)t;
+    if ((float)n > t) {
+        n--;
+    }
+    float f = t - (float)n;
+    float p = 1.0f + f * (0.69314718f + f * (0.24022651f + f * (0.05550411f +
+              f * (0.00961813f + f * 0.00133336f))));
+    
+    uint32_t bits = (uint32_t)(n + 127) << 23;
+    float scale;
+    __builtin_memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+void ai_cpu_softmax_s8(const int8_t* in, uint32_t rows, uint32_t n, float in_scale, int8_t* out) {
+    for (uint32_t r = 0; r < rows; r++) {
+        const int8_t* src = in + r * n;
+        int8_t* dst = out + r * n;
+        int32_t max = -128;
+        float sum = 0.0f;
+        
+        for (uint32_t i = 0; i < n; i++) {
+            if (src[i] > max) {
+                max = src[i];
+            }
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            sum += exp_nonpositive((float)(src[i] - max) * in_scale);
+        }
+        
+        float scale = 256.0f / sum;
+        for (uint32_t i = 0; i < n; i++) {
+            int32_t value = (int32_t)(exp_nonpositive((float)(src[i] - max) * in_scale) * scale + 0.5f) - 128;
+            dst[i] = (int8_t)((value > 127) ? 127 : value);
+        }
+    }
+}
+
+void ai_cpu_softmax_f16(const uint16_t* in, uint32_t rows, uint32_t n, uint16_t* out) {
+    for (uint32_t r = 0; r < rows; r++) {
+        const uint16_t* src = in + r * n;
+        uint16_t* dst = out + r * n;
+        float max = -65504.0f;
+        float sum = 0.0f;
+        
+        for (uint32_t i = 0; i < n; i++) {
+            float value = ai_cpu_half_to_float(src[i]);
+            if (value > max) {
+                max = value;
+            }
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            sum += exp_nonpositive(ai_cpu_half_to_float(src[i]) - max);
+        }
+        
+        float scale = 1.0f / sum;
+        for (uint32_t i = 0; i < n; i++) {
+            dst[i] = ai_cpu_float_to_half(exp_nonpositive(ai_cpu_half_to_float(src[i]) - max) * scale);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — CPU Inference Kernels
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef AI_CPU_KERNELS_H
+#define AI_CPU_KERNELS_H
+
+#include "../types.h"
+
+// Columns of B kept hot in cache while a GEMM sweeps the rows of A
+#define AI_CPU_GEMM_BLOCK_BYTES (16 * 1024)
+
+// Instruction set used by the GEMM and requantization kernels
+typedef enum {
+    AI_CPU_ISA_SCALAR = 0,
+    AI_CPU_ISA_SSE41 = 1,
+    AI_CPU_ISA_AVX2 = 2,    // Also requires FMA and F16C
+    AI_CPU_ISA_NEON = 3
+} ai_cpu_isa_t;
+
+// Output requantization of an int8 layer (gemmlowp/TFLite scheme):
+// out = clamp(zero_point + (acc * multiplier / 2^31) * 2^shift, min, max)
+typedef struct {
+    int32_t multiplier;     // Q31, in [2^30, 2^31)
+    int32_t shift;          // Positive shifts left
+    int32_t zero_point;
+    int32_t min;            // Clamp in the output domain, encodes the activation
+    int32_t max;
+} ai_cpu_requant_t;
+
+// Sliding window over an HWC tensor (convolution, depthwise, pooling).
+// pad is applied at the top and left; the bottom and right take whatever
+// the output size needs.
+typedef struct {
+    uint32_t in_h, in_w, channels;
+    uint32_t out_h, out_w;
+    uint32_t kernel_h, kernel_w;
+    uint32_t stride;
+    uint32_t pad;
+} ai_cpu_window_t;
+
+// Best instruction set the CPU supports with its SIMD state enabled
+ai_cpu_isa_t ai_cpu_detect_isa(void);
+
+// Select the kernels to run. Requests beyond what the CPU supports are
+// lowered to the best supported set, which is returned.
+ai_cpu_isa_t ai_cpu_set_isa(ai_cpu_isa_t isa);
+ai_cpu_isa_t ai_cpu_get_isa(void);
+const char* ai_cpu_isa_name(ai_cpu_isa_t isa);
+
+// IEEE half precision conversion (round to nearest even)
+float ai_cpu_half_to_float(uint16_t half);
+uint16_t ai_cpu_float_to_half(float value);
+
+// c[i * n + j] = dot(a[i * k ...], b[j * k ...]) for i < m, j < n.
+// Both operands are row-major with the reduction dimension contiguous:
+// A holds one input patch per row, B one output channel per row. Int8
+// weights must be symmetric, in [-127, 127].
+void ai_cpu_gemm_s8(const int8_t* a, const int8_t* b, int32_t* c, uint32_t m, uint32_t n, uint32_t k);
+void ai_cpu_gemm_f16(const uint16_t* a, const uint16_t* b, float* c, uint32_t m, uint32_t n, uint32_t k);
+
+// Add the per-column bias to an m x n accumulator block and narrow it
+void ai_cpu_requantize_s8(const int32_t* acc, const int32_t* bias, int8_t* out,
+                          uint32_t m, uint32_t n, const ai_cpu_requant_t* quant);
+void ai_cpu_narrow_f16(const float* acc, const float* bias, uint16_t* out,
+                       uint32_t m, uint32_t n, float min, float max);
+
+// Unfold output pixels [first, first + count) into rows of
+// kernel_h * kernel_w * channels elements; taps outside the input read pad_value
+void ai_cpu_im2col_s8(const int8_t* in, const ai_cpu_window_t* window, uint32_t first, uint32_t count,
+                      int8_t pad_value, int8_t* rows);
+void ai_cpu_im2col_f16(const uint16_t* in, const ai_cpu_window_t* window, uint32_t first, uint32_t count,
+                       uint16_t* rows);
+
+// Depthwise convolution, weights laid out [kernel_h][kernel_w][channels]
+void ai_cpu_depthwise_s8(const int8_t* in, const ai_cpu_window_t* window, const int8_t* weights,
+                         const int32_t* bias, int8_t pad_value, const ai_cpu_requant_t* quant, int8_t* out);
+void ai_cpu_depthwise_f16(const uint16_t* in, const ai_cpu_window_t* window, const uint16_t* weights,
+                          const float* bias, float min, float max, uint16_t* out);
+
+// Max or average pooling; padded taps are left out of both
+void ai_cpu_pool_s8(const int8_t* in, const ai_cpu_window_t* window, int average, int8_t* out);
+void ai_cpu_pool_f16(const uint16_t* in, const ai_cpu_window_t* window, int average, uint16_t* out);
+
+// Per-channel out = clamp(in * scale + shift, min, max), and plain clamps:
+// the unfused forms of batch norm and activation layers
+void ai_cpu_scale_shift_f16(const uint16_t* in, uint32_t pixels, uint32_t channels, const float* scale,
+                            const float* shift, float min, float max, uint16_t* out);
+void ai_cpu_clamp_s8(const int8_t* in, uint32_t count, int8_t min, int8_t max, int8_t* out);
+void ai_cpu_clamp_f16(const uint16_t* in, uint32_t count, float min, float max, uint16_t* out);
+
+// Softmax over each row of n values. The int8 version takes the input
+// scale (times beta) and produces TFLite's fixed output quantization,
+// scale 1/256 and zero point -128.
+void ai_cpu_softmax_s8(const int8_t* in, uint32_t rows, uint32_t n, float in_scale, int8_t* out);
+void ai_cpu_softmax_f16(const uint16_t* in, uint32_t rows, uint32_t n, uint16_t* out);
+
+#endif // AI_CPU_KERNELS_H
@@ -0,0 +1,182 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI HAT+ Power Governor
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "ai_governor.h"
+#include "../stdio.h"
+#include "../timer.h"
+#include <stdbool.h>
+
+static ai_governor_state_t state;
+static ai_hat_power_mode_t manual_mode;
+static uint32_t thermal_batch;          // Batch limit the temperature allows
+static uint32_t settle;                 // Samples until thermal_max may move again
+static uint64_t last_sample;
+static bool sampled = false;
+static bool reading = false;            // Telemetry read queued by ai_governor_poll
+
+// Highest draw seen in each mode, decaying by 1/64 per sample so a mode
+// that once broke the energy cap is tried again every few seconds
+static uint32_t mode_power[AI_HAT_POWER_MAX + 1];
+
+void ai_governor_init(ai_hat_power_mode_t mode) {
+    memset(&state, 0, sizeof(state));
+    memset(mode_power, 0, sizeof(mode_power));
+    state.policy = AI_POWER_POLICY_MANUAL;
+    state.mode = mode;
+    state.thermal_max = AI_HAT_POWER_MAX;
+    state.batch_limit = AI_HAT_MAX_BATCH;
+    manual_mode = mode;
+    thermal_batch = AI_HAT_MAX_BATCH;
+    settle = 0;
+    sampled = false;
+    reading = false;
+}
+
+int ai_governor_set_policy(ai_power_policy_t policy, uint32_t energy_cap_mw, ai_hat_power_mode_t mode) {
+    if (policy > AI_POWER_POLICY_ENERGY_CAP || mode > AI_HAT_POWER_MAX ||
+        (policy == AI_POWER_POLICY_ENERGY_CAP && energy_cap_mw == 0)) {
+        return AI_GOVERNOR_ERROR_PARAM;
+    }
+    
+    // A manual mode has already been applied by ai_subsystem_set_power_mode
+    state.policy = policy;
+    state.energy_cap_mw = energy_cap_mw;
+    manual_mode = mode;
+    if (policy == AI_POWER_POLICY_MANUAL) {
+        state.mode = mode;
+    }
+    ai_governor_sample();
+    return 0;
+}
+
+// Mode the energy cap allows: one step down while over the cap, one step
+// up when well under it and the next mode has not been seen to break it
+static ai_hat_power_mode_t energy_cap_mode(void) {
+    uint32_t cap = state.energy_cap_mw;
+    ai_hat_power_mode_t mode = (state.mode == AI_HAT_POWER_OFF) ? AI_HAT_POWER_LOW : state.mode;
+    
+    if (state.power > cap && mode > AI_HAT_POWER_LOW) {
+        return mode - 1;
+    }
+    if ((uint64_t)state.power * 100 < (uint64_t)cap * AI_GOVERNOR_CAP_HEADROOM && mode < AI_HAT_POWER_MAX &&
+        mode_power[mode + 1] <= cap) {
+        return mode + 1;
+    }
+    return mode;
+}
+
+static void apply_sample(const ai_hat_telemetry_t* telemetry) {
+    uint32_t temperature = telemetry->temperature;
+    uint32_t power = telemetry->power;
+    
+    state.samples++;
+    state.temperature = temperature;
+    state.power = power;
+    for (int i = 0; i <= AI_HAT_POWER_MAX; i++) {
+        mode_power[i] -= mode_power[i] / 64;
+    }
+    if (power > mode_power[state.mode]) {
+        mode_power[state.mode] = power;
+    }
+    
+    // Above AI_GOVERNOR_BATCH_C the batch limit is halved each sample.
+    // Once it is down to 1 the power mode steps down, at most once per
+    // AI_GOVERNOR_SETTLE samples since the HAT heats and cools slowly, or at
+    // once above AI_GOVERNOR_MODE_C. Limits are lifted in the opposite order.
+    uint32_t cool = AI_GOVERNOR_BATCH_C - AI_GOVERNOR_HYSTERESIS_C;
+    bool hot = temperature >= AI_GOVERNOR_MODE_C ||
+               (temperature >= AI_GOVERNOR_BATCH_C && thermal_batch == 1 && settle == 0);
+    if (settle > 0) {
+        settle--;
+    }
+    if (temperature >= AI_GOVERNOR_BATCH_C && thermal_batch > 1) {
+        thermal_batch /= 2;
+        state.batch_throttles++;
+    } else if (hot && state.mode > AI_HAT_POWER_LOW && state.thermal_max >= state.mode) {
+        state.thermal_max = state.mode - 1;
+        settle = AI_GOVERNOR_SETTLE;
+    } else if (temperature < cool && thermal_batch < AI_HAT_MAX_BATCH) {
+        thermal_batch = (thermal_batch * 2 < AI_HAT_MAX_BATCH) ? thermal_batch * 2 : AI_HAT_MAX_BATCH;
+    } else if (temperature < cool && state.thermal_max < AI_HAT_POWER_MAX && settle == 0) {
+        state.thermal_max++;
+        settle = AI_GOVERNOR_SETTLE;
+    }
+    
+    ai_hat_power_mode_t target;
+    uint32_t batch = AI_HAT_MAX_BATCH;
+    switch (state.policy) {
+        case AI_POWER_POLICY_THROUGHPUT:
+            target = AI_HAT_POWER_MAX;
+            break;
+        case AI_POWER_POLICY_LATENCY:
+            target = AI_HAT_POWER_MAX;
+            batch = 1;
+            break;
+        case AI_POWER_POLICY_ENERGY_CAP:
+            target = energy_cap_mode();
+            break;
+        default:
+            target = manual_mode;
+            break;
+    }
+    
+    if (target > state.thermal_max) {
+        target = state.thermal_max;
+    }
+    state.batch_limit = (batch < thermal_batch) ? batch : thermal_batch;
+    
+    if (target != state.mode && ai_hat_set_power_mode(target) == AI_HAT_SUCCESS) {
+        state.mode = target;
+        state.mode_changes++;
+    }
+}
+
+void ai_governor_poll(void) {
+    ai_hat_telemetry_t telemetry;
+    uint64_t now = timer_ticks();
+    
+    // One poll queues the telemetry read and a later one applies it, so
+    // the dispatch paths never wait on the I2C bus
+    if (reading) {
+        ai_hat_status_t status = ai_hat_telemetry_poll(&telemetry);
+        if (status == AI_HAT_PENDING) {
+            return;
+        }
+        reading = false;
+        if (status == AI_HAT_SUCCESS) {
+            apply_sample(&telemetry);
+        }
+        return;
+    }
+    
+    if (!sampled || timer_ticks_to_ns(now - last_sample) >= (uint64_t)AI_GOVERNOR_PERIOD_US * 1000) {
+        last_sample = now;
+        sampled = true;
+        reading = (ai_hat_telemetry_start() == AI_HAT_SUCCESS);
+    }
+}
+
+void ai_governor_sample(void) {
+    ai_hat_telemetry_t telemetry;
+    
+    // A read queued by ai_governor_poll is finished and superseded
+    last_sample = timer_ticks();
+    sampled = true;
+    reading = false;
+    if (ai_hat_get_telemetry(&telemetry) != AI_HAT_SUCCESS) {
+        return;     // No HAT; keep the last decision
+    }
+    
+    apply_sample(&telemetry);
+}
+
+uint32_t ai_governor_batch_limit(void) {
+    return state.batch_limit;
+}
+
+void ai_governor_get_state(ai_governor_state_t* out) {
+    *out = state;
+}
@@ -0,0 +1,68 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI HAT+ Power Governor
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef AI_GOVERNOR_H
+#define AI_GOVERNOR_H
+
+#include "../types.h"
+#include "../../drivers/ai_hat/ai_hat.h"
+
+#define AI_GOVERNOR_PERIOD_US      100000  // Telemetry sampling interval
+#define AI_GOVERNOR_DEVICE_LIMIT_C 85      // The HAT throttles itself from here
+#define AI_GOVERNOR_BATCH_C        75      // Batch size halved per sample from here
+#define AI_GOVERNOR_MODE_C         80      // Power mode stepped down per sample from here
+#define AI_GOVERNOR_HYSTERESIS_C   5       // Limits are lifted again this far below
+#define AI_GOVERNOR_SETTLE         10      // Samples between power mode limit changes
+#define AI_GOVERNOR_CAP_HEADROOM   85      // Percent of the energy cap below which a faster mode is tried
+
+// Error codes
+#define AI_GOVERNOR_ERROR_PARAM    -1
+
+// How the governor picks the HAT power mode
+typedef enum {
+    AI_POWER_POLICY_MANUAL = 0,      // Mode set with ai_subsystem_set_power_mode
+    AI_POWER_POLICY_THROUGHPUT = 1,  // Fastest mode, full batches
+    AI_POWER_POLICY_LATENCY = 2,     // Fastest mode, every request dispatched on its own
+    AI_POWER_POLICY_ENERGY_CAP = 3   // Fastest mode whose measured draw stays under the cap
+} ai_power_policy_t;
+
+typedef struct {
+    ai_power_policy_t policy;
+    uint32_t energy_cap_mw;
+    ai_hat_power_mode_t mode;        // Current HAT power mode
+    ai_hat_power_mode_t thermal_max; // Fastest mode the temperature allows
+    uint32_t batch_limit;            // Most requests per HAT batch
+    uint32_t temperature;            // Last sample, Celsius
+    uint32_t power;                  // Last sample, mW
+    uint32_t samples;
+    uint32_t mode_changes;
+    uint32_t batch_throttles;        // Samples that lowered the batch limit
+} ai_governor_state_t;
+
+// Every policy keeps the HAT below AI_GOVERNOR_DEVICE_LIMIT_C: first by
+// halving the batch limit, then by stepping the power mode down, and lifts
+// the limits again once it has cooled.
+
+// Start in manual mode at the HAT's current power mode
+void ai_governor_init(ai_hat_power_mode_t mode);
+
+// Change policy. manual_mode is used by AI_POWER_POLICY_MANUAL and
+// energy_cap_mw by AI_POWER_POLICY_ENERGY_CAP. Takes a sample at once.
+int ai_governor_set_policy(ai_power_policy_t policy, uint32_t energy_cap_mw, ai_hat_power_mode_t manual_mode);
+
+// Sample telemetry if AI_GOVERNOR_PERIOD_US has passed since the last
+// sample, without waiting: the read is queued on the I2C bus and applied
+// by a later call once it has completed. Called from the AI subsystem's
+// dispatch paths.
+void ai_governor_poll(void);
+
+// Sample telemetry and apply the policy now
+void ai_governor_sample(void);
+
+uint32_t ai_governor_batch_limit(void);
+void ai_governor_get_state(ai_governor_state_t* state);
+
+#endif // AI_GOVERNOR_H
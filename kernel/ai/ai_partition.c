@@ -0,0 +1,435 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI Model Partitioner
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "ai_partition.h"
+#include "ai_residency.h"
+#include "../../drivers/ai_hat/ai_hat.h"
+#include "../stdio.h"
+#include "../timer.h"
+#include <stdbool.h>
+
+#define SCRATCH_ALIGN 16
+#define NO_COST       0xFFFFFFFFFFFFFFFFull   // Kernel the device cannot run
+
+typedef struct {
+    bool used;
+    ai_partition_info_t info;
+    int handles[AI_PARTITION_MAX_SEGMENTS];         // CPU engine or residency handle of each segment
+    uint32_t buffers[AI_PARTITION_MAX_SEGMENTS][2]; // Scratch offsets of each segment's output, by frame parity
+} split_model_t;
+
+static split_model_t models[AI_PARTITION_MAX_MODELS];
+static uint8_t scratch[AI_PARTITION_SCRATCH_SIZE] __attribute__((aligned(SCRATCH_ALIGN)));
+static ai_cpu_op_profile_t ops[AI_CPU_MAX_LAYERS];
+
+static uint32_t align_scratch(uint32_t size) {
+    return (size + SCRATCH_ALIGN - 1) & ~(uint32_t)(SCRATCH_ALIGN - 1);
+}
+
+static bool hat_supports(ai_cpu_op_t op) {
+    switch (op) {
+        case AI_CPU_OP_CONV2D:
+        case AI_CPU_OP_DEPTHWISE:
+        case AI_CPU_OP_FULLY_CONNECTED:
+        case AI_CPU_OP_MAX_POOL:
+        case AI_CPU_OP_AVG_POOL:
+        case AI_CPU_OP_BATCH_NORM:
+        case AI_CPU_OP_ACTIVATION:
+        case AI_CPU_OP_RESHAPE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Time to move a tensor over the HAT link, in ns
+static uint64_t link_ns(uint32_t bytes, uint32_t bus_clock) {
+    return bus_clock ? timer_div64((uint64_t)bytes * 8 * 1000000000ull, bus_clock) : 0;
+}
+
+void ai_partition_init(void) {
+    memset(models, 0, sizeof(models));
+}
+
+int ai_partition_plan(const void* data, uint32_t size, ai_partition_info_t* plan) {
+    static uint64_t cpu_ns[AI_CPU_MAX_LAYERS];
+    static uint64_t hat_ns[AI_CPU_MAX_LAYERS];
+    static uint32_t tensor_bytes[AI_CPU_MAX_LAYERS + 1];    // Entering each kernel, then the output
+    static uint64_t cost[2][AI_CPU_MAX_LAYERS];             // Best latency up to a kernel, by its device
+    static uint8_t from[2][AI_CPU_MAX_LAYERS];              // Device of the kernel before in that solution
+    static uint8_t device[AI_CPU_MAX_LAYERS];
+    
+    if (plan == NULL) {
+        return AI_PARTITION_ERROR_PARAM;
+    }
+    if (!ai_cpu_probe(data, size)) {
+        return AI_PARTITION_ERROR_FORMAT;
+    }
+    memset(plan, 0, sizeof(*plan));
+    
+    // Compile the whole model for its kernels and time them with one run
+    int handle = ai_cpu_load_model(data, size, &plan->model);
+    if (handle < 0) {
+        return (handle == AI_CPU_ERROR_MEMORY) ? AI_PARTITION_ERROR_MEMORY : AI_PARTITION_ERROR_FORMAT;
+    }
+    uint32_t input_space = align_scratch(plan->model.input_bytes);
+    if (input_space + plan->model.output_bytes <= AI_PARTITION_SCRATCH_SIZE) {
+        memset(scratch, 0, plan->model.input_bytes);
+        plan->timed = (ai_cpu_run(handle, scratch, scratch + input_space) == 0);
+    }
+    uint32_t count = 0;
+    ai_cpu_get_profile(handle, ops, AI_CPU_MAX_LAYERS, &count);
+    ai_cpu_unload_model(handle);
+    
+    // Without a HAT every kernel stays on the CPU
+    ai_hat_info_t hat;
+    ai_hat_stream_stats_t link;
+    memset(&hat, 0, sizeof(hat));
+    memset(&link, 0, sizeof(link));
+    ai_hat_get_info(&hat);
+    ai_hat_get_stream_stats(&link);
+    uint64_t hat_macs_per_us = (uint64_t)hat.max_tops * 5000 * AI_PARTITION_HAT_EFFICIENCY;
+    
+    uint32_t element = (plan->model.dtype == AI_CPU_DTYPE_INT8) ? 1 : 2;
+    tensor_bytes[0] = plan->model.input_bytes;
+    for (uint32_t k = 0; k < count; k++) {
+        cpu_ns[k] = plan->timed ? timer_ticks_to_ns(ops[k].ticks)
+                                : timer_div64(ops[k].macs * 1000, AI_PARTITION_CPU_MACS_PER_US);
+        hat_ns[k] = (hat_macs_per_us > 0 && hat_supports(ops[k].op)) ? timer_div64(ops[k].macs * 1000, hat_macs_per_us)
+                                                                      : NO_COST;
+        tensor_bytes[k + 1] = ops[k].out_dims[0] * ops[k].out_dims[1] * ops[k].out_dims[2] * element;
+    }
+    
+    // Lowest total latency with each kernel on either device. Entering a
+    // HAT segment costs a call and the upload of its input, leaving one
+    // the download of its output; the model input and output are on the CPU.
+    uint64_t call_ns = (uint64_t)AI_PARTITION_HAT_CALL_US * 1000;
+    for (uint32_t k = 0; k < count; k++) {
+        for (int d = AI_PARTITION_CPU; d <= AI_PARTITION_HAT; d++) {
+            uint64_t run = (d == AI_PARTITION_CPU) ? cpu_ns[k] : hat_ns[k];
+            cost[d][k] = NO_COST;
+            if (run == NO_COST) {
+                continue;
+            }
+            for (int prev = AI_PARTITION_CPU; prev <= AI_PARTITION_HAT; prev++) {
+                uint64_t before = (k == 0) ? ((prev == AI_PARTITION_CPU) ? 0 : NO_COST) : cost[prev][k - 1];
+                if (before == NO_COST) {
+                    continue;
+                }
+                uint64_t total = before + run;
+                if (prev != d) {
+                    total += link_ns(tensor_bytes[k], link.bus_clock) + ((d == AI_PARTITION_HAT) ? call_ns : 0);
+                }
+                if (total < cost[d][k]) {
+                    cost[d][k] = total;
+                    from[d][k] = (uint8_t)prev;
+                }
+            }
+        }
+    }
+    
+    uint64_t end_hat = cost[AI_PARTITION_HAT][count - 1];
+    if (end_hat != NO_COST) {
+        end_hat += link_ns(tensor_bytes[count], link.bus_clock);
+    }
+    int d = (end_hat < cost[AI_PARTITION_CPU][count - 1]) ? AI_PARTITION_HAT : AI_PARTITION_CPU;
+    for (uint32_t k = count; k-- > 0;) {
+        device[k] = (uint8_t)d;
+        d = from[d][k];
+    }
+    
+    // Group runs of kernels into segments; a model cut into more than the
+    // table holds stays on the CPU whole
+    uint32_t segments = 1;
+    for (uint32_t k = 1; k < count; k++) {
+        segments += (device[k] != device[k - 1]) ? 1 : 0;
+    }
+    if (segments > AI_PARTITION_MAX_SEGMENTS) {
+        memset(device, AI_PARTITION_CPU, count);
+    }
+    
+    uint64_t cpu_total = 0, split_total = 0;
+    uint32_t layer = 0;
+    ai_partition_segment_t* segment = NULL;
+    for (uint32_t k = 0; k < count; k++) {
+        if (segment == NULL || device[k] != segment->device) {
+            segment = &plan->segment[plan->segments++];
+            segment->device = (ai_partition_device_t)device[k];
+            segment->first_op = k;
+            segment->first_layer = layer;
+            segment->input_bytes = tensor_bytes[k];
+        }
+        segment->ops++;
+        segment->layers += 1 + ops[k].fused;
+        segment->macs += ops[k].macs;
+        segment->output_bytes = tensor_bytes[k + 1];
+        layer += 1 + ops[k].fused;
+        cpu_total += cpu_ns[k];
+    }
+    
+    for (uint32_t s = 0; s < plan->segments; s++) {
+        segment = &plan->segment[s];
+        uint64_t ns = 0;
+        for (uint32_t k = segment->first_op; k < segment->first_op + segment->ops; k++) {
+            ns += (segment->device == AI_PARTITION_CPU) ? cpu_ns[k] : hat_ns[k];
+        }
+        if (segment->device == AI_PARTITION_HAT) {
+            ns += call_ns + link_ns(segment->input_bytes, link.bus_clock) +
+                  link_ns(segment->output_bytes, link.bus_clock);
+        }
+        segment->estimate_us = (uint32_t)timer_div64(ns, 1000);
+        split_total += ns;
+    }
+    plan->cpu_only_us = (uint32_t)timer_div64(cpu_total, 1000);
+    plan->split_us = (uint32_t)timer_div64(split_total, 1000);
+    
+    return 0;
+}
+
+// Unload the first count segments of a model
+static void release_segments(split_model_t* model, uint32_t count) {
+    for (uint32_t s = 0; s < count; s++) {
+        if (model->info.segment[s].device == AI_PARTITION_CPU) {
+            ai_cpu_unload_model(model->handles[s]);
+        } else {
+            ai_residency_remove(model->handles[s]);
+        }
+    }
+}
+
+int ai_partition_load(const void* data, uint32_t size, const ai_partition_info_t* plan) {
+    split_model_t* model = NULL;
+    int handle = -1;
+    
+    if (plan == NULL || plan->segments == 0 || plan->segments > AI_PARTITION_MAX_SEGMENTS) {
+        return AI_PARTITION_ERROR_PARAM;
+    }
+    
+    for (int i = 0; i < AI_PARTITION_MAX_MODELS; i++) {
+        if (!models[i].used) {
+            handle = i;
+            model = &models[i];
+            break;
+        }
+    }
+    if (model == NULL) {
+        return AI_PARTITION_ERROR_LIMIT;
+    }
+    
+    // Two buffers per cut, so a segment can write the next frame's tensor
+    // while the following segment still reads the previous one
+    memset(model, 0, sizeof(*model));
+    model->info = *plan;
+    uint32_t offset = 0;
+    for (uint32_t s = 0; s + 1 < plan->segments; s++) {
+        uint32_t bytes = align_scratch(plan->segment[s].output_bytes);
+        if (bytes > (AI_PARTITION_SCRATCH_SIZE - offset) / 2) {
+            return AI_PARTITION_ERROR_MEMORY;
+        }
+        model->buffers[s][0] = offset;
+        model->buffers[s][1] = offset + bytes;
+        offset += 2 * bytes;
+    }
+    
+    // Each segment is cut out into the scratch area, which the loaders copy
+    ai_hat_precision_t precision = (plan->model.dtype == AI_CPU_DTYPE_INT8) ? AI_HAT_PRECISION_INT8
+                                                                            : AI_HAT_PRECISION_FP16;
+    for (uint32_t s = 0; s < plan->segments; s++) {
+        const ai_partition_segment_t* segment = &plan->segment[s];
+        int length = ai_cpu_slice_model(data, size, segment->first_layer, segment->layers, scratch,
+                                        AI_PARTITION_SCRATCH_SIZE);
+        int result;
+        if (length < 0) {
+            result = (length == AI_CPU_ERROR_MEMORY) ? AI_PARTITION_ERROR_MEMORY : AI_PARTITION_ERROR_FORMAT;
+        } else if (segment->device == AI_PARTITION_CPU) {
+            result = ai_cpu_load_model(scratch, (uint32_t)length, NULL);
+            if (result < 0) {
+                result = (result == AI_CPU_ERROR_MEMORY) ? AI_PARTITION_ERROR_MEMORY : AI_PARTITION_ERROR_FORMAT;
+            }
+        } else {
+            result = ai_residency_add(scratch, (uint32_t)length, precision,
+                                      segment->input_bytes + segment->output_bytes);
+            if (result < 0) {
+                result = (result == AI_RESIDENCY_ERROR_FULL) ? AI_PARTITION_ERROR_MEMORY : AI_PARTITION_ERROR_LOAD;
+            }
+        }
+        if (result < 0) {
+            release_segments(model, s);
+            return result;
+        }
+        model->handles[s] = result;
+    }
+    
+    model->used = true;
+    return handle;
+}
+
+int ai_partition_unload(int handle) {
+    if (handle < 0 || handle >= AI_PARTITION_MAX_MODELS || !models[handle].used) {
+        return AI_PARTITION_ERROR_PARAM;
+    }
+    
+    release_segments(&models[handle], models[handle].info.segments);
+    models[handle].used = false;
+    return 0;
+}
+
+// Segment s reads the model input or the previous segment's output, and
+// writes the model output or its own buffer for the frame
+static const void* segment_input(const split_model_t* model, uint32_t s, uint32_t frame, const void* const* inputs) {
+    return (s == 0) ? inputs[frame] : scratch + model->buffers[s - 1][frame & 1];
+}
+
+static void* segment_output(const split_model_t* model, uint32_t s, uint32_t frame, void* const* outputs) {
+    return (s + 1 == model->info.segments) ? outputs[frame] : scratch + model->buffers[s][frame & 1];
+}
+
+static int run_hat_segment(split_model_t* model, uint32_t s, uint32_t frame, const void* const* inputs,
+                           void* const* outputs) {
+    ai_partition_segment_t* segment = &model->info.segment[s];
+    uint64_t start = timer_ticks();
+    uint32_t hat_id;
+    
+    if (ai_residency_acquire_wait(model->handles[s], &hat_id) != 0 ||
+        ai_hat_run_inference(hat_id, segment_input(model, s, frame, inputs), segment->input_bytes,
+                             segment_output(model, s, frame, outputs), segment->output_bytes) != AI_HAT_SUCCESS) {
+        return AI_PARTITION_ERROR_INFERENCE;
+    }
+    segment->busy_ticks += timer_ticks() - start;
+    segment->frames++;
+    return 0;
+}
+
+// Run every segment that has a frame in this step; segment s works on
+// frame step - s. The last HAT segment of the step is started first and
+// collected after the CPU segments, so the two overlap. Models with more
+// HAT segments run the others on their own beforehand.
+static int run_step(split_model_t* model, uint32_t step, const void* const* inputs, void* const* outputs,
+                    uint32_t count) {
+    int overlap = -1;
+    int result = 0;
+    
+    for (uint32_t s = 0; s < model->info.segments && s <= step; s++) {
+        if (step - s >= count || model->info.segment[s].device != AI_PARTITION_HAT) {
+            continue;
+        }
+        if (overlap >= 0 && run_hat_segment(model, (uint32_t)overlap, step - overlap, inputs, outputs) != 0) {
+            return AI_PARTITION_ERROR_INFERENCE;
+        }
+        overlap = (int)s;
+    }
+    
+    uint64_t hat_start = timer_ticks();
+    if (overlap >= 0) {
+        const ai_partition_segment_t* segment = &model->info.segment[overlap];
+        uint32_t hat_id;
+        if (ai_residency_acquire_wait(model->handles[overlap], &hat_id) != 0 ||
+            ai_hat_inference_start(hat_id, segment_input(model, overlap, step - overlap, inputs),
+                                   segment->input_bytes, segment->output_bytes) != AI_HAT_SUCCESS) {
+            return AI_PARTITION_ERROR_INFERENCE;
+        }
+    }
+    
+    for (uint32_t s = 0; s < model->info.segments && s <= step && result == 0; s++) {
+        ai_partition_segment_t* segment = &model->info.segment[s];
+        if (step - s >= count || segment->device != AI_PARTITION_CPU) {
+            continue;
+        }
+        uint64_t start = timer_ticks();
+        if (ai_cpu_run(model->handles[s], segment_input(model, s, step - s, inputs),
+                       segment_output(model, s, step - s, outputs)) != 0) {
+            result = AI_PARTITION_ERROR_INFERENCE;
+        }
+        segment->busy_ticks += timer_ticks() - start;
+        segment->frames++;
+    }
+    
+    // Collect the HAT even after a CPU failure, so it is free again
+    if (overlap >= 0) {
+        ai_partition_segment_t* segment = &model->info.segment[overlap];
+        if (ai_hat_inference_finish(segment_output(model, overlap, step - overlap, outputs)) != AI_HAT_SUCCESS) {
+            result = AI_PARTITION_ERROR_INFERENCE;
+        }
+        segment->busy_ticks += timer_ticks() - hat_start;
+        segment->frames++;
+    }
+    
+    return result;
+}
+
+int ai_partition_prepare(int handle) {
+    uint32_t hat_id;
+    
+    if (handle < 0 || handle >= AI_PARTITION_MAX_MODELS || !models[handle].used) {
+        return AI_PARTITION_ERROR_PARAM;
+    }
+    
+    const split_model_t* model = &models[handle];
+    for (uint32_t s = 0; s < model->info.segments; s++) {
+        if (model->info.segment[s].device != AI_PARTITION_HAT) {
+            continue;
+        }
+        int result = ai_residency_acquire(model->handles[s], &hat_id);
+        if (result == AI_RESIDENCY_PENDING) {
+            // Segments that do not fit on the HAT together evict each
+            // other; the run then waits for each one in turn
+            for (uint32_t t = 0; t < s; t++) {
+                if (model->info.segment[t].device == AI_PARTITION_HAT && !ai_residency_resident(model->handles[t])) {
+                    return 0;
+                }
+            }
+            return AI_PARTITION_PENDING;
+        }
+        if (result != 0) {
+            return AI_PARTITION_ERROR_LOAD;
+        }
+    }
+    return 0;
+}
+
+int ai_partition_run(int handle, const void* const* inputs, void* const* outputs, uint32_t count) {
+    if (handle < 0 || handle >= AI_PARTITION_MAX_MODELS || !models[handle].used || inputs == NULL ||
+        outputs == NULL || count == 0) {
+        return AI_PARTITION_ERROR_PARAM;
+    }
+    
+    split_model_t* model = &models[handle];
+    uint64_t start = timer_ticks();
+    int result = 0;
+    
+    // Frame f enters segment s at step f + s, so the pipeline drains after
+    // count + segments - 1 steps
+    for (uint32_t step = 0; step + 1 < count + model->info.segments && result == 0; step++) {
+        result = run_step(model, step, inputs, outputs, count);
+    }
+    
+    model->info.ticks += timer_ticks() - start;
+    model->info.frames += count;
+    return result;
+}
+
+int ai_partition_get_info(int handle, ai_partition_info_t* info) {
+    if (handle < 0 || handle >= AI_PARTITION_MAX_MODELS || !models[handle].used || info == NULL) {
+        return AI_PARTITION_ERROR_PARAM;
+    }
+    *info = models[handle].info;
+    return 0;
+}
+
+int ai_partition_reset_stats(int handle) {
+    if (handle < 0 || handle >= AI_PARTITION_MAX_MODELS || !models[handle].used) {
+        return AI_PARTITION_ERROR_PARAM;
+    }
+    
+    ai_partition_info_t* info = &models[handle].info;
+    info->frames = 0;
+    info->ticks = 0;
+    for (uint32_t s = 0; s < info->segments; s++) {
+        info->segment[s].frames = 0;
+        info->segment[s].busy_ticks = 0;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI Model Partitioner
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef AI_PARTITION_H
+#define AI_PARTITION_H
+
+#include "../types.h"
+#include "ai_cpu.h"
+
+#define AI_PARTITION_MAX_MODELS      4
+#define AI_PARTITION_MAX_SEGMENTS    8
+#define AI_PARTITION_SCRATCH_SIZE    (512 * 1024)  // Segment blobs while loading, tensors between segments while running
+#define AI_PARTITION_HAT_CALL_US     500           // Fixed cost of one HAT segment: framing, launch, status polling
+#define AI_PARTITION_HAT_EFFICIENCY  25            // Percent of the HAT's peak TOPS a segment sustains
+#define AI_PARTITION_CPU_MACS_PER_US 200           // CPU estimate when the model cannot be timed at load
+
+// Error codes
+#define AI_PARTITION_PENDING         1    // A HAT segment is being uploaded again
+#define AI_PARTITION_ERROR_PARAM     -1
+#define AI_PARTITION_ERROR_FORMAT    -2   // Not a CPU-format model, or malformed
+#define AI_PARTITION_ERROR_MEMORY    -3   // CPU arena, scratch or device memory too small
+#define AI_PARTITION_ERROR_LIMIT     -4   // Too many split models or segments
+#define AI_PARTITION_ERROR_LOAD      -5   // The HAT did not accept a segment
+#define AI_PARTITION_ERROR_INFERENCE -6
+
+typedef enum {
+    AI_PARTITION_CPU = 0,
+    AI_PARTITION_HAT = 1
+} ai_partition_device_t;
+
+// A run of consecutive kernels on one device
+typedef struct {
+    ai_partition_device_t device;
+    uint32_t first_op;          // Kernels of the fused model, as in ai_cpu_get_profile
+    uint32_t ops;
+    uint32_t first_layer;       // Layers of the model blob
+    uint32_t layers;
+    uint64_t macs;
+    uint32_t input_bytes;       // Tensor entering the segment
+    uint32_t output_bytes;
+    uint32_t estimate_us;       // Cost model per frame, transfers to and from the HAT included
+    uint32_t frames;
+    uint64_t busy_ticks;        // Time spent on this segment's frames
+} ai_partition_segment_t;
+
+typedef struct {
+    ai_cpu_model_info_t model;  // The whole model, fused
+    uint32_t timed;             // CPU costs measured by a run at load rather than estimated
+    uint32_t cpu_only_us;       // Cost model: every kernel on the CPU
+    uint32_t split_us;          // Cost model: these segments one after another
+    uint32_t frames;
+    uint64_t ticks;             // Wall time of all runs
+    uint32_t segments;
+    ai_partition_segment_t segment[AI_PARTITION_MAX_SEGMENTS];
+} ai_partition_info_t;
+
+// The HAT runs convolutions, fully connected layers, pooling and the
+// layers fused into them; softmax stays on the CPU. Each kernel goes where
+// the model's total latency is lowest, counting CPU time (measured with one
+// run at load), HAT time from its TOPS rating plus AI_PARTITION_HAT_CALL_US
+// per segment, and moving tensors over the HAT link at its bus clock.
+
+// Forget every split model
+void ai_partition_init(void);
+
+// Split a CPU-format model without loading it. Fails only for malformed
+// models; a single segment means one device is best for all of it.
+int ai_partition_plan(const void* data, uint32_t size, ai_partition_info_t* plan);
+
+// Load the segments of a plan: CPU segments onto the CPU engine, HAT
+// segments through the residency manager. Returns a handle, or a negative
+// error code. The blob is copied, so the caller's buffer is free afterwards.
+int ai_partition_load(const void* data, uint32_t size, const ai_partition_info_t* plan);
+int ai_partition_unload(int handle);
+
+// Start bringing evicted HAT segments back onto the HAT. Returns
+// AI_PARTITION_PENDING until all of them are there, so a run does not
+// stop mid-pipeline to wait for an upload.
+int ai_partition_prepare(int handle);
+
+// Run count frames. Frames are pipelined across segments: while the HAT
+// computes one frame's segment, CPU segments of other frames run. A HAT
+// segment evicted by another one is waited for.
+int ai_partition_run(int handle, const void* const* inputs, void* const* outputs, uint32_t count);
+
+// The plan with utilization counters; busy_ticks / ticks is the share of
+// wall time a segment kept its device busy. HAT segments count from input
+// upload to output read, so a result left waiting on the HAT counts as busy.
+int ai_partition_get_info(int handle, ai_partition_info_t* info);
+int ai_partition_reset_stats(int handle);
+
+#endif // AI_PARTITION_H
@@ -0,0 +1,432 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Tensor Arena Planner
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "ai_planner.h"
+#include "../stdio.h"
+#include <stdbool.h>
+
+#define UNUSED_STEP     0xFFFFFFFFu
+#define MAX_TENSOR_SIZE 0x40000000u     // Keeps offsets and sums within 32 bits
+
+// TFLite schema field indices
+#define MODEL_SUBGRAPHS     2
+#define MODEL_BUFFERS       4
+#define SUBGRAPH_TENSORS    0
+#define SUBGRAPH_INPUTS     1
+#define SUBGRAPH_OUTPUTS    2
+#define SUBGRAPH_OPERATORS  3
+#define TENSOR_SHAPE        0
+#define TENSOR_TYPE         1
+#define TENSOR_BUFFER       2
+#define TENSOR_IS_VARIABLE  5
+#define OPERATOR_INPUTS     1
+#define OPERATOR_OUTPUTS    2
+#define BUFFER_DATA         0
+#define BUFFER_SIZE         2           // Weights stored past the flatbuffer
+
+// Sort scratch for ai_planner_plan, and the tensors of the model being read
+static uint16_t order[AI_PLANNER_MAX_TENSORS];
+static uint16_t placed[AI_PLANNER_MAX_TENSORS];
+static ai_plan_tensor_t graph_tensors[AI_PLANNER_MAX_TENSORS];
+static bool graph_constant[AI_PLANNER_MAX_TENSORS];
+
+static uint32_t align_up(uint32_t value) {
+    return (value + AI_PLANNER_ALIGN - 1) & ~(uint32_t)(AI_PLANNER_ALIGN - 1);
+}
+
+int ai_planner_plan(ai_plan_tensor_t* tensors, uint32_t count, uint32_t* peak) {
+    if ((tensors == NULL && count > 0) || peak == NULL) {
+        return AI_PLANNER_ERROR_PARAM;
+    }
+    if (count > AI_PLANNER_MAX_TENSORS) {
+        return AI_PLANNER_ERROR_LIMIT;
+    }
+    
+    // Largest first; equal sizes in order of first use
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t j = i;
+        while (j > 0) {
+            const ai_plan_tensor_t* prev = &tensors[order[j - 1]];
+            if (prev->size > tensors[i].size ||
+                (prev->size == tensors[i].size && prev->first_use <= tensors[i].first_use)) {
+                break;
+            }
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint16_t)i;
+    }
+    
+    // placed[] stays sorted by offset, so the first gap that fits between
+    // lifetime-overlapping neighbours is also the lowest one
+    *peak = 0;
+    for (uint32_t n = 0; n < count; n++) {
+        ai_plan_tensor_t* tensor = &tensors[order[n]];
+        uint32_t offset = 0;
+        
+        for (uint32_t p = 0; p < n; p++) {
+            const ai_plan_tensor_t* other = &tensors[placed[p]];
+            if (other->last_use < tensor->first_use || other->first_use > tensor->last_use) {
+                continue;
+            }
+            if (other->offset >= offset + tensor->size) {
+                break;
+            }
+            if (align_up(other->offset + other->size) > offset) {
+                offset = align_up(other->offset + other->size);
+            }
+        }
+        tensor->offset = offset;
+        
+        uint32_t p = n;
+        while (p > 0 && tensors[placed[p - 1]].offset > offset) {
+            placed[p] = placed[p - 1];
+            p--;
+        }
+        placed[p] = order[n];
+        
+        if (offset + tensor->size > *peak) {
+            *peak = offset + tensor->size;
+        }
+    }
+    
+    return 0;
+}
+
+// ── FlatBuffer reading ──────────────────────────────────────────────────────
+// Every access is bounds checked against the blob; any failure reports the
+// model as malformed. Multi-byte values are little endian.
+
+typedef struct {
+    const uint8_t* data;
+    uint32_t size;
+} flatbuffer_t;
+
+static bool fb_u32(const flatbuffer_t* fb, uint32_t pos, uint32_t* value) {
+    if (fb->size < 4 || pos > fb->size - 4) {
+        return false;
+    }
+    const uint8_t* p = fb->data + pos;
+    *value = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    return true;
+}
+
+static bool fb_u16(const flatbuffer_t* fb, uint32_t pos, uint16_t* value) {
+    if (fb->size < 2 || pos > fb->size - 2) {
+        return false;
+    }
+    *value = fb->data[pos] | (fb->data[pos + 1] << 8);
+    return true;
+}
+
+// Follow the unsigned offset stored at pos
+static bool fb_deref(const flatbuffer_t* fb, uint32_t pos, uint32_t* target) {
+    uint32_t relative;
+    if (!fb_u32(fb, pos, &relative) || relative >= fb->size - pos) {
+        return false;
+    }
+    *target = pos + relative;
+    return true;
+}
+
+// Position of a table field, or 0 if the field is absent (default value)
+static bool fb_field(const flatbuffer_t* fb, uint32_t table, uint32_t field, uint32_t* pos) {
+    uint32_t back;
+    uint16_t vtable_size, offset;
+    
+    if (!fb_u32(fb, table, &back)) {
+        return false;
+    }
+    uint32_t vtable = table - back;       // Signed offset, either direction
+    if (!fb_u16(fb, vtable, &vtable_size)) {
+        return false;
+    }
+    
+    *pos = 0;
+    if (4 + field * 2 + 2 > vtable_size) {
+        return true;
+    }
+    if (!fb_u16(fb, vtable + 4 + field * 2, &offset)) {
+        return false;
+    }
+    if (offset != 0) {
+        *pos = table + offset;
+        if (*pos >= fb->size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Vector field: position of the first element and the element count.
+// Absent vectors read as empty.
+static bool fb_vector(const flatbuffer_t* fb, uint32_t table, uint32_t field, uint32_t element_size,
+                      uint32_t* start, uint32_t* length) {
+    uint32_t pos, vector;
+    
+    *length = 0;
+    *start = 0;
+    if (!fb_field(fb, table, field, &pos)) {
+        return false;
+    }
+    if (pos == 0) {
+        return true;
+    }
+    if (!fb_deref(fb, pos, &vector) || !fb_u32(fb, vector, length)) {
+        return false;
+    }
+    *start = vector + 4;
+    return *length <= (fb->size - *start) / element_size;
+}
+
+// Element i of a vector of tables
+static bool fb_table_at(const flatbuffer_t* fb, uint32_t start, uint32_t i, uint32_t* table) {
+    return fb_deref(fb, start + i * 4, table);
+}
+
+static bool fb_scalar_u32(const flatbuffer_t* fb, uint32_t table, uint32_t field, uint32_t* value) {
+    uint32_t pos;
+    *value = 0;
+    return fb_field(fb, table, field, &pos) && (pos == 0 || fb_u32(fb, pos, value));
+}
+
+static bool fb_scalar_u8(const flatbuffer_t* fb, uint32_t table, uint32_t field, uint8_t* value) {
+    uint32_t pos;
+    *value = 0;
+    if (!fb_field(fb, table, field, &pos)) {
+        return false;
+    }
+    if (pos != 0) {
+        *value = fb->data[pos];
+    }
+    return true;
+}
+
+// ── TFLite graph ────────────────────────────────────────────────────────────
+
+int ai_planner_is_tflite(const void* data, uint32_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    return data != NULL && size >= 8 &&
+           bytes[4] == 'T' && bytes[5] == 'F' && bytes[6] == 'L' && bytes[7] == '3';
+}
+
+static uint32_t element_size(uint8_t type) {
+    switch (type) {
+        case AI_PLAN_TYPE_FLOAT32:
+        case AI_PLAN_TYPE_INT32:
+            return 4;
+        case AI_PLAN_TYPE_FLOAT16:
+        case AI_PLAN_TYPE_INT16:
+            return 2;
+        case AI_PLAN_TYPE_UINT8:
+        case AI_PLAN_TYPE_BOOL:
+        case AI_PLAN_TYPE_INT8:
+            return 1;
+        case AI_PLAN_TYPE_INT64:
+            return 8;
+        default:
+            return 0;               // Strings and exotic types have no static size
+    }
+}
+
+// Size of one tensor, and its shape right-aligned into dims
+static int read_tensor(const flatbuffer_t* fb, uint32_t tensor, uint32_t* size, uint8_t* type,
+                       uint32_t dims[4]) {
+    uint32_t shape, rank;
+    uint64_t elements = 1;
+    
+    if (!fb_vector(fb, tensor, TENSOR_SHAPE, 4, &shape, &rank) || !fb_scalar_u8(fb, tensor, TENSOR_TYPE, type)) {
+        return AI_PLANNER_ERROR_FORMAT;
+    }
+    if (element_size(*type) == 0 || rank > 8) {
+        return AI_PLANNER_ERROR_LIMIT;
+    }
+    
+    for (uint32_t d = 0; d < 4; d++) {
+        dims[d] = 1;
+    }
+    for (uint32_t d = 0; d < rank; d++) {
+        uint32_t extent;
+        if (!fb_u32(fb, shape + d * 4, &extent) || extent == 0 || extent > MAX_TENSOR_SIZE) {
+            return AI_PLANNER_ERROR_FORMAT;     // Also catches -1, unresolved dynamic dims
+        }
+        elements *= extent;
+        if (elements > MAX_TENSOR_SIZE) {
+            return AI_PLANNER_ERROR_LIMIT;
+        }
+        if (rank - d <= 4) {
+            dims[4 - (rank - d)] = extent;
+        } else if (extent != 1) {
+            return AI_PLANNER_ERROR_LIMIT;      // Only leading unit dims beyond four
+        }
+    }
+    
+    elements *= element_size(*type);
+    if (elements > MAX_TENSOR_SIZE) {
+        return AI_PLANNER_ERROR_LIMIT;
+    }
+    *size = (uint32_t)elements;
+    return 0;
+}
+
+// Tensors backed by a non-empty buffer are weights, not arena activations
+static bool is_constant(const flatbuffer_t* fb, uint32_t buffers, uint32_t num_buffers, uint32_t index) {
+    uint32_t buffer, data, length, external;
+    
+    if (index == 0 || index >= num_buffers || !fb_table_at(fb, buffers, index, &buffer)) {
+        return false;
+    }
+    if (fb_vector(fb, buffer, BUFFER_DATA, 1, &data, &length) && length > 0) {
+        return true;
+    }
+    return fb_scalar_u32(fb, buffer, BUFFER_SIZE, &external) && external > 0;
+}
+
+// Widen the lifetime of each non-constant tensor listed in an index vector
+static bool mark_uses(const flatbuffer_t* fb, uint32_t start, uint32_t count, uint32_t num_tensors,
+                      uint32_t first, uint32_t last) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t index;
+        if (!fb_u32(fb, start + i * 4, &index)) {
+            return false;
+        }
+        if (index == 0xFFFFFFFFu) {
+            continue;                           // Omitted optional input
+        }
+        if (index >= num_tensors) {
+            return false;
+        }
+        
+        ai_plan_tensor_t* tensor = &graph_tensors[index];
+        if (graph_constant[index]) {
+            continue;
+        }
+        if (tensor->first_use == UNUSED_STEP) {
+            tensor->first_use = first;
+            tensor->last_use = last;
+        } else {
+            if (first < tensor->first_use) {
+                tensor->first_use = first;
+            }
+            if (last > tensor->last_use) {
+                tensor->last_use = last;
+            }
+        }
+    }
+    return true;
+}
+
+int ai_planner_plan_tflite(const void* data, uint32_t size, ai_plan_t* plan) {
+    flatbuffer_t fb = {(const uint8_t*)data, size};
+    uint32_t root, subgraphs, num_subgraphs, subgraph, buffers, num_buffers;
+    uint32_t tensors, num_tensors, inputs, num_inputs, outputs, num_outputs, operators, num_operators;
+    
+    if (plan == NULL) {
+        return AI_PLANNER_ERROR_PARAM;
+    }
+    if (!ai_planner_is_tflite(data, size)) {
+        return AI_PLANNER_ERROR_FORMAT;
+    }
+    
+    if (!fb_deref(&fb, 0, &root) ||
+        !fb_vector(&fb, root, MODEL_SUBGRAPHS, 4, &subgraphs, &num_subgraphs) || num_subgraphs == 0 ||
+        !fb_vector(&fb, root, MODEL_BUFFERS, 4, &buffers, &num_buffers) ||
+        !fb_table_at(&fb, subgraphs, 0, &subgraph) ||
+        !fb_vector(&fb, subgraph, SUBGRAPH_TENSORS, 4, &tensors, &num_tensors) ||
+        !fb_vector(&fb, subgraph, SUBGRAPH_INPUTS, 4, &inputs, &num_inputs) ||
+        !fb_vector(&fb, subgraph, SUBGRAPH_OUTPUTS, 4, &outputs, &num_outputs) ||
+        !fb_vector(&fb, subgraph, SUBGRAPH_OPERATORS, 4, &operators, &num_operators)) {
+        return AI_PLANNER_ERROR_FORMAT;
+    }
+    if (num_tensors > AI_PLANNER_MAX_TENSORS) {
+        return AI_PLANNER_ERROR_LIMIT;
+    }
+    if (num_inputs == 0 || num_outputs == 0 || num_operators == 0) {
+        return AI_PLANNER_ERROR_FORMAT;
+    }
+    
+    memset(plan, 0, sizeof(*plan));
+    plan->operators = num_operators;
+    
+    for (uint32_t i = 0; i < num_tensors; i++) {
+        uint32_t tensor, buffer_index, dims[4];
+        uint8_t type, variable;
+        
+        if (!fb_table_at(&fb, tensors, i, &tensor) ||
+            !fb_scalar_u32(&fb, tensor, TENSOR_BUFFER, &buffer_index) ||
+            !fb_scalar_u8(&fb, tensor, TENSOR_IS_VARIABLE, &variable)) {
+            return AI_PLANNER_ERROR_FORMAT;
+        }
+        
+        graph_constant[i] = is_constant(&fb, buffers, num_buffers, buffer_index);
+        graph_tensors[i].first_use = UNUSED_STEP;
+        graph_tensors[i].last_use = UNUSED_STEP;
+        graph_tensors[i].size = 0;
+        if (graph_constant[i]) {
+            continue;
+        }
+        
+        int result = read_tensor(&fb, tensor, &graph_tensors[i].size, &type, dims);
+        if (result != 0) {
+            return result;
+        }
+        
+        // Variable tensors (RNN state) persist across the whole invoke
+        if (variable) {
+            graph_tensors[i].first_use = 0;
+            graph_tensors[i].last_use = num_operators - 1;
+        }
+    }
+    
+    // Inputs are written before the first operator, outputs read after the
+    // last one, everything else lives from its producer to its last consumer
+    if (!mark_uses(&fb, inputs, num_inputs, num_tensors, 0, 0) ||
+        !mark_uses(&fb, outputs, num_outputs, num_tensors, num_operators - 1, num_operators - 1)) {
+        return AI_PLANNER_ERROR_FORMAT;
+    }
+    for (uint32_t step = 0; step < num_operators; step++) {
+        uint32_t op, op_inputs, num_op_inputs, op_outputs, num_op_outputs;
+        if (!fb_table_at(&fb, operators, step, &op) ||
+            !fb_vector(&fb, op, OPERATOR_INPUTS, 4, &op_inputs, &num_op_inputs) ||
+            !fb_vector(&fb, op, OPERATOR_OUTPUTS, 4, &op_outputs, &num_op_outputs) ||
+            !mark_uses(&fb, op_inputs, num_op_inputs, num_tensors, step, step) ||
+            !mark_uses(&fb, op_outputs, num_op_outputs, num_tensors, step, step)) {
+            return AI_PLANNER_ERROR_FORMAT;
+        }
+    }
+    
+    // Pack the live activations to the front of the table and plan them
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < num_tensors; i++) {
+        if (graph_constant[i] || graph_tensors[i].first_use == UNUSED_STEP) {
+            continue;
+        }
+        plan->naive_bytes += align_up(graph_tensors[i].size);
+        graph_tensors[count++] = graph_tensors[i];
+    }
+    plan->tensors = count;
+    
+    int result = ai_planner_plan(graph_tensors, count, &plan->arena_bytes);
+    if (result != 0) {
+        return result;
+    }
+    
+    // Shapes of the first input and output
+    uint32_t index, tensor, unused;
+    uint8_t type;
+    if (!fb_u32(&fb, inputs, &index) || index >= num_tensors || !fb_table_at(&fb, tensors, index, &tensor) ||
+        read_tensor(&fb, tensor, &unused, &type, plan->input_dims) != 0) {
+        return AI_PLANNER_ERROR_FORMAT;
+    }
+    plan->input_type = (ai_plan_type_t)type;
+    if (!fb_u32(&fb, outputs, &index) || index >= num_tensors || !fb_table_at(&fb, tensors, index, &tensor) ||
+        read_tensor(&fb, tensor, &unused, &type, plan->output_dims) != 0) {
+        return AI_PLANNER_ERROR_FORMAT;
+    }
+    plan->output_type = (ai_plan_type_t)type;
+    
+    return 0;
+}
@@ -0,0 +1,66 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Tensor Arena Planner
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef AI_PLANNER_H
+#define AI_PLANNER_H
+
+#include "../types.h"
+
+#define AI_PLANNER_MAX_TENSORS   256
+#define AI_PLANNER_ALIGN         16      // Offset alignment of every buffer
+
+// Error codes
+#define AI_PLANNER_ERROR_PARAM   -1
+#define AI_PLANNER_ERROR_FORMAT  -2      // Not a TFLite model, or malformed
+#define AI_PLANNER_ERROR_LIMIT   -3      // Too many tensors, too many dims or too large
+
+// Element types, numbered as in the TFLite schema
+typedef enum {
+    AI_PLAN_TYPE_FLOAT32 = 0,
+    AI_PLAN_TYPE_FLOAT16 = 1,
+    AI_PLAN_TYPE_INT32 = 2,
+    AI_PLAN_TYPE_UINT8 = 3,
+    AI_PLAN_TYPE_INT64 = 4,
+    AI_PLAN_TYPE_BOOL = 6,
+    AI_PLAN_TYPE_INT16 = 7,
+    AI_PLAN_TYPE_INT8 = 9
+} ai_plan_type_t;
+
+// A buffer to place. It is alive from the step that writes it to the last
+// step that reads it, both inclusive, and may share memory with any buffer
+// whose lifetime does not overlap.
+typedef struct {
+    uint32_t size;
+    uint32_t first_use;
+    uint32_t last_use;
+    uint32_t offset;            // Filled in by the planner
+} ai_plan_tensor_t;
+
+// Arena layout of a TFLite model's first subgraph
+typedef struct {
+    uint32_t input_dims[4];     // First input, NHWC, leading dims padded with 1
+    uint32_t output_dims[4];    // First output
+    ai_plan_type_t input_type;
+    ai_plan_type_t output_type;
+    uint32_t operators;
+    uint32_t tensors;           // Activations placed in the arena (weights excluded)
+    uint32_t arena_bytes;       // Peak of the packed plan
+    uint32_t naive_bytes;       // Every activation in a buffer of its own
+} ai_plan_t;
+
+// Place the tensors greedily by size: largest first, each at the lowest
+// offset that no lifetime-overlapping tensor already occupies. Returns the
+// arena size the plan needs through peak.
+int ai_planner_plan(ai_plan_tensor_t* tensors, uint32_t count, uint32_t* peak);
+
+// Whether a blob is a TFLite flatbuffer (checks the file identifier only)
+int ai_planner_is_tflite(const void* data, uint32_t size);
+
+// Read the operator graph of a TFLite model, derive tensor lifetimes from
+// operator order and plan the activations
+int ai_planner_plan_tflite(const void* data, uint32_t size, ai_plan_t* plan);
+
+#endif // AI_PLANNER_H
@@ -0,0 +1,237 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI Inference Profiler
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "ai_profiler.h"
+#include "ai_cpu.h"
+#include "../stdio.h"
+#include "../timer.h"
+#include <stdbool.h>
+
+#define SUB_BUCKETS (1u << AI_PROFILER_SUB_BITS)
+
+typedef struct {
+    bool used;
+    int cpu_handle;
+    ai_profiler_model_t stats;
+} profiler_slot_t;
+
+static profiler_slot_t slots[AI_PROFILER_MAX_MODELS];
+
+// Index of the highest set bit; value must be non-zero. A loop rather than
+// __builtin_clz, which needs libgcc on targets without a count instruction.
+static uint32_t highest_bit(uint32_t value) {
+    uint32_t bit = 0;
+    
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+}
+
+static uint32_t bucket_index(uint32_t value) {
+    if (value < SUB_BUCKETS) {
+        return value;
+    }
+    uint32_t bit = highest_bit(value);
+    uint32_t sub = (value >> (bit - AI_PROFILER_SUB_BITS)) & (SUB_BUCKETS - 1);
+    return ((bit - AI_PROFILER_SUB_BITS + 1) << AI_PROFILER_SUB_BITS) + sub;
+}
+
+// Largest value that lands in a bucket
+static uint32_t bucket_limit(uint32_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    uint32_t shift = (index >> AI_PROFILER_SUB_BITS) - 1;
+    uint32_t sub = index & (SUB_BUCKETS - 1);
+    uint64_t low = (uint64_t)(SUB_BUCKETS + sub) << shift;
+    return (uint32_t)(low + (1ull << shift) - 1);
+}
+
+void ai_histogram_add(ai_histogram_t* hist, uint32_t value) {
+    hist->buckets[bucket_index(value)]++;
+    hist->count++;
+    hist->sum += value;
+    if (value > hist->max) {
+        hist->max = value;
+    }
+}
+
+uint32_t ai_histogram_percentile(const ai_histogram_t* hist, uint32_t permille) {
+    if (hist->count == 0) {
+        return 0;
+    }
+    
+    // Rank of the value, rounded up so p99 of 10 samples is the largest
+    uint32_t rank = (uint32_t)timer_div64((uint64_t)hist->count * permille + 999, 1000);
+    if (rank == 0) {
+        rank = 1;
+    }
+    
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < AI_PROFILER_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint32_t limit = bucket_limit(i);
+            return (limit < hist->max) ? limit : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+static profiler_slot_t* find_slot(uint32_t model_id) {
+    for (int i = 0; i < AI_PROFILER_MAX_MODELS; i++) {
+        if (slots[i].used && slots[i].stats.model_id == model_id) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t ticks_to_us(uint64_t ticks) {
+    uint64_t us = timer_div64(timer_ticks_to_ns(ticks), 1000);
+    return (us > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)us;
+}
+
+static void clear_stats(profiler_slot_t* slot) {
+    uint32_t model_id = slot->stats.model_id;
+    uint32_t backend = slot->stats.backend;
+    
+    memset(&slot->stats, 0, sizeof(slot->stats));
+    slot->stats.model_id = model_id;
+    slot->stats.backend = backend;
+}
+
+void ai_profiler_init(void) {
+    memset(slots, 0, sizeof(slots));
+}
+
+int ai_profiler_attach(uint32_t model_id, ai_backend_t backend, int cpu_handle) {
+    profiler_slot_t* slot = find_slot(model_id);
+    
+    for (int i = 0; slot == NULL && i < AI_PROFILER_MAX_MODELS; i++) {
+        if (!slots[i].used) {
+            slot = &slots[i];
+        }
+    }
+    if (slot == NULL) {
+        return AI_PROFILER_ERROR_FULL;
+    }
+    
+    slot->used = true;
+    slot->cpu_handle = cpu_handle;
+    slot->stats.model_id = model_id;
+    slot->stats.backend = backend;
+    clear_stats(slot);
+    return 0;
+}
+
+void ai_profiler_detach(uint32_t model_id) {
+    profiler_slot_t* slot = find_slot(model_id);
+    
+    if (slot != NULL) {
+        slot->used = false;
+    }
+}
+
+void ai_profiler_record(uint32_t model_id, uint64_t wait_ticks, uint64_t compute_ticks,
+                        uint32_t bytes_in, uint32_t bytes_out, int ok) {
+    profiler_slot_t* slot = find_slot(model_id);
+    
+    if (slot == NULL) {
+        return;
+    }
+    
+    ai_profiler_model_t* stats = &slot->stats;
+    if (!ok) {
+        stats->errors++;
+        return;
+    }
+    stats->inferences++;
+    stats->bytes_in += bytes_in;
+    stats->bytes_out += bytes_out;
+    ai_histogram_add(&stats->wait_us, ticks_to_us(wait_ticks));
+    ai_histogram_add(&stats->compute_us, ticks_to_us(compute_ticks));
+    ai_histogram_add(&stats->total_us, ticks_to_us(wait_ticks + compute_ticks));
+}
+
+void ai_profiler_record_batch(uint32_t model_id) {
+    profiler_slot_t* slot = find_slot(model_id);
+    
+    if (slot != NULL) {
+        slot->stats.batches++;
+    }
+}
+
+int ai_profiler_get_model(uint32_t model_id, ai_profiler_model_t* stats) {
+    profiler_slot_t* slot = find_slot(model_id);
+    
+    if (slot == NULL || stats == NULL) {
+        return AI_PROFILER_ERROR_PARAM;
+    }
+    *stats = slot->stats;
+    return 0;
+}
+
+void ai_profiler_reset(uint32_t model_id) {
+    for (int i = 0; i < AI_PROFILER_MAX_MODELS; i++) {
+        if (slots[i].used && (model_id == 0 || slots[i].stats.model_id == model_id)) {
+            clear_stats(&slots[i]);
+            if (slots[i].cpu_handle >= 0) {
+                ai_cpu_reset_profile(slots[i].cpu_handle);
+            }
+        }
+    }
+}
+
+uint32_t ai_profiler_dump(ai_profiler_write_fn write, void* ctx) {
+    static ai_cpu_op_profile_t ops[AI_CPU_MAX_LAYERS];
+    ai_profiler_dump_header_t header;
+    uint32_t total = 0;
+    
+    memset(&header, 0, sizeof(header));
+    header.magic = AI_PROFILER_DUMP_MAGIC;
+    header.version = AI_PROFILER_DUMP_VERSION;
+    header.buckets = AI_PROFILER_BUCKETS;
+    header.sub_bits = AI_PROFILER_SUB_BITS;
+    for (int i = 0; i < AI_PROFILER_MAX_MODELS; i++) {
+        header.models += slots[i].used ? 1 : 0;
+    }
+    write(&header, sizeof(header), ctx);
+    total += sizeof(header);
+    
+    for (int i = 0; i < AI_PROFILER_MAX_MODELS; i++) {
+        if (!slots[i].used) {
+            continue;
+        }
+        
+        uint32_t count[2] = {0, 0};     // Op count and padding
+        if (slots[i].cpu_handle < 0 ||
+            ai_cpu_get_profile(slots[i].cpu_handle, ops, AI_CPU_MAX_LAYERS, &count[0]) != 0) {
+            count[0] = 0;
+        }
+        write(&slots[i].stats, sizeof(slots[i].stats), ctx);
+        write(count, sizeof(count), ctx);
+        total += sizeof(slots[i].stats) + sizeof(count);
+        
+        for (uint32_t j = 0; j < count[0]; j++) {
+            ai_profiler_op_t op;
+            op.macs = ops[j].macs;
+            op.total_ns = timer_ticks_to_ns(ops[j].ticks);
+            op.max_ns = timer_ticks_to_ns(ops[j].max_ticks);
+            op.op = ops[j].op;
+            op.fused = ops[j].fused;
+            op.runs = ops[j].runs;
+            op.out_dims[0] = ops[j].out_dims[0];
+            op.out_dims[1] = ops[j].out_dims[1];
+            op.out_dims[2] = ops[j].out_dims[2];
+            write(&op, sizeof(op), ctx);
+            total += sizeof(op);
+        }
+    }
+    
+    return total;
+}
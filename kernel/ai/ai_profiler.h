@@ -0,0 +1,102 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI Inference Profiler
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef AI_PROFILER_H
+#define AI_PROFILER_H
+
+#include "../types.h"
+#include "ai_subsystem.h"
+
+#define AI_PROFILER_MAX_MODELS    16
+#define AI_PROFILER_SUB_BITS      3       // 8 buckets per power of two, 12.5% resolution
+#define AI_PROFILER_BUCKETS       ((32 - AI_PROFILER_SUB_BITS + 1) << AI_PROFILER_SUB_BITS)
+#define AI_PROFILER_DUMP_MAGIC    0x50414753          // "SGAP"
+#define AI_PROFILER_DUMP_VERSION  1
+
+// Error codes
+#define AI_PROFILER_ERROR_PARAM   -1
+#define AI_PROFILER_ERROR_FULL    -2      // Every model slot in use
+
+// Log-linear histogram of microsecond values: one bucket per value below
+// 8, then 8 equal buckets per power of two up to 2^32
+typedef struct {
+    uint64_t sum;
+    uint32_t count;
+    uint32_t max;
+    uint32_t buckets[AI_PROFILER_BUCKETS];
+} ai_histogram_t;
+
+// Counters of one model. 64-bit fields come first and every size is a
+// multiple of 8, so the layout (and the dump) is the same on all targets.
+typedef struct {
+    uint64_t bytes_in;          // Input tensors handed to the backend
+    uint64_t bytes_out;
+    uint32_t model_id;
+    uint32_t backend;           // ai_backend_t
+    uint32_t inferences;
+    uint32_t errors;
+    uint32_t batches;           // Dispatches; inferences / batches is the mean batch size
+    uint32_t reserved;
+    ai_histogram_t wait_us;     // Submit to dispatch, 0 for synchronous calls
+    ai_histogram_t compute_us;  // Backend call that served the request (the whole batch)
+    ai_histogram_t total_us;    // Submit to completion
+} ai_profiler_model_t;
+
+// Binary dump: this header, then for each model an ai_profiler_model_t, a
+// uint32_t op count, 4 bytes of padding and that many ai_profiler_op_t.
+// Little-endian on every supported target.
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t models;
+    uint16_t buckets;
+    uint16_t sub_bits;
+    uint32_t reserved;
+} ai_profiler_dump_header_t;
+
+// One kernel of a CPU model (see ai_cpu_get_profile)
+typedef struct __attribute__((packed)) {
+    uint64_t macs;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t op;                // ai_cpu_op_t
+    uint32_t fused;
+    uint32_t runs;
+    uint32_t out_dims[3];
+} ai_profiler_op_t;
+
+typedef void (*ai_profiler_write_fn)(const void* data, uint32_t size, void* ctx);
+
+void ai_histogram_add(ai_histogram_t* hist, uint32_t value);
+
+// Smallest bucket bound with at least permille/1000 of the values at or
+// below it, capped at the largest value seen; 0 when empty
+uint32_t ai_histogram_percentile(const ai_histogram_t* hist, uint32_t permille);
+
+// Forget every model
+void ai_profiler_init(void);
+
+// Start or stop tracking a model. cpu_handle is its CPU engine handle, or
+// -1 for HAT models; it adds per-kernel records to the dump.
+int ai_profiler_attach(uint32_t model_id, ai_backend_t backend, int cpu_handle);
+void ai_profiler_detach(uint32_t model_id);
+
+// Account one finished request, with times in timer ticks
+void ai_profiler_record(uint32_t model_id, uint64_t wait_ticks, uint64_t compute_ticks,
+                        uint32_t bytes_in, uint32_t bytes_out, int ok);
+
+// Account one dispatch: a synchronous call or one batch of queued requests
+void ai_profiler_record_batch(uint32_t model_id);
+
+int ai_profiler_get_model(uint32_t model_id, ai_profiler_model_t* stats);
+
+// Clear the counters of one model, or of all with model_id 0
+void ai_profiler_reset(uint32_t model_id);
+
+// Write the binary dump through write, in pieces. Returns its size.
+uint32_t ai_profiler_dump(ai_profiler_write_fn write, void* ctx);
+
+#endif // AI_PROFILER_H
@@ -0,0 +1,365 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI Model Residency
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "ai_residency.h"
+#include "../../drivers/ai_hat/ai_hat.h"
+#include "../stdio.h"
+#include "../timer.h"
+#include <stdbool.h>
+
+#define STAGING_ALIGN 64
+
+typedef struct {
+    bool used;
+    bool resident;
+    bool staged;           // Has a copy in the staging pool; pinned unless mapped
+    const void* mapped;    // Caller's blob that outlives the entry, reloaded in place
+    uint32_t hat_id;       // Valid while resident
+    uint32_t size;
+    ai_hat_precision_t precision;
+    uint32_t staging_offset;
+    uint64_t footprint;    // Device bytes while resident
+    uint32_t last_use;     // LRU clock value of the last acquire
+    bool reload_failed;    // Reported by the next acquire
+} residency_entry_t;
+
+static residency_entry_t entries[AI_RESIDENCY_MAX_MODELS];
+static uint8_t staging_pool[AI_RESIDENCY_STAGING_SIZE] __attribute__((aligned(STAGING_ALIGN)));
+static ai_residency_stats_t stats;
+static uint64_t reload_us_total = 0;
+static uint32_t use_clock = 0;
+static int reloading = -1;              // Entry being uploaded again, one at a time
+static uint64_t reload_start = 0;
+
+static uint32_t staging_length(uint32_t size) {
+    return (size + STAGING_ALIGN - 1) & ~(uint32_t)(STAGING_ALIGN - 1);
+}
+
+// First fit over the gaps between staged copies
+static bool staging_alloc(uint32_t size, uint32_t* offset) {
+    uint32_t need = staging_length(size);
+    uint32_t candidate = 0;
+    
+    for (;;) {
+        int blocking = -1;
+        for (int i = 0; i < AI_RESIDENCY_MAX_MODELS; i++) {
+            const residency_entry_t* entry = &entries[i];
+            if (entry->used && entry->staged &&
+                entry->staging_offset < candidate + need &&
+                candidate < entry->staging_offset + staging_length(entry->size)) {
+                blocking = i;
+                break;
+            }
+        }
+        
+        if (blocking < 0) {
+            if (need > AI_RESIDENCY_STAGING_SIZE || candidate > AI_RESIDENCY_STAGING_SIZE - need) {
+                return false;
+            }
+            *offset = candidate;
+            return true;
+        }
+        
+        candidate = entries[blocking].staging_offset + staging_length(entries[blocking].size);
+    }
+}
+
+// Unload the least recently used evictable model other than `keep`
+static bool evict_lru(int keep) {
+    int victim = -1;
+    
+    for (int i = 0; i < AI_RESIDENCY_MAX_MODELS; i++) {
+        const residency_entry_t* entry = &entries[i];
+        if (i != keep && entry->used && entry->resident && (entry->staged || entry->mapped) &&
+            (victim < 0 || entry->last_use < entries[victim].last_use)) {
+            victim = i;
+        }
+    }
+    
+    if (victim < 0) {
+        return false;
+    }
+    
+    residency_entry_t* entry = &entries[victim];
+    ai_hat_unload_model(entry->hat_id);
+    entry->resident = false;
+    stats.device_used -= entry->footprint;
+    stats.resident--;
+    stats.evictions++;
+    return true;
+}
+
+// Reload source of an evicted model
+static const void* model_source(const residency_entry_t* entry) {
+    return entry->mapped ? entry->mapped : staging_pool + entry->staging_offset;
+}
+
+// Evict least-recently-used models until the device budget has room
+static int make_room(int handle) {
+    const residency_entry_t* entry = &entries[handle];
+    
+    if (entry->footprint > stats.device_budget) {
+        return AI_RESIDENCY_ERROR_FULL;
+    }
+    
+    while (stats.device_used + entry->footprint > stats.device_budget) {
+        if (!evict_lru(handle)) {
+            return AI_RESIDENCY_ERROR_FULL;
+        }
+    }
+    return 0;
+}
+
+// Upload a model, evicting others until both the device budget and the
+// HAT's model table have room for it
+static int make_resident(int handle, const void* data) {
+    residency_entry_t* entry = &entries[handle];
+    
+    int result = make_room(handle);
+    if (result != 0) {
+        return result;
+    }
+    
+    for (;;) {
+        ai_hat_status_t status = ai_hat_load_model(data, entry->size, entry->precision, &entry->hat_id);
+        if (status == AI_HAT_SUCCESS) {
+            break;
+        }
+        if (status != AI_HAT_ERROR_MEMORY || !evict_lru(handle)) {
+            return (status == AI_HAT_ERROR_MEMORY) ? AI_RESIDENCY_ERROR_FULL : AI_RESIDENCY_ERROR_LOAD;
+        }
+    }
+    
+    entry->resident = true;
+    stats.device_used += entry->footprint;
+    stats.resident++;
+    return 0;
+}
+
+// Start uploading an evicted model again. ai_subsystem_process() sends it
+// in slices; the device memory counts as used from now on. Waits for the
+// link while another upload has it.
+static int start_reload(int handle) {
+    residency_entry_t* entry = &entries[handle];
+    
+    if (reloading >= 0) {
+        return AI_RESIDENCY_PENDING;
+    }
+    
+    int result = make_room(handle);
+    if (result != 0) {
+        return result;
+    }
+    
+    for (;;) {
+        ai_hat_status_t status = ai_hat_load_model_start(model_source(entry), entry->size, entry->precision,
+                                                         &entry->hat_id);
+        if (status == AI_HAT_SUCCESS) {
+            break;
+        }
+        if (status == AI_HAT_ERROR_BUSY) {
+            return AI_RESIDENCY_PENDING;
+        }
+        if (status != AI_HAT_ERROR_MEMORY || !evict_lru(handle)) {
+            return (status == AI_HAT_ERROR_MEMORY) ? AI_RESIDENCY_ERROR_FULL : AI_RESIDENCY_ERROR_LOAD;
+        }
+    }
+    
+    reloading = handle;
+    reload_start = timer_ticks();
+    stats.device_used += entry->footprint;
+    stats.misses++;
+    return AI_RESIDENCY_PENDING;
+}
+
+// Whether the HAT lists the model as loaded
+static bool on_hat(uint32_t hat_id) {
+    ai_hat_model_t models[AI_HAT_MAX_MODELS];
+    uint32_t count = 0;
+    
+    ai_hat_get_models(models, AI_HAT_MAX_MODELS, &count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (models[i].id == hat_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Finish the reload in flight once its upload has ended
+static void poll_reload(void) {
+    ai_hat_load_progress_t progress;
+    
+    if (reloading < 0) {
+        return;
+    }
+    
+    residency_entry_t* entry = &entries[reloading];
+    if (ai_hat_get_load_progress(&progress) == AI_HAT_PENDING && progress.model_id == entry->hat_id) {
+        return;
+    }
+    reloading = -1;
+    
+    // Another upload may have started since; the HAT's model table says
+    // whether this one made it
+    if (!on_hat(entry->hat_id)) {
+        stats.device_used -= entry->footprint;
+        entry->reload_failed = true;
+        return;
+    }
+    
+    uint32_t us = (uint32_t)timer_div64(timer_ticks_to_ns(timer_ticks() - reload_start), 1000);
+    entry->resident = true;
+    stats.resident++;
+    stats.reload_us_last = us;
+    if (us > stats.reload_us_max) {
+        stats.reload_us_max = us;
+    }
+    reload_us_total += us;
+    stats.reload_us_avg = (uint32_t)timer_div64(reload_us_total, stats.misses);
+}
+
+void ai_residency_init(uint64_t device_budget) {
+    memset(entries, 0, sizeof(entries));
+    memset(&stats, 0, sizeof(stats));
+    reload_us_total = 0;
+    use_clock = 0;
+    reloading = -1;
+    stats.device_budget = device_budget;
+}
+
+void ai_residency_set_budget(uint64_t device_budget) {
+    stats.device_budget = device_budget;
+    
+    // Shrinking takes effect now, not at the next load
+    while (stats.device_used > stats.device_budget && evict_lru(-1)) {
+    }
+}
+
+static int add_model(const void* data, uint32_t size, ai_hat_precision_t precision, uint32_t runtime_bytes,
+                     bool mapped) {
+    int handle = -1;
+    
+    if (data == NULL || size == 0) {
+        return AI_RESIDENCY_ERROR_PARAM;
+    }
+    
+    for (int i = 0; i < AI_RESIDENCY_MAX_MODELS; i++) {
+        if (!entries[i].used) {
+            handle = i;
+            break;
+        }
+    }
+    
+    if (handle < 0) {
+        return AI_RESIDENCY_ERROR_FULL;
+    }
+    
+    residency_entry_t* entry = &entries[handle];
+    memset(entry, 0, sizeof(*entry));
+    entry->size = size;
+    entry->precision = precision;
+    entry->footprint = ((uint64_t)size + runtime_bytes + AI_RESIDENCY_PAGE - 1) &
+                       ~(uint64_t)(AI_RESIDENCY_PAGE - 1);
+    entry->last_use = ++use_clock;
+    entry->mapped = mapped ? data : NULL;
+    entry->staged = !mapped && staging_alloc(size, &entry->staging_offset);
+    
+    int result = make_resident(handle, data);
+    if (result != 0) {
+        return result;
+    }
+    
+    if (entry->staged) {
+        memcpy(staging_pool + entry->staging_offset, data, size);
+        stats.staging_used += staging_length(size);
+    }
+    
+    entry->used = true;
+    stats.models++;
+    return handle;
+}
+
+int ai_residency_add(const void* data, uint32_t size, ai_hat_precision_t precision, uint32_t runtime_bytes) {
+    return add_model(data, size, precision, runtime_bytes, false);
+}
+
+int ai_residency_add_mapped(const void* data, uint32_t size, ai_hat_precision_t precision, uint32_t runtime_bytes) {
+    return add_model(data, size, precision, runtime_bytes, true);
+}
+
+int ai_residency_acquire(int handle, uint32_t* hat_id) {
+    if (handle < 0 || handle >= AI_RESIDENCY_MAX_MODELS || !entries[handle].used || hat_id == NULL) {
+        return AI_RESIDENCY_ERROR_PARAM;
+    }
+    
+    residency_entry_t* entry = &entries[handle];
+    entry->last_use = ++use_clock;
+    poll_reload();
+    
+    if (entry->reload_failed) {
+        entry->reload_failed = false;
+        return AI_RESIDENCY_ERROR_LOAD;
+    }
+    
+    if (!entry->resident) {
+        return (reloading == handle) ? AI_RESIDENCY_PENDING : start_reload(handle);
+    }
+    
+    stats.hits++;
+    *hat_id = entry->hat_id;
+    return 0;
+}
+
+int ai_residency_acquire_wait(int handle, uint32_t* hat_id) {
+    int result;
+    
+    while ((result = ai_residency_acquire(handle, hat_id)) == AI_RESIDENCY_PENDING) {
+        ai_hat_load_model_step(AI_RESIDENCY_WAIT_SLICE_US);
+    }
+    return result;
+}
+
+int ai_residency_resident(int handle) {
+    return handle >= 0 && handle < AI_RESIDENCY_MAX_MODELS && entries[handle].used && entries[handle].resident;
+}
+
+int ai_residency_remove(int handle) {
+    int result = 0;
+    
+    if (handle < 0 || handle >= AI_RESIDENCY_MAX_MODELS || !entries[handle].used) {
+        return AI_RESIDENCY_ERROR_PARAM;
+    }
+    
+    residency_entry_t* entry = &entries[handle];
+    if (reloading == handle) {
+        ai_hat_load_model_abort();
+        stats.device_used -= entry->footprint;
+        reloading = -1;
+    }
+    
+    if (entry->resident) {
+        if (ai_hat_unload_model(entry->hat_id) != AI_HAT_SUCCESS) {
+            result = AI_RESIDENCY_ERROR_LOAD;
+        }
+        stats.device_used -= entry->footprint;
+        stats.resident--;
+    }
+    
+    if (entry->staged) {
+        stats.staging_used -= staging_length(entry->size);
+    }
+    
+    entry->used = false;
+    stats.models--;
+    return result;
+}
+
+void ai_residency_get_stats(ai_residency_stats_t* out) {
+    if (out != NULL) {
+        *out = stats;
+    }
+}
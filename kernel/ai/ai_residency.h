@@ -0,0 +1,77 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — AI Model Residency
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef AI_RESIDENCY_H
+#define AI_RESIDENCY_H
+
+#include "../types.h"
+#include "../../drivers/ai_hat/ai_hat.h"
+
+#define AI_RESIDENCY_MAX_MODELS    16                 // Models known, resident or not
+#define AI_RESIDENCY_STAGING_SIZE  (2 * 1024 * 1024)  // Host RAM holding evictable model copies
+#define AI_RESIDENCY_PAGE          4096               // Device allocation granularity
+#define AI_RESIDENCY_WAIT_SLICE_US 2000               // Upload time per step while a caller waits
+
+// Error codes
+#define AI_RESIDENCY_PENDING       1    // Being uploaded again; try later
+#define AI_RESIDENCY_ERROR_PARAM   -1
+#define AI_RESIDENCY_ERROR_FULL    -2   // No free handle, or nothing left to evict
+#define AI_RESIDENCY_ERROR_LOAD    -3   // The HAT did not accept the model
+
+typedef struct {
+    uint32_t hits;             // Acquires that found the model on the HAT
+    uint32_t misses;           // Acquires that had to upload it again
+    uint32_t evictions;
+    uint32_t reload_us_last;
+    uint32_t reload_us_max;
+    uint32_t reload_us_avg;
+    uint32_t models;           // Models known
+    uint32_t resident;         // Models on the HAT
+    uint32_t staging_used;     // Bytes of the staging pool in use
+    uint64_t device_used;      // Device bytes held by resident models
+    uint64_t device_budget;
+} ai_residency_stats_t;
+
+// Tracks which models are on the AI HAT+ and how much device memory each
+// one takes (blob plus tensors, in AI_RESIDENCY_PAGE units). When a load
+// does not fit, least-recently-used models are unloaded from the HAT; their
+// blob stays in a host staging copy and is uploaded again on next use.
+// Models too big for the staging pool are pinned on the HAT instead.
+
+// Forget all models and set the device memory budget in bytes
+void ai_residency_init(uint64_t device_budget);
+void ai_residency_set_budget(uint64_t device_budget);
+
+// Take on a model and load it. runtime_bytes is the device memory it needs
+// beyond the blob (tensors). Returns a handle, or a negative error code.
+// The blob is copied, so the caller's buffer is free once this returns.
+int ai_residency_add(const void* data, uint32_t size, ai_hat_precision_t precision, uint32_t runtime_bytes);
+
+// As ai_residency_add, for a blob that stays valid until the model is
+// removed (a file mapping). It is referenced, not copied: evictions reload
+// it from there and it takes no room in the staging pool.
+int ai_residency_add_mapped(const void* data, uint32_t size, ai_hat_precision_t precision, uint32_t runtime_bytes);
+
+// Mark the model as most recently used and, if it is resident, set *hat_id
+// to its current AI HAT+ model id and return 0. An evicted model is
+// uploaded again in chunks, driven by ai_subsystem_process(), and
+// AI_RESIDENCY_PENDING is returned until it is back; a failed reload is
+// reported by the next call.
+int ai_residency_acquire(int handle, uint32_t* hat_id);
+
+// As ai_residency_acquire, but waits for a reload, sending it in slices
+// itself. For callers that cannot leave work pending.
+int ai_residency_acquire_wait(int handle, uint32_t* hat_id);
+
+// 1 if the model is on the HAT now, 0 if it is evicted or being reloaded
+int ai_residency_resident(int handle);
+
+// Unload the model and release its staging copy
+int ai_residency_remove(int handle);
+
+void ai_residency_get_stats(ai_residency_stats_t* stats);
+
+#endif // AI_RESIDENCY_H
@@ -7,19 +7,230 @@
  *
  * ───────────────────────────────────────────────────────────────────────────── */
 #include "ai_subsystem.h"
+#include "ai_residency.h"
+#include "ai_cpu.h"
+#include "ai_planner.h"
+#include "ai_profiler.h"
+#include "ai_governor.h"
+#include "ai_partition.h"
 #include "../../drivers/ai_hat/ai_hat.h"
 #include "../memory.h"
+#include "../filesystem.h"
 #include "../../drivers/uart.h"
 #include <stdbool.h>
 #include "../stdio.h"
+#include "../timer.h"
 
-// Maximum number of models that can be loaded
-#define MAX_MODELS 8
+// Maximum number of models that can be loaded; fewer may be resident on
+// the HAT at any time, the rest are reloaded on demand
+#define MAX_MODELS AI_RESIDENCY_MAX_MODELS
+
+// Asynchronous request states
+typedef enum {
+    AI_REQUEST_FREE = 0,
+    AI_REQUEST_QUEUED,
+    AI_REQUEST_DONE      // Finished, waiting for poll/wait to collect it
+} ai_request_state_t;
+
+typedef struct {
+    ai_ticket_t ticket;
+    ai_request_state_t state;
+    ai_subsystem_status_t status;
+    uint32_t model_id;
+    const void* input;
+    void* output;
+    ai_completion_func_t callback;
+    void* ctx;
+    uint64_t submit_ticks;
+} ai_request_t;
+
+// Pending requests of one model, oldest first. Indexed like loaded_models.
+typedef struct {
+    uint8_t slots[AI_SUBSYSTEM_QUEUE_DEPTH];  // Indices into requests[]
+    uint32_t head;
+    uint32_t count;
+    uint32_t max_batch;
+    uint32_t max_wait_us;
+} ai_model_queue_t;
 
 // Static variables
 static bool ai_subsystem_initialized = false;
 static ai_model_descriptor_t loaded_models[MAX_MODELS];
+static ai_model_queue_t model_queues[MAX_MODELS];
+static int model_handles[MAX_MODELS];     // Residency, CPU engine or partition handles, indexed like loaded_models
+static const void* model_views[MAX_MODELS];   // fs_mmap view a HAT model reloads from, or NULL
 static uint32_t num_loaded_models = 0;
+static uint32_t model_sequence = 1;
+static ai_request_t requests[AI_SUBSYSTEM_MAX_REQUESTS];
+static uint32_t ticket_sequence = 1;
+static bool hat_available = false;
+static ai_backend_t preferred_backend = AI_BACKEND_AUTO;
+
+static int find_model(uint32_t model_id) {
+    for (uint32_t i = 0; i < num_loaded_models; i++) {
+        if (loaded_models[i].id == model_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static uint32_t tensor_size(const uint32_t dims[4]) {
+    return dims[0] * dims[1] * dims[2] * dims[3];
+}
+
+// Bytes of one input and one output; HAT tensors count one byte per element
+static void tensor_bytes(int model_index, uint32_t* input, uint32_t* output) {
+    static ai_partition_info_t split;
+    ai_cpu_model_info_t info;
+    
+    if (loaded_models[model_index].backend == AI_BACKEND_CPU &&
+        ai_cpu_get_model_info(model_handles[model_index], &info) == 0) {
+        *input = info.input_bytes;
+        *output = info.output_bytes;
+        return;
+    }
+    if (loaded_models[model_index].backend == AI_BACKEND_SPLIT &&
+        ai_partition_get_info(model_handles[model_index], &split) == 0) {
+        *input = split.model.input_bytes;
+        *output = split.model.output_bytes;
+        return;
+    }
+    *input = tensor_size(loaded_models[model_index].input_dims);
+    *output = tensor_size(loaded_models[model_index].output_dims);
+}
+
+static ai_request_t* find_request(ai_ticket_t ticket) {
+    ai_request_t* request = &requests[ticket % AI_SUBSYSTEM_MAX_REQUESTS];
+    
+    if (ticket == 0 || request->state == AI_REQUEST_FREE || request->ticket != ticket) {
+        return NULL;
+    }
+    return request;
+}
+
+static void complete_request(ai_request_t* request, ai_subsystem_status_t status) {
+    if (request->callback == NULL) {
+        request->status = status;
+        request->state = AI_REQUEST_DONE;
+        return;
+    }
+    
+    // Release first so the callback can submit follow-up work
+    ai_completion_func_t callback = request->callback;
+    request->state = AI_REQUEST_FREE;
+    callback(request->ticket, status, request->output, request->ctx);
+}
+
+// Requests per dispatch: the model's batching policy, held down on the
+// HAT by the power governor while the device runs hot
+static uint32_t batch_size(int model_index) {
+    uint32_t max_batch = model_queues[model_index].max_batch;
+    
+    if (loaded_models[model_index].backend == AI_BACKEND_HAT && max_batch > ai_governor_batch_limit()) {
+        return ai_governor_batch_limit();
+    }
+    return max_batch;
+}
+
+// Send the oldest count requests of a model queue to the HAT as one batch.
+// Returns the number completed, 0 while the model is uploaded again.
+static uint32_t dispatch_batch(int model_index, uint32_t count) {
+    ai_model_queue_t* queue = &model_queues[model_index];
+    const void* inputs[AI_HAT_MAX_BATCH];
+    void* outputs[AI_HAT_MAX_BATCH];
+    ai_request_t* batch[AI_HAT_MAX_BATCH];
+    
+    if (count > queue->count) {
+        count = queue->count;
+    }
+    if (count > AI_HAT_MAX_BATCH) {
+        count = AI_HAT_MAX_BATCH;
+    }
+    
+    // A model evicted from the HAT is uploaded again in slices by
+    // ai_subsystem_process(); its requests stay queued until it is back
+    const ai_model_descriptor_t* model = &loaded_models[model_index];
+    uint32_t hat_id = 0;
+    int ready = 0;
+    if (model->backend == AI_BACKEND_HAT) {
+        ready = ai_residency_acquire(model_handles[model_index], &hat_id);
+        if (ready == AI_RESIDENCY_PENDING) {
+            return 0;
+        }
+    } else if (model->backend == AI_BACKEND_SPLIT) {
+        ready = ai_partition_prepare(model_handles[model_index]);
+        if (ready == AI_PARTITION_PENDING) {
+            return 0;
+        }
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        batch[i] = &requests[queue->slots[(queue->head + i) % AI_SUBSYSTEM_QUEUE_DEPTH]];
+        inputs[i] = batch[i]->input;
+        outputs[i] = batch[i]->output;
+    }
+    queue->head = (queue->head + count) % AI_SUBSYSTEM_QUEUE_DEPTH;
+    queue->count -= count;
+    
+    ai_subsystem_status_t result = AI_SUBSYSTEM_ERROR_MODEL;
+    uint32_t model_id = model->id;
+    uint32_t input_bytes, output_bytes;
+    
+    tensor_bytes(model_index, &input_bytes, &output_bytes);
+    ai_profiler_record_batch(model_id);
+    
+    // The CPU engine has nothing to amortize across a batch. Requests are
+    // accounted before completion, whose callback may reuse the slot.
+    if (model->backend == AI_BACKEND_CPU) {
+        int handle = model_handles[model_index];
+        for (uint32_t i = 0; i < count; i++) {
+            uint64_t start = timer_ticks();
+            result = (ai_cpu_run(handle, inputs[i], outputs[i]) == 0) ? AI_SUBSYSTEM_SUCCESS
+                                                                       : AI_SUBSYSTEM_ERROR_INFERENCE;
+            ai_profiler_record(model_id, start - batch[i]->submit_ticks, timer_ticks() - start,
+                               input_bytes, output_bytes, result == AI_SUBSYSTEM_SUCCESS);
+            complete_request(batch[i], result);
+        }
+        return count;
+    }
+    
+    // A failed reload fails the batch with AI_SUBSYSTEM_ERROR_MODEL. Split
+    // models pipeline the batch through their segments.
+    ai_governor_poll();
+    uint64_t start = timer_ticks();
+    if (ready == 0 && model->backend == AI_BACKEND_SPLIT) {
+        result = (ai_partition_run(model_handles[model_index], inputs, outputs, count) == 0)
+                     ? AI_SUBSYSTEM_SUCCESS : AI_SUBSYSTEM_ERROR_INFERENCE;
+    } else if (ready == 0) {
+        ai_hat_status_t status = ai_hat_run_inference_batch(hat_id, inputs, tensor_size(model->input_dims),
+                                                            outputs, tensor_size(model->output_dims), count);
+        result = (status == AI_HAT_SUCCESS) ? AI_SUBSYSTEM_SUCCESS : AI_SUBSYSTEM_ERROR_INFERENCE;
+    }
+    uint64_t compute = timer_ticks() - start;
+    
+    for (uint32_t i = 0; i < count; i++) {
+        ai_profiler_record(model_id, start - batch[i]->submit_ticks, compute, input_bytes, output_bytes,
+                           result == AI_SUBSYSTEM_SUCCESS);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        complete_request(batch[i], result);
+    }
+    
+    return count;
+}
+
+// Budget device memory by what the HAT reports (in KB)
+static void attach_hat(void) {
+    ai_hat_info_t info;
+    
+    memset(&info, 0, sizeof(info));
+    if (hat_available) {
+        ai_hat_get_info(&info);
+        ai_governor_init(info.power_mode);
+    }
+    ai_residency_init((uint64_t)info.memory_size * 1024);
+}
 
 // Initialize the AI subsystem
 ai_subsystem_status_t ai_subsystem_init(void) {
@@ -30,15 +241,29 @@ ai_subsystem_status_t ai_subsystem_init(void) {
     
     uart_puts("Initializing AI subsystem...\n");
     
-    // Initialize AI HAT+
+    // The CPU engine is always there
+    ai_cpu_init();
+    ai_partition_init();
+    
+    // Initialize AI HAT+. The emulator only stands in for a missing HAT in
+    // builds made with AI_HAT_EMULATOR=1 or after `aiemu on`.
     ai_hat_status_t status = ai_hat_init();
+#ifdef AI_HAT_EMULATOR
     if (status != AI_HAT_SUCCESS) {
-        uart_puts("Failed to initialize AI HAT+\n");
-        return AI_SUBSYSTEM_ERROR_INIT;
+        uart_puts("AI HAT+ not detected, using the emulator\n");
+        status = ai_hat_init_emulator();
+    }
+#endif
+    hat_available = (status == AI_HAT_SUCCESS);
+    if (!hat_available) {
+        uart_puts("AI HAT+ not detected, running models on the CPU\n");
     }
     
-    // Initialize model list
+    // Initialize model list and request pool
     num_loaded_models = 0;
+    memset(requests, 0, sizeof(requests));
+    ai_profiler_init();
+    attach_hat();
     
     ai_subsystem_initialized = true;
     uart_puts("AI subsystem initialized successfully\n");
@@ -46,6 +271,26 @@ ai_subsystem_status_t ai_subsystem_init(void) {
     return AI_SUBSYSTEM_SUCCESS;
 }
 
+// Bring up the emulator in place of a HAT that was not detected
+ai_subsystem_status_t ai_subsystem_use_emulator(void) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (hat_available) {
+        return AI_SUBSYSTEM_SUCCESS;
+    }
+    
+    if (ai_hat_init_emulator() != AI_HAT_SUCCESS) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    hat_available = true;
+    attach_hat();
+    
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
 // Get AI subsystem information
 ai_subsystem_status_t ai_subsystem_get_info(ai_hat_info_t* info) {
     if (!ai_subsystem_initialized) {
@@ -56,6 +301,10 @@ ai_subsystem_status_t ai_subsystem_get_info(ai_hat_info_t* info) {
         return AI_SUBSYSTEM_ERROR_PARAM;
     }
     
+    if (!hat_available) {
+        return AI_SUBSYSTEM_ERROR_NO_HAT;
+    }
+    
     // Get information from AI HAT+
     ai_hat_status_t status = ai_hat_get_info(info);
     if (status != AI_HAT_SUCCESS) {
@@ -65,9 +314,111 @@ ai_subsystem_status_t ai_subsystem_get_info(ai_hat_info_t* info) {
     return AI_SUBSYSTEM_SUCCESS;
 }
 
-// Load a model from memory
-ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t model_size, 
-                                             ai_model_type_t type, ai_model_descriptor_t* descriptor) {
+// Choose the backend for subsequent loads
+ai_subsystem_status_t ai_subsystem_set_backend(ai_backend_t backend) {
+    if (backend != AI_BACKEND_AUTO && backend != AI_BACKEND_HAT && backend != AI_BACKEND_CPU) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    preferred_backend = backend;
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Shapes and precision of a CPU-format model come from the model itself
+static void describe_cpu_model(ai_model_descriptor_t* model, const ai_cpu_model_info_t* info) {
+    model->precision = (info->dtype == AI_CPU_DTYPE_INT8) ? AI_HAT_PRECISION_INT8 : AI_HAT_PRECISION_FP16;
+    model->input_dims[0] = 1;
+    model->output_dims[0] = 1;
+    for (int i = 0; i < 3; i++) {
+        model->input_dims[i + 1] = info->input_dims[i];
+        model->output_dims[i + 1] = info->output_dims[i];
+    }
+    model->arena_bytes = info->arena_bytes;
+}
+
+// Load a model onto the CPU engine
+static ai_subsystem_status_t load_cpu_model(const void* model_data, uint32_t model_size,
+                                            ai_model_descriptor_t* model, int* handle) {
+    ai_cpu_model_info_t info;
+    
+    *handle = ai_cpu_load_model(model_data, model_size, &info);
+    if (*handle < 0) {
+        return (*handle == AI_CPU_ERROR_MEMORY) ? AI_SUBSYSTEM_ERROR_MEMORY : AI_SUBSYSTEM_ERROR_MODEL;
+    }
+    
+    model->backend = AI_BACKEND_CPU;
+    describe_cpu_model(model, &info);
+    
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// A CPU-format model bound for the HAT: kernels the HAT cannot run, or
+// runs slower once transfers are counted, go to the CPU engine. When one
+// device is best for all of it, it loads as an ordinary model.
+static ai_subsystem_status_t load_split_model(const void* model_data, uint32_t model_size, bool mapped,
+                                              ai_model_descriptor_t* model, int* handle) {
+    static ai_partition_info_t plan;
+    
+    int result = ai_partition_plan(model_data, model_size, &plan);
+    if (result < 0) {
+        return (result == AI_PARTITION_ERROR_MEMORY) ? AI_SUBSYSTEM_ERROR_MEMORY : AI_SUBSYSTEM_ERROR_MODEL;
+    }
+    
+    if (plan.segments == 1 && plan.segment[0].device == AI_PARTITION_CPU) {
+        return load_cpu_model(model_data, model_size, model, handle);
+    }
+    
+    describe_cpu_model(model, &plan.model);
+    if (plan.segments == 1) {
+        model->backend = AI_BACKEND_HAT;
+        uint32_t runtime_bytes = plan.model.input_bytes + plan.model.output_bytes;
+        *handle = mapped ? ai_residency_add_mapped(model_data, model_size, model->precision, runtime_bytes)
+                         : ai_residency_add(model_data, model_size, model->precision, runtime_bytes);
+        if (*handle < 0) {
+            return (*handle == AI_RESIDENCY_ERROR_FULL) ? AI_SUBSYSTEM_ERROR_MEMORY : AI_SUBSYSTEM_ERROR_MODEL;
+        }
+        return AI_SUBSYSTEM_SUCCESS;
+    }
+    
+    model->backend = AI_BACKEND_SPLIT;
+    *handle = ai_partition_load(model_data, model_size, &plan);
+    if (*handle < 0) {
+        return (*handle == AI_PARTITION_ERROR_MEMORY || *handle == AI_PARTITION_ERROR_LIMIT)
+                   ? AI_SUBSYSTEM_ERROR_MEMORY : AI_SUBSYSTEM_ERROR_MODEL;
+    }
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Take shapes, precision and arena size from a TFLite model's own graph.
+// Other HAT blobs are opaque and keep the defaults of their model type.
+static void plan_hat_model(const void* model_data, uint32_t model_size, ai_model_descriptor_t* model) {
+    ai_plan_t plan;
+    
+    if (ai_planner_plan_tflite(model_data, model_size, &plan) != 0) {
+        return;
+    }
+    
+    memcpy(model->input_dims, plan.input_dims, sizeof(model->input_dims));
+    memcpy(model->output_dims, plan.output_dims, sizeof(model->output_dims));
+    switch (plan.input_type) {
+        case AI_PLAN_TYPE_INT8:
+        case AI_PLAN_TYPE_UINT8:
+            model->precision = AI_HAT_PRECISION_INT8;
+            break;
+        case AI_PLAN_TYPE_FLOAT32:
+            model->precision = AI_HAT_PRECISION_FP32;
+            break;
+        default:
+            model->precision = AI_HAT_PRECISION_FP16;
+            break;
+    }
+    model->arena_bytes = plan.arena_bytes;
+}
+
+// Load a model from memory. A mapped blob stays valid while the model is
+// loaded, so HAT models reference it instead of keeping a staging copy.
+static ai_subsystem_status_t load_model(const void* model_data, uint32_t model_size, bool mapped,
+                                        ai_model_type_t type, ai_model_descriptor_t* descriptor) {
     if (!ai_subsystem_initialized) {
         return AI_SUBSYSTEM_ERROR_INIT;
     }
@@ -80,20 +431,15 @@ ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t m
         return AI_SUBSYSTEM_ERROR_MEMORY;
     }
     
-    // Load model to AI HAT+
-    uint32_t model_id;
-    ai_hat_status_t status = ai_hat_load_model(model_data, model_size, &model_id);
-    if (status != AI_HAT_SUCCESS) {
-        return AI_SUBSYSTEM_ERROR_MODEL;
-    }
-    
-    // Create model descriptor
+    // Create model descriptor. The id stays the same while the model
+    // moves on and off the HAT.
     ai_model_descriptor_t model;
     memset(&model, 0, sizeof(ai_model_descriptor_t));
-    model.id = model_id;
+    model.id = model_sequence;
     model.type = type;
     
-    // Set default input/output dimensions based on model type
+    // Default input/output dimensions based on model type, for models
+    // whose graph does not say
     switch (type) {
         case AI_MODEL_TYPE_CLASSIFICATION:
             // Default: 224x224 RGB image input, 1000 class output
@@ -107,7 +453,7 @@ ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t m
             model.output_dims[2] = 1;    // width
             model.output_dims[3] = 1000; // classes
             break;
-            
+        
         case AI_MODEL_TYPE_DETECTION:
             // Default: 416x416 RGB image input, detection output
             model.input_dims[0] = 1;    // batch
@@ -120,7 +466,7 @@ ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t m
             model.output_dims[2] = 1;   // width
             model.output_dims[3] = 100; // detections
             break;
-            
+        
         case AI_MODEL_TYPE_SEGMENTATION:
             // Default: 512x512 RGB image input, segmentation mask output
             model.input_dims[0] = 1;    // batch
@@ -133,7 +479,7 @@ ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t m
             model.output_dims[2] = 512;  // width
             model.output_dims[3] = 21;   // classes
             break;
-            
+        
         case AI_MODEL_TYPE_GENERATION:
             // Default: text generation model
             model.input_dims[0] = 1;    // batch
@@ -146,7 +492,7 @@ ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t m
             model.output_dims[2] = 1;    // width
             model.output_dims[3] = 512;  // sequence length
             break;
-            
+        
         case AI_MODEL_TYPE_CUSTOM:
         default:
             // Default: custom model with unknown dimensions
@@ -163,13 +509,56 @@ ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t m
     }
     
     // Set model name with bounds checking
-    snprintf(model.name, sizeof(model.name), "Model_%u", model_id);
+    snprintf(model.name, sizeof(model.name), "Model_%u", model.id);
     
     // Set precision (default to FP16)
     model.precision = AI_HAT_PRECISION_FP16;
     
-    // Add model to list
+    // Without a HAT the CPU engine runs whatever it can; other models
+    // only run on the HAT
+    bool cpu_format = ai_cpu_probe(model_data, model_size);
+    ai_backend_t backend = preferred_backend;
+    if (backend == AI_BACKEND_AUTO || (!hat_available && cpu_format)) {
+        backend = cpu_format ? AI_BACKEND_CPU : AI_BACKEND_HAT;
+    }
+    
+    int handle;
+    if (backend == AI_BACKEND_CPU) {
+        ai_subsystem_status_t result = load_cpu_model(model_data, model_size, &model, &handle);
+        if (result != AI_SUBSYSTEM_SUCCESS) {
+            return result;
+        }
+    } else if (!hat_available) {
+        return AI_SUBSYSTEM_ERROR_NO_HAT;
+    } else if (cpu_format) {
+        ai_subsystem_status_t result = load_split_model(model_data, model_size, mapped, &model, &handle);
+        if (result != AI_SUBSYSTEM_SUCCESS) {
+            return result;
+        }
+    } else {
+        // Load model to AI HAT+; the device also holds its tensors
+        model.backend = AI_BACKEND_HAT;
+        plan_hat_model(model_data, model_size, &model);
+        uint32_t tensor_bytes = model.arena_bytes;
+        if (tensor_bytes == 0) {
+            tensor_bytes = tensor_size(model.input_dims) + tensor_size(model.output_dims);
+        }
+        handle = mapped ? ai_residency_add_mapped(model_data, model_size, model.precision, tensor_bytes)
+                        : ai_residency_add(model_data, model_size, model.precision, tensor_bytes);
+        if (handle < 0) {
+            return (handle == AI_RESIDENCY_ERROR_FULL) ? AI_SUBSYSTEM_ERROR_MEMORY : AI_SUBSYSTEM_ERROR_MODEL;
+        }
+    }
+    model_sequence++;
+    ai_profiler_attach(model.id, model.backend, (model.backend == AI_BACKEND_CPU) ? handle : -1);
+    
+    // Add model to list with an empty request queue
     loaded_models[num_loaded_models] = model;
+    model_handles[num_loaded_models] = handle;
+    model_views[num_loaded_models] = NULL;
+    memset(&model_queues[num_loaded_models], 0, sizeof(ai_model_queue_t));
+    model_queues[num_loaded_models].max_batch = AI_SUBSYSTEM_DEFAULT_BATCH;
+    model_queues[num_loaded_models].max_wait_us = AI_SUBSYSTEM_DEFAULT_WAIT_US;
     num_loaded_models++;
     
     // Copy descriptor to output
@@ -178,6 +567,41 @@ ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t m
     return AI_SUBSYSTEM_SUCCESS;
 }
 
+ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t model_size,
+                                             ai_model_type_t type, ai_model_descriptor_t* descriptor) {
+    return load_model(model_data, model_size, false, type, descriptor);
+}
+
+ai_subsystem_status_t ai_subsystem_load_model_file(const char* filename, ai_model_type_t type,
+                                                  ai_model_descriptor_t* descriptor) {
+    const char* data;
+    size_t size;
+    
+    if (filename == NULL || fs_get_file_view(filename, &data, &size) != 0 || size == 0) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    const void* view = fs_mmap(filename, 0, size);
+    if (view == NULL) {
+        return AI_SUBSYSTEM_ERROR_MEMORY;
+    }
+    
+    ai_subsystem_status_t result = load_model(view, (uint32_t)size, true, type, descriptor);
+    if (result != AI_SUBSYSTEM_SUCCESS) {
+        fs_munmap(view);
+        return result;
+    }
+    
+    // CPU and split models were compiled into arenas of their own; only
+    // models living on the HAT reload from the view
+    if (descriptor->backend == AI_BACKEND_HAT) {
+        model_views[num_loaded_models - 1] = view;
+    } else {
+        fs_munmap(view);
+    }
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
 // Unload a model
 ai_subsystem_status_t ai_subsystem_unload_model(uint32_t model_id) {
     if (!ai_subsystem_initialized) {
@@ -197,20 +621,42 @@ ai_subsystem_status_t ai_subsystem_unload_model(uint32_t model_id) {
         return AI_SUBSYSTEM_ERROR_PARAM;
     }
     
-    // Unload model from AI HAT+
-    ai_hat_status_t status = ai_hat_unload_model(model_id);
-    if (status != AI_HAT_SUCCESS) {
-        return AI_SUBSYSTEM_ERROR_MODEL;
+    // Unload model from AI HAT+ (if resident) and drop its staging copy.
+    // The entry goes even if the HAT did not answer.
+    int result;
+    if (loaded_models[model_index].backend == AI_BACKEND_CPU) {
+        result = ai_cpu_unload_model(model_handles[model_index]);
+    } else if (loaded_models[model_index].backend == AI_BACKEND_SPLIT) {
+        result = ai_partition_unload(model_handles[model_index]);
+    } else {
+        result = ai_residency_remove(model_handles[model_index]);
+    }
+    
+    ai_profiler_detach(model_id);
+    if (model_views[model_index] != NULL) {
+        fs_munmap(model_views[model_index]);
+    }
+    
+    // Fail requests still queued for the model
+    ai_model_queue_t* queue = &model_queues[model_index];
+    while (queue->count > 0) {
+        ai_request_t* request = &requests[queue->slots[queue->head]];
+        queue->head = (queue->head + 1) % AI_SUBSYSTEM_QUEUE_DEPTH;
+        queue->count--;
+        complete_request(request, AI_SUBSYSTEM_ERROR_MODEL);
     }
     
     // Remove model from list by shifting remaining models
     for (uint32_t i = model_index; i < num_loaded_models - 1; i++) {
         loaded_models[i] = loaded_models[i + 1];
+        model_queues[i] = model_queues[i + 1];
+        model_handles[i] = model_handles[i + 1];
+        model_views[i] = model_views[i + 1];
     }
     
     num_loaded_models--;
     
-    return AI_SUBSYSTEM_SUCCESS;
+    return (result == 0) ? AI_SUBSYSTEM_SUCCESS : AI_SUBSYSTEM_ERROR_MODEL;
 }
 
 // Run inference on a loaded model
@@ -237,22 +683,201 @@ ai_subsystem_status_t ai_subsystem_run_inference(uint32_t model_id, const void*
     }
     
     // Calculate input and output sizes
-    uint32_t input_size = loaded_models[model_index].input_dims[0] *
-                         loaded_models[model_index].input_dims[1] *
-                         loaded_models[model_index].input_dims[2] *
-                         loaded_models[model_index].input_dims[3];
-    
-    uint32_t output_size = loaded_models[model_index].output_dims[0] *
-                          loaded_models[model_index].output_dims[1] *
-                          loaded_models[model_index].output_dims[2] *
-                          loaded_models[model_index].output_dims[3];
-    
-    // Run inference on AI HAT+
-    ai_hat_status_t status = ai_hat_run_inference(model_id, input, input_size, output, output_size);
-    if (status != AI_HAT_SUCCESS) {
-        return AI_SUBSYSTEM_ERROR_INFERENCE;
+    uint32_t input_size, output_size;
+    tensor_bytes(model_index, &input_size, &output_size);
+    ai_profiler_record_batch(model_id);
+    uint64_t start = timer_ticks();
+    ai_subsystem_status_t result = AI_SUBSYSTEM_SUCCESS;
+    
+    if (loaded_models[model_index].backend == AI_BACKEND_CPU) {
+        if (ai_cpu_run(model_handles[model_index], input, output) != 0) {
+            result = AI_SUBSYSTEM_ERROR_INFERENCE;
+        }
+    } else if (loaded_models[model_index].backend == AI_BACKEND_SPLIT) {
+        ai_governor_poll();
+        if (ai_partition_run(model_handles[model_index], &input, &output, 1) != 0) {
+            result = AI_SUBSYSTEM_ERROR_INFERENCE;
+        }
+    } else {
+        // Bring the model back onto the HAT if it was evicted, then run
+        // inference on AI HAT+
+        uint32_t hat_id;
+        ai_governor_poll();
+        if (ai_residency_acquire_wait(model_handles[model_index], &hat_id) != 0) {
+            result = AI_SUBSYSTEM_ERROR_MODEL;
+        } else if (ai_hat_run_inference(hat_id, input, input_size, output, output_size) != AI_HAT_SUCCESS) {
+            result = AI_SUBSYSTEM_ERROR_INFERENCE;
+        }
     }
     
+    // Synchronous calls never queue
+    ai_profiler_record(model_id, 0, timer_ticks() - start, input_size, output_size,
+                       result == AI_SUBSYSTEM_SUCCESS);
+    return result;
+}
+
+// Queue an inference request
+ai_subsystem_status_t ai_subsystem_submit(uint32_t model_id, const void* input, void* output,
+                                          ai_completion_func_t callback, void* ctx, ai_ticket_t* ticket) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    // Without a callback the ticket is the only way to collect the result
+    if (input == NULL || output == NULL || (callback == NULL && ticket == NULL)) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    int model_index = find_model(model_id);
+    if (model_index == -1) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    ai_model_queue_t* queue = &model_queues[model_index];
+    if (queue->count >= AI_SUBSYSTEM_QUEUE_DEPTH) {
+        return AI_SUBSYSTEM_ERROR_BUSY;
+    }
+    
+    uint32_t slot = 0;
+    while (slot < AI_SUBSYSTEM_MAX_REQUESTS && requests[slot].state != AI_REQUEST_FREE) {
+        slot++;
+    }
+    if (slot == AI_SUBSYSTEM_MAX_REQUESTS) {
+        return AI_SUBSYSTEM_ERROR_BUSY;
+    }
+    
+    // Ticket encodes the slot; the sequence part makes stale tickets invalid
+    if (ticket_sequence >= 0xFFFFFFFFu / AI_SUBSYSTEM_MAX_REQUESTS) {
+        ticket_sequence = 1;
+    }
+    
+    ai_request_t* request = &requests[slot];
+    request->ticket = ticket_sequence++ * AI_SUBSYSTEM_MAX_REQUESTS + slot;
+    request->state = AI_REQUEST_QUEUED;
+    request->status = AI_SUBSYSTEM_PENDING;
+    request->model_id = model_id;
+    request->input = input;
+    request->output = output;
+    request->callback = callback;
+    request->ctx = ctx;
+    request->submit_ticks = timer_ticks();
+    
+    queue->slots[(queue->head + queue->count) % AI_SUBSYSTEM_QUEUE_DEPTH] = (uint8_t)slot;
+    queue->count++;
+    
+    if (ticket != NULL) {
+        *ticket = request->ticket;
+    }
+    
+    // Only queue: batches go out from process, poll or wait, which are
+    // also the only places completion callbacks run
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Collect a finished request and release its ticket
+static ai_subsystem_status_t collect_request(ai_request_t* request) {
+    ai_subsystem_status_t status = request->status;
+    request->state = AI_REQUEST_FREE;
+    return status;
+}
+
+// Check a request without blocking
+ai_subsystem_status_t ai_subsystem_poll(ai_ticket_t ticket) {
+    ai_request_t* request = find_request(ticket);
+    if (request == NULL || request->callback != NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    if (request->state == AI_REQUEST_QUEUED) {
+        ai_subsystem_process();
+        if (request->state == AI_REQUEST_QUEUED) {
+            return AI_SUBSYSTEM_PENDING;
+        }
+    }
+    
+    return collect_request(request);
+}
+
+// Run the request's queue now and return its final status
+ai_subsystem_status_t ai_subsystem_wait(ai_ticket_t ticket) {
+    ai_request_t* request = find_request(ticket);
+    if (request == NULL || request->callback != NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    // Nothing else can submit while we wait, so skip the latency budget.
+    // A model on its way back to the HAT is uploaded from here meanwhile.
+    while (request->state == AI_REQUEST_QUEUED) {
+        int model_index = find_model(request->model_id);
+        if (model_index == -1) {
+            return AI_SUBSYSTEM_ERROR_MODEL;
+        }
+        if (dispatch_batch(model_index, batch_size(model_index)) == 0) {
+            ai_hat_load_model_step(AI_SUBSYSTEM_LOAD_SLICE_US);
+        }
+    }
+    
+    return collect_request(request);
+}
+
+// Dispatch full batches and batches past their latency budget
+uint32_t ai_subsystem_process(void) {
+    uint32_t completed = 0;
+    
+    if (!ai_subsystem_initialized) {
+        return 0;
+    }
+    
+    if (hat_available) {
+        ai_governor_poll();
+    }
+    
+    uint64_t now = timer_ticks();
+    for (uint32_t i = 0; i < num_loaded_models; i++) {
+        ai_model_queue_t* queue = &model_queues[i];
+        
+        while (queue->count >= batch_size(i)) {
+            uint32_t dispatched = dispatch_batch(i, batch_size(i));
+            if (dispatched == 0) {
+                break;                  // Waiting for the model to be uploaded again
+            }
+            completed += dispatched;
+        }
+        
+        if (queue->count > 0) {
+            const ai_request_t* oldest = &requests[queue->slots[queue->head]];
+            uint64_t waited_ns = timer_ticks_to_ns(now - oldest->submit_ticks);
+            if (waited_ns >= (uint64_t)queue->max_wait_us * 1000) {
+                completed += dispatch_batch(i, queue->count);
+            }
+        }
+    }
+    
+    // Inferences first, then one slice of a model upload started with
+    // ai_hat_load_model_start(). A slice that fails is resumed by the next
+    // one from where the HAT left off.
+    if (ai_hat_get_load_progress(NULL) == AI_HAT_PENDING) {
+        ai_hat_load_model_step(AI_SUBSYSTEM_LOAD_SLICE_US);
+    }
+    
+    return completed;
+}
+
+// Set the batching policy of a model
+ai_subsystem_status_t ai_subsystem_set_batching(uint32_t model_id, uint32_t max_batch, uint32_t max_wait_us) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    int model_index = find_model(model_id);
+    if (model_index == -1 || max_batch == 0 || max_batch > AI_HAT_MAX_BATCH ||
+        max_batch > AI_SUBSYSTEM_QUEUE_DEPTH) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    model_queues[model_index].max_batch = max_batch;
+    model_queues[model_index].max_wait_us = max_wait_us;
+    
     return AI_SUBSYSTEM_SUCCESS;
 }
 
@@ -277,6 +902,58 @@ ai_subsystem_status_t ai_subsystem_get_models(ai_model_descriptor_t* models, uin
     return AI_SUBSYSTEM_SUCCESS;
 }
 
+// Get the per-kernel profile of a CPU model
+ai_subsystem_status_t ai_subsystem_get_op_profile(uint32_t model_id, ai_cpu_op_profile_t* ops, uint32_t max_ops,
+                                                  uint32_t* num_ops) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    int model_index = find_model(model_id);
+    if (model_index == -1 || loaded_models[model_index].backend != AI_BACKEND_CPU) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    return (ai_cpu_get_profile(model_handles[model_index], ops, max_ops, num_ops) == 0) ? AI_SUBSYSTEM_SUCCESS
+                                                                                        : AI_SUBSYSTEM_ERROR_PARAM;
+}
+
+// Clear the per-kernel profile of a CPU model, or the segment counters of a split one
+ai_subsystem_status_t ai_subsystem_reset_op_profile(uint32_t model_id) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    int model_index = find_model(model_id);
+    if (model_index == -1) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    if (loaded_models[model_index].backend == AI_BACKEND_SPLIT) {
+        return (ai_partition_reset_stats(model_handles[model_index]) == 0) ? AI_SUBSYSTEM_SUCCESS
+                                                                           : AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    if (loaded_models[model_index].backend != AI_BACKEND_CPU) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    return (ai_cpu_reset_profile(model_handles[model_index]) == 0) ? AI_SUBSYSTEM_SUCCESS : AI_SUBSYSTEM_ERROR_PARAM;
+}
+
+// Get the segments of a model split between the CPU and the HAT
+ai_subsystem_status_t ai_subsystem_get_partition(uint32_t model_id, ai_partition_info_t* info) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    int model_index = find_model(model_id);
+    if (info == NULL || model_index == -1 || loaded_models[model_index].backend != AI_BACKEND_SPLIT) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    return (ai_partition_get_info(model_handles[model_index], info) == 0) ? AI_SUBSYSTEM_SUCCESS
+                                                                          : AI_SUBSYSTEM_ERROR_PARAM;
+}
+
 // Get AI subsystem temperature
 ai_subsystem_status_t ai_subsystem_get_temperature(uint32_t* temperature) {
     if (!ai_subsystem_initialized) {
@@ -321,12 +998,50 @@ ai_subsystem_status_t ai_subsystem_set_power_mode(ai_hat_power_mode_t mode) {
         return AI_SUBSYSTEM_ERROR_INIT;
     }
     
-    // Set power mode on AI HAT+
+    // Set power mode on AI HAT+; the governor keeps it from now on
     ai_hat_status_t status = ai_hat_set_power_mode(mode);
     if (status != AI_HAT_SUCCESS) {
         return AI_SUBSYSTEM_ERROR_INIT;
     }
+    ai_governor_set_policy(AI_POWER_POLICY_MANUAL, 0, mode);
+    
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Let the power governor pick the HAT power mode
+ai_subsystem_status_t ai_subsystem_set_power_policy(ai_power_policy_t policy, uint32_t energy_cap_mw) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (!hat_available) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    ai_governor_state_t state;
+    ai_governor_get_state(&state);
+    if (policy == AI_POWER_POLICY_MANUAL || ai_governor_set_policy(policy, energy_cap_mw, state.mode) != 0) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
+    
+    return AI_SUBSYSTEM_SUCCESS;
+}
+
+// Get the power governor's policy and last telemetry sample
+ai_subsystem_status_t ai_subsystem_get_power_state(ai_governor_state_t* state) {
+    if (!ai_subsystem_initialized) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    if (state == NULL) {
+        return AI_SUBSYSTEM_ERROR_PARAM;
+    }
     
+    if (!hat_available) {
+        return AI_SUBSYSTEM_ERROR_INIT;
+    }
+    
+    ai_governor_get_state(state);
     return AI_SUBSYSTEM_SUCCESS;
 }
 
@@ -342,7 +1057,9 @@ void ai_subsystem_shutdown(void) {
     }
     
     // Shutdown AI HAT+
-    ai_hat_shutdown();
+    if (hat_available) {
+        ai_hat_shutdown();
+    }
     
     ai_subsystem_initialized = false;
 }
\ No newline at end of file
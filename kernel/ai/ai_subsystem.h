@@ -11,15 +11,28 @@
 
 #include "../types.h"
 #include "../../drivers/ai_hat/ai_hat.h"
+#include "ai_cpu.h"
+#include "ai_governor.h"
+#include "ai_partition.h"
+
+// Asynchronous request limits
+#define AI_SUBSYSTEM_MAX_REQUESTS   32    // Requests in flight across all models
+#define AI_SUBSYSTEM_QUEUE_DEPTH    16    // Pending requests per model
+#define AI_SUBSYSTEM_DEFAULT_BATCH  8     // Requests coalesced into one HAT call
+#define AI_SUBSYSTEM_DEFAULT_WAIT_US 2000 // Latency budget before a partial batch runs
+#define AI_SUBSYSTEM_LOAD_SLICE_US  2000  // Model upload time per ai_subsystem_process() call
 
 // AI subsystem status codes
 typedef enum {
+    AI_SUBSYSTEM_PENDING = 1,     // Asynchronous request not finished yet
     AI_SUBSYSTEM_SUCCESS = 0,
     AI_SUBSYSTEM_ERROR_INIT = -1,
     AI_SUBSYSTEM_ERROR_MEMORY = -2,
     AI_SUBSYSTEM_ERROR_MODEL = -3,
     AI_SUBSYSTEM_ERROR_INFERENCE = -4,
-    AI_SUBSYSTEM_ERROR_PARAM = -5
+    AI_SUBSYSTEM_ERROR_PARAM = -5,
+    AI_SUBSYSTEM_ERROR_BUSY = -6,   // Request pool or model queue full
+    AI_SUBSYSTEM_ERROR_NO_HAT = -7  // Needs the AI HAT+, which was not detected
 } ai_subsystem_status_t;
 
 // AI model type
@@ -31,6 +44,14 @@ typedef enum {
     AI_MODEL_TYPE_CUSTOM = 4
 } ai_model_type_t;
 
+// Where a model runs
+typedef enum {
+    AI_BACKEND_AUTO = 0,  // CPU for CPU-format models (ai_cpu.h), AI HAT+ otherwise
+    AI_BACKEND_HAT = 1,   // CPU-format models are split with the CPU where that is faster (ai_partition.h)
+    AI_BACKEND_CPU = 2,
+    AI_BACKEND_SPLIT = 3  // Reported for split models; not a choice for ai_subsystem_set_backend
+} ai_backend_t;
+
 // AI model descriptor
 typedef struct {
     char name[32];
@@ -39,36 +60,102 @@ typedef struct {
     uint32_t input_dims[4];  // [batch, height, width, channels]
     uint32_t output_dims[4]; // [batch, height, width, channels]
     ai_hat_precision_t precision;
+    ai_backend_t backend;
+    uint32_t arena_bytes;    // Planned peak of the model's activation tensors, 0 if unknown
 } ai_model_descriptor_t;
 
+// Handle for an asynchronous inference request (0 is never a valid ticket)
+typedef uint32_t ai_ticket_t;
+
+// Completion callback for asynchronous requests. Runs from
+// ai_subsystem_process(), ai_subsystem_poll() or ai_subsystem_wait(); the
+// ticket is released once the callback returns.
+typedef void (*ai_completion_func_t)(ai_ticket_t ticket, ai_subsystem_status_t status, void* output, void* ctx);
+
 // Initialize the AI subsystem
 ai_subsystem_status_t ai_subsystem_init(void);
 
+// Use the AI HAT+ emulator when no HAT was detected (QEMU, bring-up).
+// Returns success if a HAT, real or emulated, is already in use.
+ai_subsystem_status_t ai_subsystem_use_emulator(void);
+
 // Get AI subsystem information
 ai_subsystem_status_t ai_subsystem_get_info(ai_hat_info_t* info);
 
-// Load a model from memory
+// Choose the backend for models loaded from now on (AI_BACKEND_AUTO by default)
+ai_subsystem_status_t ai_subsystem_set_backend(ai_backend_t backend);
+
+// Load a model from memory. CPU models take their dimensions and precision
+// from the model itself; type only labels them. Without an AI HAT+,
+// CPU-format models load on the CPU engine whatever the backend, and other
+// models fail with AI_SUBSYSTEM_ERROR_NO_HAT.
 ai_subsystem_status_t ai_subsystem_load_model(const void* model_data, uint32_t model_size, 
                                              ai_model_type_t type, ai_model_descriptor_t* descriptor);
 
+// Load a model straight from a file through fs_mmap, without copying it
+// into a buffer first. HAT models keep the view and are reloaded from it
+// after an eviction; it is released when the model is unloaded.
+ai_subsystem_status_t ai_subsystem_load_model_file(const char* filename, ai_model_type_t type,
+                                                  ai_model_descriptor_t* descriptor);
+
 // Unload a model
 ai_subsystem_status_t ai_subsystem_unload_model(uint32_t model_id);
 
 // Run inference on a loaded model
 ai_subsystem_status_t ai_subsystem_run_inference(uint32_t model_id, const void* input, void* output);
 
+// Queue an inference request. input and output must stay valid until the
+// request completes. Submitting never runs an inference or a callback, even
+// when the request fills a batch; ai_subsystem_process() dispatches it.
+// With a callback, completion is reported through it; otherwise collect
+// the result with ai_subsystem_poll() or ai_subsystem_wait().
+ai_subsystem_status_t ai_subsystem_submit(uint32_t model_id, const void* input, void* output,
+                                          ai_completion_func_t callback, void* ctx, ai_ticket_t* ticket);
+
+// Check a request without blocking. Returns AI_SUBSYSTEM_PENDING while it is
+// queued; otherwise its final status, and the ticket is released.
+ai_subsystem_status_t ai_subsystem_poll(ai_ticket_t ticket);
+
+// Run the request's queue now and return its final status
+ai_subsystem_status_t ai_subsystem_wait(ai_ticket_t ticket);
+
+// Dispatch every queue that has a full batch or has waited past its latency
+// budget, then advance a running model upload by one slice. There are no
+// kernel threads, so idle loops call this to make progress. Returns the
+// number of requests completed.
+uint32_t ai_subsystem_process(void);
+
+// Batching policy for one model: coalesce up to max_batch requests, or send
+// a partial batch once the oldest has waited max_wait_us microseconds
+ai_subsystem_status_t ai_subsystem_set_batching(uint32_t model_id, uint32_t max_batch, uint32_t max_wait_us);
+
 // Get list of loaded models
 ai_subsystem_status_t ai_subsystem_get_models(ai_model_descriptor_t* models, uint32_t max_models, uint32_t* num_models);
 
+// Per-kernel timings of a CPU model, after layer fusion (see ai_cpu.h)
+ai_subsystem_status_t ai_subsystem_get_op_profile(uint32_t model_id, ai_cpu_op_profile_t* ops, uint32_t max_ops,
+                                                  uint32_t* num_ops);
+ai_subsystem_status_t ai_subsystem_reset_op_profile(uint32_t model_id);
+
+// Segments and utilization of a model split between the CPU and the HAT
+ai_subsystem_status_t ai_subsystem_get_partition(uint32_t model_id, ai_partition_info_t* info);
+
 // Get AI subsystem temperature
 ai_subsystem_status_t ai_subsystem_get_temperature(uint32_t* temperature);
 
 // Get AI subsystem power consumption
 ai_subsystem_status_t ai_subsystem_get_power_consumption(uint32_t* power);
 
-// Set AI subsystem power mode
+// Set AI subsystem power mode. Fixes the mode (AI_POWER_POLICY_MANUAL);
+// the governor still steps it down to keep the HAT below its limit.
 ai_subsystem_status_t ai_subsystem_set_power_mode(ai_hat_power_mode_t mode);
 
+// Let the governor pick the power mode and HAT batch size from temperature
+// and power telemetry (see ai_governor.h). energy_cap_mw is only used by
+// AI_POWER_POLICY_ENERGY_CAP; use ai_subsystem_set_power_mode for manual.
+ai_subsystem_status_t ai_subsystem_set_power_policy(ai_power_policy_t policy, uint32_t energy_cap_mw);
+ai_subsystem_status_t ai_subsystem_get_power_state(ai_governor_state_t* state);
+
 // Shutdown the AI subsystem
 void ai_subsystem_shutdown(void);
 
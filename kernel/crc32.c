@@ -0,0 +1,59 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — CRC32
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "crc32.h"
+
+#define CRC32_POLY 0xEDB88320u
+
+// Slicing-by-4 tables: tables[0] is the classic byte table, tables[k]
+// advances a byte that is k positions further from the end
+static uint32_t tables[4][256];
+static int tables_ready = 0;
+
+static void build_tables(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (CRC32_POLY & (0u - (crc & 1)));
+        }
+        tables[0][i] = crc;
+    }
+    
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 4; k++) {
+            uint32_t prev = tables[k - 1][i];
+            tables[k][i] = (prev >> 8) ^ tables[0][prev & 0xFF];
+        }
+    }
+    
+    tables_ready = 1;
+}
+
+uint32_t crc32_update(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    
+    if (!tables_ready) {
+        build_tables();
+    }
+    
+    crc = ~crc;
+    
+    // Four bytes per step; assembled bytewise so alignment and
+    // endianness do not matter
+    while (len >= 4) {
+        crc ^= (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        crc = tables[3][crc & 0xFF] ^ tables[2][(crc >> 8) & 0xFF] ^
+              tables[1][(crc >> 16) & 0xFF] ^ tables[0][crc >> 24];
+        p += 4;
+        len -= 4;
+    }
+    
+    while (len--) {
+        crc = (crc >> 8) ^ tables[0][(crc ^ *p++) & 0xFF];
+    }
+    
+    return ~crc;
+}
@@ -0,0 +1,20 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — CRC32
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include "types.h"
+
+// CRC-32 (IEEE 802.3, reflected, as used by zlib and Ethernet).
+// crc32_update() continues a running CRC; start from 0.
+uint32_t crc32_update(uint32_t crc, const void* data, size_t len);
+
+static inline uint32_t crc32(const void* data, size_t len) {
+    return crc32_update(0, data, len);
+}
+
+#endif // CRC32_H
@@ -9,22 +9,42 @@
 #include "memory.h"
 #include "stdio.h"
 #include "utils.h"
+#include "vmm.h"
 
 #define MAX_FILES 64
 #define MAX_FILENAME 128
-#define MAX_FILESIZE 2048
 #define MAX_DIRECTORIES 16
+#define MAX_MAPPINGS 16
+
+// File contents live in page-aligned extents of one storage area, so a
+// file's pages can be mapped (fs_mmap) instead of copied
+#ifndef FS_STORAGE_SIZE
+#define FS_STORAGE_SIZE (4 * 1024 * 1024)
+#endif
+#define FS_STORAGE_PAGES (FS_STORAGE_SIZE / PAGE_SIZE)
 
 typedef struct {
     char name[MAX_FILENAME];
-    char content[MAX_FILESIZE];
+    char* content;              // Start of the extent, NUL-terminated after size bytes
     size_t size;
+    uint32_t first_page;
+    uint32_t pages;             // Extent length; always holds the terminator
+    uint32_t maps;              // Live fs_mmap views; the file cannot change while mapped
+    vmm_object_t* object;       // The extent's pages as a VM object while mapped
     int is_used;
     uint32_t created_time;
     uint32_t modified_time;
     uint32_t permissions;
 } enhanced_file_entry_t;
 
+typedef struct {
+    int used;
+    int slot;
+    uint64_t addr;
+    uint64_t size;              // Page multiple
+    vmm_space_t* space;         // NULL for an in-place view (no VMM)
+} file_mapping_t;
+
 typedef struct {
     char name[MAX_FILENAME];
     int is_used;
@@ -32,6 +52,9 @@ typedef struct {
 } directory_entry_t;
 
 static enhanced_file_entry_t enhanced_files[MAX_FILES];
+static uint8_t storage[FS_STORAGE_SIZE] __attribute__((aligned(PAGE_SIZE)));
+static uint8_t page_used[FS_STORAGE_PAGES];
+static file_mapping_t mappings[MAX_MAPPINGS];
 static directory_entry_t directories[MAX_DIRECTORIES];
 static int enhanced_fs_initialized = 0;
 static char current_directory[256] = "/";
@@ -42,6 +65,104 @@ static uint32_t get_enhanced_system_time() {
     return ++system_time;
 }
 
+// Pages for size bytes plus the terminator
+static uint32_t extent_pages(size_t size) {
+    return (uint32_t)((size + PAGE_SIZE) >> PAGE_SHIFT);
+}
+
+// First fit over the free storage pages; returns the first page, or -1
+static int extent_alloc(uint32_t pages) {
+    uint32_t run = 0;
+    
+    for (uint32_t i = 0; i < FS_STORAGE_PAGES; i++) {
+        run = page_used[i] ? 0 : run + 1;
+        if (run == pages) {
+            uint32_t first = i + 1 - pages;
+            memset(page_used + first, 1, pages);
+            return (int)first;
+        }
+    }
+    return -1;
+}
+
+static void extent_free(uint32_t first, uint32_t pages) {
+    memset(page_used + first, 0, pages);
+}
+
+// Grow an extent where it lies if the pages after it are free. The new
+// pages hold stale data until the caller writes over them.
+static int extent_grow(enhanced_file_entry_t* file, uint32_t pages) {
+    uint32_t end = file->first_page + pages;
+    
+    if (end > FS_STORAGE_PAGES) {
+        return 0;
+    }
+    for (uint32_t i = file->first_page + file->pages; i < end; i++) {
+        if (page_used[i]) {
+            return 0;
+        }
+    }
+    memset(page_used + file->first_page + file->pages, 1, pages - file->pages);
+    file->pages = pages;
+    return 1;
+}
+
+// Keep the first `keep` bytes of a file and write size bytes after them,
+// moving the file to a larger extent if it outgrows its own. Bytes past
+// the end of a file are kept zeroed up to the end of its last page, so a
+// mapping never sees stale data.
+static int file_store(enhanced_file_entry_t* file, size_t keep, const char* data, size_t size) {
+    size_t total = keep + size;
+    size_t clear = file->size;      // Zero [total, clear) once the data is in
+    uint32_t pages = extent_pages(total);
+    
+    if (total < keep || total >= FS_STORAGE_SIZE) {
+        return -3; // File too large
+    }
+    
+    if (pages > file->pages && file->content != NULL && extent_grow(file, pages)) {
+        clear = (size_t)pages << PAGE_SHIFT;
+    } else if (file->content == NULL || pages > file->pages) {
+        int first = extent_alloc(pages);
+        if (first < 0) {
+            return -3; // Storage full
+        }
+        char* content = (char*)storage + ((size_t)first << PAGE_SHIFT);
+        if (file->content != NULL) {
+            memcpy(content, file->content, keep);
+            extent_free(file->first_page, file->pages);
+        }
+        file->content = content;
+        file->first_page = (uint32_t)first;
+        file->pages = pages;
+        clear = (size_t)pages << PAGE_SHIFT;
+    }
+    
+    if (clear > (size_t)pages << PAGE_SHIFT) {
+        clear = (size_t)pages << PAGE_SHIFT;    // Pages being freed may keep stale data
+    }
+    memcpy(file->content + keep, data, size);
+    if (clear > total) {
+        memset(file->content + total, 0, clear - total);
+    }
+    if (pages < file->pages) {
+        extent_free(file->first_page + pages, file->pages - pages);
+        file->pages = pages;
+    }
+    file->size = total;
+    file->modified_time = get_enhanced_system_time();
+    return 0;
+}
+
+static int find_file(const char* filename) {
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (enhanced_files[i].is_used && strcmp(enhanced_files[i].name, filename) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 void enhanced_fs_init() {
     if (enhanced_fs_initialized) {
         return;
@@ -51,8 +172,11 @@ void enhanced_fs_init() {
     for (int i = 0; i < MAX_FILES; i++) {
         enhanced_files[i].is_used = 0;
         enhanced_files[i].name[0] = '\0';
-        enhanced_files[i].content[0] = '\0';
+        enhanced_files[i].content = NULL;
         enhanced_files[i].size = 0;
+        enhanced_files[i].pages = 0;
+        enhanced_files[i].maps = 0;
+        enhanced_files[i].object = NULL;
         enhanced_files[i].created_time = 0;
         enhanced_files[i].modified_time = 0;
         enhanced_files[i].permissions = 0644; // Default permissions
@@ -79,8 +203,9 @@ void enhanced_fs_init() {
     enhanced_fs_save("system.log", "SAGE OS Enhanced System Log\n===========================\n\nSystem startup completed successfully.\nEnhanced file system initialized.\nPersistent memory storage enabled.\nAdvanced shell commands loaded.\n\nReady for user interaction.\n");
 }
 
-int enhanced_fs_save(const char* filename, const char* content) {
-    if (!filename || !content || strlen(filename) >= MAX_FILENAME) {
+// Create or replace a file with size bytes of data (binary safe)
+int enhanced_fs_write(const char* filename, const char* data, size_t size) {
+    if (!filename || !data || strlen(filename) >= MAX_FILENAME) {
         return -1;
     }
     
@@ -99,13 +224,16 @@ int enhanced_fs_save(const char* filename, const char* content) {
     if (slot == -1) {
         return -2; // No space available
     }
+    if (enhanced_files[slot].maps > 0) {
+        return -4; // File is mapped
+    }
     
     // Save file
+    int result = file_store(&enhanced_files[slot], 0, data, size);
+    if (result != 0) {
+        return result;
+    }
     strcpy(enhanced_files[slot].name, filename);
-    strncpy(enhanced_files[slot].content, content, MAX_FILESIZE - 1);
-    enhanced_files[slot].content[MAX_FILESIZE - 1] = '\0';
-    enhanced_files[slot].size = strlen(enhanced_files[slot].content);
-    enhanced_files[slot].modified_time = get_enhanced_system_time();
     
     if (!enhanced_files[slot].is_used) {
         enhanced_files[slot].created_time = enhanced_files[slot].modified_time;
@@ -115,29 +243,27 @@ int enhanced_fs_save(const char* filename, const char* content) {
     return 0;
 }
 
+int enhanced_fs_save(const char* filename, const char* content) {
+    if (!content) {
+        return -1;
+    }
+    return enhanced_fs_write(filename, content, strlen(content));
+}
+
 int enhanced_fs_append(const char* filename, const char* content) {
     if (!filename || !content || strlen(filename) >= MAX_FILENAME) {
         return -1;
     }
     
-    // Find existing file
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (enhanced_files[i].is_used && strcmp(enhanced_files[i].name, filename) == 0) {
-            size_t current_len = strlen(enhanced_files[i].content);
-            size_t append_len = strlen(content);
-            
-            if (current_len + append_len < MAX_FILESIZE - 1) {
-                strcat(enhanced_files[i].content, content);
-                enhanced_files[i].size = strlen(enhanced_files[i].content);
-                enhanced_files[i].modified_time = get_enhanced_system_time();
-                return 0;
-            } else {
-                return -3; // File too large
-            }
-        }
+    int slot = find_file(filename);
+    if (slot < 0) {
+        return -2; // File not found
+    }
+    if (enhanced_files[slot].maps > 0) {
+        return -4; // File is mapped
     }
     
-    return -2; // File not found
+    return file_store(&enhanced_files[slot], enhanced_files[slot].size, content, strlen(content));
 }
 
 int enhanced_fs_cat(const char* filename, char* buffer, size_t buffer_size) {
@@ -156,17 +282,15 @@ int enhanced_fs_cat(const char* filename, char* buffer, size_t buffer_size) {
     return -2; // File not found
 }
 
-int enhanced_fs_delete_file(const char* filename) {
-    if (!filename) {
+int enhanced_fs_get_file_view(const char* filename, const char** data, size_t* size) {
+    if (!filename || !data || !size) {
         return -1;
     }
     
     for (int i = 0; i < MAX_FILES; i++) {
         if (enhanced_files[i].is_used && strcmp(enhanced_files[i].name, filename) == 0) {
-            enhanced_files[i].is_used = 0;
-            enhanced_files[i].name[0] = '\0';
-            enhanced_files[i].content[0] = '\0';
-            enhanced_files[i].size = 0;
+            *data = enhanced_files[i].content;
+            *size = enhanced_files[i].size;
             return 0;
         }
     }
@@ -174,6 +298,135 @@ int enhanced_fs_delete_file(const char* filename) {
     return -2; // File not found
 }
 
+const char* enhanced_fs_get_file_name(int slot) {
+    if (slot < 0 || slot >= MAX_FILES || !enhanced_files[slot].is_used) {
+        return NULL;
+    }
+    
+    return enhanced_files[slot].name;
+}
+
+int enhanced_fs_delete_file(const char* filename) {
+    if (!filename) {
+        return -1;
+    }
+    
+    int slot = find_file(filename);
+    if (slot < 0) {
+        return -2; // File not found
+    }
+    
+    enhanced_file_entry_t* file = &enhanced_files[slot];
+    if (file->maps > 0) {
+        return -4; // File is mapped
+    }
+    extent_free(file->first_page, file->pages);
+    file->is_used = 0;
+    file->name[0] = '\0';
+    file->content = NULL;
+    file->size = 0;
+    file->pages = 0;
+    return 0;
+}
+
+// Map a file's pages into the current address space, read-only and shared.
+// The file's extent becomes a VM object on its first mapping; every view
+// of the file maps the same frames, so nothing is copied. Without a VMM
+// the view is the extent itself.
+const void* enhanced_fs_mmap(const char* filename, size_t offset, size_t length) {
+    if (!filename || (offset & (PAGE_SIZE - 1)) != 0) {
+        return NULL;
+    }
+    
+    int slot = find_file(filename);
+    if (slot < 0 || offset >= enhanced_files[slot].size) {
+        return NULL;
+    }
+    
+    enhanced_file_entry_t* file = &enhanced_files[slot];
+    if (length == 0) {
+        length = file->size - offset;
+    }
+    if (length > file->size - offset) {
+        return NULL;
+    }
+    
+    file_mapping_t* mapping = NULL;
+    for (int i = 0; i < MAX_MAPPINGS; i++) {
+        if (!mappings[i].used) {
+            mapping = &mappings[i];
+            break;
+        }
+    }
+    if (mapping == NULL) {
+        return NULL;
+    }
+    
+    uint64_t addr = (uint64_t)(uintptr_t)(file->content + offset);
+    uint64_t size = ((uint64_t)length + PAGE_SIZE - 1) & ~(uint64_t)(PAGE_SIZE - 1);
+    vmm_space_t* space = NULL;
+    
+    if (vmm_enabled()) {
+        if (file->object == NULL) {
+            uint64_t extent = (uint64_t)(uintptr_t)file->content;
+            uint64_t extent_size = (uint64_t)file->pages << PAGE_SHIFT;
+            file->object = vmm_object_create(extent_size, NULL, NULL);
+            if (file->object == NULL) {
+                return NULL;
+            }
+            for (uint64_t page = 0; page < extent_size; page += PAGE_SIZE) {
+                if (vmm_object_insert(file->object, page, extent + page) != VMM_SUCCESS) {
+                    vmm_object_put(file->object);
+                    file->object = NULL;
+                    return NULL;
+                }
+            }
+        }
+        
+        space = vmm_current();
+        uint64_t view = 0;
+        if (vmm_map_object(space, &view, size, VMM_PROT_READ, VMM_MAP_SHARED | VMM_MAP_POPULATE,
+                           file->object, offset) != VMM_SUCCESS) {
+            if (file->maps == 0) {
+                vmm_object_put(file->object);
+                file->object = NULL;
+            }
+            return NULL;
+        }
+        addr = view;
+    }
+    
+    mapping->used = 1;
+    mapping->slot = slot;
+    mapping->addr = addr;
+    mapping->size = size;
+    mapping->space = space;
+    file->maps++;
+    return (const void*)(uintptr_t)addr;
+}
+
+int enhanced_fs_munmap(const void* addr) {
+    for (int i = 0; i < MAX_MAPPINGS; i++) {
+        file_mapping_t* mapping = &mappings[i];
+        if (!mapping->used || mapping->addr != (uint64_t)(uintptr_t)addr) {
+            continue;
+        }
+        
+        enhanced_file_entry_t* file = &enhanced_files[mapping->slot];
+        if (mapping->space != NULL) {
+            vmm_unmap(mapping->space, mapping->addr, mapping->size);
+        }
+        mapping->used = 0;
+        if (--file->maps == 0 && file->object != NULL) {
+            vmm_object_put(file->object);
+            file->object = NULL;
+        }
+        return 0;
+    }
+    
+    return -2; // Not a mapping
+}
+
 int enhanced_fs_list_files(char* buffer, size_t buffer_size) {
     if (!buffer || buffer_size == 0) {
         return -1;
@@ -234,7 +487,13 @@ void enhanced_fs_get_memory_info(uint32_t* total_files, uint32_t* memory_used, u
     
     if (total_files) *total_files = used_files;
     if (memory_used) *memory_used = used_memory;
-    if (memory_available) *memory_available = (MAX_FILES * MAX_FILESIZE) - used_memory;
+    if (memory_available) {
+        uint32_t free_pages = 0;
+        for (uint32_t i = 0; i < FS_STORAGE_PAGES; i++) {
+            free_pages += !page_used[i];
+        }
+        *memory_available = free_pages << PAGE_SHIFT;
+    }
 }
 
 // Wrapper functions to maintain compatibility with existing filesystem interface
@@ -254,6 +513,26 @@ int fs_cat(const char* filename, char* buffer, size_t buffer_size) {
     return enhanced_fs_cat(filename, buffer, buffer_size);
 }
 
+int fs_write_file(const char* filename, const char* content, size_t size) {
+    return enhanced_fs_write(filename, content, size);
+}
+
+int fs_get_file_view(const char* filename, const char** data, size_t* size) {
+    return enhanced_fs_get_file_view(filename, data, size);
+}
+
+const void* fs_mmap(const char* filename, size_t offset, size_t length) {
+    return enhanced_fs_mmap(filename, offset, length);
+}
+
+int fs_munmap(const void* addr) {
+    return enhanced_fs_munmap(addr);
+}
+
+const char* fs_get_file_name(int slot) {
+    return enhanced_fs_get_file_name(slot);
+}
+
 int fs_delete_file(const char* filename) {
     return enhanced_fs_delete_file(filename);
 }
@@ -13,6 +13,20 @@
 #include "stdio.h"
 #include "utils.h"
 #include "filesystem.h"
+#include "shell_args.h"
+#include "shell_cmd.h"
+#include "shell_io.h"
+#include "kbench.h"
+#include "timer.h"
+#include "textsearch.h"
+#include "ai/ai_subsystem.h"
+#include "ai/ai_residency.h"
+#include "ai/ai_profiler.h"
+#include "../drivers/ai_hat/ai_hat_emu.h"
+#include "crc32.h"
+#include "mmu.h"
+#include "vmm.h"
+#include "smp.h"
 
 #define MAX_COMMAND_LENGTH 256
 #define MAX_ARGS 16
@@ -26,15 +40,6 @@ static char history[HISTORY_SIZE][MAX_COMMAND_LENGTH];
 static int history_count = 0;
 static int history_index = 0;
 
-// Built-in commands
-typedef void (*command_func_t)(int argc, char* argv[]);
-
-typedef struct {
-    const char* name;
-    const char* description;
-    command_func_t func;
-} command_t;
-
 // Forward declarations of command functions
 static void cmd_help(int argc, char* argv[]);
 static void cmd_echo(int argc, char* argv[]);
@@ -57,9 +62,17 @@ static void cmd_find(int argc, char* argv[]);
 static void cmd_grep(int argc, char* argv[]);
 static void cmd_wc(int argc, char* argv[]);
 static void cmd_history(int argc, char* argv[]);
+static void cmd_source(int argc, char* argv[]);
+static void cmd_bench(int argc, char* argv[]);
+static void cmd_models(int argc, char* argv[]);
+static void cmd_aiprof(int argc, char* argv[]);
+static void cmd_aistat(int argc, char* argv[]);
+static void cmd_aipower(int argc, char* argv[]);
+static void cmd_aiemu(int argc, char* argv[]);
+static void cmd_vmstat(int argc, char* argv[]);
 
 // Command table
-static const command_t commands[] = {
+static const shell_command_t commands[] = {
     {"help",     "Display available commands",           cmd_help},
     {"echo",     "Echo text to the console",             cmd_echo},
     {"clear",    "Clear the screen",                     cmd_clear},
@@ -78,12 +91,23 @@ static const command_t commands[] = {
     {"cp",       "Copy file",                            cmd_cp},
     {"mv",       "Move/rename file",                     cmd_mv},
     {"find",     "Find files by name",                   cmd_find},
-    {"grep",     "Search text in files",                 cmd_grep},
+    {"grep",     "Search text in files (-E regex, -c)",  cmd_grep},
     {"wc",       "Count lines, words, characters",       cmd_wc},
     {"history",  "Show command history",                 cmd_history},
+    {"source",   "Run commands from a script file",      cmd_source},
+    {"bench",    "Run kernel benchmarks (bench [suite])", cmd_bench},
+    {"models",   "List, load or unload AI HAT+ models",  cmd_models},
+    {"aiprof",   "Per-kernel CPU or split model profile (aiprof <id> [reset])", cmd_aiprof},
+    {"aistat",   "AI inference latency statistics (aistat [id|reset|dump])", cmd_aistat},
+    {"aipower",  "AI HAT+ power policy (aipower [throughput|latency|energy <mW>|mode <0-4>])", cmd_aipower},
+    {"aiemu",    "Emulated AI HAT+ (aiemu [on|link <MHz> <us>|memory <KB>|faults <nack> <timeout> <crc>])", cmd_aiemu},
+    {"vmstat",   "MMU, cache and virtual memory state, kernel memory map", cmd_vmstat},
     {NULL, NULL, NULL}  // Terminator
 };
 
+// Hashed lookup over commands[] plus driver-registered commands
+static shell_cmd_table_t command_table = SHELL_CMD_TABLE_INIT(commands);
+
 // Initialize the enhanced shell
 void enhanced_shell_init() {
     // Initialize file system
@@ -97,40 +121,6 @@ void enhanced_shell_init() {
     fs_save("system.log", "SAGE OS System Log\n================\nSystem started successfully.\nFile system initialized.\n");
 }
 
-// Split a command into arguments
-static int split_args(char* command, char* argv[], int max_args) {
-    int argc = 0;
-    char* token = command;
-    char* end = command + strlen(command);
-    
-    // Skip leading whitespace
-    while (*token && (*token == ' ' || *token == '\t')) {
-        token++;
-    }
-    
-    while (token < end && argc < max_args) {
-        // Mark the start of the argument
-        argv[argc++] = token;
-        
-        // Find the end of the argument
-        while (*token && *token != ' ' && *token != '\t') {
-            token++;
-        }
-        
-        // Null-terminate the argument
-        if (*token) {
-            *token++ = '\0';
-        }
-        
-        // Skip whitespace to the next argument
-        while (*token && (*token == ' ' || *token == '\t')) {
-            token++;
-        }
-    }
-    
-    return argc;
-}
-
 // Add a command to history
 static void add_to_history(const char* command) {
     if (strlen(command) == 0) {
@@ -138,7 +128,7 @@ static void add_to_history(const char* command) {
     }
     
     // Check if this command is the same as the last one
-    if (history_count > 0 && strcmp(command, history[(history_index - 1) % HISTORY_SIZE]) == 0) {
+    if (history_count > 0 && strcmp(command, history[(history_index + HISTORY_SIZE - 1) % HISTORY_SIZE]) == 0) {
         return;  // Don't add duplicate commands consecutively
     }
     
@@ -151,29 +141,21 @@ static void add_to_history(const char* command) {
     }
 }
 
-// Process a command
-void enhanced_shell_process_command(const char* command) {
-    char cmd_copy[MAX_COMMAND_LENGTH];
-    strncpy(cmd_copy, command, MAX_COMMAND_LENGTH - 1);
-    cmd_copy[MAX_COMMAND_LENGTH - 1] = '\0';
-    
-    // Add to history
-    add_to_history(cmd_copy);
-    
+// Execute a single command (one pipeline stage)
+static void execute_command(char* command) {
     // Split into arguments
     char* argv[MAX_ARGS];
-    int argc = split_args(cmd_copy, argv, MAX_ARGS);
+    int argc = shell_split_args(command, argv, MAX_ARGS);
     
     if (argc == 0) {
         return;  // Empty command
     }
     
     // Find and execute the command
-    for (int i = 0; commands[i].name != NULL; i++) {
-        if (strcmp(argv[0], commands[i].name) == 0) {
-            commands[i].func(argc, argv);
-            return;
-        }
+    const shell_command_t* cmd = shell_cmd_lookup(&command_table, argv[0]);
+    if (cmd != NULL) {
+        cmd->func(argc, argv);
+        return;
     }
     
     // Command not found
@@ -183,6 +165,19 @@ void enhanced_shell_process_command(const char* command) {
     serial_puts("Type 'help' for a list of commands\n");
 }
 
+// Process a command line, which may be a pipeline
+void enhanced_shell_process_command(const char* command) {
+    // Add to history
+    add_to_history(command);
+    
+    int result = shell_exec_line(command, execute_command);
+    if (result == SHELL_IO_ERROR_STAGES) {
+        serial_puts("Invalid pipeline\n");
+    } else if (result == SHELL_IO_ERROR_NESTED) {
+        serial_puts("Pipelines cannot be nested\n");
+    }
+}
+
 // Run the enhanced shell (main loop)
 void enhanced_shell_run() {
     char command[MAX_COMMAND_LENGTH];
@@ -191,6 +186,9 @@ void enhanced_shell_run() {
     serial_puts("\n=== SAGE OS Enhanced Shell ===\n");
     serial_puts("Type 'help' for available commands\n\n");
     
+    // Batch mode: run the autorun script if one has been stored
+    shell_run_script(SHELL_AUTORUN_SCRIPT, execute_command);
+    
     while (1) {
         // Display prompt
         serial_puts(PROMPT);
@@ -201,7 +199,7 @@ void enhanced_shell_run() {
         
         // Read command
         while (1) {
-            char c = uart_getc();
+            char c = shell_in_getc();
             
             if (c == '\r' || c == '\n') {
                 // End of command
@@ -232,43 +230,49 @@ void enhanced_shell_run() {
 static void cmd_help(int argc, char* argv[]) {
     (void)argc; (void)argv; // Suppress unused parameter warnings
     
-    serial_puts("SAGE OS Enhanced Shell - Available Commands:\n");
-    serial_puts("==========================================\n\n");
+    shell_out_puts("SAGE OS Enhanced Shell - Available Commands:\n");
+    shell_out_puts("==========================================\n\n");
     
-    for (int i = 0; commands[i].name != NULL; i++) {
+    const shell_command_t* cmd;
+    for (uint32_t i = 0; (cmd = shell_cmd_at(&command_table, i)) != NULL; i++) {
         char help_line[256];
-        sprintf(help_line, "  %-12s - %s\n", commands[i].name, commands[i].description);
-        serial_puts(help_line);
+        sprintf(help_line, "  %-12s - %s\n", cmd->name, cmd->description);
+        shell_out_puts(help_line);
     }
     
-    serial_puts("\nFile Management Examples:\n");
-    serial_puts("  save test.txt Hello World    - Save text to file\n");
-    serial_puts("  cat test.txt                 - Display file contents\n");
-    serial_puts("  append test.txt More text    - Append to file\n");
-    serial_puts("  rm test.txt                  - Delete file\n");
-    serial_puts("  cp test.txt backup.txt       - Copy file\n");
-    serial_puts("  ls                           - List all files\n");
+    shell_out_puts("\nFile Management Examples:\n");
+    shell_out_puts("  save test.txt Hello World    - Save text to file\n");
+    shell_out_puts("  cat test.txt                 - Display file contents\n");
+    shell_out_puts("  append test.txt More text    - Append to file\n");
+    shell_out_puts("  rm test.txt                  - Delete file\n");
+    shell_out_puts("  cp test.txt backup.txt       - Copy file\n");
+    shell_out_puts("  ls                           - List all files\n");
+    
+    shell_out_puts("\nScripting Examples:\n");
+    shell_out_puts("  cat system.log | grep error | wc - Pipe output between commands\n");
+    shell_out_puts("  source setup.sh              - Run commands from a file\n");
+    shell_out_puts("  (autorun.sh runs at startup when present)\n");
 }
 
 static void cmd_echo(int argc, char* argv[]) {
     for (int i = 1; i < argc; i++) {
-        serial_puts(argv[i]);
+        shell_out_puts(argv[i]);
         if (i < argc - 1) {
-            serial_putc(' ');
+            shell_out_putc(' ');
         }
     }
-    serial_putc('\n');
+    shell_out_putc('\n');
 }
 
 static void cmd_clear(int argc, char* argv[]) {
     (void)argc; (void)argv; // Suppress unused parameter warnings
     
     // Clear screen (ANSI escape sequence)
-    serial_puts("\033[2J\033[H");
+    shell_out_puts("\033[2J\033[H");
     // Also clear VGA if available
     vga_init();
-    serial_puts("SAGE OS Enhanced Shell - Screen Cleared\n");
-    serial_puts("Type 'help' for available commands.\n");
+    shell_out_puts("SAGE OS Enhanced Shell - Screen Cleared\n");
+    shell_out_puts("Type 'help' for available commands.\n");
 }
 
 static void cmd_meminfo(int argc, char* argv[]) {
@@ -280,20 +284,20 @@ static void cmd_meminfo(int argc, char* argv[]) {
     uint32_t total_files, memory_used, memory_available;
     fs_get_memory_info(&total_files, &memory_used, &memory_available);
     
-    serial_puts("\nFile System Memory:\n");
+    shell_out_puts("\nFile System Memory:\n");
     char buffer[256];
     sprintf(buffer, "  Total Files: %u\n", total_files);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
     sprintf(buffer, "  Memory Used: %u bytes\n", memory_used);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
     sprintf(buffer, "  Memory Available: %u bytes\n", memory_available);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
 }
 
 static void cmd_reboot(int argc, char* argv[]) {
     (void)argc; (void)argv; // Suppress unused parameter warnings
     
-    serial_puts("Rebooting SAGE OS...\n");
+    shell_out_puts("Rebooting SAGE OS...\n");
     
     // For i386, use keyboard controller reset
     #if defined(__i386__) || defined(__x86_64__)
@@ -314,35 +318,35 @@ static void cmd_reboot(int argc, char* argv[]) {
 static void cmd_version(int argc, char* argv[]) {
     (void)argc; (void)argv; // Suppress unused parameter warnings
     
-    serial_puts("SAGE OS Enhanced Shell v1.0.1\n");
-    serial_puts("Self-Aware General Environment Operating System\n");
-    serial_puts("Copyright (c) 2025 Ashish Vasant Yesale\n");
-    serial_puts("Designed by Ashish Yesale (ashishyesale007@gmail.com)\n");
-    serial_puts("\nFeatures:\n");
-    serial_puts("- Enhanced file management with persistent storage\n");
-    serial_puts("- Advanced shell commands (cp, mv, find, grep, wc)\n");
-    serial_puts("- Command history\n");
-    serial_puts("- VGA graphics support\n");
-    serial_puts("- Multi-architecture support (i386, x86_64, ARM64)\n");
-    
-    serial_puts("\nArchitecture: ");
+    shell_out_puts("SAGE OS Enhanced Shell v1.0.1\n");
+    shell_out_puts("Self-Aware General Environment Operating System\n");
+    shell_out_puts("Copyright (c) 2025 Ashish Vasant Yesale\n");
+    shell_out_puts("Designed by Ashish Yesale (ashishyesale007@gmail.com)\n");
+    shell_out_puts("\nFeatures:\n");
+    shell_out_puts("- Enhanced file management with persistent storage\n");
+    shell_out_puts("- Advanced shell commands (cp, mv, find, grep, wc)\n");
+    shell_out_puts("- Command history\n");
+    shell_out_puts("- VGA graphics support\n");
+    shell_out_puts("- Multi-architecture support (i386, x86_64, ARM64)\n");
+    
+    shell_out_puts("\nArchitecture: ");
     #if defined(__i386__)
-    serial_puts("i386 (32-bit x86)");
+    shell_out_puts("i386 (32-bit x86)");
     #elif defined(__x86_64__)
-    serial_puts("x86_64 (64-bit x86)");
+    shell_out_puts("x86_64 (64-bit x86)");
     #elif defined(__aarch64__)
-    serial_puts("aarch64 (64-bit ARM)");
+    shell_out_puts("aarch64 (64-bit ARM)");
     #else
-    serial_puts("unknown");
+    shell_out_puts("unknown");
     #endif
-    serial_puts("\n");
+    shell_out_puts("\n");
 }
 
 static void cmd_exit(int argc, char* argv[]) {
     (void)argc; (void)argv; // Suppress unused parameter warnings
     
-    serial_puts("Shutting down SAGE OS Enhanced Shell...\n");
-    serial_puts("Thank you for using SAGE OS!\n");
+    shell_out_puts("Shutting down SAGE OS Enhanced Shell...\n");
+    shell_out_puts("Thank you for using SAGE OS!\n");
     
     // Exit QEMU
     #if defined(__i386__) || defined(__x86_64__)
@@ -362,9 +366,9 @@ static void cmd_ls(int argc, char* argv[]) {
     int file_count = fs_list_files(buffer, sizeof(buffer));
     
     if (file_count >= 0) {
-        serial_puts(buffer);
+        shell_out_puts(buffer);
     } else {
-        serial_puts("Error listing files\n");
+        shell_out_puts("Error listing files\n");
     }
 }
 
@@ -373,12 +377,12 @@ static void cmd_pwd(int argc, char* argv[]) {
     
     char current_dir[256];
     fs_get_current_directory(current_dir, sizeof(current_dir));
-    serial_printf("Current directory: %s\n", current_dir);
+    shell_out_printf("Current directory: %s\n", current_dir);
 }
 
 static void cmd_mkdir(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: mkdir <directory_name>\n");
+        shell_out_puts("Usage: mkdir <directory_name>\n");
         return;
     }
     
@@ -388,48 +392,50 @@ static void cmd_mkdir(int argc, char* argv[]) {
     
     int result = fs_save(marker_name, "Directory marker file");
     if (result == 0) {
-        serial_printf("Directory '%s' created successfully\n", argv[1]);
+        shell_out_printf("Directory '%s' created successfully\n", argv[1]);
     } else {
-        serial_printf("Failed to create directory '%s'\n", argv[1]);
+        shell_out_printf("Failed to create directory '%s'\n", argv[1]);
     }
 }
 
 static void cmd_touch(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: touch <filename>\n");
+        shell_out_puts("Usage: touch <filename>\n");
         return;
     }
     
     int result = fs_save(argv[1], "");
     if (result == 0) {
-        serial_printf("File '%s' created successfully\n", argv[1]);
+        shell_out_printf("File '%s' created successfully\n", argv[1]);
     } else {
-        serial_printf("Failed to create file '%s'\n", argv[1]);
+        shell_out_printf("Failed to create file '%s'\n", argv[1]);
     }
 }
 
 static void cmd_cat(int argc, char* argv[]) {
+    const char* data;
+    size_t size;
+    
     if (argc < 2) {
-        serial_puts("Usage: cat <filename>\n");
+        // Pass piped input through unchanged
+        if (shell_in_get(&data, &size)) {
+            shell_out_view(data, size);
+        } else {
+            shell_out_puts("Usage: cat <filename>\n");
+        }
         return;
     }
     
-    char content[MAX_FILESIZE];
-    int result = fs_cat(argv[1], content, sizeof(content));
-    
-    if (result >= 0) {
-        serial_puts(content);
-        if (strlen(content) > 0 && content[strlen(content) - 1] != '\n') {
-            serial_puts("\n");
-        }
+    if (fs_get_file_view(argv[1], &data, &size) == 0) {
+        shell_out_file_view(data, size);
     } else {
-        serial_printf("File '%s' not found or error reading file\n", argv[1]);
+        shell_out_printf("File '%s' not found or error reading file\n", argv[1]);
     }
 }
 
 static void cmd_save(int argc, char* argv[]) {
     if (argc < 3) {
-        serial_puts("Usage: save <filename> <content>\n");
+        shell_out_puts("Usage: save <filename> <content>\n");
         return;
     }
     
@@ -446,15 +452,15 @@ static void cmd_save(int argc, char* argv[]) {
     
     int result = fs_save(argv[1], content);
     if (result == 0) {
-        serial_printf("Content saved to '%s' successfully\n", argv[1]);
+        shell_out_printf("Content saved to '%s' successfully\n", argv[1]);
     } else {
-        serial_printf("Failed to save content to '%s'\n", argv[1]);
+        shell_out_printf("Failed to save content to '%s'\n", argv[1]);
     }
 }
 
 static void cmd_append(int argc, char* argv[]) {
     if (argc < 3) {
-        serial_puts("Usage: append <filename> <content>\n");
+        shell_out_puts("Usage: append <filename> <content>\n");
         return;
     }
     
@@ -471,29 +477,29 @@ static void cmd_append(int argc, char* argv[]) {
     
     int result = fs_append(argv[1], content);
     if (result == 0) {
-        serial_printf("Content appended to '%s' successfully\n", argv[1]);
+        shell_out_printf("Content appended to '%s' successfully\n", argv[1]);
     } else {
-        serial_printf("Failed to append content to '%s'\n", argv[1]);
+        shell_out_printf("Failed to append content to '%s'\n", argv[1]);
     }
 }
 
 static void cmd_rm(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: rm <filename>\n");
+        shell_out_puts("Usage: rm <filename>\n");
         return;
     }
     
     int result = fs_delete_file(argv[1]);
     if (result == 0) {
-        serial_printf("File '%s' deleted successfully\n", argv[1]);
+        shell_out_printf("File '%s' deleted successfully\n", argv[1]);
     } else {
-        serial_printf("Failed to delete file '%s' (file not found)\n", argv[1]);
+        shell_out_printf("Failed to delete file '%s' (file not found)\n", argv[1]);
     }
 }
 
 static void cmd_cp(int argc, char* argv[]) {
     if (argc < 3) {
-        serial_puts("Usage: cp <source> <destination>\n");
+        shell_out_puts("Usage: cp <source> <destination>\n");
         return;
     }
     
@@ -503,18 +509,18 @@ static void cmd_cp(int argc, char* argv[]) {
     if (result >= 0) {
         result = fs_save(argv[2], content);
         if (result == 0) {
-            serial_printf("File copied from '%s' to '%s' successfully\n", argv[1], argv[2]);
+            shell_out_printf("File copied from '%s' to '%s' successfully\n", argv[1], argv[2]);
         } else {
-            serial_printf("Failed to copy file to '%s'\n", argv[2]);
+            shell_out_printf("Failed to copy file to '%s'\n", argv[2]);
         }
     } else {
-        serial_printf("Source file '%s' not found\n", argv[1]);
+        shell_out_printf("Source file '%s' not found\n", argv[1]);
     }
 }
 
 static void cmd_mv(int argc, char* argv[]) {
     if (argc < 3) {
-        serial_puts("Usage: mv <source> <destination>\n");
+        shell_out_puts("Usage: mv <source> <destination>\n");
         return;
     }
     
@@ -525,37 +531,77 @@ static void cmd_mv(int argc, char* argv[]) {
         result = fs_save(argv[2], content);
         if (result == 0) {
             fs_delete_file(argv[1]);
-            serial_printf("File moved from '%s' to '%s' successfully\n", argv[1], argv[2]);
+            shell_out_printf("File moved from '%s' to '%s' successfully\n", argv[1], argv[2]);
         } else {
-            serial_printf("Failed to move file to '%s'\n", argv[2]);
+            shell_out_printf("Failed to move file to '%s'\n", argv[2]);
         }
     } else {
-        serial_printf("Source file '%s' not found\n", argv[1]);
+        shell_out_printf("Source file '%s' not found\n", argv[1]);
+    }
+}
+
+// Print scan statistics to the console; kept out of pipes like other diagnostics
+static void report_throughput(const char* command, uint32_t files, uint64_t bytes, uint64_t ticks) {
+    char line[128];
+    uint64_t ns = timer_ticks_to_ns(ticks);
+    uint32_t centi_mbps = (uint32_t)timer_div64(bytes * 100000, ns ? ns : 1);
+    
+    sprintf(line, "%s: %u files, %u bytes, %u.%u%u MB/s\n", command, files, (uint32_t)bytes,
+            centi_mbps / 100, (centi_mbps / 10) % 10, centi_mbps % 10);
+    serial_puts(line);
+}
+
+// Parse leading -E / -c style flags; returns the index of the first operand
+static int parse_search_flags(int argc, char* argv[], int* flags, int* count_only) {
+    int i = 1;
+    
+    while (i < argc && argv[i][0] == '-') {
+        if (strcmp(argv[i], "-E") == 0) {
+            *flags |= TS_FLAG_REGEX;
+        } else if (count_only != NULL && strcmp(argv[i], "-c") == 0) {
+            *count_only = 1;
+        } else {
+            break;
+        }
+        i++;
     }
+    
+    return i;
+}
+
+static int compile_search_pattern(ts_pattern_t* pattern, const char* text, int flags) {
+    int result = ts_compile(pattern, text, flags);
+    
+    if (result == TS_ERROR_LENGTH) {
+        serial_puts("Pattern too long\n");
+    } else if (result != 0) {
+        serial_puts("Invalid pattern\n");
+    }
+    
+    return result;
 }
 
 static void cmd_find(int argc, char* argv[]) {
-    if (argc < 2) {
-        serial_puts("Usage: find <pattern>\n");
+    ts_pattern_t pattern;
+    int flags = 0;
+    int i = parse_search_flags(argc, argv, &flags, NULL);
+    
+    if (i >= argc) {
+        shell_out_puts("Usage: find [-E] <pattern>\n");
         return;
     }
     
-    // Simple implementation - list files containing the pattern in name
-    char buffer[2048];
-    fs_list_files(buffer, sizeof(buffer));
-    
-    serial_printf("Files matching pattern '%s':\n", argv[1]);
+    if (compile_search_pattern(&pattern, argv[i], flags) != 0) {
+        return;
+    }
     
-    // Parse the file list and find matches
-    char* line = strtok(buffer, "\n");
     int found = 0;
-    
-    while (line != NULL) {
-        if (strstr(line, argv[1]) != NULL) {
-            serial_printf("  %s\n", line);
+    for (int slot = 0; slot < MAX_FILES; slot++) {
+        const char* name = fs_get_file_name(slot);
+        if (name != NULL && ts_match(&pattern, name, strlen(name))) {
+            shell_out_printf("%s\n", name);
             found++;
         }
-        line = strtok(NULL, "\n");
     }
     
     if (found == 0) {
@@ -563,84 +609,772 @@ static void cmd_find(int argc, char* argv[]) {
     }
 }
 
+// How matching lines of one source are printed
+typedef struct {
+    const char* filename;   // Prefix each line with "name:", or NULL
+    int numbered;
+} grep_output_t;
+
+static int grep_print_line(const char* line, size_t len, uint32_t line_num, void* ctx) {
+    grep_output_t* output = (grep_output_t*)ctx;
+    
+    if (output->filename != NULL) {
+        shell_out_printf("%s:", output->filename);
+    }
+    if (output->numbered) {
+        shell_out_printf("%u: ", line_num);
+    }
+    shell_out_write(line, len);
+    shell_out_putc('\n');
+    
+    return 0;
+}
+
+// Stream one file (or piped input) through the matcher in chunks
+static uint32_t grep_source(const ts_pattern_t* pattern, const char* data, size_t size,
+                            grep_output_t* output, int count_only) {
+    ts_stream_t stream;
+    
+    ts_stream_init(&stream, pattern, count_only ? NULL : grep_print_line, output);
+    
+    for (size_t pos = 0; pos < size; pos += TS_CHUNK_SIZE) {
+        size_t len = size - pos < TS_CHUNK_SIZE ? size - pos : TS_CHUNK_SIZE;
+        ts_stream_feed(&stream, data + pos, len);
+    }
+    ts_stream_finish(&stream);
+    
+    if (count_only) {
+        if (output->filename != NULL) {
+            shell_out_printf("%s:", output->filename);
+        }
+        shell_out_printf("%u\n", stream.matches);
+    }
+    
+    return stream.matches;
+}
+
 static void cmd_grep(int argc, char* argv[]) {
-    if (argc < 3) {
-        serial_puts("Usage: grep <pattern> <filename>\n");
+    ts_pattern_t pattern;
+    grep_output_t output;
+    const char* data;
+    size_t size;
+    int flags = 0;
+    int count_only = 0;
+    int i = parse_search_flags(argc, argv, &flags, &count_only);
+    
+    if (i >= argc) {
+        shell_out_puts("Usage: grep [-E] [-c] <pattern> [file...]\n");
         return;
     }
     
-    char content[MAX_FILESIZE];
-    int result = fs_cat(argv[2], content, sizeof(content));
+    if (compile_search_pattern(&pattern, argv[i], flags) != 0) {
+        return;
+    }
+    i++;
     
-    if (result >= 0) {
-        serial_printf("Lines in '%s' containing '%s':\n", argv[2], argv[1]);
-        
-        char* line = strtok(content, "\n");
-        int line_num = 1;
-        int found = 0;
-        
-        while (line != NULL) {
-            if (strstr(line, argv[1]) != NULL) {
-                serial_printf("%d: %s\n", line_num, line);
-                found++;
+    uint32_t matches = 0;
+    uint32_t files = 0;
+    uint64_t bytes = 0;
+    uint64_t start = timer_ticks();
+    
+    if (i == argc && shell_in_get(&data, &size)) {
+        // Piped input: plain lines, like the stage before produced them
+        output.filename = NULL;
+        output.numbered = 0;
+        matches = grep_source(&pattern, data, size, &output, count_only);
+        bytes = size;
+    } else if (i == argc) {
+        // No files given: search every file in the file system
+        output.numbered = 1;
+        for (int slot = 0; slot < MAX_FILES; slot++) {
+            output.filename = fs_get_file_name(slot);
+            if (output.filename != NULL && fs_get_file_view(output.filename, &data, &size) == 0) {
+                matches += grep_source(&pattern, data, size, &output, count_only);
+                bytes += size;
+                files++;
             }
-            line = strtok(NULL, "\n");
-            line_num++;
-        }
-        
-        if (found == 0) {
-            serial_puts("Pattern not found in file\n");
         }
     } else {
-        serial_printf("File '%s' not found\n", argv[2]);
+        output.numbered = 1;
+        for (; i < argc; i++) {
+            if (fs_get_file_view(argv[i], &data, &size) != 0) {
+                shell_out_printf("File '%s' not found\n", argv[i]);
+                continue;
+            }
+            output.filename = (argc - i > 1 || files > 0) ? argv[i] : NULL;
+            matches += grep_source(&pattern, data, size, &output, count_only);
+            bytes += size;
+            files++;
+        }
     }
+    
+    if (matches == 0) {
+        serial_puts("No matches found\n");
+    }
+    report_throughput("grep", files, bytes, timer_ticks() - start);
 }
 
 static void cmd_wc(int argc, char* argv[]) {
+    ts_wc_t counts;
+    ts_wc_t total;
+    const char* data;
+    size_t size;
+    
     if (argc < 2) {
-        serial_puts("Usage: wc <filename>\n");
+        if (!shell_in_get(&data, &size)) {
+            shell_out_puts("Usage: wc <filename> [file...]\n");
+            return;
+        }
+        ts_wc_init(&counts);
+        ts_wc_feed(&counts, data, size);
+        shell_out_printf("  %u  %u  %u\n", counts.lines, counts.words, (uint32_t)counts.bytes);
         return;
     }
     
-    char content[MAX_FILESIZE];
-    int result = fs_cat(argv[1], content, sizeof(content));
+    uint32_t files = 0;
+    uint64_t start = timer_ticks();
+    ts_wc_init(&total);
     
-    if (result >= 0) {
-        int lines = 0, words = 0, chars = strlen(content);
-        int in_word = 0;
-        
-        for (int i = 0; content[i]; i++) {
-            if (content[i] == '\n') {
-                lines++;
-            }
-            
-            if (content[i] == ' ' || content[i] == '\t' || content[i] == '\n') {
-                in_word = 0;
-            } else if (!in_word) {
-                in_word = 1;
-                words++;
-            }
+    for (int i = 1; i < argc; i++) {
+        if (fs_get_file_view(argv[i], &data, &size) != 0) {
+            shell_out_printf("File '%s' not found\n", argv[i]);
+            continue;
         }
         
-        serial_printf("  %d  %d  %d %s\n", lines, words, chars, argv[1]);
-    } else {
-        serial_printf("File '%s' not found\n", argv[1]);
+        ts_wc_init(&counts);
+        ts_wc_feed(&counts, data, size);
+        shell_out_printf("  %u  %u  %u %s\n", counts.lines, counts.words, (uint32_t)counts.bytes, argv[i]);
+        
+        total.lines += counts.lines;
+        total.words += counts.words;
+        total.bytes += counts.bytes;
+        files++;
     }
+    
+    if (files > 1) {
+        shell_out_printf("  %u  %u  %u total\n", total.lines, total.words, (uint32_t)total.bytes);
+    }
+    
+    report_throughput("wc", files, total.bytes, timer_ticks() - start);
 }
 
 static void cmd_history(int argc, char* argv[]) {
     (void)argc; (void)argv; // Suppress unused parameter warnings
     
-    serial_puts("Command History:\n");
+    shell_out_puts("Command History:\n");
     
     if (history_count == 0) {
-        serial_puts("No commands in history\n");
+        shell_out_puts("No commands in history\n");
         return;
     }
     
     int start = (history_count < HISTORY_SIZE) ? 0 : history_index;
     for (int i = 0; i < history_count; i++) {
         int idx = (start + i) % HISTORY_SIZE;
-        serial_printf("%3d  %s\n", i + 1, history[idx]);
+        shell_out_printf("%3d  %s\n", i + 1, history[idx]);
     }
-}
\ No newline at end of file
+}
+
+// Run in-kernel benchmarks
+static void cmd_bench(int argc, char* argv[]) {
+    const char* suite = (argc > 1) ? argv[1] : "all";
+    
+    if (kbench_run(suite) != 0) {
+        shell_out_puts("Usage: bench [all|mem|ctx|irq|fs|uart|ai|spi|cpu|vm|pages]\n");
+    }
+}
+
+// Run commands from a script file
+static void cmd_source(int argc, char* argv[]) {
+    if (argc < 2) {
+        shell_out_puts("Usage: source <filename>\n");
+        return;
+    }
+    
+    int result = shell_run_script(argv[1], execute_command);
+    if (result == SHELL_IO_ERROR_NOT_FOUND) {
+        shell_out_printf("Script '%s' not found\n", argv[1]);
+    } else if (result == SHELL_IO_ERROR_DEPTH) {
+        shell_out_puts("Scripts nested too deeply\n");
+    }
+}
+
+// Decimal argument, or -1 if it is not a number
+static int32_t parse_number(const char* text) {
+    int32_t value = 0;
+    
+    if (*text == '\0') {
+        return -1;
+    }
+    
+    for (; *text; text++) {
+        if (*text < '0' || *text > '9' || value > 100000) {
+            return -1;
+        }
+        value = value * 10 + (*text - '0');
+    }
+    
+    return value;
+}
+
+static const char* backend_name(ai_backend_t backend) {
+    switch (backend) {
+        case AI_BACKEND_CPU:
+            return "cpu";
+        case AI_BACKEND_SPLIT:
+            return "split";
+        default:
+            return "hat";
+    }
+}
+
+// Bytes per second over a span of microseconds, as "X.YY MB/s"
+static void format_rate(char* out, uint64_t bytes, uint64_t us) {
+    uint32_t centi_mbps = (uint32_t)timer_div64(bytes * 100, us ? us : 1);
+    sprintf(out, "%u.%u%u MB/s", centi_mbps / 100, (centi_mbps / 10) % 10, centi_mbps % 10);
+}
+
+// File view a background upload reads from, held until the upload ends
+static const void* upload_view = NULL;
+
+// Report an upload that ran in the background and release its file
+static void models_upload_status(void) {
+    ai_hat_load_progress_t progress;
+    char rate[32];
+    
+    ai_hat_status_t status = ai_hat_get_load_progress(&progress);
+    if (status == AI_HAT_PENDING) {
+        uint32_t percent = (uint32_t)timer_div64((uint64_t)progress.sent * 100, progress.size);
+        shell_out_printf("Uploading model %u: %u%% of %u bytes, %u retransmits\n",
+                         progress.model_id, percent, progress.size, progress.retransmits);
+        return;
+    }
+    
+    if (upload_view == NULL) {
+        return;
+    }
+    fs_munmap(upload_view);
+    upload_view = NULL;
+    
+    if (status != AI_HAT_SUCCESS) {
+        shell_out_printf("Upload of model %u failed at %u of %u bytes (error %d)\n",
+                         progress.model_id, progress.sent, progress.size, status);
+        return;
+    }
+    
+    format_rate(rate, progress.size, timer_div64(timer_ticks_to_ns(progress.ticks), 1000));
+    shell_out_printf("Loaded model %u: %u bytes in %u KB chunks, %s, %u retransmits\n",
+                     progress.model_id, progress.size, progress.chunk_size / 1024, rate, progress.retransmits);
+}
+
+// Start uploading a file to the HAT. The shell's idle loop sends it in
+// slices through ai_subsystem_process(); `models` shows how far it got.
+static void models_load(const char* filename, int32_t chunk_kb) {
+    const char* data;
+    size_t size;
+    uint32_t model_id;
+    ai_hat_info_t info;
+    
+    if (ai_subsystem_get_info(&info) == AI_SUBSYSTEM_ERROR_NO_HAT) {
+        shell_out_puts("No AI HAT+ detected ('aiemu on' starts the emulator)\n");
+        return;
+    }
+    
+    if (ai_hat_get_load_progress(NULL) == AI_HAT_PENDING) {
+        shell_out_puts("Another upload is in progress\n");
+        return;
+    }
+    
+    // Reports the previous upload and releases its file
+    models_upload_status();
+    
+    if (fs_get_file_view(filename, &data, &size) != 0 || size == 0) {
+        shell_out_printf("File '%s' not found or empty\n", filename);
+        return;
+    }
+    
+    if (chunk_kb > 0 && ai_hat_set_chunk_size((uint32_t)chunk_kb * 1024) != AI_HAT_SUCCESS) {
+        shell_out_puts("Chunk size out of range\n");
+        return;
+    }
+    
+    // The file cannot change while the HAT reads from its view
+    const void* view = fs_mmap(filename, 0, size);
+    if (view == NULL) {
+        shell_out_puts("Cannot map the file\n");
+        return;
+    }
+    
+    // A raw blob says nothing about its precision; FP16 is the HAT's default
+    ai_hat_status_t status = ai_hat_load_model_start(view, (uint32_t)size, AI_HAT_PRECISION_FP16, &model_id);
+    if (status != AI_HAT_SUCCESS) {
+        shell_out_printf("Cannot start upload (error %d)\n", status);
+        fs_munmap(view);
+        return;
+    }
+    
+    upload_view = view;
+    shell_out_printf("Uploading model %u: %u bytes\n", model_id, (uint32_t)size);
+}
+
+// List, load or unload AI HAT+ models
+static void cmd_models(int argc, char* argv[]) {
+    ai_hat_model_t models[AI_HAT_MAX_MODELS];
+    ai_model_descriptor_t descriptors[AI_RESIDENCY_MAX_MODELS];
+    ai_residency_stats_t residency;
+    uint32_t count = 0;
+    uint32_t registered = 0;
+    char rate[32];
+    
+    if (ai_subsystem_init() != AI_SUBSYSTEM_SUCCESS) {
+        shell_out_puts("AI subsystem not available\n");
+        return;
+    }
+    
+    if (argc >= 3 && argc <= 4 && strcmp(argv[1], "load") == 0) {
+        models_load(argv[2], (argc == 4) ? parse_number(argv[3]) : 0);
+        return;
+    }
+    
+    if (argc == 3 && strcmp(argv[1], "unload") == 0) {
+        int32_t id = parse_number(argv[2]);
+        if (id < 0 || ai_hat_unload_model((uint32_t)id) == AI_HAT_ERROR_PARAM) {
+            shell_out_printf("No model %s\n", argv[2]);
+        }
+        return;
+    }
+    
+    if (argc != 1) {
+        shell_out_puts("Usage: models [load <file> [chunk_kb] | unload <id>]\n");
+        return;
+    }
+    
+    models_upload_status();
+    ai_hat_get_models(models, AI_HAT_MAX_MODELS, &count);
+    ai_residency_get_stats(&residency);
+    ai_subsystem_get_models(descriptors, AI_RESIDENCY_MAX_MODELS, &registered);
+    if (count == 0 && registered == 0) {
+        shell_out_puts("No models loaded\n");
+        return;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        format_rate(rate, models[i].size, models[i].load_us);
+        shell_out_printf("%u  %s  %u bytes  loaded in %u ms at %s, %u retransmits\n",
+                         models[i].id, models[i].name, models[i].size, models[i].load_us / 1000,
+                         rate, models[i].retransmits);
+    }
+    
+    // Models registered through the AI subsystem, with their planned arenas
+    for (uint32_t i = 0; i < registered; i++) {
+        const ai_model_descriptor_t* model = &descriptors[i];
+        shell_out_printf("%s  %s  in %ux%ux%ux%u  out %ux%ux%ux%u  arena ",
+                         model->name, backend_name(model->backend),
+                         model->input_dims[0], model->input_dims[1], model->input_dims[2], model->input_dims[3],
+                         model->output_dims[0], model->output_dims[1], model->output_dims[2], model->output_dims[3]);
+        if (model->arena_bytes > 0 || model->backend == AI_BACKEND_CPU) {
+            shell_out_printf("%u KB\n", (model->arena_bytes + 1023) >> 10);
+        } else {
+            shell_out_puts("unknown\n");       // Opaque HAT blob
+        }
+    }
+    
+    // Resident or evicted on the HAT
+    if (residency.models > 0) {
+        shell_out_printf("Residency: %u/%u resident, %u KB of %u KB device memory, %u KB staged\n",
+                         residency.resident, residency.models,
+                         (uint32_t)(residency.device_used >> 10), (uint32_t)(residency.device_budget >> 10),
+                         residency.staging_used >> 10);
+        shell_out_printf("           %u hits, %u misses, %u evictions, reload avg %u us, max %u us\n",
+                         residency.hits, residency.misses, residency.evictions,
+                         residency.reload_us_avg, residency.reload_us_max);
+    }
+}
+
+// Segments of a model split between the CPU and the HAT: the kernels each
+// device runs, the cost model's estimate, and how busy each one kept its device
+static int print_partition(uint32_t model_id) {
+    static ai_partition_info_t info;
+    
+    if (ai_subsystem_get_partition(model_id, &info) != AI_SUBSYSTEM_SUCCESS) {
+        return 0;
+    }
+    
+    for (uint32_t i = 0; i < info.segments; i++) {
+        const ai_partition_segment_t* segment = &info.segment[i];
+        uint32_t avg_us = segment->frames ? (uint32_t)timer_div64(timer_ticks_to_ns(segment->busy_ticks),
+                                                                   (uint64_t)segment->frames * 1000) : 0;
+        uint32_t busy = info.ticks ? (uint32_t)timer_div64(segment->busy_ticks * 100, info.ticks) : 0;
+        shell_out_printf("%u  %s  kernels %u-%u  %u kMAC  est %u us  avg %u us  busy %u%%\n", i,
+                         (segment->device == AI_PARTITION_HAT) ? "hat" : "cpu",
+                         segment->first_op, segment->first_op + segment->ops - 1,
+                         (uint32_t)timer_div64(segment->macs, 1000), segment->estimate_us, avg_us, busy);
+    }
+    shell_out_printf("Estimate %u us split, %u us on the CPU alone (%s)\n", info.split_us, info.cpu_only_us,
+                     info.timed ? "timed" : "estimated");
+    if (info.frames > 0) {
+        shell_out_printf("%u frames, avg %u us per frame\n", info.frames,
+                         (uint32_t)timer_div64(timer_ticks_to_ns(info.ticks), (uint64_t)info.frames * 1000));
+    }
+    return 1;
+}
+
+// Per-kernel lines of a CPU model's profile, or the segments of a split
+// model. Returns 0 for models on the HAT alone.
+static int print_op_profile(uint32_t model_id) {
+    static const char* op_names[] = {
+        "?", "conv2d", "depthwise", "fc", "maxpool", "avgpool", "softmax", "batchnorm", "activation", "reshape"
+    };
+    static ai_cpu_op_profile_t ops[AI_CPU_MAX_LAYERS];
+    uint32_t count = 0;
+    uint64_t total = 0;
+    
+    if (print_partition(model_id)) {
+        return 1;
+    }
+    if (ai_subsystem_get_op_profile(model_id, ops, AI_CPU_MAX_LAYERS, &count) != AI_SUBSYSTEM_SUCCESS) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        total += ops[i].ticks;
+    }
+    if (count == 0 || ops[0].runs == 0) {
+        shell_out_puts("No inferences profiled yet\n");
+        return 1;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const ai_cpu_op_profile_t* op = &ops[i];
+        uint32_t avg_us = (uint32_t)timer_div64(timer_ticks_to_ns(op->ticks), (uint64_t)op->runs * 1000);
+        uint32_t max_us = (uint32_t)timer_div64(timer_ticks_to_ns(op->max_ticks), 1000);
+        uint32_t share = (total > 0) ? (uint32_t)timer_div64(op->ticks * 100, total) : 0;
+        shell_out_printf("%u  %s", i, (op->op < sizeof(op_names) / sizeof(op_names[0])) ? op_names[op->op] : "?");
+        if (op->fused > 0) {
+            shell_out_printf(" +%u fused", op->fused);
+        }
+        shell_out_printf("  out %ux%ux%u  %u kMAC  avg %u us  max %u us  %u%%\n",
+                         op->out_dims[0], op->out_dims[1], op->out_dims[2],
+                         (uint32_t)timer_div64(op->macs, 1000), avg_us, max_us, share);
+    }
+    shell_out_printf("%u kernels, %u runs, avg %u us per inference\n", count, ops[0].runs,
+                     (uint32_t)timer_div64(timer_ticks_to_ns(total), (uint64_t)ops[0].runs * 1000));
+    return 1;
+}
+
+// Show where a CPU model spends its time, one line per kernel after fusion
+static void cmd_aiprof(int argc, char* argv[]) {
+    int32_t id = (argc >= 2) ? parse_number(argv[1]) : -1;
+    if (id < 0 || argc > 3 || (argc == 3 && strcmp(argv[2], "reset") != 0)) {
+        shell_out_puts("Usage: aiprof <id> [reset]\n");
+        return;
+    }
+    
+    if (ai_subsystem_init() != AI_SUBSYSTEM_SUCCESS) {
+        shell_out_puts("AI subsystem not available\n");
+        return;
+    }
+    
+    if (argc == 3) {
+        if (ai_subsystem_reset_op_profile((uint32_t)id) != AI_SUBSYSTEM_SUCCESS) {
+            shell_out_printf("No CPU or split model %s\n", argv[1]);
+        }
+        return;
+    }
+    
+    if (!print_op_profile((uint32_t)id)) {
+        shell_out_printf("No CPU or split model %s\n", argv[1]);
+    }
+}
+
+static void print_histogram(const char* label, const ai_histogram_t* hist) {
+    shell_out_printf("  %s  p50 %u  p90 %u  p99 %u  max %u us\n", label,
+                     ai_histogram_percentile(hist, 500), ai_histogram_percentile(hist, 900),
+                     ai_histogram_percentile(hist, 990), hist->max);
+}
+
+static void print_model_stats(const ai_profiler_model_t* stats) {
+    uint32_t batch_tenths = stats->batches ? (uint32_t)timer_div64((uint64_t)stats->inferences * 10, stats->batches) : 0;
+    
+    shell_out_printf("Model %u (%s): %u inferences, %u errors, %u batches of %u.%u, %u KB in, %u KB out\n",
+                     stats->model_id, backend_name(stats->backend),
+                     stats->inferences, stats->errors, stats->batches, batch_tenths / 10, batch_tenths % 10,
+                     (uint32_t)(stats->bytes_in >> 10), (uint32_t)(stats->bytes_out >> 10));
+    if (stats->inferences > 0) {
+        print_histogram("total  ", &stats->total_us);
+        print_histogram("wait   ", &stats->wait_us);
+        print_histogram("compute", &stats->compute_us);
+    }
+}
+
+// Hex lines for aistat dump, with a running CRC for the trailer
+typedef struct {
+    char line[80];
+    uint32_t used;
+    uint32_t crc;
+} dump_writer_t;
+
+static void dump_write(const void* data, uint32_t size, void* ctx) {
+    static const char digits[] = "0123456789abcdef";
+    dump_writer_t* writer = (dump_writer_t*)ctx;
+    const uint8_t* bytes = (const uint8_t*)data;
+    
+    writer->crc = crc32_update(writer->crc, data, size);
+    for (uint32_t i = 0; i < size; i++) {
+        writer->line[writer->used++] = digits[bytes[i] >> 4];
+        writer->line[writer->used++] = digits[bytes[i] & 0xF];
+        if (writer->used == 64) {
+            writer->line[writer->used++] = '\n';
+            shell_out_write(writer->line, writer->used);
+            writer->used = 0;
+        }
+    }
+}
+
+// Inference latency of every model: queue wait against compute time,
+// batching and bytes moved, plus per-kernel times of CPU models
+static void cmd_aistat(int argc, char* argv[]) {
+    static ai_model_descriptor_t descriptors[AI_RESIDENCY_MAX_MODELS];
+    static ai_profiler_model_t stats;
+    uint32_t count = 0;
+    
+    if (ai_subsystem_init() != AI_SUBSYSTEM_SUCCESS) {
+        shell_out_puts("AI subsystem not available\n");
+        return;
+    }
+    
+    if (argc >= 2 && argc <= 3 && strcmp(argv[1], "reset") == 0) {
+        int32_t id = (argc == 3) ? parse_number(argv[2]) : 0;
+        if (id < 0 || (id > 0 && ai_profiler_get_model((uint32_t)id, &stats) != 0)) {
+            shell_out_printf("No model %s\n", argv[2]);
+            return;
+        }
+        ai_profiler_reset((uint32_t)id);
+        return;
+    }
+    
+    // Binary dump as hex lines between markers, for capture from the console
+    if (argc == 2 && strcmp(argv[1], "dump") == 0) {
+        static dump_writer_t writer;
+        writer.used = 0;
+        writer.crc = 0;
+        shell_out_puts("AISTAT BEGIN\n");
+        uint32_t size = ai_profiler_dump(dump_write, &writer);
+        if (writer.used > 0) {
+            writer.line[writer.used++] = '\n';
+            shell_out_write(writer.line, writer.used);
+        }
+        shell_out_printf("AISTAT END %u bytes crc32 %x\n", size, writer.crc);
+        return;
+    }
+    
+    if (argc == 2) {
+        int32_t id = parse_number(argv[1]);
+        if (id <= 0 || ai_profiler_get_model((uint32_t)id, &stats) != 0) {
+            shell_out_printf("No model %s\n", argv[1]);
+            return;
+        }
+        print_model_stats(&stats);
+        if (stats.backend != AI_BACKEND_HAT) {
+            print_op_profile((uint32_t)id);
+        }
+        return;
+    }
+    
+    if (argc != 1) {
+        shell_out_puts("Usage: aistat [<id> | reset [id] | dump]\n");
+        return;
+    }
+    
+    ai_subsystem_get_models(descriptors, AI_RESIDENCY_MAX_MODELS, &count);
+    if (count == 0) {
+        shell_out_puts("No models loaded\n");
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (ai_profiler_get_model(descriptors[i].id, &stats) == 0) {
+            print_model_stats(&stats);
+        }
+    }
+}
+
+// Show or change how the HAT power mode and batch size are chosen
+static void cmd_aipower(int argc, char* argv[]) {
+    static const char* const policies[] = {"manual", "throughput", "latency", "energy cap"};
+    ai_subsystem_status_t status = AI_SUBSYSTEM_SUCCESS;
+    ai_governor_state_t state;
+    int32_t value = (argc == 3) ? parse_number(argv[2]) : -1;
+    
+    if (ai_subsystem_init() != AI_SUBSYSTEM_SUCCESS) {
+        shell_out_puts("AI subsystem not available\n");
+        return;
+    }
+    
+    if (argc == 2 && strcmp(argv[1], "throughput") == 0) {
+        status = ai_subsystem_set_power_policy(AI_POWER_POLICY_THROUGHPUT, 0);
+    } else if (argc == 2 && strcmp(argv[1], "latency") == 0) {
+        status = ai_subsystem_set_power_policy(AI_POWER_POLICY_LATENCY, 0);
+    } else if (argc == 3 && strcmp(argv[1], "energy") == 0 && value > 0) {
+        status = ai_subsystem_set_power_policy(AI_POWER_POLICY_ENERGY_CAP, (uint32_t)value);
+    } else if (argc == 3 && strcmp(argv[1], "mode") == 0 && value >= 0 && value <= AI_HAT_POWER_MAX) {
+        status = ai_subsystem_set_power_mode((ai_hat_power_mode_t)value);
+    } else if (argc != 1) {
+        shell_out_puts("Usage: aipower [throughput | latency | energy <mW> | mode <0-4>]\n");
+        return;
+    }
+    
+    if (status != AI_SUBSYSTEM_SUCCESS || ai_subsystem_get_power_state(&state) != AI_SUBSYSTEM_SUCCESS) {
+        shell_out_puts("AI HAT+ not available\n");
+        return;
+    }
+    
+    shell_out_printf("Policy %s", policies[state.policy]);
+    if (state.policy == AI_POWER_POLICY_ENERGY_CAP) {
+        shell_out_printf(" (%u mW)", state.energy_cap_mw);
+    }
+    shell_out_printf(", mode %u (thermal limit %u), batch limit %u\n", state.mode, state.thermal_max,
+                     state.batch_limit);
+    shell_out_printf("Last sample %u C, %u mW; %u samples, %u mode changes, %u batch throttles\n",
+                     state.temperature, state.power, state.samples, state.mode_changes, state.batch_throttles);
+}
+
+// Start the emulated HAT, or show or change it: link and compute speed,
+// model memory and injected faults, for repeatable runs without hardware
+static void cmd_aiemu(int argc, char* argv[]) {
+    ai_hat_stream_stats_t link;
+    ai_hat_emu_memory_t memory;
+    ai_hat_emu_faults_t faults;
+    int32_t values[3] = {-1, -1, -1};
+    
+    for (int i = 2; i < argc && i < 5; i++) {
+        values[i - 2] = parse_number(argv[i]);
+    }
+    
+    if (ai_subsystem_init() != AI_SUBSYSTEM_SUCCESS) {
+        shell_out_puts("AI subsystem not available\n");
+        return;
+    }
+    
+    if (argc == 2 && strcmp(argv[1], "on") == 0 && ai_subsystem_use_emulator() != AI_SUBSYSTEM_SUCCESS) {
+        shell_out_puts("Cannot start the AI HAT+ emulator\n");
+        return;
+    }
+    
+    if (ai_hat_get_stream_stats(&link) != AI_HAT_SUCCESS || link.link == NULL ||
+        strcmp(link.link, "emulator") != 0) {
+        shell_out_puts("AI HAT+ is not emulated ('aiemu on' without a HAT)\n");
+        return;
+    }
+    
+    if (argc == 4 && strcmp(argv[1], "link") == 0 && values[0] > 0 && values[1] >= 0) {
+        ai_hat_emu_configure((uint32_t)values[0] * 1000000, (uint32_t)values[1]);
+    } else if (argc == 3 && strcmp(argv[1], "memory") == 0 && values[0] > 0) {
+        ai_hat_emu_set_memory((uint32_t)values[0]);
+    } else if (argc == 5 && strcmp(argv[1], "faults") == 0 && values[0] >= 0 && values[1] >= 0 && values[2] >= 0) {
+        faults.nack_every = (uint32_t)values[0];
+        faults.timeout_every = (uint32_t)values[1];
+        faults.crc_every = (uint32_t)values[2];
+        ai_hat_emu_set_faults(&faults);
+    } else if (argc != 1 && !(argc == 2 && strcmp(argv[1], "on") == 0)) {
+        shell_out_puts("Usage: aiemu [on | link <MHz> <us> | memory <KB> | faults <nack> <timeout> <crc>]\n");
+        return;
+    }
+    
+    ai_hat_get_stream_stats(&link);
+    ai_hat_emu_get_memory(&memory);
+    ai_hat_emu_get_faults(&faults);
+    shell_out_printf("Link %u MHz; model memory %u KB free of %u KB, %u models\n", link.bus_clock / 1000000,
+                     memory.free_kb, memory.total_kb, memory.models);
+    shell_out_printf("Faults every %u register accesses, %u transactions, %u chunks (0 = off)\n",
+                     faults.nack_every, faults.timeout_every, faults.crc_every);
+    shell_out_printf("Injected %u NACKs, %u timeouts, %u CRC errors\n", faults.nacks, faults.timeouts,
+                     faults.crc_errors);
+}
+
+// printf has no 64-bit conversions; physical addresses can exceed 4 GiB
+static const char* format_addr(char* buffer, uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    char reversed[16];
+    int count = 0;
+    
+    do {
+        reversed[count++] = digits[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+    
+    buffer[0] = '0';
+    buffer[1] = 'x';
+    for (int i = 0; i < count; i++) {
+        buffer[2 + i] = reversed[count - 1 - i];
+    }
+    buffer[2 + count] = '\0';
+    return buffer;
+}
+
+// Page frames, address spaces and fault counts
+static void vmstat_paging(void) {
+    memory_stats_t memory;
+    vmm_stats_t vm;
+    
+    memory_get_stats(&memory);
+    shell_out_printf("Page frames: %u free of %u (peak %u in use, %u failed allocations)\n",
+                     memory.free_pages, memory.total_pages, memory.peak_pages, memory.failures);
+    for (uint32_t z = 0; z < MEMORY_ZONES; z++) {
+        const memory_zone_stats_t* zone = &memory.zones[z];
+        shell_out_printf("  %s zone: %u free of %u, lock taken %u times (%u contended)\n",
+                         z == MEMORY_ZONE_DMA ? "DMA" : "Normal", zone->free_pages, zone->total_pages,
+                         zone->lock_acquires, zone->lock_contended);
+    }
+    shell_out_printf("Per-CPU page caches: %s, %u CPUs, %u frames cached, %u hits, %u refills, %u drains\n",
+                     memory.cache_enabled ? "on" : "off", smp_cpu_count(), memory.cached_pages,
+                     memory.cache_hits, memory.cache_refills, memory.cache_drains);
+    
+    vmm_get_stats(&vm);
+    if (!vm.enabled) {
+        shell_out_puts("VMM: not available on this platform\n");
+        return;
+    }
+    shell_out_printf("VMM: %u spaces, %u mappings, %u objects, %u pages resident, %u page-table pages\n",
+                     vm.spaces, vm.vmas, vm.objects, vm.resident, vm.tables);
+    shell_out_printf("Faults: %u (zero-fill %u, zero page %u, object reads %u, COW copies %u, "
+                     "COW reuses %u, errors %u)\n", vm.faults, vm.zero_fills, vm.zero_maps,
+                     vm.object_fills, vm.cow_copies, vm.cow_reuses, vm.errors);
+}
+
+static void cmd_vmstat(int argc, char* argv[]) {
+    (void)argc; (void)argv; // Suppress unused parameter warnings
+    
+    mmu_stats_t stats;
+    mmu_region_t region;
+    char start[20], end[20];
+    
+    mmu_get_stats(&stats);
+    shell_out_printf("Kernel image: %s - %s (%u KB)\n", format_addr(start, stats.kernel_start),
+                     format_addr(end, stats.kernel_end),
+                     (uint32_t)((stats.kernel_end - stats.kernel_start + 1023) >> 10));
+    
+    if (!stats.enabled) {
+        shell_out_puts("MMU: not managed by the kernel on this platform\n");
+        vmstat_paging();
+        return;
+    }
+    
+    shell_out_printf("MMU: on, %u KB granule, %u-bit VA, %u-bit PA\n", stats.granule >> 10,
+                     stats.va_bits, stats.pa_bits);
+    shell_out_printf("Caches: I %s, D %s\n", stats.icache ? "on" : "off", stats.dcache ? "on" : "off");
+    shell_out_printf("Higher half: %s = physical 0\n", format_addr(start, stats.high_base));
+    shell_out_printf("Page tables: %u pages (%u KB)\n", stats.tables, stats.tables * 4);
+    shell_out_printf("Mappings: %u x 1 GB, %u x 2 MB, %u x 4 KB pages\n", stats.blocks_1g, stats.blocks_2m,
+                     stats.pages_4k);
+    shell_out_printf("Write-combining: %s\n", stats.write_combining ? "yes" : "no (mapped uncached)");
+    
+    shell_out_puts("Regions:\n");
+    for (uint32_t i = 0; mmu_get_region(i, &region) == 0; i++) {
+        int megabytes = region.size >= (1ull << 20);
+        shell_out_printf("  %s - %s  %s  %u %s  %s\n", format_addr(start, region.phys),
+                         format_addr(end, region.phys + region.size - 1), mmu_type_name(region.type),
+                         (uint32_t)(region.size >> (megabytes ? 20 : 10)), megabytes ? "MB" : "KB",
+                         region.name);
+    }
+    
+    vmstat_paging();
+}
@@ -264,6 +264,47 @@ int fs_cat(const char* filename, char* output, size_t output_size) {
     return fs_read_file(filename, output, output_size);
 }
 
+int fs_get_file_view(const char* filename, const char** data, size_t* size) {
+    if (!filename || !data || !size) {
+        return -1;
+    }
+    
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (fs.files[i].is_used && strcmp(fs.files[i].name, filename) == 0) {
+            *data = fs.files[i].content;
+            *size = fs.files[i].size;
+            return 0;
+        }
+    }
+    
+    return -1; // File not found
+}
+
+// File contents here are not page aligned, so views are always in place
+const void* fs_mmap(const char* filename, size_t offset, size_t length) {
+    const char* data;
+    size_t size;
+    
+    if (fs_get_file_view(filename, &data, &size) != 0 || (offset & 0xFFF) != 0 ||
+        offset >= size || length > size - offset) {
+        return NULL;
+    }
+    
+    return data + offset;
+}
+
+int fs_munmap(const void* addr) {
+    return addr ? 0 : -1;
+}
+
+const char* fs_get_file_name(int slot) {
+    if (slot < 0 || slot >= MAX_FILES || !fs.files[slot].is_used) {
+        return NULL;
+    }
+    
+    return fs.files[slot].name;
+}
+
 int fs_save(const char* filename, const char* content) {
     if (!filename || !content) {
         return -1;
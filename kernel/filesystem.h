@@ -50,4 +50,21 @@ int fs_cat(const char* filename, char* output, size_t output_size);
 int fs_save(const char* filename, const char* content);
 int fs_append(const char* filename, const char* content);
 
+// Borrow a read-only view of a file's contents without copying it.
+// The view stays valid until the file is next written or deleted.
+int fs_get_file_view(const char* filename, const char** data, size_t* size);
+
+// Map length bytes of a file from offset (a multiple of 4 KiB; length 0
+// means to the end) read-only and shared, without copying. With the VMM
+// running, the file's own storage pages are mapped into the current address
+// space; otherwise the view points at them in place. A mapped file cannot
+// be written or deleted until every view is released with fs_munmap.
+// Returns the first byte of the view, or NULL.
+const void* fs_mmap(const char* filename, size_t offset, size_t length);
+int fs_munmap(const void* addr);
+
+// Name of the file in slot 0..MAX_FILES-1, or NULL if the slot is unused.
+// Lets callers walk every file without formatting a listing.
+const char* fs_get_file_name(int slot);
+
 #endif // FILESYSTEM_H
\ No newline at end of file
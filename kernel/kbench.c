@@ -0,0 +1,967 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — In-Kernel Benchmarks
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "kbench.h"
+#include "timer.h"
+#include "../drivers/serial.h"
+#include "stdio.h"
+#include "utils.h"
+#include "filesystem.h"
+#include "ai/ai_subsystem.h"
+#include "ai/ai_cpu.h"
+#include "memory.h"
+#include "vmm.h"
+#include "smp.h"
+#include "../drivers/ai_hat/ai_hat.h"
+
+#define KBENCH_MEM_BUFFER_SIZE  (64 * 1024)
+#define KBENCH_MEM_BYTES        (4 * 1024 * 1024)  // Bytes moved per memory test
+#define KBENCH_CTX_ROUNDS       10000
+#define KBENCH_FS_OPS           256
+#define KBENCH_UART_LINES       16
+#define KBENCH_AI_SAMPLES       64
+#define KBENCH_AI_BUFFER_SIZE   (64 * 1024)
+#define KBENCH_SPI_TENSORS      32
+#define KBENCH_SPI_INPUT_SIZE   1024   // Small classifier-sized tensors
+#define KBENCH_SPI_OUTPUT_SIZE  1000
+#define KBENCH_CPU_RUNS         8
+#define KBENCH_CPU_MODEL_SIZE   (32 * 1024)
+#define KBENCH_STACK_SIZE       4096
+#define KBENCH_VM_PAGES         256    // 1 MB per fault test
+#define KBENCH_PAGE_ROUNDS      2048   // Per CPU, each allocating then freeing a burst
+#define KBENCH_PAGE_BURST       8
+#define KBENCH_SUMMARY_SIZE     2048
+
+static uint8_t mem_src[KBENCH_MEM_BUFFER_SIZE] __attribute__((aligned(64)));
+static uint8_t mem_dst[KBENCH_MEM_BUFFER_SIZE] __attribute__((aligned(64)));
+static uint8_t ai_input[KBENCH_AI_BUFFER_SIZE] __attribute__((aligned(64)));
+static uint8_t ai_output[KBENCH_AI_BUFFER_SIZE] __attribute__((aligned(64)));
+
+static char summary[KBENCH_SUMMARY_SIZE];
+
+#if defined(__x86_64__)
+#define KBENCH_ARCH   "x86_64"
+#elif defined(__i386__)
+#define KBENCH_ARCH   "i386"
+#elif defined(__aarch64__)
+#define KBENCH_ARCH   "aarch64"
+#elif defined(__riscv)
+#define KBENCH_ARCH   "riscv64"
+#else
+#error "Unsupported architecture for kbench"
+#endif
+
+// ─── Context switch ──────────────────────────────────────────────────────────
+//
+// A minimal cooperative switch: push the callee-saved registers, swap stack
+// pointers, pop and return into the other context. The benchmark coroutine
+// does not use floating point, so only integer state is switched.
+
+void kbench_switch(uintptr_t* save_sp, uintptr_t new_sp);
+
+#if defined(__i386__)
+
+#define SWITCH_FRAME_WORDS 6   // edi, esi, ebx, ebp, entry, fake return
+#define SWITCH_ENTRY_SLOT  4
+
+__asm__(
+    ".text\n"
+    ".global kbench_switch\n"
+    ".type kbench_switch, @function\n"
+    "kbench_switch:\n"
+    "    movl 4(%esp), %eax\n"
+    "    movl 8(%esp), %edx\n"
+    "    pushl %ebp\n"
+    "    pushl %ebx\n"
+    "    pushl %esi\n"
+    "    pushl %edi\n"
+    "    movl %esp, (%eax)\n"
+    "    movl %edx, %esp\n"
+    "    popl %edi\n"
+    "    popl %esi\n"
+    "    popl %ebx\n"
+    "    popl %ebp\n"
+    "    ret\n"
+);
+
+#elif defined(__x86_64__)
+
+#define SWITCH_FRAME_WORDS 8   // r15, r14, r13, r12, rbx, rbp, entry, fake return
+#define SWITCH_ENTRY_SLOT  6
+
+__asm__(
+    ".text\n"
+    ".global kbench_switch\n"
+    ".type kbench_switch, @function\n"
+    "kbench_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+);
+
+#elif defined(__aarch64__)
+
+#define SWITCH_FRAME_WORDS 12  // x19-x28, x29, x30
+#define SWITCH_ENTRY_SLOT  11
+
+__asm__(
+    ".text\n"
+    ".global kbench_switch\n"
+    ".type kbench_switch, %function\n"
+    "kbench_switch:\n"
+    "    sub sp, sp, #96\n"
+    "    stp x19, x20, [sp, #0]\n"
+    "    stp x21, x22, [sp, #16]\n"
+    "    stp x23, x24, [sp, #32]\n"
+    "    stp x25, x26, [sp, #48]\n"
+    "    stp x27, x28, [sp, #64]\n"
+    "    stp x29, x30, [sp, #80]\n"
+    "    mov x9, sp\n"
+    "    str x9, [x0]\n"
+    "    mov sp, x1\n"
+    "    ldp x19, x20, [sp, #0]\n"
+    "    ldp x21, x22, [sp, #16]\n"
+    "    ldp x23, x24, [sp, #32]\n"
+    "    ldp x25, x26, [sp, #48]\n"
+    "    ldp x27, x28, [sp, #64]\n"
+    "    ldp x29, x30, [sp, #80]\n"
+    "    add sp, sp, #96\n"
+    "    ret\n"
+);
+
+#elif defined(__riscv)
+
+#define SWITCH_FRAME_WORDS 14  // ra, s0-s11, padding to 16 bytes
+#define SWITCH_ENTRY_SLOT  0
+
+__asm__(
+    ".text\n"
+    ".global kbench_switch\n"
+    ".type kbench_switch, @function\n"
+    "kbench_switch:\n"
+    "    addi sp, sp, -112\n"
+    "    sd ra, 0(sp)\n"
+    "    sd s0, 8(sp)\n"
+    "    sd s1, 16(sp)\n"
+    "    sd s2, 24(sp)\n"
+    "    sd s3, 32(sp)\n"
+    "    sd s4, 40(sp)\n"
+    "    sd s5, 48(sp)\n"
+    "    sd s6, 56(sp)\n"
+    "    sd s7, 64(sp)\n"
+    "    sd s8, 72(sp)\n"
+    "    sd s9, 80(sp)\n"
+    "    sd s10, 88(sp)\n"
+    "    sd s11, 96(sp)\n"
+    "    sd sp, 0(a0)\n"
+    "    mv sp, a1\n"
+    "    ld ra, 0(sp)\n"
+    "    ld s0, 8(sp)\n"
+    "    ld s1, 16(sp)\n"
+    "    ld s2, 24(sp)\n"
+    "    ld s3, 32(sp)\n"
+    "    ld s4, 40(sp)\n"
+    "    ld s5, 48(sp)\n"
+    "    ld s6, 56(sp)\n"
+    "    ld s7, 64(sp)\n"
+    "    ld s8, 72(sp)\n"
+    "    ld s9, 80(sp)\n"
+    "    ld s10, 88(sp)\n"
+    "    ld s11, 96(sp)\n"
+    "    addi sp, sp, 112\n"
+    "    ret\n"
+);
+
+#endif
+
+static uint8_t peer_stack[KBENCH_STACK_SIZE] __attribute__((aligned(16)));
+static uintptr_t main_sp;
+static uintptr_t peer_sp;
+
+static void kbench_peer(void) {
+    while (1) {
+        kbench_switch(&peer_sp, main_sp);
+    }
+}
+
+// Build an initial frame so the first switch "returns" into entry
+static uintptr_t kbench_init_stack(void (*entry)(void)) {
+    uintptr_t* frame = (uintptr_t*)(peer_stack + KBENCH_STACK_SIZE) - SWITCH_FRAME_WORDS;
+    for (int i = 0; i < SWITCH_FRAME_WORDS; i++) {
+        frame[i] = 0;
+    }
+    frame[SWITCH_ENTRY_SLOT] = (uintptr_t)entry;
+    return (uintptr_t)frame;
+}
+
+// ─── Reporting ───────────────────────────────────────────────────────────────
+
+static void summary_add(const char* key, uint32_t value) {
+    char item[64];
+    sprintf(item, " %s=%u", key, value);
+    if (strlen(summary) + strlen(item) < KBENCH_SUMMARY_SIZE) {
+        strcat(summary, item);
+    }
+}
+
+static void summary_add_na(const char* key) {
+    char item[64];
+    sprintf(item, " %s=na", key);
+    if (strlen(summary) + strlen(item) < KBENCH_SUMMARY_SIZE) {
+        strcat(summary, item);
+    }
+}
+
+static void report(const char* label, uint32_t value, const char* unit) {
+    char line[128];
+    sprintf(line, "  %s: %u %s\n", label, value, unit);
+    serial_puts(line);
+}
+
+static uint32_t mb_per_sec(uint64_t bytes, uint64_t ticks) {
+    uint64_t ns = timer_ticks_to_ns(ticks);
+    return (uint32_t)timer_div64(bytes * 1000, ns ? ns : 1);
+}
+
+static uint32_t ns_per_op(uint64_t ticks, uint32_t ops) {
+    return (uint32_t)timer_div64(timer_ticks_to_ns(ticks), ops ? ops : 1);
+}
+
+// ─── Benchmarks ──────────────────────────────────────────────────────────────
+
+static void bench_mem(void) {
+    static const uint32_t sizes[] = {64, 1024, 4096, KBENCH_MEM_BUFFER_SIZE};
+    static const char* const names[] = {"64", "1k", "4k", "64k"};
+    char key[32];
+    char label[32];
+    
+    serial_puts("Memory bandwidth:\n");
+    
+    for (uint32_t i = 0; i < KBENCH_MEM_BUFFER_SIZE; i++) {
+        mem_src[i] = (uint8_t)i;
+    }
+    
+    for (int s = 0; s < 4; s++) {
+        uint32_t iters = KBENCH_MEM_BYTES / sizes[s];
+        
+        uint64_t start = timer_ticks();
+        for (uint32_t i = 0; i < iters; i++) {
+            memcpy(mem_dst, mem_src, sizes[s]);
+        }
+        uint32_t rate = mb_per_sec(KBENCH_MEM_BYTES, timer_ticks() - start);
+        sprintf(label, "memcpy %s", names[s]);
+        report(label, rate, "MB/s");
+        sprintf(key, "memcpy_%s_mbps", names[s]);
+        summary_add(key, rate);
+        
+        start = timer_ticks();
+        for (uint32_t i = 0; i < iters; i++) {
+            memset(mem_dst, (int)i, sizes[s]);
+        }
+        rate = mb_per_sec(KBENCH_MEM_BYTES, timer_ticks() - start);
+        sprintf(label, "memset %s", names[s]);
+        report(label, rate, "MB/s");
+        sprintf(key, "memset_%s_mbps", names[s]);
+        summary_add(key, rate);
+    }
+}
+
+static void bench_ctx(void) {
+    serial_puts("Context switch:\n");
+    
+    peer_sp = kbench_init_stack(kbench_peer);
+    kbench_switch(&main_sp, peer_sp);  // Warm up and enter the peer loop
+    
+    uint64_t start = timer_ticks();
+    for (uint32_t i = 0; i < KBENCH_CTX_ROUNDS; i++) {
+        kbench_switch(&main_sp, peer_sp);
+    }
+    uint64_t elapsed = timer_ticks() - start;
+    
+    // Each round trip is two switches
+    uint32_t ns = ns_per_op(elapsed, KBENCH_CTX_ROUNDS * 2);
+    report("switch", ns, "ns");
+    summary_add("ctxsw_ns", ns);
+}
+
+static void bench_irq(void) {
+    // No interrupt controller (IDT/PIC, GIC, PLIC) is programmed yet, so
+    // there is no interrupt path to time.
+    serial_puts("IRQ latency:\n");
+    serial_puts("  irq: n/a (interrupts not configured)\n");
+    summary_add_na("irq_ns");
+}
+
+static void bench_fs(void) {
+    static const char* const bench_file = "kbench.tmp";
+    static const char* const chunk = "0123456789abcdef";
+    uint64_t save_ticks = 0;
+    uint64_t cat_ticks = 0;
+    uint64_t append_ticks = 0;
+    uint64_t delete_ticks = 0;
+    char buffer[MAX_FILESIZE];
+    
+    serial_puts("File system:\n");
+    
+    for (uint32_t i = 0; i < KBENCH_FS_OPS; i++) {
+        uint64_t start = timer_ticks();
+        fs_save(bench_file, "SAGE OS kernel benchmark file\n");
+        save_ticks += timer_ticks() - start;
+        
+        start = timer_ticks();
+        fs_append(bench_file, chunk);
+        append_ticks += timer_ticks() - start;
+        
+        start = timer_ticks();
+        fs_cat(bench_file, buffer, sizeof(buffer));
+        cat_ticks += timer_ticks() - start;
+        
+        start = timer_ticks();
+        fs_delete_file(bench_file);
+        delete_ticks += timer_ticks() - start;
+    }
+    
+    uint32_t ns = ns_per_op(save_ticks, KBENCH_FS_OPS);
+    report("save", ns, "ns/op");
+    summary_add("fs_save_ns", ns);
+    
+    ns = ns_per_op(append_ticks, KBENCH_FS_OPS);
+    report("append", ns, "ns/op");
+    summary_add("fs_append_ns", ns);
+    
+    ns = ns_per_op(cat_ticks, KBENCH_FS_OPS);
+    report("cat", ns, "ns/op");
+    summary_add("fs_cat_ns", ns);
+    
+    ns = ns_per_op(delete_ticks, KBENCH_FS_OPS);
+    report("delete", ns, "ns/op");
+    summary_add("fs_delete_ns", ns);
+}
+
+static void bench_uart(void) {
+    static const char* const line =
+        "...............................................................\n";
+    uint32_t bytes = 0;
+    
+    serial_puts("UART TX:\n");
+    
+    uint64_t start = timer_ticks();
+    for (int i = 0; i < KBENCH_UART_LINES; i++) {
+        serial_puts(line);
+        bytes += strlen(line);
+    }
+    uint64_t ns = timer_ticks_to_ns(timer_ticks() - start);
+    
+    uint32_t rate = (uint32_t)timer_div64((uint64_t)bytes * 1000000000ULL, ns ? ns : 1);
+    report("tx", rate, "bytes/s");
+    summary_add("uart_tx_bps", rate);
+}
+
+static void sort_samples(uint32_t* samples, int count) {
+    for (int i = 1; i < count; i++) {
+        uint32_t value = samples[i];
+        int j = i - 1;
+        while (j >= 0 && samples[j] > value) {
+            samples[j + 1] = samples[j];
+            j--;
+        }
+        samples[j + 1] = value;
+    }
+}
+
+static void ai_summary_na(void) {
+    summary_add_na("ai_p50_us");
+    summary_add_na("ai_p90_us");
+    summary_add_na("ai_p99_us");
+    summary_add_na("ai_sync_ips");
+    summary_add_na("ai_batch_ips");
+}
+
+static uint32_t ai_completions;
+
+static void ai_count_completion(ai_ticket_t ticket, ai_subsystem_status_t status, void* output, void* ctx) {
+    (void)ticket;
+    (void)status;
+    (void)output;
+    (void)ctx;
+    ai_completions++;
+}
+
+static uint32_t per_second(uint32_t count, uint64_t ticks) {
+    uint64_t ns = timer_ticks_to_ns(ticks);
+    return (uint32_t)timer_div64((uint64_t)count * 1000000000ULL, ns ? ns : 1);
+}
+
+static void bench_ai(void) {
+    ai_model_descriptor_t model;
+    uint32_t num_models = 0;
+    uint32_t samples[KBENCH_AI_SAMPLES];
+    
+    serial_puts("AI inference:\n");
+    
+    if (ai_subsystem_get_models(&model, 1, &num_models) != AI_SUBSYSTEM_SUCCESS ||
+        num_models == 0) {
+        serial_puts("  inference: n/a (AI subsystem not initialized or no model loaded)\n");
+        ai_summary_na();
+        return;
+    }
+    
+    uint32_t input_size = model.input_dims[0] * model.input_dims[1] *
+                          model.input_dims[2] * model.input_dims[3];
+    uint32_t output_size = model.output_dims[0] * model.output_dims[1] *
+                           model.output_dims[2] * model.output_dims[3];
+    if (input_size > KBENCH_AI_BUFFER_SIZE || output_size > KBENCH_AI_BUFFER_SIZE) {
+        serial_puts("  inference: n/a (model tensors exceed benchmark buffers)\n");
+        ai_summary_na();
+        return;
+    }
+    
+    int count = 0;
+    for (int i = 0; i < KBENCH_AI_SAMPLES; i++) {
+        uint64_t start = timer_ticks();
+        if (ai_subsystem_run_inference(model.id, ai_input, ai_output) != AI_SUBSYSTEM_SUCCESS) {
+            continue;
+        }
+        samples[count++] = (uint32_t)timer_div64(timer_ticks_to_ns(timer_ticks() - start), 1000);
+    }
+    
+    if (count == 0) {
+        serial_puts("  inference: failed\n");
+        ai_summary_na();
+        return;
+    }
+    
+    sort_samples(samples, count);
+    uint32_t p50 = samples[(count * 50) / 100];
+    uint32_t p90 = samples[(count * 90) / 100];
+    uint32_t p99 = samples[(count * 99) / 100];
+    
+    report("p50", p50, "us");
+    report("p90", p90, "us");
+    report("p99", p99, "us");
+    summary_add("ai_p50_us", p50);
+    summary_add("ai_p90_us", p90);
+    summary_add("ai_p99_us", p99);
+    
+    // Throughput: back-to-back synchronous calls vs the batching queue.
+    // Every request shares one output buffer; the results are discarded.
+    uint64_t start = timer_ticks();
+    for (int i = 0; i < KBENCH_AI_SAMPLES; i++) {
+        ai_subsystem_run_inference(model.id, ai_input, ai_output);
+    }
+    uint32_t sync_ips = per_second(KBENCH_AI_SAMPLES, timer_ticks() - start);
+    
+    uint32_t submitted = 0;
+    ai_completions = 0;
+    start = timer_ticks();
+    while (submitted < KBENCH_AI_SAMPLES) {
+        ai_subsystem_status_t status = ai_subsystem_submit(model.id, ai_input, ai_output,
+                                                           ai_count_completion, NULL, NULL);
+        if (status == AI_SUBSYSTEM_SUCCESS) {
+            submitted++;
+        } else if (status == AI_SUBSYSTEM_ERROR_BUSY) {
+            ai_subsystem_process();
+        } else {
+            break;
+        }
+    }
+    while (ai_completions < submitted) {
+        ai_subsystem_process();
+    }
+    uint32_t batch_ips = per_second(submitted, timer_ticks() - start);
+    
+    report("sync", sync_ips, "inferences/s");
+    report("batched", batch_ips, "inferences/s");
+    summary_add("ai_sync_ips", sync_ips);
+    summary_add("ai_batch_ips", batch_ips);
+}
+
+static void spi_summary_na(void) {
+    summary_add_na("spi_serial_ips");
+    summary_add_na("spi_pipelined_ips");
+    summary_add_na("spi_kbps");
+    summary_add_na("spi_bus_kbps");
+}
+
+// Stream KBENCH_SPI_TENSORS tensors through the HAT in batches, with the
+// tensor slots used one at a time and then double-buffered
+static uint32_t spi_stream(uint32_t model_id, int pipelined, ai_hat_stream_stats_t* stats) {
+    const void* inputs[AI_HAT_MAX_BATCH];
+    void* outputs[AI_HAT_MAX_BATCH];
+    
+    for (int i = 0; i < AI_HAT_MAX_BATCH; i++) {
+        inputs[i] = ai_input;
+        outputs[i] = ai_output;
+    }
+    
+    ai_hat_set_double_buffering(pipelined);
+    ai_hat_reset_stream_stats();
+    for (int done = 0; done < KBENCH_SPI_TENSORS; done += AI_HAT_MAX_BATCH) {
+        if (ai_hat_run_inference_batch(model_id, inputs, KBENCH_SPI_INPUT_SIZE, outputs,
+                                       KBENCH_SPI_OUTPUT_SIZE, AI_HAT_MAX_BATCH) != AI_HAT_SUCCESS) {
+            return 0;
+        }
+    }
+    
+    ai_hat_get_stream_stats(stats);
+    return per_second(stats->tensors, stats->ticks);
+}
+
+static void bench_spi(void) {
+    static const uint8_t blob[64];
+    ai_hat_stream_stats_t stats;
+    uint32_t model_id;
+    char line[96];
+    
+    serial_puts("AI HAT+ tensor streaming:\n");
+    
+    // Use the HAT that is already up, otherwise the emulator for the
+    // length of the suite only
+    ai_hat_info_t info;
+    int borrowed = ai_hat_get_info(&info) != AI_HAT_SUCCESS;
+    if (ai_hat_init_emulator() != AI_HAT_SUCCESS ||
+        ai_hat_load_model(blob, sizeof(blob), AI_HAT_PRECISION_FP16, &model_id) != AI_HAT_SUCCESS) {
+        serial_puts("  stream: n/a (AI HAT+ unavailable)\n");
+        spi_summary_na();
+        if (borrowed) {
+            ai_hat_shutdown();
+        }
+        return;
+    }
+    
+    uint32_t serial_ips = spi_stream(model_id, 0, &stats);
+    uint32_t pipelined_ips = spi_stream(model_id, 1, &stats);
+    ai_hat_unload_model(model_id);
+    if (borrowed) {
+        ai_hat_shutdown();
+    }
+    
+    if (serial_ips == 0 || pipelined_ips == 0) {
+        serial_puts("  stream: failed\n");
+        spi_summary_na();
+        return;
+    }
+    
+    // Achieved payload rate against the raw bus rate
+    uint64_t ns = timer_ticks_to_ns(stats.ticks);
+    uint32_t kbps = (uint32_t)timer_div64(stats.bytes * 1000000ULL, ns ? ns : 1);
+    uint32_t bus_kbps = stats.bus_clock / 8000;
+    uint32_t percent = bus_kbps ? (uint32_t)timer_div64((uint64_t)kbps * 100, bus_kbps) : 0;
+    
+    report("serial", serial_ips, "inferences/s");
+    report("double-buffered", pipelined_ips, "inferences/s");
+    sprintf(line, "  throughput: %u.%u%u MB/s of %u.%u%u MB/s bus (%u%%, %s)\n",
+            kbps / 1000, (kbps / 100) % 10, (kbps / 10) % 10,
+            bus_kbps / 1000, (bus_kbps / 100) % 10, (bus_kbps / 10) % 10, percent, stats.link);
+    serial_puts(line);
+    
+    summary_add("spi_serial_ips", serial_ips);
+    summary_add("spi_pipelined_ips", pipelined_ips);
+    summary_add("spi_kbps", kbps);
+    summary_add("spi_bus_kbps", bus_kbps);
+}
+
+static uint8_t cpu_model[KBENCH_CPU_MODEL_SIZE] __attribute__((aligned(16)));
+static uint32_t cpu_model_length;
+static uint32_t cpu_model_seed;
+
+static void cpu_model_put(const void* data, uint32_t size) {
+    memcpy(cpu_model + cpu_model_length, data, size);
+    cpu_model_length += size;
+}
+
+// Append a layer with pseudo-random weights and zero biases. Only
+// ACTIVATION layers clamp, so the engine has something to fuse.
+static void cpu_model_layer(ai_cpu_dtype_t dtype, ai_cpu_op_t op, uint8_t kernel, uint8_t stride,
+                            uint8_t pad, uint16_t out_channels, uint32_t weights, uint32_t biases) {
+    ai_cpu_layer_t layer;
+    uint32_t element = (dtype == AI_CPU_DTYPE_INT8) ? 1 : 2;
+    uint32_t weight_bytes = (weights * element + 3) & ~3u;
+    const uint32_t zero = 0;
+    
+    memset(&layer, 0, sizeof(layer));
+    layer.op = op;
+    layer.kernel_h = kernel;
+    layer.kernel_w = kernel;
+    layer.stride = stride;
+    layer.pad = pad;
+    layer.out_channels = out_channels;
+    layer.activation = (op == AI_CPU_OP_ACTIVATION) ? AI_CPU_ACT_RELU : AI_CPU_ACT_NONE;
+    layer.multiplier = 1 << 30;   // acc / 512
+    layer.shift = -8;
+    layer.act_min = (op == AI_CPU_OP_ACTIVATION) ? 0 : -128;
+    layer.act_max = 127;
+    layer.in_scale = 0.1f;
+    layer.weights_size = (biases > 0) ? weight_bytes + biases * 4 : 0;
+    cpu_model_put(&layer, sizeof(layer));
+    
+    for (uint32_t i = 0; i < weights; i++) {
+        cpu_model_seed = cpu_model_seed * 1103515245 + 12345;
+        int8_t value = (int8_t)((int32_t)((cpu_model_seed >> 16) % 255) - 127);
+        if (dtype == AI_CPU_DTYPE_INT8) {
+            cpu_model_put(&value, 1);
+        } else {
+            uint16_t half = ai_cpu_float_to_half((float)value / 512.0f);
+            cpu_model_put(&half, 2);
+        }
+    }
+    cpu_model_put(&zero, weight_bytes - weights * element);
+    for (uint32_t i = 0; i < biases; i++) {
+        cpu_model_put(&zero, 4);
+    }
+}
+
+// Append an FP16 batch norm over channels with scales near 1
+static void cpu_model_batch_norm(uint32_t channels) {
+    ai_cpu_layer_t layer;
+    
+    memset(&layer, 0, sizeof(layer));
+    layer.op = AI_CPU_OP_BATCH_NORM;
+    layer.weights_size = channels * 8;
+    cpu_model_put(&layer, sizeof(layer));
+    
+    for (uint32_t i = 0; i < channels; i++) {
+        float scale = 1.0f + (float)(i % 4) / 8.0f;
+        cpu_model_put(&scale, 4);
+    }
+    for (uint32_t i = 0; i < channels; i++) {
+        float shift = (float)(i % 3) / 16.0f;
+        cpu_model_put(&shift, 4);
+    }
+}
+
+// A small MobileNet-style classifier: 64x64x3 -> 10 classes, written out
+// layer by layer the way a converter emits it before fusion
+static void cpu_model_build(ai_cpu_dtype_t dtype) {
+    ai_cpu_model_header_t header;
+    int fp16 = (dtype == AI_CPU_DTYPE_FP16);
+    
+    memset(&header, 0, sizeof(header));
+    header.magic = AI_CPU_MODEL_MAGIC;
+    header.version = AI_CPU_MODEL_VERSION;
+    header.dtype = dtype;
+    header.num_layers = fp16 ? 13 : 10;
+    header.input_h = 64;
+    header.input_w = 64;
+    header.input_c = 3;
+    
+    cpu_model_length = 0;
+    cpu_model_seed = 1;
+    cpu_model_put(&header, sizeof(header));
+    cpu_model_layer(dtype, AI_CPU_OP_CONV2D, 3, 2, 1, 16, 16 * 3 * 3 * 3, 16);    // 32x32x16
+    if (fp16) {
+        cpu_model_batch_norm(16);
+    }
+    cpu_model_layer(dtype, AI_CPU_OP_ACTIVATION, 0, 0, 0, 0, 0, 0);
+    cpu_model_layer(dtype, AI_CPU_OP_DEPTHWISE, 3, 1, 1, 0, 3 * 3 * 16, 16);      // 32x32x16
+    if (fp16) {
+        cpu_model_batch_norm(16);
+    }
+    cpu_model_layer(dtype, AI_CPU_OP_ACTIVATION, 0, 0, 0, 0, 0, 0);
+    cpu_model_layer(dtype, AI_CPU_OP_CONV2D, 3, 1, 1, 32, 32 * 3 * 3 * 16, 32);   // 32x32x32
+    if (fp16) {
+        cpu_model_batch_norm(32);
+    }
+    cpu_model_layer(dtype, AI_CPU_OP_ACTIVATION, 0, 0, 0, 0, 0, 0);
+    cpu_model_layer(dtype, AI_CPU_OP_AVG_POOL, 8, 8, 0, 0, 0, 0);                 // 4x4x32
+    cpu_model_layer(dtype, AI_CPU_OP_RESHAPE, 0, 0, 0, 0, 0, 0);                  // 1x1x512
+    cpu_model_layer(dtype, AI_CPU_OP_FULLY_CONNECTED, 0, 0, 0, 10, 10 * 512, 10); // 10
+    cpu_model_layer(dtype, AI_CPU_OP_SOFTMAX, 0, 0, 0, 0, 0, 0);
+}
+
+static uint32_t cpu_run(int handle, ai_cpu_isa_t isa) {
+    ai_cpu_set_isa(isa);
+    ai_cpu_run(handle, ai_input, ai_output);
+    
+    uint64_t start = timer_ticks();
+    for (int i = 0; i < KBENCH_CPU_RUNS; i++) {
+        ai_cpu_run(handle, ai_input, ai_output);
+    }
+    return per_second(KBENCH_CPU_RUNS, timer_ticks() - start);
+}
+
+static void bench_cpu(void) {
+    static const struct {
+        ai_cpu_dtype_t dtype;
+        const char* name;
+        const char* scalar_key;
+        const char* simd_key;
+        const char* unfused_key;
+    } variants[] = {
+        {AI_CPU_DTYPE_INT8, "int8", "cpu_int8_scalar_ips", "cpu_int8_ips", "cpu_int8_unfused_ips"},
+        {AI_CPU_DTYPE_FP16, "fp16", "cpu_fp16_scalar_ips", "cpu_fp16_ips", "cpu_fp16_unfused_ips"},
+    };
+    char label[48];
+    char line[96];
+    
+    ai_cpu_init();
+    ai_cpu_isa_t best = ai_cpu_detect_isa();
+    
+    serial_puts("CPU inference engine:\n");
+    for (uint32_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+        ai_cpu_model_info_t info;
+        cpu_model_build(variants[v].dtype);
+        int handle = ai_cpu_load_model(cpu_model, cpu_model_length, &info);
+        if (handle < 0) {
+            sprintf(line, "  %s: n/a (model rejected)\n", variants[v].name);
+            serial_puts(line);
+            summary_add_na(variants[v].scalar_key);
+            summary_add_na(variants[v].simd_key);
+            summary_add_na(variants[v].unfused_key);
+            continue;
+        }
+        
+        memset(ai_input, 0x11, info.input_bytes);
+        uint32_t scalar_ips = cpu_run(handle, AI_CPU_ISA_SCALAR);
+        uint32_t simd_ips = cpu_run(handle, best);
+        ai_cpu_unload_model(handle);
+        
+        // The same model with every layer as its own kernel
+        uint32_t unfused_ips = 0;
+        ai_cpu_set_fusion(0);
+        cpu_model_build(variants[v].dtype);
+        handle = ai_cpu_load_model(cpu_model, cpu_model_length, NULL);
+        ai_cpu_set_fusion(1);
+        if (handle >= 0) {
+            unfused_ips = cpu_run(handle, best);
+            ai_cpu_unload_model(handle);
+        }
+        
+        sprintf(label, "%s scalar", variants[v].name);
+        report(label, scalar_ips, "inferences/s");
+        sprintf(label, "%s %s", variants[v].name, ai_cpu_isa_name(best));
+        report(label, simd_ips, "inferences/s");
+        sprintf(label, "%s %s unfused", variants[v].name, ai_cpu_isa_name(best));
+        report(label, unfused_ips, "inferences/s");
+        sprintf(line, "  %s: %u MMAC/s, %u MMAC per inference, %u layers in %u kernels\n", variants[v].name,
+                (uint32_t)timer_div64(info.macs * simd_ips, 1000000),
+                (uint32_t)timer_div64(info.macs, 1000000), info.layers, info.ops);
+        serial_puts(line);
+        
+        summary_add(variants[v].scalar_key, scalar_ips);
+        summary_add(variants[v].simd_key, simd_ips);
+        summary_add(variants[v].unfused_key, unfused_ips);
+    }
+    ai_cpu_set_isa(best);
+}
+
+static void vm_summary_na(void) {
+    summary_add_na("vm_zero_map_ns");
+    summary_add_na("vm_zero_fill_ns");
+    summary_add_na("vm_cow_ns");
+}
+
+// Time one fault per page: a read of untouched memory (zero page), the
+// first write to it (zeroed frame) and a write after cloning the address
+// space (copy-on-write)
+static void bench_vm(void) {
+    const uint64_t size = (uint64_t)KBENCH_VM_PAGES * PAGE_SIZE;
+    vmm_space_t* space = vmm_current();
+    uint64_t addr = 0;
+    uint32_t sum = 0;
+    
+    serial_puts("Virtual memory:\n");
+    
+    if (!vmm_enabled() || vmm_map_anon(space, &addr, size, VMM_PROT_READ | VMM_PROT_WRITE, 0) != VMM_SUCCESS) {
+        serial_puts("  vm: n/a (no virtual memory manager)\n");
+        vm_summary_na();
+        return;
+    }
+    volatile uint8_t* base = (volatile uint8_t*)(uintptr_t)addr;
+    
+    uint64_t start = timer_ticks();
+    for (uint32_t i = 0; i < KBENCH_VM_PAGES; i++) {
+        sum += base[i * PAGE_SIZE];
+    }
+    uint32_t ns = ns_per_op(timer_ticks() - start, KBENCH_VM_PAGES);
+    report("zero page map", ns, "ns/fault");
+    summary_add("vm_zero_map_ns", ns);
+    
+    start = timer_ticks();
+    for (uint32_t i = 0; i < KBENCH_VM_PAGES; i++) {
+        base[i * PAGE_SIZE] = (uint8_t)i;
+    }
+    ns = ns_per_op(timer_ticks() - start, KBENCH_VM_PAGES);
+    report("zero fill", ns, "ns/fault");
+    summary_add("vm_zero_fill_ns", ns);
+    
+    vmm_space_t* clone = vmm_space_clone(space);
+    if (clone == NULL) {
+        serial_puts("  cow: n/a (clone failed)\n");
+        summary_add_na("vm_cow_ns");
+    } else {
+        start = timer_ticks();
+        for (uint32_t i = 0; i < KBENCH_VM_PAGES; i++) {
+            base[i * PAGE_SIZE] = (uint8_t)(i + 1);
+        }
+        ns = ns_per_op(timer_ticks() - start, KBENCH_VM_PAGES);
+        report("copy-on-write", ns, "ns/fault");
+        summary_add("vm_cow_ns", ns);
+        vmm_space_destroy(clone);
+    }
+    
+    vmm_unmap(space, addr, size);
+    (void)sum;
+}
+
+static void pages_worker(uint32_t cpu, void* arg) {
+    uint64_t frames[KBENCH_PAGE_BURST];
+    (void)cpu;
+    (void)arg;
+    
+    for (uint32_t round = 0; round < KBENCH_PAGE_ROUNDS; round++) {
+        for (uint32_t i = 0; i < KBENCH_PAGE_BURST; i++) {
+            frames[i] = page_alloc();
+        }
+        for (uint32_t i = 0; i < KBENCH_PAGE_BURST; i++) {
+            if (frames[i] != 0) {
+                page_put(frames[i]);
+            }
+        }
+    }
+}
+
+// Alloc/free pairs on cpus CPUs at once, with or without the per-CPU
+// caches. Returns ns per pair as seen by one CPU; *contended receives the
+// percentage of zone lock acquires that had to wait.
+static uint32_t pages_run(uint32_t cpus, int cached, uint32_t* contended) {
+    memory_stats_t before, after;
+    uint32_t acquires = 0;
+    uint32_t waits = 0;
+    
+    memory_set_page_cache(cached);
+    pages_worker(0, NULL);  // Warm the caches and the allocator's code path
+    
+    memory_get_stats(&before);
+    uint64_t start = timer_ticks();
+    smp_run(cpus, pages_worker, NULL);
+    uint64_t ticks = timer_ticks() - start;
+    memory_get_stats(&after);
+    
+    for (uint32_t z = 0; z < MEMORY_ZONES; z++) {
+        acquires += after.zones[z].lock_acquires - before.zones[z].lock_acquires;
+        waits += after.zones[z].lock_contended - before.zones[z].lock_contended;
+    }
+    *contended = acquires ? (uint32_t)timer_div64((uint64_t)waits * 100, acquires) : 0;
+    return ns_per_op(ticks, KBENCH_PAGE_ROUNDS * KBENCH_PAGE_BURST);
+}
+
+static void pages_summary(uint32_t cpus, const uint32_t* values) {
+    static const char* const keys[] = {
+        "pages_cpu%u_ns", "pages_cpu%u_contended_pct",
+        "pages_locked_cpu%u_ns", "pages_locked_cpu%u_contended_pct"
+    };
+    char key[40];
+    
+    for (uint32_t i = 0; i < 4; i++) {
+        sprintf(key, keys[i], cpus);
+        if (values != NULL) {
+            summary_add(key, values[i]);
+        } else {
+            summary_add_na(key);
+        }
+    }
+}
+
+// Page allocator scaling: the same alloc/free loop on 1 to SMP_MAX_CPUS
+// CPUs, through the per-CPU caches and then through the zone lock alone.
+// With the caches the time per pair should stay flat as CPUs are added.
+// The summary keeps 1, 2, 4 and 8 CPUs.
+static void bench_pages(void) {
+    uint32_t online = smp_cpu_count();
+    char line[128];
+    
+    sprintf(line, "Page allocator (%u CPUs online, ns per alloc+free on each CPU):\n", online);
+    serial_puts(line);
+    
+    for (uint32_t cpus = 1; cpus <= SMP_MAX_CPUS; cpus++) {
+        int keyed = (cpus & (cpus - 1)) == 0;
+        uint32_t values[4];
+        
+        if (cpus > online) {
+            sprintf(line, "  %u CPUs: n/a (run QEMU with -smp %u)\n", cpus, cpus);
+            serial_puts(line);
+            if (keyed) {
+                pages_summary(cpus, NULL);
+            }
+            continue;
+        }
+        
+        values[0] = pages_run(cpus, 1, &values[1]);
+        values[2] = pages_run(cpus, 0, &values[3]);
+        sprintf(line, "  %u CPUs: per-CPU cache %u ns (%u%% lock waits), zone lock only %u ns (%u%% lock waits)\n",
+                cpus, values[0], values[1], values[2], values[3]);
+        serial_puts(line);
+        if (keyed) {
+            pages_summary(cpus, values);
+        }
+    }
+    memory_set_page_cache(1);
+}
+
+// ─── Entry point ─────────────────────────────────────────────────────────────
+
+typedef struct {
+    const char* name;
+    void (*run)(void);
+} kbench_suite_t;
+
+static const kbench_suite_t suites[] = {
+    {"mem",  bench_mem},
+    {"ctx",  bench_ctx},
+    {"irq",  bench_irq},
+    {"fs",   bench_fs},
+    {"uart", bench_uart},
+    {"ai",   bench_ai},
+    {"spi",  bench_spi},
+    {"cpu",  bench_cpu},
+    {"vm",   bench_vm},
+    {"pages", bench_pages},
+    {NULL, NULL}
+};
+
+int kbench_run(const char* suite) {
+    int all = (suite == NULL || strcmp(suite, "all") == 0);
+    int found = all;
+    
+    for (int i = 0; !all && suites[i].name != NULL; i++) {
+        if (strcmp(suite, suites[i].name) == 0) {
+            found = 1;
+        }
+    }
+    if (!found) {
+        return -1;
+    }
+    
+    char header[96];
+    uint32_t hz = (uint32_t)timer_ticks_per_sec();
+    sprintf(header, "SAGE OS kernel benchmarks (%s, timer %s @ %u Hz)\n", KBENCH_ARCH, timer_source(), hz);
+    serial_puts(header);
+    
+    sprintf(summary, "BENCH_SUMMARY arch=%s timer=%s timer_hz=%u", KBENCH_ARCH, timer_source(), hz);
+    
+    for (int i = 0; suites[i].name != NULL; i++) {
+        if (all || strcmp(suite, suites[i].name) == 0) {
+            suites[i].run();
+        }
+    }
+    
+    serial_puts(summary);
+    serial_puts("\n");
+    return 0;
+}
@@ -0,0 +1,18 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — In-Kernel Benchmarks
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef KBENCH_H
+#define KBENCH_H
+
+#include "types.h"
+
+// Run a benchmark suite and print the results followed by a single
+// "BENCH_SUMMARY key=value ..." line for scripts to collect.
+// suite is one of: all, mem, ctx, irq, fs, uart, ai, spi, cpu, vm, pages.
+// Returns 0 on success, -1 if the suite name is unknown.
+int kbench_run(const char* suite);
+
+#endif // KBENCH_H
@@ -4,6 +4,10 @@
 #include "../drivers/serial.h"
 #include "shell.h"
 #include "filesystem.h"
+#include "mmu.h"
+#include "memory.h"
+#include "vmm.h"
+#include "smp.h"
 
 #if defined(__x86_64__) || defined(__i386__)
 // I/O port functions for x86
@@ -334,6 +338,28 @@ void kernel_main() {
     serial_puts(serial_get_uart_info());
     serial_puts("\n");
     
+    // Page tables and caches before anything memory-bound runs
+    int mmu_status = mmu_init();
+    if (mmu_status == MMU_SUCCESS) {
+        serial_puts("SAGE OS: MMU on, I/D caches enabled\n");
+    } else if (mmu_status != MMU_ERROR_UNSUPPORTED) {
+        serial_puts("SAGE OS: MMU not enabled, running uncached\n");
+    }
+    
+    // Page frames, then demand paging on top of the kernel tables
+    memory_init();
+    if (vmm_init() == VMM_SUCCESS) {
+        serial_puts("SAGE OS: Virtual memory manager ready\n");
+    }
+    
+    // Secondary CPUs run on the kernel tables, so they start once those are built
+    int cpus = smp_init();
+    if (cpus > 1) {
+        char line[] = "SAGE OS: 0 CPUs online\n";
+        line[9] = (char)('0' + cpus);
+        serial_puts(line);
+    }
+    
     // Display ASCII art welcome message
     display_welcome_message();
     
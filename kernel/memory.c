@@ -69,20 +69,415 @@
 //
 
 #include "memory.h"
+#include "smp.h"
 #include "../drivers/uart.h"
 
+#define MEMORY_POOL_PAGES       (MEMORY_POOL_SIZE / PAGE_SIZE)
+#define MEMORY_DMA_PAGES        ((MEMORY_DMA_SIZE < MEMORY_POOL_SIZE ? MEMORY_DMA_SIZE : MEMORY_POOL_SIZE) / PAGE_SIZE)
+
+// Per-CPU caches: a ring of free frame numbers, hot end at head + count - 1,
+// cold end at head. An empty cache takes a batch from its zone; a full one
+// gives a batch from the cold end back first. Each cache has a lock that
+// only its own CPU takes, unless a zone runs dry and another CPU reclaims
+// the frames cached there.
+#define PAGE_CACHE_SIZE         64      // Power of two
+#define PAGE_CACHE_BATCH        16
+#define PAGE_CACHE_MASK         (PAGE_CACHE_SIZE - 1)
+
+#define FRAME_NONE              0xFFFFFFFFu
+
+// Linker script symbol: end of the kernel image and its BSS
+extern char __end[];
+
+typedef struct {
+    uint32_t lock;
+    uint32_t first;             // First frame number of the zone
+    uint32_t pages;
+    uint32_t free_count;        // Free frames at free_stack[first .. first + free_count)
+    uint32_t lock_acquires;
+    uint32_t lock_contended;
+} __attribute__((aligned(64))) memory_zone_t;
+
+typedef struct {
+    uint32_t frames[PAGE_CACHE_SIZE];
+    uint32_t lock;
+    uint32_t head;
+    uint32_t count;
+    uint32_t hits;
+    uint32_t refills;
+    uint32_t drains;
+} __attribute__((aligned(64))) page_cache_t;
+
+static uint64_t pool_start = 0;
+static uint32_t free_stack[MEMORY_POOL_PAGES];     // Per-zone slices, top at free_count - 1
+static uint32_t page_ref_count[MEMORY_POOL_PAGES];
+static memory_zone_t zones[MEMORY_ZONES];
+static page_cache_t page_caches[SMP_MAX_CPUS][MEMORY_ZONES];
+static int cache_enabled = 1;
+static uint32_t pages_taken = 0;                    // Frames off the zone free lists
+static uint32_t peak_pages = 0;
+static uint32_t alloc_failures = 0;
+static int memory_ready = 0;
+
+// Frame number of a pool address, or MEMORY_POOL_PAGES if outside the pool
+static uint32_t frame_index(uint64_t phys) {
+    if (phys < pool_start || phys - pool_start >= (uint64_t)MEMORY_POOL_SIZE) {
+        return MEMORY_POOL_PAGES;
+    }
+    return (uint32_t)((phys - pool_start) >> PAGE_SHIFT);
+}
+
+static inline uint32_t frame_zone(uint32_t index) {
+    return (index < MEMORY_DMA_PAGES) ? MEMORY_ZONE_DMA : MEMORY_ZONE_NORMAL;
+}
+
+// Returns 1 if the lock was held by another CPU and had to be waited for
+static int spin_lock(uint32_t* lock) {
+    int contended = 0;
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE) != 0) {
+        contended = 1;
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED) != 0) {
+            smp_relax();
+        }
+    }
+    return contended;
+}
+
+static void spin_unlock(uint32_t* lock) {
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+static void zone_lock(memory_zone_t* zone) {
+    int contended = spin_lock(&zone->lock);
+    zone->lock_acquires++;
+    zone->lock_contended += contended;
+}
+
+static void zone_unlock(memory_zone_t* zone) {
+    spin_unlock(&zone->lock);
+}
+
+static void taken_add(uint32_t count) {
+    uint32_t taken = __atomic_add_fetch(&pages_taken, count, __ATOMIC_RELAXED);
+    uint32_t peak = __atomic_load_n(&peak_pages, __ATOMIC_RELAXED);
+    while (taken > peak &&
+           !__atomic_compare_exchange_n(&peak_pages, &peak, taken, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// Move up to count frames from a zone's free list to the hot end of a
+// cache. The caller holds the cache lock, as for cache_drain.
+static uint32_t cache_refill(page_cache_t* cache, memory_zone_t* zone, uint32_t count) {
+    zone_lock(zone);
+    if (count > zone->free_count) {
+        count = zone->free_count;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        cache->frames[(cache->head + cache->count) & PAGE_CACHE_MASK] =
+            free_stack[zone->first + --zone->free_count];
+        cache->count++;
+    }
+    zone_unlock(zone);
+    
+    if (count > 0) {
+        cache->refills++;
+        taken_add(count);
+    }
+    return count;
+}
+
+// Return up to count frames from the cold end of a cache to its zone
+static void cache_drain(page_cache_t* cache, memory_zone_t* zone, uint32_t count) {
+    if (count > cache->count) {
+        count = cache->count;
+    }
+    zone_lock(zone);
+    for (uint32_t i = 0; i < count; i++) {
+        free_stack[zone->first + zone->free_count++] = cache->frames[cache->head];
+        cache->head = (cache->head + 1) & PAGE_CACHE_MASK;
+        cache->count--;
+    }
+    zone_unlock(zone);
+    
+    cache->drains++;
+    __atomic_sub_fetch(&pages_taken, count, __ATOMIC_RELAXED);
+}
+
+// Give the frames cached by every other CPU for a zone back to it
+static void cache_reclaim(uint32_t self, uint32_t zone_id) {
+    for (uint32_t cpu = 0; cpu < SMP_MAX_CPUS; cpu++) {
+        page_cache_t* cache = &page_caches[cpu][zone_id];
+        if (cpu == self) {
+            continue;
+        }
+        spin_lock(&cache->lock);
+        if (cache->count > 0) {
+            cache_drain(cache, &zones[zone_id], PAGE_CACHE_SIZE);
+        }
+        spin_unlock(&cache->lock);
+    }
+}
+
+// Lock a CPU's cache for a zone, or return NULL when the caches are off.
+// The flag is read again under the lock: once memory_set_page_cache(0) has
+// drained a cache, nothing more is put into it.
+static page_cache_t* cache_lock(uint32_t cpu, uint32_t zone_id) {
+    if (cpu >= SMP_MAX_CPUS || !__atomic_load_n(&cache_enabled, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    page_cache_t* cache = &page_caches[cpu][zone_id];
+    spin_lock(&cache->lock);
+    if (!__atomic_load_n(&cache_enabled, __ATOMIC_ACQUIRE)) {
+        spin_unlock(&cache->lock);
+        return NULL;
+    }
+    return cache;
+}
+
+static uint32_t cache_alloc(page_cache_t* cache, uint32_t flags) {
+    uint32_t index;
+    if (flags & PAGE_ALLOC_COLD) {
+        index = cache->frames[cache->head];
+        cache->head = (cache->head + 1) & PAGE_CACHE_MASK;
+    } else {
+        index = cache->frames[(cache->head + cache->count - 1) & PAGE_CACHE_MASK];
+    }
+    cache->count--;
+    return index;
+}
+
+// Take a frame from a zone, through this CPU's cache when it has one
+static uint32_t zone_alloc(uint32_t zone_id, uint32_t flags) {
+    memory_zone_t* zone = &zones[zone_id];
+    uint32_t cpu = smp_cpu_id();
+    uint32_t index = FRAME_NONE;
+    
+    page_cache_t* cache = cache_lock(cpu, zone_id);
+    if (cache != NULL) {
+        if (cache->count > 0) {
+            cache->hits++;
+            index = cache_alloc(cache, flags);
+        } else if (cache_refill(cache, zone, PAGE_CACHE_BATCH) > 0) {
+            index = cache_alloc(cache, flags);
+        }
+        spin_unlock(&cache->lock);
+        
+        // The zone is dry: frames may still sit in other CPUs' caches
+        if (index == FRAME_NONE) {
+            cache_reclaim(cpu, zone_id);
+            cache = cache_lock(cpu, zone_id);
+            if (cache != NULL) {
+                if (cache->count > 0 || cache_refill(cache, zone, PAGE_CACHE_BATCH) > 0) {
+                    index = cache_alloc(cache, flags);
+                }
+                spin_unlock(&cache->lock);
+            }
+        }
+    }
+    
+    // Caches off, or turned off while this CPU was reclaiming
+    if (cache == NULL) {
+        zone_lock(zone);
+        if (zone->free_count > 0) {
+            index = free_stack[zone->first + --zone->free_count];
+        }
+        zone_unlock(zone);
+        
+        if (index != FRAME_NONE) {
+            taken_add(1);
+        }
+    }
+    
+    if (index != FRAME_NONE) {
+        __atomic_store_n(&page_ref_count[index], 1, __ATOMIC_RELAXED);
+    }
+    return index;
+}
+
+static void frame_free(uint32_t index, int cold) {
+    uint32_t zone_id = frame_zone(index);
+    memory_zone_t* zone = &zones[zone_id];
+    uint32_t cpu = smp_cpu_id();
+    
+    page_cache_t* cache = cache_lock(cpu, zone_id);
+    if (cache != NULL) {
+        if (cache->count == PAGE_CACHE_SIZE) {
+            cache_drain(cache, zone, PAGE_CACHE_BATCH);
+        }
+        
+        if (cold) {
+            cache->head = (cache->head - 1) & PAGE_CACHE_MASK;
+            cache->frames[cache->head] = index;
+        } else {
+            cache->frames[(cache->head + cache->count) & PAGE_CACHE_MASK] = index;
+        }
+        cache->count++;
+        spin_unlock(&cache->lock);
+    } else {
+        zone_lock(zone);
+        free_stack[zone->first + zone->free_count++] = index;
+        zone_unlock(zone);
+        __atomic_sub_fetch(&pages_taken, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static uint64_t frame_address(uint32_t index) {
+    return pool_start + ((uint64_t)index << PAGE_SHIFT);
+}
+
 // Initialize memory management
 void memory_init() {
-    // Basic memory initialization
-    // For now, this is a placeholder
+    if (memory_ready) {
+        return;
+    }
+    
+    pool_start = ((uint64_t)(uintptr_t)__end + PAGE_SIZE - 1) & ~(uint64_t)(PAGE_SIZE - 1);
+    
+    zones[MEMORY_ZONE_DMA].first = 0;
+    zones[MEMORY_ZONE_DMA].pages = MEMORY_DMA_PAGES;
+    zones[MEMORY_ZONE_NORMAL].first = MEMORY_DMA_PAGES;
+    zones[MEMORY_ZONE_NORMAL].pages = MEMORY_POOL_PAGES - MEMORY_DMA_PAGES;
+    
+    // Push in reverse so the lowest frames of each zone are handed out first
+    for (uint32_t z = 0; z < MEMORY_ZONES; z++) {
+        memory_zone_t* zone = &zones[z];
+        for (uint32_t i = 0; i < zone->pages; i++) {
+            free_stack[zone->first + i] = zone->first + zone->pages - 1 - i;
+            page_ref_count[zone->first + i] = 0;
+        }
+        zone->free_count = zone->pages;
+    }
+    memory_ready = 1;
+}
+
+uint64_t page_alloc_zone(uint32_t zone, uint32_t flags) {
+    if (!memory_ready) {
+        memory_init();
+    }
+    if (zone >= MEMORY_ZONES) {
+        return 0;
+    }
+    
+    uint32_t index = zone_alloc(zone, flags);
+    if (index == FRAME_NONE) {
+        __atomic_add_fetch(&alloc_failures, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return frame_address(index);
+}
+
+uint64_t page_alloc(void) {
+    if (!memory_ready) {
+        memory_init();
+    }
+    
+    uint32_t index = zone_alloc(MEMORY_ZONE_NORMAL, 0);
+    if (index == FRAME_NONE) {
+        index = zone_alloc(MEMORY_ZONE_DMA, 0);
+    }
+    if (index == FRAME_NONE) {
+        __atomic_add_fetch(&alloc_failures, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return frame_address(index);
+}
+
+void page_get(uint64_t phys) {
+    uint32_t index = frame_index(phys);
+    if (index < MEMORY_POOL_PAGES && __atomic_load_n(&page_ref_count[index], __ATOMIC_RELAXED) != 0) {
+        __atomic_add_fetch(&page_ref_count[index], 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void frame_put(uint64_t phys, int cold) {
+    uint32_t index = frame_index(phys);
+    if (index < MEMORY_POOL_PAGES && __atomic_load_n(&page_ref_count[index], __ATOMIC_RELAXED) != 0 &&
+        __atomic_sub_fetch(&page_ref_count[index], 1, __ATOMIC_ACQ_REL) == 0) {
+        frame_free(index, cold);
+    }
+}
+
+void page_put(uint64_t phys) {
+    frame_put(phys, 0);
+}
+
+void page_put_cold(uint64_t phys) {
+    frame_put(phys, 1);
+}
+
+uint32_t page_refs(uint64_t phys) {
+    uint32_t index = frame_index(phys);
+    return (index < MEMORY_POOL_PAGES) ? __atomic_load_n(&page_ref_count[index], __ATOMIC_RELAXED) : 0;
+}
+
+void memory_set_page_cache(int enabled) {
+    if (!memory_ready) {
+        memory_init();
+    }
+    
+    // Turn the caches off before draining them, so no CPU refills one
+    // behind the drain
+    __atomic_store_n(&cache_enabled, enabled, __ATOMIC_RELEASE);
+    if (!enabled) {
+        for (uint32_t z = 0; z < MEMORY_ZONES; z++) {
+            cache_reclaim(SMP_MAX_CPUS, z);
+        }
+    }
+}
+
+void memory_get_stats(memory_stats_t* stats) {
+    if (!memory_ready) {
+        memory_init();
+    }
+    stats->pool_start = pool_start;
+    stats->total_pages = MEMORY_POOL_PAGES;
+    stats->free_pages = 0;
+    stats->peak_pages = __atomic_load_n(&peak_pages, __ATOMIC_RELAXED);
+    stats->failures = __atomic_load_n(&alloc_failures, __ATOMIC_RELAXED);
+    stats->cached_pages = 0;
+    stats->cache_hits = 0;
+    stats->cache_refills = 0;
+    stats->cache_drains = 0;
+    stats->cache_enabled = __atomic_load_n(&cache_enabled, __ATOMIC_ACQUIRE);
+    
+    // Other CPUs may be allocating; the counts are a snapshot, not exact
+    for (uint32_t z = 0; z < MEMORY_ZONES; z++) {
+        memory_zone_stats_t* zone = &stats->zones[z];
+        zone->total_pages = zones[z].pages;
+        zone->free_pages = zones[z].free_count;
+        zone->lock_acquires = zones[z].lock_acquires;
+        zone->lock_contended = zones[z].lock_contended;
+        for (uint32_t cpu = 0; cpu < SMP_MAX_CPUS; cpu++) {
+            const page_cache_t* cache = &page_caches[cpu][z];
+            zone->free_pages += cache->count;
+            stats->cached_pages += cache->count;
+            stats->cache_hits += cache->hits;
+            stats->cache_refills += cache->refills;
+            stats->cache_drains += cache->drains;
+        }
+        stats->free_pages += zone->free_pages;
+    }
 }
 
 // Display memory statistics
 void memory_stats() {
+    memory_stats_t stats;
+    memory_get_stats(&stats);
+    
     uart_puts("Memory Statistics:\n");
-    uart_puts("  Total RAM: 1024 MB\n");
-    uart_puts("  Available: 1000 MB\n");
-    uart_puts("  Used: 24 MB\n");
-    uart_puts("  Kernel: 16 MB\n");
-    uart_puts("  User: 8 MB\n");
-}
\ No newline at end of file
+    uart_printf("  Page pool: %d KB (%d frames)\n", (int)(stats.total_pages * (PAGE_SIZE / 1024)),
+                (int)stats.total_pages);
+    uart_printf("  Free: %d KB\n", (int)(stats.free_pages * (PAGE_SIZE / 1024)));
+    uart_printf("  Used: %d KB (peak %d KB)\n",
+                (int)((stats.total_pages - stats.free_pages) * (PAGE_SIZE / 1024)),
+                (int)(stats.peak_pages * (PAGE_SIZE / 1024)));
+    uart_printf("  Allocation failures: %d\n", (int)stats.failures);
+    uart_printf("  DMA zone: %d/%d KB free, normal zone: %d/%d KB free\n",
+                (int)(stats.zones[MEMORY_ZONE_DMA].free_pages * (PAGE_SIZE / 1024)),
+                (int)(stats.zones[MEMORY_ZONE_DMA].total_pages * (PAGE_SIZE / 1024)),
+                (int)(stats.zones[MEMORY_ZONE_NORMAL].free_pages * (PAGE_SIZE / 1024)),
+                (int)(stats.zones[MEMORY_ZONE_NORMAL].total_pages * (PAGE_SIZE / 1024)));
+    uart_printf("  Per-CPU caches: %d frames, %d hits, %d refills, %d drains\n",
+                (int)stats.cached_pages, (int)stats.cache_hits, (int)stats.cache_refills,
+                (int)stats.cache_drains);
+}
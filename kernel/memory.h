@@ -71,8 +71,90 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
-// Function declarations
+#include "types.h"
+
+// Physical page frames for page tables and demand-paged memory, taken from
+// the RAM that follows the kernel image. Frames are reference counted so
+// copy-on-write and shared mappings can point at the same frame.
+//
+// The pool is split into zones: the lowest frames form the DMA zone, kept
+// for buffers the SPI/DMA engines address, the rest the normal zone. Each
+// zone has its own free list and lock; in front of it every CPU keeps a
+// small cache of free frames, refilled and drained a batch at a time, so
+// most allocations and frees never touch the shared lock. Recently freed
+// frames are handed out first (hot, likely still in the CPU's cache);
+// cold frames go to the other end of the per-CPU cache. When a zone runs
+// dry, the frames other CPUs have cached are reclaimed before an
+// allocation fails. Frames are not allocated or freed from interrupt
+// handlers.
+
+#define PAGE_SIZE               4096
+#define PAGE_SHIFT              12
+
+// Bytes of RAM handed out as frames; boards can change it at build time
+#ifndef MEMORY_POOL_SIZE
+#define MEMORY_POOL_SIZE        (16 * 1024 * 1024)
+#endif
+
+// Bytes at the bottom of the pool kept for DMA. The pool starts right
+// after the kernel image, well inside the first GiB the BCM2711 DMA
+// engines can reach.
+#ifndef MEMORY_DMA_SIZE
+#define MEMORY_DMA_SIZE         (2 * 1024 * 1024)
+#endif
+
+// Zones
+#define MEMORY_ZONE_DMA         0
+#define MEMORY_ZONE_NORMAL      1
+#define MEMORY_ZONES            2
+
+// Allocation flags
+#define PAGE_ALLOC_COLD         0x1     // Prefer a frame not recently touched (device buffers)
+
+typedef struct {
+    uint32_t total_pages;
+    uint32_t free_pages;        // On the zone's free list or in a per-CPU cache
+    uint32_t lock_acquires;
+    uint32_t lock_contended;    // Acquires that found the lock held by another CPU
+} memory_zone_stats_t;
+
+typedef struct {
+    uint64_t pool_start;        // Physical address of the first frame
+    uint32_t total_pages;
+    uint32_t free_pages;
+    uint32_t peak_pages;        // Most frames out of the free lists at once
+    uint32_t failures;          // Allocations refused for lack of frames
+    uint32_t cached_pages;      // Free frames held in per-CPU caches
+    uint32_t cache_hits;        // Allocations served by a per-CPU cache without a refill
+    uint32_t cache_refills;
+    uint32_t cache_drains;
+    int cache_enabled;
+    memory_zone_stats_t zones[MEMORY_ZONES];
+} memory_stats_t;
+
 void memory_init();
 void memory_stats();
 
-#endif // MEMORY_H
\ No newline at end of file
+// Allocate a frame (contents undefined) holding one reference; returns its
+// physical address, or 0 when the pool is exhausted. Takes from the normal
+// zone and falls back to the DMA zone.
+uint64_t page_alloc(void);
+
+// Allocate from one zone only; flags are PAGE_ALLOC_*
+uint64_t page_alloc_zone(uint32_t zone, uint32_t flags);
+
+// Take or drop a reference; the frame is freed when the last one goes.
+// page_put_cold frees to the cold end, for frames the CPU has not touched.
+void page_get(uint64_t phys);
+void page_put(uint64_t phys);
+void page_put_cold(uint64_t phys);
+
+uint32_t page_refs(uint64_t phys);
+
+// Turn the per-CPU caches off (every CPU goes to the zone locks, for
+// comparison) or back on. Call only while no other CPU is allocating.
+void memory_set_page_cache(int enabled);
+
+void memory_get_stats(memory_stats_t* stats);
+
+#endif // MEMORY_H
@@ -0,0 +1,617 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — MMU and Kernel Page Tables
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "mmu.h"
+
+// RAM mapped at boot; boards with more memory can raise it at build time
+#ifndef MMU_RAM_SIZE
+#define MMU_RAM_SIZE            0x40000000ull
+#endif
+
+static const char* const type_names[MMU_MEM_TYPES] = {"normal", "device", "uncached", "write-combining"};
+
+static mmu_region_t regions[MMU_MAX_REGIONS];
+static uint32_t region_count = 0;
+static int mmu_on = 0;
+
+// Linker script symbols bounding the kernel image
+extern char __start[];
+extern char __end[];
+
+const char* mmu_type_name(uint32_t type) {
+    return (type < MMU_MEM_TYPES) ? type_names[type] : "?";
+}
+
+int mmu_enabled(void) {
+    return mmu_on;
+}
+
+int mmu_get_region(uint32_t index, mmu_region_t* region) {
+    if (index >= region_count || region == NULL) {
+        return -1;
+    }
+    *region = regions[index];
+    return 0;
+}
+
+#if defined(__aarch64__) || defined(__x86_64__)
+
+// ─── Page tables ─────────────────────────────────────────────────────────────
+//
+// Both architectures use 512-entry tables of 64-bit descriptors with a
+// 4 KiB granule: 1 GiB leaves one level above 2 MiB leaves, one above 4 KiB
+// pages. Only the root level and the descriptor bits differ.
+
+#define MMU_ENTRIES             512
+#define MMU_INDEX_BITS          9
+#define MMU_PAGE_SHIFT          12
+#define MMU_TABLE_POOL          16      // Page-table pages besides the root
+#define MMU_MAP_LIMIT           (1ull << 39)    // Reach of the higher-half alias
+
+#define DESC_ADDR_MASK          0x000FFFFFFFFFF000ull
+
+static uint64_t root_table[MMU_ENTRIES] __attribute__((aligned(4096)));
+static uint64_t table_pool[MMU_TABLE_POOL][MMU_ENTRIES] __attribute__((aligned(4096)));
+static uint32_t tables_used = 0;
+static uint32_t pa_bits = 0;
+static int huge_1g = 0;             // 1 GiB leaves supported
+static int write_combining = 0;
+static uint32_t leaves_1g = 0;
+static uint32_t leaves_2m = 0;
+static uint32_t leaves_4k = 0;
+
+#if defined(__aarch64__)
+
+// ─── AArch64: TTBR0/TTBR1, 39-bit VA starting at L1 ──────────────────────────
+//
+// TTBR0 and TTBR1 point at the same L1 table, so every mapping appears both
+// at its physical address and at MMU_HIGH_BASE + phys.
+
+#define MMU_ROOT_SHIFT          30
+
+// Descriptor bits (VMSAv8-64 stage 1)
+#define DESC_BLOCK              0x1ull
+#define DESC_TABLE              0x3ull
+#define DESC_PAGE               0x3ull
+#define DESC_TYPE_MASK          0x3ull
+#define DESC_ATTR(index)        ((uint64_t)(index) << 2)
+#define DESC_SH_INNER           (3ull << 8)
+#define DESC_AF                 (1ull << 10)
+#define DESC_PXN                (1ull << 53)
+#define DESC_UXN                (1ull << 54)
+
+// MAIR_EL1 attribute index per mmu_mem_type_t: write-back RA/WA,
+// Device-nGnRE, Normal non-cacheable. Write-combining uses the
+// non-cacheable index, which allows gathering.
+#define MAIR_VALUE              (0xFFull | (0x04ull << 8) | (0x44ull << 16))
+
+// TCR_EL1: both halves 39-bit, 4 KiB granule, inner shareable, walks
+// through write-back caches. IPS is filled in from the CPU's PA range.
+#define TCR_TSZ                 (64 - MMU_VA_BITS)
+#define TCR_VALUE               ((uint64_t)TCR_TSZ | (1ull << 8) | (1ull << 10) | (3ull << 12) | \
+                                 ((uint64_t)TCR_TSZ << 16) | (1ull << 24) | (1ull << 26) | \
+                                 (3ull << 28) | (2ull << 30))
+#define TCR_IPS_SHIFT           32
+
+#define SCTLR_M                 (1ull << 0)
+#define SCTLR_A                 (1ull << 1)
+#define SCTLR_C                 (1ull << 2)
+#define SCTLR_I                 (1ull << 12)
+#define SCTLR_WXN               (1ull << 19)
+
+static const uint8_t pa_range_bits[] = {32, 36, 40, 42, 44, 48};
+static uint32_t pa_range = 0;
+
+static uint64_t read_sctlr(void) {
+    uint64_t value;
+    __asm__ volatile ("mrs %0, sctlr_el1" : "=r"(value));
+    return value;
+}
+
+static uint32_t current_el(void) {
+    uint64_t value;
+    __asm__ volatile ("mrs %0, CurrentEL" : "=r"(value));
+    return (uint32_t)(value >> 2) & 3;
+}
+
+// PA size as its IPS encoding (capped at 48 bits, the most a 4 KiB granule
+// addresses without FEAT_LPA2)
+static void cpu_detect(void) {
+    uint64_t value;
+    __asm__ volatile ("mrs %0, id_aa64mmfr0_el1" : "=r"(value));
+    pa_range = (uint32_t)value & 0xF;
+    if (pa_range > 5) {
+        pa_range = 5;
+    }
+    pa_bits = pa_range_bits[pa_range];
+    huge_1g = 1;
+    write_combining = 1;
+}
+
+static uint64_t desc_table(const uint64_t* table) {
+    return (uint64_t)(uintptr_t)table | DESC_TABLE;
+}
+
+static uint64_t desc_leaf(uint64_t phys, uint32_t type, uint32_t shift) {
+    uint64_t kind = (shift == MMU_PAGE_SHIFT) ? DESC_PAGE : DESC_BLOCK;
+    
+    switch (type) {
+    case MMU_MEM_DEVICE:
+        return phys | DESC_ATTR(1) | DESC_AF | DESC_PXN | DESC_UXN | kind;
+    case MMU_MEM_NONCACHED:
+    case MMU_MEM_WRITE_COMBINING:
+        return phys | DESC_ATTR(2) | DESC_SH_INNER | DESC_AF | DESC_PXN | DESC_UXN | kind;
+    default:
+        return phys | DESC_ATTR(0) | DESC_SH_INNER | DESC_AF | DESC_UXN | kind;
+    }
+}
+
+static int desc_is_table(uint64_t entry) {
+    return (entry & DESC_TYPE_MASK) == DESC_TABLE;
+}
+
+// Entries only ever go from invalid to valid, so no TLB maintenance
+static void tables_updated(void) {
+    if (mmu_on) {
+        __asm__ volatile ("dsb ishst; isb" : : : "memory");
+    }
+}
+
+// Invalidate the data and unified caches by set/way. Lines left from before
+// the caches were enabled would otherwise shadow the page tables and
+// everything else written with the caches off.
+static void dcache_invalidate_all(void) {
+    uint64_t clidr;
+    __asm__ volatile ("mrs %0, clidr_el1" : "=r"(clidr));
+    uint32_t levels = (uint32_t)(clidr >> 24) & 7;     // Level of coherence
+    
+    for (uint32_t level = 0; level < levels; level++) {
+        uint32_t cache_type = (uint32_t)(clidr >> (level * 3)) & 7;
+        if (cache_type < 2) {
+            continue;           // No data cache at this level
+        }
+        
+        uint64_t ccsidr;
+        __asm__ volatile ("msr csselr_el1, %0; isb" : : "r"((uint64_t)level << 1) : "memory");
+        __asm__ volatile ("mrs %0, ccsidr_el1" : "=r"(ccsidr));
+        uint32_t line_shift = ((uint32_t)ccsidr & 7) + 4;
+        uint32_t ways = (((uint32_t)ccsidr >> 3) & 0x3FF) + 1;
+        uint32_t sets = (((uint32_t)ccsidr >> 13) & 0x7FFF) + 1;
+        
+        // The way number sits in the top bits of the operand
+        uint32_t way_bits = 0;
+        while ((1u << way_bits) < ways) {
+            way_bits++;
+        }
+        
+        for (uint32_t way = 0; way < ways; way++) {
+            for (uint32_t set = 0; set < sets; set++) {
+                uint64_t operand = ((uint64_t)way << (32 - way_bits)) |
+                                   ((uint64_t)set << line_shift) | (level << 1);
+                __asm__ volatile ("dc isw, %0" : : "r"(operand) : "memory");
+            }
+        }
+    }
+    __asm__ volatile ("dsb sy; isb" : : : "memory");
+}
+
+#elif defined(__x86_64__)
+
+// ─── x86_64: 4-level paging ──────────────────────────────────────────────────
+//
+// Long mode runs with paging on, so these tables replace the loader's.
+// PML4 entries 0 and 256 share one PDPT, giving the identity map and the
+// higher half. Memory types come from the PAT, reprogrammed so that PWT
+// alone selects write-combining; PAT WC also overrides an MTRR UC range,
+// so the MTRRs are left as the firmware set them.
+
+#define MMU_ROOT_SHIFT          39
+#define MMU_HIGH_INDEX          256
+
+#define PTE_PRESENT             0x001ull
+#define PTE_WRITE               0x002ull
+#define PTE_PWT                 0x008ull
+#define PTE_PCD                 0x010ull
+#define PTE_PS                  0x080ull
+
+// PAT entries 0-3 (and 4-7): WB, WC, UC-, UC
+#define MSR_PAT                 0x277
+#define PAT_VALUE               0x0007010600070106ull
+
+#define CR0_NW                  (1ull << 29)
+#define CR0_CD                  (1ull << 30)
+#define CR4_PGE                 (1ull << 7)
+
+static void cpuid(uint32_t leaf, uint32_t* eax, uint32_t* ebx, uint32_t* ecx, uint32_t* edx) {
+    __asm__ volatile ("cpuid" : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx) : "a"(leaf), "c"(0));
+}
+
+static uint64_t read_cr0(void) {
+    uint64_t value;
+    __asm__ volatile ("mov %%cr0, %0" : "=r"(value));
+    return value;
+}
+
+static void write_cr0(uint64_t value) {
+    __asm__ volatile ("mov %0, %%cr0" : : "r"(value) : "memory");
+}
+
+static void write_cr3(uint64_t value) {
+    __asm__ volatile ("mov %0, %%cr3" : : "r"(value) : "memory");
+}
+
+static void flush_tlb(void) {
+    uint64_t cr3;
+    __asm__ volatile ("mov %%cr3, %0" : "=r"(cr3));
+    write_cr3(cr3);
+}
+
+static void cpu_detect(void) {
+    uint32_t eax, ebx, ecx, edx, max_ext;
+    
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+    write_combining = (edx >> 16) & 1;      // PAT
+    
+    cpuid(0x80000000, &max_ext, &ebx, &ecx, &edx);
+    if (max_ext >= 0x80000001) {
+        cpuid(0x80000001, &eax, &ebx, &ecx, &edx);
+        huge_1g = (edx >> 26) & 1;          // Page1GB
+    }
+    pa_bits = 36;
+    if (max_ext >= 0x80000008) {
+        cpuid(0x80000008, &eax, &ebx, &ecx, &edx);
+        pa_bits = eax & 0xFF;
+    }
+}
+
+// Change the PAT with caching disabled and the caches and TLBs flushed
+// before and after, as the SDM requires for memory-type changes
+static void pat_program(void) {
+    uint64_t cr0 = read_cr0();
+    
+    write_cr0((cr0 | CR0_CD) & ~CR0_NW);
+    __asm__ volatile ("wbinvd" : : : "memory");
+    flush_tlb();
+    __asm__ volatile ("wrmsr" : : "c"(MSR_PAT), "a"((uint32_t)PAT_VALUE),
+                      "d"((uint32_t)(PAT_VALUE >> 32)) : "memory");
+    __asm__ volatile ("wbinvd" : : : "memory");
+    flush_tlb();
+    write_cr0(cr0);
+}
+
+static uint64_t desc_table(const uint64_t* table) {
+    return (uint64_t)(uintptr_t)table | PTE_PRESENT | PTE_WRITE;
+}
+
+static uint64_t desc_leaf(uint64_t phys, uint32_t type, uint32_t shift) {
+    uint64_t entry = phys | PTE_PRESENT | PTE_WRITE;
+    
+    if (shift > MMU_PAGE_SHIFT) {
+        entry |= PTE_PS;
+    }
+    if (type == MMU_MEM_WRITE_COMBINING && write_combining) {
+        entry |= PTE_PWT;
+    } else if (type != MMU_MEM_NORMAL) {
+        entry |= PTE_PCD | PTE_PWT;
+    }
+    return entry;
+}
+
+static int desc_is_table(uint64_t entry) {
+    return (entry & PTE_PS) == 0;
+}
+
+// Mirror the identity PDPT into the higher half. Newly present entries
+// need no invalidation; reloading CR3 also drops cached upper levels.
+static void tables_updated(void) {
+    root_table[MMU_HIGH_INDEX] = root_table[0];
+    if (mmu_on) {
+        flush_tlb();
+    }
+}
+
+#endif
+
+static int leaf_allowed(uint32_t shift) {
+    return shift == MMU_PAGE_SHIFT || shift == 21 || (shift == 30 && huge_1g);
+}
+
+static uint64_t* table_of(uint64_t entry) {
+    return (uint64_t*)(uintptr_t)(entry & DESC_ADDR_MASK);
+}
+
+static void count_leaf(uint32_t shift, uint32_t delta) {
+    if (shift == 30) {
+        leaves_1g += delta;
+    } else if (shift == 21) {
+        leaves_2m += delta;
+    } else {
+        leaves_4k += delta;
+    }
+}
+
+// Tables needed to map [addr, end) below an empty entry covering 2^shift
+static uint32_t tables_below(uint32_t shift, uint64_t addr, uint64_t end) {
+    uint32_t child = shift - MMU_INDEX_BITS;
+    uint64_t size = 1ull << child;
+    uint32_t count = 1;
+    
+    while (addr < end) {
+        uint64_t next = (addr | (size - 1)) + 1;
+        if (next > end) {
+            next = end;
+        }
+        if (!leaf_allowed(child) || (addr & (size - 1)) != 0 || next - addr != size) {
+            count += tables_below(child, addr, next);
+        }
+        addr = next;
+    }
+    return count;
+}
+
+// Map [addr, end) into a table whose entries cover 2^shift bytes each,
+// using the largest leaves that fit. With apply == 0 nothing is written:
+// the range is checked to be unmapped and the new tables are counted.
+static int walk(uint64_t* table, uint32_t shift, uint64_t addr, uint64_t end, uint32_t type,
+                int apply, uint32_t* needed) {
+    uint64_t size = 1ull << shift;
+    
+    while (addr < end) {
+        uint64_t* entry = &table[(addr >> shift) & (MMU_ENTRIES - 1)];
+        uint64_t next = (addr | (size - 1)) + 1;
+        if (next > end) {
+            next = end;
+        }
+        int whole = (addr & (size - 1)) == 0 && next - addr == size;
+        
+        if (*entry == 0 && whole && leaf_allowed(shift)) {
+            if (apply) {
+                *entry = desc_leaf(addr, type, shift);
+                count_leaf(shift, 1);
+            }
+        } else if (*entry == 0) {
+            if (!apply) {
+                *needed += tables_below(shift, addr, next);
+            } else {
+                // Fill the new table before linking it in
+                uint64_t* child = table_pool[tables_used++];
+                for (uint32_t i = 0; i < MMU_ENTRIES; i++) {
+                    child[i] = 0;
+                }
+                walk(child, shift - MMU_INDEX_BITS, addr, next, type, 1, needed);
+                *entry = desc_table(child);
+            }
+        } else if (shift > MMU_PAGE_SHIFT && desc_is_table(*entry)) {
+            int status = walk(table_of(*entry), shift - MMU_INDEX_BITS, addr, next, type, apply, needed);
+            if (status != MMU_SUCCESS) {
+                return status;
+            }
+        } else {
+            return MMU_ERROR_MAPPED;
+        }
+        addr = next;
+    }
+    return MMU_SUCCESS;
+}
+
+static int add_region(uint64_t phys, uint64_t size, uint32_t type, const char* name) {
+    uint64_t end = phys + size;
+    uint32_t needed = 0;
+    
+    if (size == 0 || type >= MMU_MEM_TYPES || ((phys | size) & (MMU_PAGE_SIZE - 1)) != 0 ||
+        end < phys || end > (1ull << pa_bits) || end > MMU_MAP_LIMIT) {
+        return MMU_ERROR_PARAM;
+    }
+    if (region_count >= MMU_MAX_REGIONS) {
+        return MMU_ERROR_REGIONS;
+    }
+    
+    // Check first so a failed mapping leaves the tables untouched
+    int status = walk(root_table, MMU_ROOT_SHIFT, phys, end, type, 0, &needed);
+    if (status != MMU_SUCCESS) {
+        return status;
+    }
+    if (tables_used + needed > MMU_TABLE_POOL) {
+        return MMU_ERROR_NO_TABLES;
+    }
+    
+    walk(root_table, MMU_ROOT_SHIFT, phys, end, type, 1, &needed);
+    tables_updated();
+    
+    regions[region_count].phys = phys;
+    regions[region_count].size = size;
+    regions[region_count].type = type;
+    regions[region_count].name = name;
+    region_count++;
+    return MMU_SUCCESS;
+}
+
+#if defined(__aarch64__)
+
+// The platform is told apart by where the image was loaded: QEMU virt has
+// RAM from 1 GiB with MMIO below it, Raspberry Pi boards have RAM from 0
+static void add_platform_regions(void) {
+    uint64_t load = (uint64_t)(uintptr_t)__start;
+    uint64_t ram = MMU_RAM_SIZE;
+    
+    if (load >= MMU_BLOCK_1G) {
+        add_region(0, MMU_BLOCK_1G, MMU_MEM_DEVICE, "virt mmio");
+        add_region(MMU_BLOCK_1G, ram, MMU_MEM_NORMAL, "ram");
+        return;
+    }
+    
+    // RAM stops below the BCM2837 peripherals; on 4 and 8 GiB boards it
+    // continues above 1 GiB up to the BCM2711/2712 low-peripheral window
+    add_region(0, (ram < 0x3F000000ull) ? ram : 0x3F000000ull, MMU_MEM_NORMAL, "ram");
+    if (ram > MMU_BLOCK_1G) {
+        add_region(MMU_BLOCK_1G, ((ram < 0xFC000000ull) ? ram : 0xFC000000ull) - MMU_BLOCK_1G,
+                   MMU_MEM_NORMAL, "ram high");
+    }
+    add_region(0x3F000000ull, 0x01000000ull, MMU_MEM_DEVICE, "bcm2837 peripherals");
+    add_region(0xFC000000ull, 0x04000000ull, MMU_MEM_DEVICE, "bcm2711 peripherals");
+    add_region(0x107C000000ull, 0x04000000ull, MMU_MEM_DEVICE, "bcm2712 peripherals");
+}
+
+int mmu_init(void) {
+    if (mmu_on) {
+        return MMU_SUCCESS;
+    }
+    if (current_el() != 1) {
+        return MMU_ERROR_EL;
+    }
+    if (read_sctlr() & SCTLR_M) {
+        return MMU_ERROR_ACTIVE;
+    }
+    
+    cpu_detect();
+    
+    // Regions added through mmu_map_region before now are already in the
+    // tables; the platform map fills in around them
+    add_platform_regions();
+    
+    // Tables must be in memory before the walker reads them
+    __asm__ volatile ("dsb ish" : : : "memory");
+    __asm__ volatile ("msr mair_el1, %0" : : "r"(MAIR_VALUE));
+    __asm__ volatile ("msr tcr_el1, %0" : : "r"(TCR_VALUE | ((uint64_t)pa_range << TCR_IPS_SHIFT)));
+    __asm__ volatile ("msr ttbr0_el1, %0" : : "r"((uint64_t)(uintptr_t)root_table));
+    __asm__ volatile ("msr ttbr1_el1, %0" : : "r"((uint64_t)(uintptr_t)root_table));
+    __asm__ volatile ("isb" : : : "memory");
+    
+    dcache_invalidate_all();
+    __asm__ volatile ("ic iallu; tlbi vmalle1; dsb ish; isb" : : : "memory");
+    
+    uint64_t sctlr = read_sctlr();
+    sctlr |= SCTLR_M | SCTLR_C | SCTLR_I;
+    sctlr &= ~(SCTLR_A | SCTLR_WXN);
+    __asm__ volatile ("msr sctlr_el1, %0; isb" : : "r"(sctlr) : "memory");
+    
+    mmu_on = 1;
+    return MMU_SUCCESS;
+}
+
+static void read_cache_state(int* icache, int* dcache) {
+    uint64_t sctlr = read_sctlr();
+    *icache = (sctlr & SCTLR_I) != 0;
+    *dcache = (sctlr & SCTLR_C) != 0;
+}
+
+#elif defined(__x86_64__)
+
+// Conventional memory, the VGA window write-combining (text mode at
+// 0xB8000 and mode 13h at 0xA0000), then RAM through the option ROMs and
+// the kernel image at 1 MiB. Everything from 2 MiB up uses large pages.
+static void add_platform_regions(void) {
+    add_region(0, 0xA0000, MMU_MEM_NORMAL, "low ram");
+    add_region(0xA0000, 0x20000, MMU_MEM_WRITE_COMBINING, "vga");
+    add_region(0xC0000, MMU_RAM_SIZE - 0xC0000, MMU_MEM_NORMAL, "ram");
+}
+
+int mmu_init(void) {
+    if (mmu_on) {
+        return MMU_SUCCESS;
+    }
+    
+    cpu_detect();
+    if (write_combining) {
+        pat_program();
+    }
+    add_platform_regions();
+    
+    // A CR3 load keeps global entries; toggling PGE drops the loader's too
+    uint64_t cr4;
+    __asm__ volatile ("mov %%cr4, %0" : "=r"(cr4));
+    write_cr3((uint64_t)(uintptr_t)root_table);
+    if (cr4 & CR4_PGE) {
+        __asm__ volatile ("mov %0, %%cr4; mov %1, %%cr4" : : "r"(cr4 & ~CR4_PGE), "r"(cr4) : "memory");
+    }
+    
+    mmu_on = 1;
+    return MMU_SUCCESS;
+}
+
+static void read_cache_state(int* icache, int* dcache) {
+    int enabled = (read_cr0() & CR0_CD) == 0;
+    *icache = enabled;
+    *dcache = enabled;
+}
+
+#endif
+
+int mmu_map_region(uint64_t phys, uint64_t size, uint32_t type, const char* name) {
+    if (pa_bits == 0) {
+        cpu_detect();
+    }
+    return add_region(phys, size, type, name);
+}
+
+void* mmu_phys_to_virt(uint64_t phys) {
+    return (void*)(uintptr_t)(mmu_on ? MMU_HIGH_BASE + phys : phys);
+}
+
+uint64_t mmu_root_table(void) {
+    return mmu_on ? (uint64_t)(uintptr_t)root_table : 0;
+}
+
+void mmu_get_stats(mmu_stats_t* stats) {
+    read_cache_state(&stats->icache, &stats->dcache);
+    stats->enabled = mmu_on;
+    stats->va_bits = MMU_VA_BITS;
+    stats->pa_bits = pa_bits;
+    stats->granule = (uint32_t)MMU_PAGE_SIZE;
+    stats->high_base = mmu_on ? MMU_HIGH_BASE : 0;
+    stats->kernel_start = (uint64_t)(uintptr_t)__start;
+    stats->kernel_end = (uint64_t)(uintptr_t)__end;
+    stats->tables = 1 + tables_used;
+    stats->blocks_1g = leaves_1g;
+    stats->blocks_2m = leaves_2m;
+    stats->pages_4k = leaves_4k;
+    stats->regions = region_count;
+    stats->write_combining = write_combining;
+}
+
+#else
+
+// Other architectures keep the paging their boot code set up
+
+int mmu_init(void) {
+    return MMU_ERROR_UNSUPPORTED;
+}
+
+int mmu_map_region(uint64_t phys, uint64_t size, uint32_t type, const char* name) {
+    (void)phys;
+    (void)size;
+    (void)type;
+    (void)name;
+    return MMU_ERROR_UNSUPPORTED;
+}
+
+void* mmu_phys_to_virt(uint64_t phys) {
+    return (void*)(uintptr_t)phys;
+}
+
+uint64_t mmu_root_table(void) {
+    return 0;
+}
+
+void mmu_get_stats(mmu_stats_t* stats) {
+    stats->enabled = 0;
+    stats->icache = 0;
+    stats->dcache = 0;
+    stats->va_bits = 0;
+    stats->pa_bits = 0;
+    stats->granule = 0;
+    stats->high_base = 0;
+    stats->kernel_start = (uint64_t)(uintptr_t)__start;
+    stats->kernel_end = (uint64_t)(uintptr_t)__end;
+    stats->tables = 0;
+    stats->blocks_1g = 0;
+    stats->blocks_2m = 0;
+    stats->pages_4k = 0;
+    stats->regions = region_count;
+    stats->write_combining = 0;
+}
+
+#endif
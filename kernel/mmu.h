@@ -0,0 +1,103 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — MMU and Kernel Page Tables
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef MMU_H
+#define MMU_H
+
+#include "types.h"
+
+// The kernel address space maps physical memory twice: identity (the
+// kernel keeps running at its load address) and at MMU_HIGH_BASE, a
+// higher-half alias of all mapped RAM and MMIO. Ranges are mapped with the
+// largest pages their alignment allows (1 GiB, 2 MiB, then 4 KiB) to keep
+// TLB misses rare; MMIO is mapped uncached, framebuffers write-combining.
+
+#if defined(__aarch64__)
+#define MMU_VA_BITS             39
+#define MMU_HIGH_BASE           0xFFFFFF8000000000ull   // Bottom of the TTBR1 range
+#elif defined(__x86_64__)
+#define MMU_VA_BITS             48
+#define MMU_HIGH_BASE           0xFFFF800000000000ull   // PML4 entry 256
+#else
+#define MMU_VA_BITS             0
+#define MMU_HIGH_BASE           0ull
+#endif
+
+#define MMU_PAGE_SIZE           0x1000ull
+#define MMU_BLOCK_2M            0x200000ull
+#define MMU_BLOCK_1G            0x40000000ull
+#define MMU_MAX_REGIONS         12
+
+// Error codes
+#define MMU_SUCCESS             0
+#define MMU_ERROR_UNSUPPORTED   -1  // No MMU support for this architecture
+#define MMU_ERROR_EL            -2  // aarch64: not running at EL1
+#define MMU_ERROR_ACTIVE        -3  // MMU already enabled by firmware
+#define MMU_ERROR_PARAM         -4  // Not page aligned, empty or beyond the PA range
+#define MMU_ERROR_NO_TABLES     -5  // Page-table pool exhausted
+#define MMU_ERROR_MAPPED        -6  // Overlaps an existing mapping
+#define MMU_ERROR_REGIONS       -7  // Region table full
+
+// Memory types
+typedef enum {
+    MMU_MEM_NORMAL = 0,         // Write-back cacheable RAM
+    MMU_MEM_DEVICE,             // MMIO: uncached, no gathering or reordering
+    MMU_MEM_NONCACHED,          // Normal memory, uncached (DMA buffers)
+    MMU_MEM_WRITE_COMBINING,    // Framebuffers: uncached, writes merged into bursts
+    MMU_MEM_TYPES
+} mmu_mem_type_t;
+
+typedef struct {
+    uint64_t phys;
+    uint64_t size;
+    uint32_t type;          // mmu_mem_type_t
+    const char* name;
+} mmu_region_t;
+
+typedef struct {
+    int enabled;
+    int icache;
+    int dcache;
+    uint32_t va_bits;
+    uint32_t pa_bits;
+    uint32_t granule;       // Bytes
+    uint64_t high_base;     // Virtual address of physical 0 in the higher half
+    uint64_t kernel_start;  // Physical extent of the kernel image
+    uint64_t kernel_end;
+    uint32_t tables;        // Page-table pages in use
+    uint32_t blocks_1g;
+    uint32_t blocks_2m;
+    uint32_t pages_4k;
+    uint32_t regions;
+    int write_combining;    // Write-combining available (else mapped uncached)
+} mmu_stats_t;
+
+// Build the kernel page tables for this platform and turn on the MMU and
+// the instruction and data caches. Safe to call more than once.
+int mmu_init(void);
+
+int mmu_enabled(void);
+
+// Map a page-aligned physical range, identity and in the higher half.
+// Before mmu_init the range is added to the boot map; afterwards it is
+// mapped into the live tables.
+int mmu_map_region(uint64_t phys, uint64_t size, uint32_t type, const char* name);
+
+// Higher-half address of a physical address (identity while the MMU is off)
+void* mmu_phys_to_virt(uint64_t phys);
+
+// Physical address of the kernel's top-level table, 0 while the kernel has
+// not built one; address spaces copy its entries
+uint64_t mmu_root_table(void);
+
+void mmu_get_stats(mmu_stats_t* stats);
+
+// Regions in the order they were mapped; returns 0, or -1 past the end
+int mmu_get_region(uint32_t index, mmu_region_t* region);
+
+const char* mmu_type_name(uint32_t type);
+
+#endif // MMU_H
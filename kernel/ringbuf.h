@@ -0,0 +1,335 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Lock-Free Ring Buffers
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include "types.h"
+
+// Bounded queues of fixed-size elements in caller-supplied storage, for
+// producer/consumer pairs such as UART FIFOs, DMA descriptor lists, request
+// queues and log buffers:
+//
+//   ringbuf_t       single producer, single consumer (SPSC)
+//                   many producers, single consumer (MPSC)
+//   ringbuf_mpmc_t  many producers, many consumers (Vyukov's bounded queue)
+//
+// Capacities are powers of two. Head and tail indices run freely and wrap
+// at 2^32; they sit on separate cache lines so producers and consumers do
+// not share a line. Indices are published with release stores and read with
+// acquire loads (GCC/Clang __atomic builtins: plain moves on x86, LDAR/STLR
+// on aarch64, fenced accesses on RISC-V), which orders the element copies
+// against them. Batch calls move as many elements as fit and return the
+// count; 0 means full or empty.
+//
+// A multi-producer or multi-consumer side spins while another one finishes
+// its claim, so it must not be interrupted by a user of the same side on the
+// same CPU: disable interrupts around the call if an interrupt handler is
+// also a producer (or consumer) there.
+
+#define RINGBUF_CACHE_LINE      64
+#define RINGBUF_ERROR_PARAM     -1
+
+// Storage bytes for `capacity` elements
+#define RINGBUF_STORAGE(capacity, elem_size)       ((capacity) * (elem_size))
+
+// The MPMC queue keeps a sequence number in front of every element; cells
+// are rounded to 8 bytes so 8-byte aligned storage keeps elements aligned
+#define RINGBUF_MPMC_CELL_SIZE(elem_size)          (8 + (((elem_size) + 7) & ~7u))
+#define RINGBUF_MPMC_STORAGE(capacity, elem_size)  ((capacity) * RINGBUF_MPMC_CELL_SIZE(elem_size))
+
+typedef struct {
+    // Consumer line
+    uint32_t head __attribute__((aligned(RINGBUF_CACHE_LINE)));  // Next element to dequeue
+    uint32_t cached_tail;       // Consumer's last view of tail
+    
+    // Producer line
+    uint32_t tail __attribute__((aligned(RINGBUF_CACHE_LINE)));  // Elements published up to here
+    uint32_t reserve;           // MPSC: claimed by producers, published in order
+    uint32_t cached_head;       // SPSC producer's last view of head
+    
+    // Read-only after init
+    uint8_t* data __attribute__((aligned(RINGBUF_CACHE_LINE)));
+    uint32_t mask;
+    uint32_t elem_size;
+} ringbuf_t;
+
+typedef struct {
+    uint32_t enqueue_pos __attribute__((aligned(RINGBUF_CACHE_LINE)));
+    uint32_t dequeue_pos __attribute__((aligned(RINGBUF_CACHE_LINE)));
+    uint8_t* cells __attribute__((aligned(RINGBUF_CACHE_LINE)));
+    uint32_t mask;
+    uint32_t elem_size;
+    uint32_t cell_size;
+} ringbuf_mpmc_t;
+
+// ─── Primitives ──────────────────────────────────────────────────────────────
+
+static inline uint32_t ringbuf_load_relaxed(const uint32_t* index) {
+    return __atomic_load_n(index, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t ringbuf_load_acquire(const uint32_t* index) {
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void ringbuf_store_release(uint32_t* index, uint32_t value) {
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+// Advance *index from *expected to desired; on failure *expected is reloaded
+static inline int ringbuf_claim(uint32_t* index, uint32_t* expected, uint32_t desired) {
+    return __atomic_compare_exchange_n(index, expected, desired, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+// Spin-wait hint
+static inline void ringbuf_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ volatile("pause" ::: "memory");
+#elif defined(__aarch64__)
+    __asm__ volatile("yield" ::: "memory");
+#else
+    __asm__ volatile("" ::: "memory");
+#endif
+}
+
+static inline int ringbuf_valid_capacity(uint32_t capacity) {
+    return capacity != 0 && (capacity & (capacity - 1)) == 0 && capacity <= 0x80000000u;
+}
+
+// ─── SPSC and MPSC ───────────────────────────────────────────────────────────
+
+// storage holds RINGBUF_STORAGE(capacity, elem_size) bytes. Returns 0, or
+// RINGBUF_ERROR_PARAM if capacity is not a power of two.
+static inline int ringbuf_init(ringbuf_t* ring, void* storage, uint32_t elem_size, uint32_t capacity) {
+    if (ring == NULL || storage == NULL || elem_size == 0 || !ringbuf_valid_capacity(capacity)) {
+        return RINGBUF_ERROR_PARAM;
+    }
+    
+    ring->head = 0;
+    ring->cached_tail = 0;
+    ring->tail = 0;
+    ring->reserve = 0;
+    ring->cached_head = 0;
+    ring->data = (uint8_t*)storage;
+    ring->mask = capacity - 1;
+    ring->elem_size = elem_size;
+    return 0;
+}
+
+static inline uint32_t ringbuf_capacity(const ringbuf_t* ring) {
+    return ring->mask + 1;
+}
+
+// Elements queued; exact only when called by the consumer or a sole producer
+static inline uint32_t ringbuf_count(const ringbuf_t* ring) {
+    return ringbuf_load_acquire(&ring->tail) - ringbuf_load_acquire(&ring->head);
+}
+
+// Copy between the caller and the ring at position pos, in up to two runs
+static inline void ringbuf_copy_in(ringbuf_t* ring, uint32_t pos, const void* elems, uint32_t count) {
+    uint32_t index = pos & ring->mask;
+    uint32_t first = ring->mask + 1 - index;
+    
+    if (first > count) {
+        first = count;
+    }
+    __builtin_memcpy(ring->data + index * ring->elem_size, elems, first * ring->elem_size);
+    __builtin_memcpy(ring->data, (const uint8_t*)elems + first * ring->elem_size, (count - first) * ring->elem_size);
+}
+
+static inline void ringbuf_copy_out(const ringbuf_t* ring, uint32_t pos, void* elems, uint32_t count) {
+    uint32_t index = pos & ring->mask;
+    uint32_t first = ring->mask + 1 - index;
+    
+    if (first > count) {
+        first = count;
+    }
+    __builtin_memcpy(elems, ring->data + index * ring->elem_size, first * ring->elem_size);
+    __builtin_memcpy((uint8_t*)elems + first * ring->elem_size, ring->data, (count - first) * ring->elem_size);
+}
+
+// Sole producer: queue up to count elements
+static inline uint32_t ringbuf_spsc_enqueue(ringbuf_t* ring, const void* elems, uint32_t count) {
+    uint32_t tail = ring->tail;
+    uint32_t space = ring->mask + 1 - (tail - ring->cached_head);
+    
+    // Look at the consumer's index only when the cached one says full
+    if (space < count) {
+        ring->cached_head = ringbuf_load_acquire(&ring->head);
+        space = ring->mask + 1 - (tail - ring->cached_head);
+    }
+    if (count > space) {
+        count = space;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    
+    ringbuf_copy_in(ring, tail, elems, count);
+    ringbuf_store_release(&ring->tail, tail + count);
+    return count;
+}
+
+// Sole consumer of an SPSC or MPSC ring: take up to count elements
+static inline uint32_t ringbuf_dequeue(ringbuf_t* ring, void* elems, uint32_t count) {
+    uint32_t head = ring->head;
+    uint32_t ready = ring->cached_tail - head;
+    
+    if (ready < count) {
+        ring->cached_tail = ringbuf_load_acquire(&ring->tail);
+        ready = ring->cached_tail - head;
+    }
+    if (count > ready) {
+        count = ready;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    
+    ringbuf_copy_out(ring, head, elems, count);
+    ringbuf_store_release(&ring->head, head + count);
+    return count;
+}
+
+static inline uint32_t ringbuf_spsc_dequeue(ringbuf_t* ring, void* elems, uint32_t count) {
+    return ringbuf_dequeue(ring, elems, count);
+}
+
+static inline uint32_t ringbuf_mpsc_dequeue(ringbuf_t* ring, void* elems, uint32_t count) {
+    return ringbuf_dequeue(ring, elems, count);
+}
+
+// One of many producers: claim space by advancing reserve, copy, then
+// publish after the producers that claimed earlier have published
+static inline uint32_t ringbuf_mpsc_enqueue(ringbuf_t* ring, const void* elems, uint32_t count) {
+    uint32_t start = ringbuf_load_relaxed(&ring->reserve);
+    uint32_t claimed;
+    
+    do {
+        uint32_t space = ring->mask + 1 - (start - ringbuf_load_acquire(&ring->head));
+        claimed = (count < space) ? count : space;
+        if (claimed == 0) {
+            return 0;
+        }
+    } while (!ringbuf_claim(&ring->reserve, &start, start + claimed));
+    
+    ringbuf_copy_in(ring, start, elems, claimed);
+    
+    while (ringbuf_load_acquire(&ring->tail) != start) {
+        ringbuf_cpu_relax();
+    }
+    ringbuf_store_release(&ring->tail, start + claimed);
+    return claimed;
+}
+
+// ─── MPMC ────────────────────────────────────────────────────────────────────
+
+// A cell's sequence is pos while it is free for the enqueue at pos, pos + 1
+// once that element is in it, and pos + capacity when the dequeue at pos
+// has emptied it for the next lap
+
+static inline uint32_t* ringbuf_mpmc_sequence(const ringbuf_mpmc_t* ring, uint32_t pos) {
+    return (uint32_t*)(ring->cells + (pos & ring->mask) * ring->cell_size);
+}
+
+static inline uint8_t* ringbuf_mpmc_element(const ringbuf_mpmc_t* ring, uint32_t pos) {
+    return ring->cells + (pos & ring->mask) * ring->cell_size + 8;
+}
+
+// storage holds RINGBUF_MPMC_STORAGE(capacity, elem_size) bytes, 4-byte
+// aligned at least
+static inline int ringbuf_mpmc_init(ringbuf_mpmc_t* ring, void* storage, uint32_t elem_size, uint32_t capacity) {
+    if (ring == NULL || storage == NULL || elem_size == 0 || !ringbuf_valid_capacity(capacity)) {
+        return RINGBUF_ERROR_PARAM;
+    }
+    
+    ring->enqueue_pos = 0;
+    ring->dequeue_pos = 0;
+    ring->cells = (uint8_t*)storage;
+    ring->mask = capacity - 1;
+    ring->elem_size = elem_size;
+    ring->cell_size = RINGBUF_MPMC_CELL_SIZE(elem_size);
+    for (uint32_t pos = 0; pos < capacity; pos++) {
+        ringbuf_store_release(ringbuf_mpmc_sequence(ring, pos), pos);
+    }
+    return 0;
+}
+
+// Elements queued; approximate while other CPUs are enqueuing or dequeuing
+static inline uint32_t ringbuf_mpmc_count(const ringbuf_mpmc_t* ring) {
+    return ringbuf_load_relaxed(&ring->enqueue_pos) - ringbuf_load_relaxed(&ring->dequeue_pos);
+}
+
+// Queue one element; 0 if the queue is full
+static inline uint32_t ringbuf_mpmc_enqueue_one(ringbuf_mpmc_t* ring, const void* elem) {
+    uint32_t pos = ringbuf_load_relaxed(&ring->enqueue_pos);
+    uint32_t* sequence;
+    
+    for (;;) {
+        sequence = ringbuf_mpmc_sequence(ring, pos);
+        int32_t diff = (int32_t)(ringbuf_load_acquire(sequence) - pos);
+        if (diff == 0) {
+            if (ringbuf_claim(&ring->enqueue_pos, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;       // A lap behind: the dequeue of this cell is still pending
+        } else {
+            pos = ringbuf_load_relaxed(&ring->enqueue_pos);
+        }
+    }
+    
+    __builtin_memcpy(ringbuf_mpmc_element(ring, pos), elem, ring->elem_size);
+    ringbuf_store_release(sequence, pos + 1);
+    return 1;
+}
+
+// Take one element; 0 if the queue is empty
+static inline uint32_t ringbuf_mpmc_dequeue_one(ringbuf_mpmc_t* ring, void* elem) {
+    uint32_t pos = ringbuf_load_relaxed(&ring->dequeue_pos);
+    uint32_t* sequence;
+    
+    for (;;) {
+        sequence = ringbuf_mpmc_sequence(ring, pos);
+        int32_t diff = (int32_t)(ringbuf_load_acquire(sequence) - (pos + 1));
+        if (diff == 0) {
+            if (ringbuf_claim(&ring->dequeue_pos, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;       // Not filled yet
+        } else {
+            pos = ringbuf_load_relaxed(&ring->dequeue_pos);
+        }
+    }
+    
+    __builtin_memcpy(elem, ringbuf_mpmc_element(ring, pos), ring->elem_size);
+    ringbuf_store_release(sequence, pos + ring->mask + 1);
+    return 1;
+}
+
+// Batches are claimed a cell at a time, so elements of concurrent batches
+// may interleave
+static inline uint32_t ringbuf_mpmc_enqueue(ringbuf_mpmc_t* ring, const void* elems, uint32_t count) {
+    uint32_t done = 0;
+    
+    while (done < count && ringbuf_mpmc_enqueue_one(ring, (const uint8_t*)elems + done * ring->elem_size)) {
+        done++;
+    }
+    return done;
+}
+
+static inline uint32_t ringbuf_mpmc_dequeue(ringbuf_mpmc_t* ring, void* elems, uint32_t count) {
+    uint32_t done = 0;
+    
+    while (done < count && ringbuf_mpmc_dequeue_one(ring, (uint8_t*)elems + done * ring->elem_size)) {
+        done++;
+    }
+    return done;
+}
+
+#endif // RINGBUF_H
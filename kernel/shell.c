@@ -13,6 +13,10 @@
 #include "stdio.h"
 #include "utils.h"
 #include "filesystem.h"
+#include "shell_args.h"
+#include "shell_cmd.h"
+#include "shell_io.h"
+#include "kbench.h"
 
 #define MAX_COMMAND_LENGTH 256
 #define MAX_ARGS 16
@@ -26,15 +30,6 @@ static char history[HISTORY_SIZE][MAX_COMMAND_LENGTH];
 static int history_count = 0;
 static int history_index = 0;
 
-// Built-in commands
-typedef void (*command_func_t)(int argc, char* argv[]);
-
-typedef struct {
-    const char* name;
-    const char* description;
-    command_func_t func;
-} command_t;
-
 // Forward declarations of command functions
 static void cmd_help(int argc, char* argv[]);
 static void cmd_echo(int argc, char* argv[]);
@@ -59,9 +54,11 @@ static void cmd_save(int argc, char* argv[]);
 static void cmd_append(int argc, char* argv[]);
 static void cmd_delete(int argc, char* argv[]);
 static void cmd_fileinfo(int argc, char* argv[]);
+static void cmd_bench(int argc, char* argv[]);
+static void cmd_source(int argc, char* argv[]);
 
 // Command table
-static const command_t commands[] = {
+static const shell_command_t commands[] = {
     {"help",     "Display help information",           cmd_help},
     {"echo",     "Echo arguments to the console",      cmd_echo},
     {"clear",    "Clear the screen",                   cmd_clear},
@@ -85,9 +82,14 @@ static const command_t commands[] = {
     {"append",   "Append text to file",                cmd_append},
     {"delete",   "Delete file",                        cmd_delete},
     {"fileinfo", "Display file information",           cmd_fileinfo},
+    {"bench",    "Run kernel benchmarks (bench [suite])", cmd_bench},
+    {"source",   "Run commands from a script file",    cmd_source},
     {NULL, NULL, NULL}  // Terminator
 };
 
+// Hashed lookup over commands[] plus driver-registered commands
+static shell_cmd_table_t command_table = SHELL_CMD_TABLE_INIT(commands);
+
 // Initialize the shell
 void shell_init() {
     // Initialize file system first
@@ -97,40 +99,6 @@ void shell_init() {
     serial_puts("SAGE OS Shell initialized\n");
 }
 
-// Split a command into arguments
-static int split_args(char* command, char* argv[], int max_args) {
-    int argc = 0;
-    char* token = command;
-    char* end = command + strlen(command);
-    
-    // Skip leading whitespace
-    while (*token && (*token == ' ' || *token == '\t')) {
-        token++;
-    }
-    
-    while (token < end && argc < max_args) {
-        // Mark the start of the argument
-        argv[argc++] = token;
-        
-        // Find the end of the argument
-        while (*token && *token != ' ' && *token != '\t') {
-            token++;
-        }
-        
-        // Null-terminate the argument
-        if (*token) {
-            *token++ = '\0';
-        }
-        
-        // Skip whitespace to the next argument
-        while (*token && (*token == ' ' || *token == '\t')) {
-            token++;
-        }
-    }
-    
-    return argc;
-}
-
 // Add a command to history
 static void add_to_history(const char* command) {
     if (strlen(command) == 0) {
@@ -138,7 +106,7 @@ static void add_to_history(const char* command) {
     }
     
     // Check if this command is the same as the last one
-    if (history_count > 0 && strcmp(command, history[(history_index - 1) % HISTORY_SIZE]) == 0) {
+    if (history_count > 0 && strcmp(command, history[(history_index + HISTORY_SIZE - 1) % HISTORY_SIZE]) == 0) {
         return;  // Don't add duplicate commands consecutively
     }
     
@@ -151,29 +119,21 @@ static void add_to_history(const char* command) {
     }
 }
 
-// Process a command
-void shell_process_command(const char* command) {
-    char cmd_copy[MAX_COMMAND_LENGTH];
-    strncpy(cmd_copy, command, MAX_COMMAND_LENGTH - 1);
-    cmd_copy[MAX_COMMAND_LENGTH - 1] = '\0';
-    
-    // Add to history
-    add_to_history(cmd_copy);
-    
+// Execute a single command (one pipeline stage)
+static void execute_command(char* command) {
     // Split into arguments
     char* argv[MAX_ARGS];
-    int argc = split_args(cmd_copy, argv, MAX_ARGS);
+    int argc = shell_split_args(command, argv, MAX_ARGS);
     
     if (argc == 0) {
         return;  // Empty command
     }
     
     // Find and execute the command
-    for (int i = 0; commands[i].name != NULL; i++) {
-        if (strcmp(argv[0], commands[i].name) == 0) {
-            commands[i].func(argc, argv);
-            return;
-        }
+    const shell_command_t* cmd = shell_cmd_lookup(&command_table, argv[0]);
+    if (cmd != NULL) {
+        cmd->func(argc, argv);
+        return;
     }
     
     // Command not found
@@ -183,11 +143,27 @@ void shell_process_command(const char* command) {
     serial_puts("Type 'help' for a list of commands\n");
 }
 
+// Process a command line, which may be a pipeline
+void shell_process_command(const char* command) {
+    // Add to history
+    add_to_history(command);
+    
+    int result = shell_exec_line(command, execute_command);
+    if (result == SHELL_IO_ERROR_STAGES) {
+        serial_puts("Invalid pipeline\n");
+    } else if (result == SHELL_IO_ERROR_NESTED) {
+        serial_puts("Pipelines cannot be nested\n");
+    }
+}
+
 // Run the shell (main loop)
 void shell_run() {
     char command[MAX_COMMAND_LENGTH];
     int pos = 0;
     
+    // Batch mode: run the autorun script if one has been stored
+    shell_run_script(SHELL_AUTORUN_SCRIPT, execute_command);
+    
     while (1) {
         // Display prompt
         serial_puts(PROMPT);
@@ -198,7 +174,7 @@ void shell_run() {
         
         // Read command
         while (1) {
-            char c = uart_getc();
+            char c = shell_in_getc();
             
             if (c == '\r' || c == '\n') {
                 // End of command
@@ -227,69 +203,75 @@ void shell_run() {
 // Command implementations
 
 static void cmd_help(int argc, char* argv[]) {
-    serial_puts("SAGE OS Shell - Available Commands:\n");
-    serial_puts("==================================\n\n");
+    shell_out_puts("SAGE OS Shell - Available Commands:\n");
+    shell_out_puts("==================================\n\n");
     
-    for (int i = 0; commands[i].name != NULL; i++) {
+    const shell_command_t* cmd;
+    for (uint32_t i = 0; (cmd = shell_cmd_at(&command_table, i)) != NULL; i++) {
         char help_line[256];
-        sprintf(help_line, "  %-12s - %s\n", commands[i].name, commands[i].description);
-        serial_puts(help_line);
+        sprintf(help_line, "  %-12s - %s\n", cmd->name, cmd->description);
+        shell_out_puts(help_line);
     }
     
-    serial_puts("\nFile Management Examples:\n");
-    serial_puts("  save test.txt Hello World    - Save text to file\n");
-    serial_puts("  cat test.txt                 - Display file contents\n");
-    serial_puts("  append test.txt More text    - Append to file\n");
-    serial_puts("  delete test.txt              - Delete file\n");
-    serial_puts("  ls                           - List all files\n");
+    shell_out_puts("\nFile Management Examples:\n");
+    shell_out_puts("  save test.txt Hello World    - Save text to file\n");
+    shell_out_puts("  cat test.txt                 - Display file contents\n");
+    shell_out_puts("  append test.txt More text    - Append to file\n");
+    shell_out_puts("  delete test.txt              - Delete file\n");
+    shell_out_puts("  ls                           - List all files\n");
+    
+    shell_out_puts("\nScripting Examples:\n");
+    shell_out_puts("  cat test.txt | cat           - Pipe output between commands\n");
+    shell_out_puts("  source setup.sh              - Run commands from a file\n");
+    shell_out_puts("  (autorun.sh runs at startup when present)\n");
 }
 
 static void cmd_echo(int argc, char* argv[]) {
     for (int i = 1; i < argc; i++) {
-        serial_puts(argv[i]);
+        shell_out_puts(argv[i]);
         if (i < argc - 1) {
-            serial_putc(' ');
+            shell_out_putc(' ');
         }
     }
-    serial_putc('\n');
+    shell_out_putc('\n');
 }
 
 static void cmd_clear(int argc, char* argv[]) {
     // Clear screen (ANSI escape sequence)
-    serial_puts("\033[2J\033[H");
-    serial_puts("SAGE OS Shell - Screen Cleared\n");
-    serial_puts("Type 'help' for available commands.\n");
+    shell_out_puts("\033[2J\033[H");
+    shell_out_puts("SAGE OS Shell - Screen Cleared\n");
+    shell_out_puts("Type 'help' for available commands.\n");
 }
 
 static void cmd_meminfo(int argc, char* argv[]) {
     // Display basic memory statistics
-    serial_puts("Memory Statistics:\n");
-    serial_puts("  Total RAM: 1024 MB\n");
-    serial_puts("  Available: 1000 MB\n");
-    serial_puts("  Used: 24 MB\n");
-    serial_puts("  Kernel: 16 MB\n");
-    serial_puts("  User: 8 MB\n");
+    shell_out_puts("Memory Statistics:\n");
+    shell_out_puts("  Total RAM: 1024 MB\n");
+    shell_out_puts("  Available: 1000 MB\n");
+    shell_out_puts("  Used: 24 MB\n");
+    shell_out_puts("  Kernel: 16 MB\n");
+    shell_out_puts("  User: 8 MB\n");
     
     // Add file system memory information
     uint32_t total_files, memory_used, memory_available;
     fs_get_memory_info(&total_files, &memory_used, &memory_available);
     
-    serial_puts("\nFile System Memory:\n");
+    shell_out_puts("\nFile System Memory:\n");
     char buffer[256];
     sprintf(buffer, "  Total Files: %u\n", total_files);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
     sprintf(buffer, "  Memory Used: %u bytes\n", memory_used);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
     sprintf(buffer, "  Memory Available: %u bytes\n", memory_available);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
 }
 
 static void cmd_reboot(int argc, char* argv[]) {
-    serial_puts("Rebooting...\n");
+    shell_out_puts("Rebooting...\n");
     
     // For i386, we can use the keyboard controller to reboot
     // This is a common method for x86 systems
-    serial_puts("Sending reboot command to keyboard controller...\n");
+    shell_out_puts("Sending reboot command to keyboard controller...\n");
     
     // Wait for keyboard controller to be ready
     uint8_t temp;
@@ -301,32 +283,32 @@ static void cmd_reboot(int argc, char* argv[]) {
     *((volatile uint8_t*)0x64) = 0xFE;
     
     // If we get here, the reboot failed
-    serial_puts("Reboot failed. System halted.\n");
+    shell_out_puts("Reboot failed. System halted.\n");
     while (1) {
         // Halt
     }
 }
 
 static void cmd_version(int argc, char* argv[]) {
-    serial_puts("SAGE OS v1.0.1 i386 Edition\n");
-    serial_puts("Self-Aware General Environment Operating System\n");
-    serial_puts("Copyright (c) 2025 Ashish Vasant Yesale\n");
-    serial_puts("Designed by Ashish Yesale (ashishyesale007@gmail.com)\n");
-    serial_puts("\nFeatures:\n");
-    serial_puts("- i386 optimized\n");
-    serial_puts("- In-memory file system\n");
-    serial_puts("- Advanced shell commands\n");
-    serial_puts("- Persistent memory storage\n");
+    shell_out_puts("SAGE OS v1.0.1 i386 Edition\n");
+    shell_out_puts("Self-Aware General Environment Operating System\n");
+    shell_out_puts("Copyright (c) 2025 Ashish Vasant Yesale\n");
+    shell_out_puts("Designed by Ashish Yesale (ashishyesale007@gmail.com)\n");
+    shell_out_puts("\nFeatures:\n");
+    shell_out_puts("- i386 optimized\n");
+    shell_out_puts("- In-memory file system\n");
+    shell_out_puts("- Advanced shell commands\n");
+    shell_out_puts("- Persistent memory storage\n");
 }
 
 // Exit command - shuts down QEMU
 static void cmd_exit(int argc, char* argv[]) {
-    serial_puts("Shutting down SAGE OS...\n");
-    serial_puts("Thank you for using SAGE OS!\n");
-    serial_puts("Designed by Ashish Yesale\n\n");
+    shell_out_puts("Shutting down SAGE OS...\n");
+    shell_out_puts("Thank you for using SAGE OS!\n");
+    shell_out_puts("Designed by Ashish Yesale\n\n");
 
     // Send QEMU monitor command to quit
-    serial_puts("Sending QEMU quit command...\n");
+    shell_out_puts("Sending QEMU quit command...\n");
 
     // For QEMU, we can trigger a shutdown by writing to specific ports
     // or by causing a triple fault. Let's use a clean shutdown approach.
@@ -342,7 +324,7 @@ static void cmd_exit(int argc, char* argv[]) {
     __asm__ __volatile__ ("outw %0, %1" : : "a"((uint16_t)0x00), "Nd"((uint16_t)0x8900));
 
     // If we get here, none of the methods worked
-    serial_puts("Shutdown failed. System halted.\n");
+    shell_out_puts("Shutdown failed. System halted.\n");
     while (1) {
         // Halt
     }
@@ -358,9 +340,9 @@ static void cmd_ls(int argc, char* argv[]) {
     int result = fs_list_files(buffer, sizeof(buffer));
     
     if (result >= 0) {
-        serial_puts(buffer);
+        shell_out_puts(buffer);
     } else {
-        serial_puts("Error listing files\n");
+        shell_out_puts("Error listing files\n");
     }
 }
 
@@ -368,37 +350,37 @@ static void cmd_ls(int argc, char* argv[]) {
 static void cmd_pwd(int argc, char* argv[]) {
     char current_dir[128];
     fs_get_current_directory(current_dir, sizeof(current_dir));
-    serial_puts(current_dir);
-    serial_puts("\n");
+    shell_out_puts(current_dir);
+    shell_out_puts("\n");
 }
 
 // Create directory (simulated)
 static void cmd_mkdir(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: mkdir <directory_name>\n");
+        shell_out_puts("Usage: mkdir <directory_name>\n");
         return;
     }
     // For now, just simulate directory creation since we have a simple file system
     char msg[256];
     sprintf(msg, "Directory '%s' created (simulated)\n", argv[1]);
-    serial_puts(msg);
+    shell_out_puts(msg);
 }
 
 // Remove directory (simulated)
 static void cmd_rmdir(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: rmdir <directory_name>\n");
+        shell_out_puts("Usage: rmdir <directory_name>\n");
         return;
     }
     char msg[256];
     sprintf(msg, "Directory '%s' removed (simulated)\n", argv[1]);
-    serial_puts(msg);
+    shell_out_puts(msg);
 }
 
 // Create empty file
 static void cmd_touch(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: touch <filename>\n");
+        shell_out_puts("Usage: touch <filename>\n");
         return;
     }
     
@@ -407,18 +389,18 @@ static void cmd_touch(int argc, char* argv[]) {
     if (result == 0) {
         char msg[256];
         sprintf(msg, "File '%s' created\n", argv[1]);
-        serial_puts(msg);
+        shell_out_puts(msg);
     } else {
         char msg[256];
         sprintf(msg, "Error creating file '%s' (code: %d)\n", argv[1], result);
-        serial_puts(msg);
+        shell_out_puts(msg);
     }
 }
 
 // Remove file
 static void cmd_rm(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: rm <filename>\n");
+        shell_out_puts("Usage: rm <filename>\n");
         return;
     }
     
@@ -427,38 +409,42 @@ static void cmd_rm(int argc, char* argv[]) {
     if (result == 0) {
         char msg[256];
         sprintf(msg, "File '%s' deleted\n", argv[1]);
-        serial_puts(msg);
+        shell_out_puts(msg);
     } else {
         char msg[256];
         sprintf(msg, "Error deleting file '%s' (code: %d)\n", argv[1], result);
-        serial_puts(msg);
+        shell_out_puts(msg);
     }
 }
 
 // Display file contents (simulated)
 static void cmd_cat(int argc, char* argv[]) {
+    const char* data;
+    size_t size;
+    
     if (argc < 2) {
-        serial_puts("Usage: cat <filename>\n");
+        // Pass piped input through unchanged
+        if (shell_in_get(&data, &size)) {
+            shell_out_view(data, size);
+        } else {
+            shell_out_puts("Usage: cat <filename>\n");
+        }
         return;
     }
     
-    char buffer[4096];
-    int result = fs_cat(argv[1], buffer, sizeof(buffer));
-    
-    if (result >= 0) {
-        serial_puts(buffer);
-        serial_puts("\n");
+    if (fs_get_file_view(argv[1], &data, &size) == 0) {
+        shell_out_file_view(data, size);
     } else {
         char error_msg[256];
         sprintf(error_msg, "File not found: %s\n", argv[1]);
-        serial_puts(error_msg);
+        shell_out_puts(error_msg);
     }
 }
 
 // Simple text editor (simulated)
 static void cmd_nano(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: nano <filename>\n");
+        shell_out_puts("Usage: nano <filename>\n");
         return;
     }
     
@@ -468,43 +454,43 @@ static void cmd_nano(int argc, char* argv[]) {
     if (result < 0) {
         char msg[256];
         sprintf(msg, "Creating new file: %s\n", argv[1]);
-        serial_puts(msg);
+        shell_out_puts(msg);
     } else {
         char msg[256];
         sprintf(msg, "Editing file: %s\n", argv[1]);
-        serial_puts(msg);
-        serial_puts("Current content:\n");
-        serial_puts(buffer);
-        serial_puts("\n");
+        shell_out_puts(msg);
+        shell_out_puts("Current content:\n");
+        shell_out_puts(buffer);
+        shell_out_puts("\n");
     }
     
-    serial_puts("Enter new content (end with a line containing only '.')\n");
+    shell_out_puts("Enter new content (end with a line containing only '.')\n");
     
     char content[4096] = "";
     char line[256];
     int pos = 0;
     
     while (1) {
-        serial_puts("> ");
+        shell_out_puts("> ");
         
         // Read a line
         int line_pos = 0;
         while (1) {
-            char c = uart_getc();
+            char c = shell_in_getc();
             
             if (c == '\r' || c == '\n') {
-                serial_puts("\n");
+                shell_out_puts("\n");
                 line[line_pos] = '\0';
                 break;
             } else if (c == 8 || c == 127) {
                 // Backspace
                 if (line_pos > 0) {
                     line_pos--;
-                    serial_puts("\b \b");
+                    shell_out_puts("\b \b");
                 }
             } else if (c >= ' ' && c <= '~' && line_pos < sizeof(line) - 1) {
                 line[line_pos++] = c;
-                serial_putc(c);
+                shell_out_putc(c);
             }
         }
         
@@ -521,7 +507,7 @@ static void cmd_nano(int argc, char* argv[]) {
             content[pos++] = '\n';
             content[pos] = '\0';
         } else {
-            serial_puts("Buffer full, saving current content\n");
+            shell_out_puts("Buffer full, saving current content\n");
             break;
         }
     }
@@ -531,34 +517,34 @@ static void cmd_nano(int argc, char* argv[]) {
     if (result == 0) {
         char msg[256];
         sprintf(msg, "File '%s' saved successfully\n", argv[1]);
-        serial_puts(msg);
+        shell_out_puts(msg);
     } else {
         char msg[256];
         sprintf(msg, "Error saving file '%s'\n", argv[1]);
-        serial_puts(msg);
+        shell_out_puts(msg);
     }
 }
 
 // Show system uptime (simulated)
 static void cmd_uptime(int argc, char* argv[]) {
-    serial_puts("System uptime: 0 days, 0 hours, 5 minutes\n");
+    shell_out_puts("System uptime: 0 days, 0 hours, 5 minutes\n");
 }
 
 // Show current user (simulated)
 static void cmd_whoami(int argc, char* argv[]) {
-    serial_puts("sage\n");
+    shell_out_puts("sage\n");
 }
 
 // Show system information (simulated)
 static void cmd_uname(int argc, char* argv[]) {
-    serial_puts("SAGE-OS 1.0.1 i386 #1 SMP PREEMPT\n");
+    shell_out_puts("SAGE-OS 1.0.1 i386 #1 SMP PREEMPT\n");
 }
 
 // Save text to file
 static void cmd_save(int argc, char* argv[]) {
     if (argc < 3) {
-        serial_puts("Usage: save <filename> <content>\n");
-        serial_puts("Example: save test.txt \"Hello World\"\n");
+        shell_out_puts("Usage: save <filename> <content>\n");
+        shell_out_puts("Example: save test.txt \"Hello World\"\n");
         return;
     }
     
@@ -575,18 +561,18 @@ static void cmd_save(int argc, char* argv[]) {
     if (result == 0) {
         char msg[256];
         sprintf(msg, "File '%s' saved successfully\n", argv[1]);
-        serial_puts(msg);
+        shell_out_puts(msg);
     } else {
         char msg[256];
         sprintf(msg, "Error saving file '%s' (code: %d)\n", argv[1], result);
-        serial_puts(msg);
+        shell_out_puts(msg);
     }
 }
 
 // Append text to file
 static void cmd_append(int argc, char* argv[]) {
     if (argc < 3) {
-        serial_puts("Usage: append <filename> <content>\n");
+        shell_out_puts("Usage: append <filename> <content>\n");
         return;
     }
     
@@ -603,18 +589,18 @@ static void cmd_append(int argc, char* argv[]) {
     if (result == 0) {
         char msg[256];
         sprintf(msg, "Content appended to '%s' successfully\n", argv[1]);
-        serial_puts(msg);
+        shell_out_puts(msg);
     } else {
         char msg[256];
         sprintf(msg, "Error appending to file '%s' (code: %d)\n", argv[1], result);
-        serial_puts(msg);
+        shell_out_puts(msg);
     }
 }
 
 // Delete file
 static void cmd_delete(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: delete <filename>\n");
+        shell_out_puts("Usage: delete <filename>\n");
         return;
     }
     
@@ -622,25 +608,25 @@ static void cmd_delete(int argc, char* argv[]) {
     if (result == 0) {
         char msg[256];
         sprintf(msg, "File '%s' deleted successfully\n", argv[1]);
-        serial_puts(msg);
+        shell_out_puts(msg);
     } else {
         char msg[256];
         sprintf(msg, "Error deleting file '%s' (code: %d)\n", argv[1], result);
-        serial_puts(msg);
+        shell_out_puts(msg);
     }
 }
 
 // Display file information
 static void cmd_fileinfo(int argc, char* argv[]) {
     if (argc < 2) {
-        serial_puts("Usage: fileinfo <filename>\n");
+        shell_out_puts("Usage: fileinfo <filename>\n");
         return;
     }
     
     if (!fs_file_exists(argv[1])) {
         char msg[256];
         sprintf(msg, "File not found: %s\n", argv[1]);
-        serial_puts(msg);
+        shell_out_puts(msg);
         return;
     }
     
@@ -648,9 +634,9 @@ static void cmd_fileinfo(int argc, char* argv[]) {
     
     char buffer[256];
     sprintf(buffer, "File: %s\n", argv[1]);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
     sprintf(buffer, "Size: %u bytes\n", (unsigned int)size);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
     
     // Read file content for preview
     char content[4096];
@@ -674,20 +660,46 @@ static void cmd_fileinfo(int argc, char* argv[]) {
     }
     
     sprintf(buffer, "Lines: %d\n", lines + 1);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
     sprintf(buffer, "Words: %d\n", words);
-    serial_puts(buffer);
+    shell_out_puts(buffer);
     
     // Show preview
-    serial_puts("Preview:\n");
+    shell_out_puts("Preview:\n");
     if (size > 100) {
         char preview[101];
         strncpy(preview, content, 100);
         preview[100] = '\0';
-        serial_puts(preview);
-        serial_puts("...\n");
+        shell_out_puts(preview);
+        shell_out_puts("...\n");
     } else {
-        serial_puts(content);
-        serial_puts("\n");
+        shell_out_puts(content);
+        shell_out_puts("\n");
     }
-}
\ No newline at end of file
+}
+
+// Run in-kernel benchmarks
+static void cmd_bench(int argc, char* argv[]) {
+    const char* suite = (argc > 1) ? argv[1] : "all";
+    
+    if (kbench_run(suite) != 0) {
+        shell_out_puts("Usage: bench [all|mem|ctx|irq|fs|uart|ai|spi|cpu]\n");
+    }
+}
+
+// Run commands from a script file
+static void cmd_source(int argc, char* argv[]) {
+    if (argc < 2) {
+        shell_out_puts("Usage: source <filename>\n");
+        return;
+    }
+    
+    int result = shell_run_script(argv[1], execute_command);
+    if (result == SHELL_IO_ERROR_NOT_FOUND) {
+        char msg[256];
+        sprintf(msg, "Script not found: %s\n", argv[1]);
+        shell_out_puts(msg);
+    } else if (result == SHELL_IO_ERROR_DEPTH) {
+        shell_out_puts("Scripts nested too deeply\n");
+    }
+}
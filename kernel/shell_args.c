@@ -0,0 +1,46 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Shell Argument Parser
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "shell_args.h"
+#include "types.h"
+
+// Split a command into arguments
+int shell_split_args(char* command, char* argv[], int max_args) {
+    int argc = 0;
+    char* token = command;
+    
+    if (max_args <= 0) {
+        return 0;
+    }
+    
+    // Skip leading whitespace
+    while (*token == ' ' || *token == '\t') {
+        token++;
+    }
+    
+    while (*token && argc < max_args - 1) {
+        // Mark the start of the argument
+        argv[argc++] = token;
+        
+        // Find the end of the argument
+        while (*token && *token != ' ' && *token != '\t') {
+            token++;
+        }
+        
+        // Null-terminate the argument
+        if (*token) {
+            *token++ = '\0';
+        }
+        
+        // Skip whitespace to the next argument
+        while (*token == ' ' || *token == '\t') {
+            token++;
+        }
+    }
+    
+    argv[argc] = NULL;
+    return argc;
+}
@@ -0,0 +1,15 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Shell Argument Parser
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SHELL_ARGS_H
+#define SHELL_ARGS_H
+
+// Split a command line into whitespace separated arguments, in place.
+// At most max_args - 1 arguments are stored and argv[argc] is set to NULL.
+// Returns the number of arguments found.
+int shell_split_args(char* command, char* argv[], int max_args);
+
+#endif // SHELL_ARGS_H
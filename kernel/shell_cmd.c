@@ -0,0 +1,155 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Shell Command Dispatch
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "shell_cmd.h"
+#include "stdio.h"
+
+#define SHELL_CMD_SEED_TRIES 1024
+
+// Commands registered by drivers, shared by all shells
+static shell_cmd_table_t registered_commands = SHELL_CMD_TABLE_INIT(NULL);
+
+// FNV-1a, with the seed folded into the offset basis
+static uint32_t shell_cmd_hash(const char* name, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    
+    return hash ^ (hash >> 16);
+}
+
+static void shell_cmd_clear_slots(shell_cmd_table_t* table) {
+    for (uint32_t i = 0; i < SHELL_CMD_SLOTS; i++) {
+        table->slots[i] = NULL;
+    }
+}
+
+static void shell_cmd_insert(shell_cmd_table_t* table, const shell_command_t* command) {
+    uint32_t slot = shell_cmd_hash(command->name, table->seed) & (SHELL_CMD_SLOTS - 1);
+    
+    while (table->slots[slot] != NULL) {
+        slot = (slot + 1) & (SHELL_CMD_SLOTS - 1);
+    }
+    table->slots[slot] = command;
+}
+
+// Try to place every built-in without a collision using the given seed
+static int shell_cmd_try_seed(shell_cmd_table_t* table, uint32_t seed) {
+    shell_cmd_clear_slots(table);
+    
+    for (uint32_t i = 0; i < table->count; i++) {
+        uint32_t slot = shell_cmd_hash(table->order[i]->name, seed) & (SHELL_CMD_SLOTS - 1);
+        if (table->slots[slot] != NULL) {
+            return 0;
+        }
+        table->slots[slot] = table->order[i];
+    }
+    
+    return 1;
+}
+
+static void shell_cmd_build(shell_cmd_table_t* table) {
+    table->count = 0;
+    table->seed = 0;
+    
+    if (table->builtins != NULL) {
+        for (int i = 0; table->builtins[i].name != NULL && table->count < SHELL_CMD_MAX; i++) {
+            table->order[table->count++] = &table->builtins[i];
+        }
+    }
+    
+    table->built = 1;
+    
+    for (uint32_t seed = 0; seed < SHELL_CMD_SEED_TRIES; seed++) {
+        if (shell_cmd_try_seed(table, seed)) {
+            table->seed = seed;
+            return;
+        }
+    }
+    
+    // No collision-free seed: fall back to probing, lookups stay correct
+    shell_cmd_clear_slots(table);
+    for (uint32_t i = 0; i < table->count; i++) {
+        shell_cmd_insert(table, table->order[i]);
+    }
+}
+
+static const shell_command_t* shell_cmd_find(shell_cmd_table_t* table, const char* name) {
+    if (!table->built) {
+        shell_cmd_build(table);
+    }
+    
+    uint32_t slot = shell_cmd_hash(name, table->seed) & (SHELL_CMD_SLOTS - 1);
+    
+    while (table->slots[slot] != NULL) {
+        if (strcmp(table->slots[slot]->name, name) == 0) {
+            return table->slots[slot];
+        }
+        slot = (slot + 1) & (SHELL_CMD_SLOTS - 1);
+    }
+    
+    return NULL;
+}
+
+const shell_command_t* shell_cmd_lookup(shell_cmd_table_t* table, const char* name) {
+    if (table == NULL || name == NULL) {
+        return NULL;
+    }
+    
+    const shell_command_t* command = shell_cmd_find(table, name);
+    if (command == NULL && registered_commands.count > 0) {
+        command = shell_cmd_find(&registered_commands, name);
+    }
+    
+    return command;
+}
+
+int shell_cmd_table_add(shell_cmd_table_t* table, const shell_command_t* command) {
+    if (table == NULL || command == NULL || command->name == NULL || command->func == NULL) {
+        return SHELL_CMD_ERROR_PARAM;
+    }
+    
+    if (shell_cmd_find(table, command->name) != NULL) {
+        return SHELL_CMD_ERROR_DUPLICATE;
+    }
+    
+    if (table->count >= SHELL_CMD_MAX) {
+        return SHELL_CMD_ERROR_FULL;
+    }
+    
+    table->order[table->count++] = command;
+    shell_cmd_insert(table, command);
+    
+    return 0;
+}
+
+const shell_command_t* shell_cmd_at(shell_cmd_table_t* table, uint32_t index) {
+    if (table == NULL) {
+        return NULL;
+    }
+    
+    if (!table->built) {
+        shell_cmd_build(table);
+    }
+    
+    if (index < table->count) {
+        return table->order[index];
+    }
+    
+    index -= table->count;
+    if (index < registered_commands.count) {
+        return registered_commands.order[index];
+    }
+    
+    return NULL;
+}
+
+int shell_register_command(const shell_command_t* command) {
+    return shell_cmd_table_add(&registered_commands, command);
+}
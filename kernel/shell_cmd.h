@@ -0,0 +1,60 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Shell Command Dispatch
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SHELL_CMD_H
+#define SHELL_CMD_H
+
+#include "types.h"
+
+#define SHELL_CMD_SLOTS 128   // Hash slots per table, must be a power of two
+#define SHELL_CMD_MAX   64    // Commands per table (built-ins plus registered)
+
+// Shell command handler
+typedef void (*shell_command_func_t)(int argc, char* argv[]);
+
+typedef struct {
+    const char* name;
+    const char* description;
+    shell_command_func_t func;
+} shell_command_t;
+
+// Hashed command table. The hash is built on first lookup; the seed is
+// chosen so that every built-in lands in its own slot, making a built-in
+// dispatch one hash plus one strcmp. Later additions use linear probing.
+typedef struct {
+    const shell_command_t* builtins;                 // {NULL, ...} terminated
+    const shell_command_t* slots[SHELL_CMD_SLOTS];
+    const shell_command_t* order[SHELL_CMD_MAX];     // Insertion order, for help
+    uint32_t count;
+    uint32_t seed;
+    int built;
+} shell_cmd_table_t;
+
+// Static initializer for a table over a built-in command array
+#define SHELL_CMD_TABLE_INIT(builtin_table) { .builtins = (builtin_table) }
+
+// Error codes
+#define SHELL_CMD_ERROR_PARAM     -1
+#define SHELL_CMD_ERROR_FULL      -2
+#define SHELL_CMD_ERROR_DUPLICATE -3
+
+// Find a command by name: the table's own commands first, then commands
+// registered globally with shell_register_command(). Returns NULL if unknown.
+const shell_command_t* shell_cmd_lookup(shell_cmd_table_t* table, const char* name);
+
+// Add a command to a single table. The command must stay valid for the
+// lifetime of the table (it is referenced, not copied).
+int shell_cmd_table_add(shell_cmd_table_t* table, const shell_command_t* command);
+
+// Get the index'th command for listing: the table's commands in insertion
+// order followed by globally registered ones. Returns NULL past the end.
+const shell_command_t* shell_cmd_at(shell_cmd_table_t* table, uint32_t index);
+
+// Register a command with every shell, e.g. from a driver init routine.
+// Built-in commands of the same name take precedence.
+int shell_register_command(const shell_command_t* command);
+
+#endif // SHELL_CMD_H
@@ -0,0 +1,287 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Shell I/O, Pipelines and Scripts
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "shell_io.h"
+#include "../drivers/serial.h"
+#include "../drivers/uart.h"
+#include "stdio.h"
+#include "utils.h"
+#include "ai/ai_subsystem.h"
+
+#define SHELL_PRINTF_MAX 512
+
+// Output of one pipeline stage. data points at storage, or at borrowed
+// memory (a file view) when the stage emitted a single view and nothing else.
+typedef struct {
+    char* storage;
+    const char* data;
+    size_t len;
+    int truncated;
+} shell_pipe_t;
+
+// Stages alternate between two buffers: stage N writes one while reading
+// stage N-1's output from the other.
+static char pipe_storage[2][SHELL_PIPE_SIZE];
+static shell_pipe_t pipes[2] = {
+    {pipe_storage[0], pipe_storage[0], 0, 0},
+    {pipe_storage[1], pipe_storage[1], 0, 0}
+};
+
+static shell_pipe_t* current_out = NULL;   // NULL: serial console
+static const char* current_in = NULL;
+static size_t current_in_len = 0;
+static int current_in_valid = 0;
+static int pipeline_active = 0;
+static int script_depth = 0;
+
+static int in_pipe_storage(const char* data) {
+    return data >= pipe_storage[0] && data < pipe_storage[0] + sizeof(pipe_storage);
+}
+
+// Copy borrowed contents into the pipe's own storage before appending
+static void pipe_materialize(shell_pipe_t* pipe) {
+    if (pipe->data != pipe->storage) {
+        memcpy(pipe->storage, pipe->data, pipe->len);
+        pipe->data = pipe->storage;
+    }
+}
+
+static void pipe_append(shell_pipe_t* pipe, const char* data, size_t len) {
+    pipe_materialize(pipe);
+    
+    if (pipe->len + len > SHELL_PIPE_SIZE) {
+        len = SHELL_PIPE_SIZE - pipe->len;
+        pipe->truncated = 1;
+    }
+    
+    memcpy(pipe->storage + pipe->len, data, len);
+    pipe->len += len;
+}
+
+void shell_out_write(const char* data, size_t len) {
+    if (data == NULL || len == 0) {
+        return;
+    }
+    
+    if (current_out != NULL) {
+        pipe_append(current_out, data, len);
+        return;
+    }
+    
+    for (size_t i = 0; i < len; i++) {
+        serial_putc(data[i]);
+    }
+}
+
+void shell_out_putc(char c) {
+    shell_out_write(&c, 1);
+}
+
+void shell_out_puts(const char* str) {
+    if (str != NULL) {
+        shell_out_write(str, strlen(str));
+    }
+}
+
+int shell_out_printf(const char* format, ...) {
+    char buffer[SHELL_PRINTF_MAX];
+    va_list args;
+    
+    va_start(args, format);
+    // Longer output is cut off rather than overrunning the buffer
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    
+    shell_out_write(buffer, (size_t)len);
+    return len;
+}
+
+void shell_out_view(const char* data, size_t len) {
+    // Borrow only memory that outlives the pipeline and is not a pipe buffer
+    if (current_out != NULL && current_out->len == 0 && !in_pipe_storage(data)) {
+        if (len > SHELL_PIPE_SIZE) {
+            len = SHELL_PIPE_SIZE;
+            current_out->truncated = 1;
+        }
+        current_out->data = data;
+        current_out->len = len;
+        return;
+    }
+    
+    shell_out_write(data, len);
+}
+
+void shell_out_file_view(const char* data, size_t len) {
+    shell_out_view(data, len);
+    if (current_out == NULL && len > 0 && data[len - 1] != '\n') {
+        shell_out_putc('\n');
+    }
+}
+
+int shell_in_get(const char** data, size_t* len) {
+    if (!current_in_valid || data == NULL || len == NULL) {
+        return 0;
+    }
+    
+    *data = current_in;
+    *len = current_in_len;
+    return 1;
+}
+
+char shell_in_getc(void) {
+    int c;
+    
+    while ((c = uart_try_getc()) < 0) {
+        ai_subsystem_process();
+    }
+    return (char)c;
+}
+
+static char* trim(char* str) {
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    
+    char* end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        *--end = '\0';
+    }
+    
+    return str;
+}
+
+int shell_exec_line(const char* line, shell_exec_func_t exec) {
+    char buffer[SHELL_LINE_MAX];
+    char* stages[SHELL_MAX_STAGES];
+    int num_stages = 0;
+    
+    if (line == NULL || exec == NULL) {
+        return SHELL_IO_ERROR_PARAM;
+    }
+    
+    strncpy(buffer, line, SHELL_LINE_MAX - 1);
+    buffer[SHELL_LINE_MAX - 1] = '\0';
+    
+    // Split into stages on '|'
+    char* start = buffer;
+    for (char* p = buffer; ; p++) {
+        if (*p == '|' || *p == '\0') {
+            int last = (*p == '\0');
+            if (num_stages == SHELL_MAX_STAGES) {
+                return SHELL_IO_ERROR_STAGES;
+            }
+            *p = '\0';
+            stages[num_stages++] = trim(start);
+            if (last) {
+                break;
+            }
+            start = p + 1;
+        }
+    }
+    
+    if (num_stages == 1) {
+        exec(stages[0]);
+        return 0;
+    }
+    
+    for (int i = 0; i < num_stages; i++) {
+        if (stages[i][0] == '\0') {
+            return SHELL_IO_ERROR_STAGES;
+        }
+    }
+    
+    if (pipeline_active) {
+        return SHELL_IO_ERROR_NESTED;
+    }
+    
+    shell_pipe_t* saved_out = current_out;
+    int truncated = 0;
+    pipeline_active = 1;
+    
+    for (int i = 0; i < num_stages; i++) {
+        if (i > 0) {
+            shell_pipe_t* prev = &pipes[(i - 1) & 1];
+            current_in = prev->data;
+            current_in_len = prev->len;
+            current_in_valid = 1;
+            truncated |= prev->truncated;
+        }
+        
+        if (i < num_stages - 1) {
+            current_out = &pipes[i & 1];
+            current_out->data = current_out->storage;
+            current_out->len = 0;
+            current_out->truncated = 0;
+        } else {
+            current_out = saved_out;
+        }
+        
+        exec(stages[i]);
+    }
+    
+    current_out = saved_out;
+    current_in = NULL;
+    current_in_len = 0;
+    current_in_valid = 0;
+    pipeline_active = 0;
+    
+    if (truncated) {
+        serial_puts("warning: pipe buffer full, output truncated\n");
+    }
+    
+    return 0;
+}
+
+int shell_run_script(const char* filename, shell_exec_func_t exec) {
+    const char* data;
+    size_t size;
+    size_t pos = 0;
+    
+    if (filename == NULL || exec == NULL) {
+        return SHELL_IO_ERROR_PARAM;
+    }
+    
+    if (fs_get_file_view(filename, &data, &size) != 0) {
+        return SHELL_IO_ERROR_NOT_FOUND;
+    }
+    
+    if (script_depth >= SHELL_MAX_SCRIPT_DEPTH) {
+        return SHELL_IO_ERROR_DEPTH;
+    }
+    
+    script_depth++;
+    
+    // Re-acquire the view for every line: commands in the script may
+    // rewrite or delete the script file itself.
+    while (fs_get_file_view(filename, &data, &size) == 0 && pos < size) {
+        char line[SHELL_LINE_MAX];
+        size_t len = 0;
+        
+        while (pos < size && data[pos] != '\n') {
+            if (len < SHELL_LINE_MAX - 1) {
+                line[len++] = data[pos];
+            }
+            pos++;
+        }
+        pos++;  // Skip the newline
+        line[len] = '\0';
+        
+        char* command = trim(line);
+        if (command[0] == '\0' || command[0] == '#') {
+            continue;
+        }
+        
+        int result = shell_exec_line(command, exec);
+        if (result == SHELL_IO_ERROR_NESTED) {
+            serial_puts("error: pipelines cannot be nested\n");
+        } else if (result == SHELL_IO_ERROR_STAGES) {
+            serial_puts("error: invalid pipeline\n");
+        }
+    }
+    
+    script_depth--;
+    return 0;
+}
@@ -0,0 +1,60 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Shell I/O, Pipelines and Scripts
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SHELL_IO_H
+#define SHELL_IO_H
+
+#include "types.h"
+#include "filesystem.h"
+
+#define SHELL_LINE_MAX          256
+#define SHELL_PIPE_SIZE         MAX_FILESIZE  // Bytes buffered between two stages
+#define SHELL_MAX_STAGES        8
+#define SHELL_MAX_SCRIPT_DEPTH  4
+#define SHELL_AUTORUN_SCRIPT    "autorun.sh"
+
+// Error codes
+#define SHELL_IO_ERROR_PARAM      -1
+#define SHELL_IO_ERROR_NOT_FOUND  -2
+#define SHELL_IO_ERROR_STAGES     -3  // Too many stages or an empty stage
+#define SHELL_IO_ERROR_NESTED     -4  // Pipeline started from inside a pipeline
+#define SHELL_IO_ERROR_DEPTH      -5  // Scripts sourcing scripts too deeply
+
+// Executes one command (no '|'); the string may be modified
+typedef void (*shell_exec_func_t)(char* command);
+
+// Command output. Goes to the serial console, or to the in-memory pipe
+// buffer of the next stage while a pipeline is running.
+void shell_out_putc(char c);
+void shell_out_puts(const char* str);
+void shell_out_write(const char* data, size_t len);
+int shell_out_printf(const char* format, ...);
+
+// Output data that stays valid for the whole pipeline, such as a file view.
+// If it is all a stage writes, the next stage reads it in place, uncopied.
+void shell_out_view(const char* data, size_t len);
+
+// Output a whole file's view, as cat does. On the console a newline is
+// added when a non-empty file does not end in one; a pipe gets the bytes
+// unchanged, so the next stage can still read the view in place.
+void shell_out_file_view(const char* data, size_t len);
+
+// Input piped in from the previous stage. Returns 1 and sets data/len when
+// the current command is a pipeline stage with input, 0 otherwise.
+int shell_in_get(const char** data, size_t* len);
+
+// Next character typed on the console. While none is waiting, queued AI
+// requests and model uploads advance through ai_subsystem_process().
+char shell_in_getc(void);
+
+// Execute a command line, connecting '|'-separated stages in memory
+int shell_exec_line(const char* line, shell_exec_func_t exec);
+
+// Execute a script stored in the file system, one line at a time.
+// Blank lines and lines starting with '#' are skipped.
+int shell_run_script(const char* filename, shell_exec_func_t exec);
+
+#endif // SHELL_IO_H
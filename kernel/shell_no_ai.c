@@ -138,7 +138,7 @@ static void add_to_history(const char* command) {
     }
     
     // Check if this command is the same as the last one
-    if (history_count > 0 && strcmp(command, history[(history_index - 1) % HISTORY_SIZE]) == 0) {
+    if (history_count > 0 && strcmp(command, history[(history_index + HISTORY_SIZE - 1) % HISTORY_SIZE]) == 0) {
         return;  // Don't add duplicate commands consecutively
     }
     
@@ -10,17 +10,12 @@
 #include "filesystem.h"
 #include "memory.h"
 #include "utils.h"
+#include "shell_args.h"
+#include "shell_cmd.h"
 
 #define MAX_COMMAND_LENGTH 256
 #define MAX_ARGS 16
 
-// Command structure
-typedef struct {
-    const char* name;
-    void (*handler)(int argc, char* argv[]);
-    const char* description;
-} command_t;
-
 // Forward declarations
 static void cmd_help(int argc, char* argv[]);
 static void cmd_echo(int argc, char* argv[]);
@@ -48,59 +43,36 @@ static void cmd_tail(int argc, char* argv[]);
 static void cmd_stat(int argc, char* argv[]);
 
 // Command table
-static const command_t commands[] = {
-    {"help", cmd_help, "Show available commands"},
-    {"echo", cmd_echo, "Echo text to console"},
-    {"clear", cmd_clear, "Clear the screen"},
-    {"meminfo", cmd_meminfo, "Show memory information"},
-    {"reboot", cmd_reboot, "Reboot the system"},
-    {"version", cmd_version, "Show OS version"},
-    {"exit", cmd_exit, "Exit SAGE OS"},
-    {"ls", cmd_ls, "List files and directories"},
-    {"pwd", cmd_pwd, "Show current directory"},
-    {"cat", cmd_cat, "Display file contents"},
-    {"save", cmd_save, "Save text to file"},
-    {"rm", cmd_rm, "Remove file"},
-    {"cp", cmd_cp, "Copy file"},
-    {"mv", cmd_mv, "Move/rename file"},
-    {"mkdir", cmd_mkdir, "Create directory"},
-    {"touch", cmd_touch, "Create empty file"},
-    {"find", cmd_find, "Find files by name"},
-    {"grep", cmd_grep, "Search text in files"},
-    {"wc", cmd_wc, "Count lines, words, characters"},
-    {"head", cmd_head, "Show first lines of file"},
-    {"tail", cmd_tail, "Show last lines of file"},
-    {"stat", cmd_stat, "Show file statistics"},
-    {"uptime", cmd_uptime, "Show system uptime"},
-    {"whoami", cmd_whoami, "Show current user"},
+static const shell_command_t commands[] = {
+    {"help", "Show available commands", cmd_help},
+    {"echo", "Echo text to console", cmd_echo},
+    {"clear", "Clear the screen", cmd_clear},
+    {"meminfo", "Show memory information", cmd_meminfo},
+    {"reboot", "Reboot the system", cmd_reboot},
+    {"version", "Show OS version", cmd_version},
+    {"exit", "Exit SAGE OS", cmd_exit},
+    {"ls", "List files and directories", cmd_ls},
+    {"pwd", "Show current directory", cmd_pwd},
+    {"cat", "Display file contents", cmd_cat},
+    {"save", "Save text to file", cmd_save},
+    {"rm", "Remove file", cmd_rm},
+    {"cp", "Copy file", cmd_cp},
+    {"mv", "Move/rename file", cmd_mv},
+    {"mkdir", "Create directory", cmd_mkdir},
+    {"touch", "Create empty file", cmd_touch},
+    {"find", "Find files by name", cmd_find},
+    {"grep", "Search text in files", cmd_grep},
+    {"wc", "Count lines, words, characters", cmd_wc},
+    {"head", "Show first lines of file", cmd_head},
+    {"tail", "Show last lines of file", cmd_tail},
+    {"stat", "Show file statistics", cmd_stat},
+    {"uptime", "Show system uptime", cmd_uptime},
+    {"whoami", "Show current user", cmd_whoami},
     {NULL, NULL, NULL}
 };
 
-// Parse command line into arguments
-static int parse_command(char* command, char* argv[]) {
-    int argc = 0;
-    char* token = command;
-    
-    // Skip leading whitespace
-    while (*token == ' ' || *token == '\t') token++;
-    
-    while (*token && argc < MAX_ARGS - 1) {
-        argv[argc++] = token;
-        
-        // Find end of current argument
-        while (*token && *token != ' ' && *token != '\t') token++;
-        
-        // Null-terminate current argument
-        if (*token) {
-            *token++ = '\0';
-            // Skip whitespace to next argument
-            while (*token == ' ' || *token == '\t') token++;
-        }
-    }
-    
-    argv[argc] = NULL;
-    return argc;
-}
+// Hashed lookup over commands[] plus driver-registered commands
+static shell_cmd_table_t command_table = SHELL_CMD_TABLE_INIT(commands);
 
 // Process a command
 void shell_process_command(const char* input) {
@@ -113,16 +85,15 @@ void shell_process_command(const char* input) {
     command[MAX_COMMAND_LENGTH - 1] = '\0';
     
     // Parse command
-    argc = parse_command(command, argv);
+    argc = shell_split_args(command, argv, MAX_ARGS);
     
     if (argc == 0) return;
     
     // Find and execute command
-    for (int i = 0; commands[i].name; i++) {
-        if (strcmp(argv[0], commands[i].name) == 0) {
-            commands[i].handler(argc, argv);
-            return;
-        }
+    const shell_command_t* cmd = shell_cmd_lookup(&command_table, argv[0]);
+    if (cmd) {
+        cmd->func(argc, argv);
+        return;
     }
     
     // Command not found
@@ -138,11 +109,12 @@ static void cmd_help(int argc, char* argv[]) {
     serial_puts("SAGE OS Enhanced Shell - Available Commands:\n");
     serial_puts("==========================================\n");
     
-    for (int i = 0; commands[i].name; i++) {
+    const shell_command_t* cmd;
+    for (uint32_t i = 0; (cmd = shell_cmd_at(&command_table, i)); i++) {
         serial_puts("  ");
-        serial_puts(commands[i].name);
+        serial_puts(cmd->name);
         serial_puts(" - ");
-        serial_puts(commands[i].description);
+        serial_puts(cmd->description);
         serial_puts("\n");
     }
     
@@ -0,0 +1,178 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Secondary CPU Bring-up
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "smp.h"
+#include "mmu.h"
+
+static uint32_t cpus_online = 1;
+static int smp_started = 0;
+
+// Work handed out by smp_run. Secondaries wait for the generation to move,
+// run their share and count themselves done.
+static smp_work_t work_fn;
+static void* work_arg;
+static uint32_t work_cpus;
+static uint32_t work_generation;
+static uint32_t work_done;
+
+#if defined(__aarch64__)
+
+#define PSCI_VERSION            0x84000000u
+#define PSCI_CPU_ON             0xC4000003u     // SMC64 function ID
+#define PSCI_SUCCESS            0
+#define SMP_ONLINE_SPINS        10000000u       // Wait for a started CPU to check in
+#define MPIDR_AFFINITY_MASK     0xFF00FFFF00ull // Aff3, Aff2 and Aff1
+
+// Linker script symbol: load address of the kernel image
+extern char __start[];
+
+// boot.S: where CPU_ON starts a secondary, with x0 = its logical number
+extern void secondary_entry(void);
+
+// Read by secondary_entry with the MMU off: MAIR, TCR, TTBR0, TTBR1,
+// SCTLR and VBAR of the boot CPU, and one stack per secondary
+uint64_t smp_boot_regs[6] __attribute__((aligned(64)));
+uint8_t smp_stacks[SMP_MAX_CPUS - 1][SMP_STACK_SIZE] __attribute__((aligned(16)));
+
+static inline void cpu_wait(void) {
+    __asm__ volatile ("wfe" : : : "memory");
+}
+
+static inline void cpu_signal(void) {
+    __asm__ volatile ("dsb ish; sev" : : : "memory");
+}
+
+// PSCI through the hypervisor conduit QEMU virt uses without EL2/EL3
+static int64_t psci_call(uint64_t function, uint64_t arg1, uint64_t arg2, uint64_t arg3) {
+    register uint64_t x0 __asm__("x0") = function;
+    register uint64_t x1 __asm__("x1") = arg1;
+    register uint64_t x2 __asm__("x2") = arg2;
+    register uint64_t x3 __asm__("x3") = arg3;
+    __asm__ volatile ("hvc #0"
+                      : "+r"(x0), "+r"(x1), "+r"(x2), "+r"(x3)
+                      :
+                      : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13",
+                        "x14", "x15", "x16", "x17", "memory");
+    return (int64_t)x0;
+}
+
+static void save_boot_regs(void) {
+    __asm__ volatile ("mrs %0, mair_el1" : "=r"(smp_boot_regs[0]));
+    __asm__ volatile ("mrs %0, tcr_el1" : "=r"(smp_boot_regs[1]));
+    __asm__ volatile ("mrs %0, ttbr0_el1" : "=r"(smp_boot_regs[2]));
+    __asm__ volatile ("mrs %0, ttbr1_el1" : "=r"(smp_boot_regs[3]));
+    __asm__ volatile ("mrs %0, sctlr_el1" : "=r"(smp_boot_regs[4]));
+    __asm__ volatile ("mrs %0, vbar_el1" : "=r"(smp_boot_regs[5]));
+    
+    // Secondaries read these before their caches are on
+    __asm__ volatile ("dc cvac, %0; dsb sy" : : "r"(smp_boot_regs) : "memory");
+}
+
+static int start_cpu(uint32_t cpu, uint64_t mpidr) {
+    if (psci_call(PSCI_CPU_ON, mpidr, (uint64_t)(uintptr_t)secondary_entry, cpu) != PSCI_SUCCESS) {
+        return 0;
+    }
+    for (uint32_t spin = 0; spin < SMP_ONLINE_SPINS; spin++) {
+        if (__atomic_load_n(&cpus_online, __ATOMIC_ACQUIRE) > cpu) {
+            return 1;
+        }
+        smp_relax();
+    }
+    return 0;
+}
+
+int smp_init(void) {
+    if (smp_started) {
+        return (int)cpus_online;
+    }
+    smp_started = 1;
+    
+    // PSCI is only known to be present on QEMU virt (RAM from 1 GiB, as in
+    // mmu.c); Raspberry Pi firmware parks the other cores in a spin table.
+    // Secondaries run on the boot CPU's tables, so those must be live.
+    if ((uint64_t)(uintptr_t)__start < MMU_BLOCK_1G || !mmu_enabled()) {
+        return 1;
+    }
+    if (psci_call(PSCI_VERSION, 0, 0, 0) < 0) {
+        return 1;
+    }
+    
+    save_boot_regs();
+    
+    uint64_t mpidr;
+    __asm__ volatile ("mrs %0, mpidr_el1" : "=r"(mpidr));
+    
+    // QEMU virt numbers the cores of a cluster 0-7 in Aff0; stop at the
+    // first that does not exist or does not come up
+    for (uint32_t cpu = 1; cpu < SMP_MAX_CPUS; cpu++) {
+        if (!start_cpu(cpu, (mpidr & MPIDR_AFFINITY_MASK) | cpu)) {
+            break;
+        }
+    }
+    return (int)cpus_online;
+}
+
+// Called by secondary_entry with the MMU and caches on
+void smp_secondary_main(uint32_t cpu) {
+    uint32_t seen = __atomic_load_n(&work_generation, __ATOMIC_ACQUIRE);
+    __atomic_fetch_add(&cpus_online, 1, __ATOMIC_RELEASE);
+    
+    for (;;) {
+        uint32_t generation;
+        while ((generation = __atomic_load_n(&work_generation, __ATOMIC_ACQUIRE)) == seen) {
+            cpu_wait();
+        }
+        seen = generation;
+        
+        if (cpu < work_cpus) {
+            work_fn(cpu, work_arg);
+        }
+        __atomic_fetch_add(&work_done, 1, __ATOMIC_RELEASE);
+        cpu_signal();
+    }
+}
+
+#else
+
+static inline void cpu_wait(void) {
+    smp_relax();
+}
+
+static inline void cpu_signal(void) {
+}
+
+int smp_init(void) {
+    smp_started = 1;
+    return 1;
+}
+
+#endif
+
+uint32_t smp_cpu_count(void) {
+    return __atomic_load_n(&cpus_online, __ATOMIC_ACQUIRE);
+}
+
+int smp_run(uint32_t cpus, smp_work_t work, void* arg) {
+    uint32_t online = smp_cpu_count();
+    if (cpus == 0 || cpus > online || work == NULL) {
+        return SMP_ERROR_PARAM;
+    }
+    
+    // Every secondary checks in, with or without a share of the work
+    work_fn = work;
+    work_arg = arg;
+    work_cpus = cpus;
+    __atomic_store_n(&work_done, 0, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&work_generation, 1, __ATOMIC_RELEASE);
+    cpu_signal();
+    
+    work(0, arg);
+    
+    while (__atomic_load_n(&work_done, __ATOMIC_ACQUIRE) < online - 1) {
+        cpu_wait();
+    }
+    return SMP_SUCCESS;
+}
@@ -0,0 +1,58 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Secondary CPU Bring-up
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SMP_H
+#define SMP_H
+
+#include "types.h"
+
+// The boot CPU is logical CPU 0. On aarch64 the other cores are started
+// through PSCI when the firmware provides it (QEMU virt with -smp); they
+// share the boot CPU's page tables and vectors and then sit idle until
+// smp_run hands them work. Other architectures run on the boot CPU only.
+
+#define SMP_MAX_CPUS            8
+#define SMP_STACK_SIZE          16384   // Per secondary CPU; boot.S shifts by 14
+
+// Error codes
+#define SMP_SUCCESS             0
+#define SMP_ERROR_PARAM         -1  // No CPUs, or more than are online
+
+// Logical number of the running CPU, 0 to SMP_MAX_CPUS - 1
+static inline uint32_t smp_cpu_id(void) {
+#if defined(__aarch64__)
+    uint64_t id;
+    __asm__ volatile ("mrs %0, tpidr_el1" : "=r"(id));
+    return (uint32_t)id;
+#else
+    return 0;
+#endif
+}
+
+// Spin-wait hint for loops polling memory another CPU writes
+static inline void smp_relax(void) {
+#if defined(__aarch64__)
+    __asm__ volatile ("yield" : : : "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    __asm__ volatile ("pause" : : : "memory");
+#else
+    __asm__ volatile ("" : : : "memory");
+#endif
+}
+
+typedef void (*smp_work_t)(uint32_t cpu, void* arg);
+
+// Start the secondary CPUs; needs mmu_init to have succeeded. Returns the
+// number of CPUs online, boot CPU included.
+int smp_init(void);
+
+uint32_t smp_cpu_count(void);
+
+// Run work(cpu, arg) on CPUs 0 to cpus - 1 at once, the caller's own CPU
+// taking CPU 0's share, and return when every one has finished
+int smp_run(uint32_t cpus, smp_work_t work, void* arg);
+
+#endif // SMP_H
@@ -0,0 +1,462 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Streaming Text Search
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "textsearch.h"
+#include "stdio.h"
+
+// Word-at-a-time helpers. Byte scanning uses plain machine words (4 or 8
+// bytes per step) so text search does not depend on the AI CPU engine
+// having turned on SIMD state.
+typedef uintptr_t __attribute__((may_alias)) ts_word_t;
+
+#define TS_WORD_SIZE  sizeof(ts_word_t)
+#define TS_ONES       ((uintptr_t)-1 / 0xFF)   // 0x0101...01
+#define TS_HIGHS      (TS_ONES * 0x80)         // 0x8080...80
+#define TS_LOWS       (TS_ONES * 0x7F)         // 0x7F7F...7F
+
+// Non-zero if any byte of v is zero (may flag bytes above a zero byte)
+static inline uintptr_t word_has_zero(uintptr_t v) {
+    return (v - TS_ONES) & ~v & TS_HIGHS;
+}
+
+// Exact number of zero bytes in v
+static inline uint32_t word_count_zero(uintptr_t v) {
+    uintptr_t t = ~(((v & TS_LOWS) + TS_LOWS) | v) & TS_HIGHS;
+    return (uint32_t)(((t >> 7) * TS_ONES) >> ((TS_WORD_SIZE - 1) * 8));
+}
+
+const char* ts_memchr(const char* data, int c, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    unsigned char target = (unsigned char)c;
+    
+    // Byte steps up to word alignment
+    while (len > 0 && ((uintptr_t)p & (TS_WORD_SIZE - 1)) != 0) {
+        if (*p == target) {
+            return (const char*)p;
+        }
+        p++;
+        len--;
+    }
+    
+    uintptr_t mask = TS_ONES * target;
+    while (len >= TS_WORD_SIZE) {
+        if (word_has_zero(*(const ts_word_t*)p ^ mask)) {
+            break;
+        }
+        p += TS_WORD_SIZE;
+        len -= TS_WORD_SIZE;
+    }
+    
+    while (len > 0) {
+        if (*p == target) {
+            return (const char*)p;
+        }
+        p++;
+        len--;
+    }
+    
+    return NULL;
+}
+
+uint32_t ts_count_byte(const char* data, int c, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    unsigned char target = (unsigned char)c;
+    uint32_t count = 0;
+    
+    while (len > 0 && ((uintptr_t)p & (TS_WORD_SIZE - 1)) != 0) {
+        count += (*p++ == target);
+        len--;
+    }
+    
+    uintptr_t mask = TS_ONES * target;
+    while (len >= TS_WORD_SIZE) {
+        count += word_count_zero(*(const ts_word_t*)p ^ mask);
+        p += TS_WORD_SIZE;
+        len -= TS_WORD_SIZE;
+    }
+    
+    while (len > 0) {
+        count += (*p++ == target);
+        len--;
+    }
+    
+    return count;
+}
+
+// ─── Pattern compilation ─────────────────────────────────────────────────────
+
+static inline void set_add(ts_atom_t* atom, unsigned char c) {
+    atom->set[c >> 5] |= (uint32_t)1 << (c & 31);
+}
+
+static inline int set_has(const ts_atom_t* atom, unsigned char c) {
+    return (atom->set[c >> 5] >> (c & 31)) & 1;
+}
+
+// Parse a [...] class starting after '['; returns the index past ']' or -1
+static int compile_class(ts_atom_t* atom, const char* text, int i) {
+    int negate = 0;
+    int first = 1;
+    
+    if (text[i] == '^') {
+        negate = 1;
+        i++;
+    }
+    
+    while (text[i] != '\0' && (text[i] != ']' || first)) {
+        unsigned char lo = (unsigned char)text[i];
+        if (lo == '\\' && text[i + 1] != '\0') {
+            lo = (unsigned char)text[++i];
+        }
+        i++;
+        
+        unsigned char hi = lo;
+        if (text[i] == '-' && text[i + 1] != ']' && text[i + 1] != '\0') {
+            hi = (unsigned char)text[i + 1];
+            i += 2;
+        }
+        
+        for (unsigned int c = lo; c <= hi; c++) {
+            set_add(atom, (unsigned char)c);
+        }
+        first = 0;
+    }
+    
+    if (text[i] != ']') {
+        return -1;
+    }
+    
+    if (negate) {
+        for (int w = 0; w < 8; w++) {
+            atom->set[w] = ~atom->set[w];
+        }
+    }
+    
+    return i + 1;
+}
+
+static int compile_regex(ts_pattern_t* pattern, const char* text) {
+    int i = 0;
+    
+    if (text[i] == '^') {
+        pattern->anchor_start = 1;
+        i++;
+    }
+    
+    while (text[i] != '\0') {
+        if (text[i] == '$' && text[i + 1] == '\0') {
+            pattern->anchor_end = 1;
+            break;
+        }
+        
+        if (pattern->num_atoms == TS_MAX_ATOMS) {
+            return TS_ERROR_LENGTH;
+        }
+        
+        ts_atom_t* atom = &pattern->atoms[pattern->num_atoms++];
+        memset(atom, 0, sizeof(*atom));
+        atom->min = 1;
+        
+        char c = text[i];
+        if (c == '.') {
+            memset(atom->set, 0xFF, sizeof(atom->set));
+            i++;
+        } else if (c == '[') {
+            i = compile_class(atom, text, i + 1);
+            if (i < 0) {
+                return TS_ERROR_SYNTAX;
+            }
+        } else if (c == '*' || c == '+' || c == '?') {
+            return TS_ERROR_SYNTAX;  // Quantifier with nothing to repeat
+        } else {
+            if (c == '\\') {
+                c = text[++i];
+                if (c == '\0') {
+                    return TS_ERROR_SYNTAX;
+                }
+            }
+            set_add(atom, (unsigned char)c);
+            i++;
+        }
+        
+        if (text[i] == '*') {
+            atom->min = 0;
+            atom->many = 1;
+            i++;
+        } else if (text[i] == '+') {
+            atom->many = 1;
+            i++;
+        } else if (text[i] == '?') {
+            atom->min = 0;
+            i++;
+        }
+    }
+    
+    return 0;
+}
+
+int ts_compile(ts_pattern_t* pattern, const char* text, int flags) {
+    if (pattern == NULL || text == NULL) {
+        return TS_ERROR_PARAM;
+    }
+    
+    memset(pattern, 0, sizeof(*pattern));
+    
+    size_t length = strlen(text);
+    if (length >= TS_MAX_PATTERN) {
+        return TS_ERROR_LENGTH;
+    }
+    if (ts_memchr(text, '\n', length) != NULL) {
+        return TS_ERROR_SYNTAX;
+    }
+    
+    if (flags & TS_FLAG_REGEX) {
+        pattern->is_regex = 1;
+        return compile_regex(pattern, text);
+    }
+    
+    memcpy(pattern->literal, text, length + 1);
+    pattern->length = length;
+    
+    // Horspool shift: distance from the last occurrence to the pattern end
+    for (int c = 0; c < 256; c++) {
+        pattern->skip[c] = (uint8_t)(length > 0 ? length : 1);
+    }
+    for (size_t i = 0; i + 1 < length; i++) {
+        pattern->skip[(unsigned char)text[i]] = (uint8_t)(length - 1 - i);
+    }
+    
+    return 0;
+}
+
+// ─── Matching ────────────────────────────────────────────────────────────────
+
+// Boyer-Moore-Horspool; returns the first occurrence in hay or NULL
+static const char* bmh_find(const ts_pattern_t* pattern, const char* hay, size_t len) {
+    size_t m = pattern->length;
+    const unsigned char* pat = (const unsigned char*)pattern->literal;
+    const unsigned char* text = (const unsigned char*)hay;
+    
+    if (m == 0) {
+        return hay;
+    }
+    if (m > len) {
+        return NULL;
+    }
+    if (m == 1) {
+        return ts_memchr(hay, pat[0], len);
+    }
+    
+    size_t last = m - 1;
+    size_t pos = 0;
+    while (pos <= len - m) {
+        unsigned char c = text[pos + last];
+        if (c == pat[last]) {
+            size_t i = 0;
+            while (i < last && text[pos + i] == pat[i]) {
+                i++;
+            }
+            if (i == last) {
+                return hay + pos;
+            }
+        }
+        pos += pattern->skip[c];
+    }
+    
+    return NULL;
+}
+
+// Backtracking matcher for the regex subset; greedy repeats
+static int match_here(const ts_atom_t* atom, int n, const unsigned char* s, size_t len, int anchor_end) {
+    if (n == 0) {
+        return !anchor_end || len == 0;
+    }
+    
+    if (atom->many) {
+        size_t run = 0;
+        while (run < len && set_has(atom, s[run])) {
+            run++;
+        }
+        if (run < atom->min) {
+            return 0;
+        }
+        for (size_t k = run; ; k--) {
+            if (match_here(atom + 1, n - 1, s + k, len - k, anchor_end)) {
+                return 1;
+            }
+            if (k == atom->min) {
+                break;
+            }
+        }
+        return 0;
+    }
+    
+    if (len > 0 && set_has(atom, s[0]) && match_here(atom + 1, n - 1, s + 1, len - 1, anchor_end)) {
+        return 1;
+    }
+    
+    return atom->min == 0 && match_here(atom + 1, n - 1, s, len, anchor_end);
+}
+
+int ts_match(const ts_pattern_t* pattern, const char* text, size_t len) {
+    if (pattern == NULL || text == NULL) {
+        return 0;
+    }
+    
+    if (!pattern->is_regex) {
+        return bmh_find(pattern, text, len) != NULL;
+    }
+    
+    const unsigned char* s = (const unsigned char*)text;
+    if (pattern->anchor_start) {
+        return match_here(pattern->atoms, pattern->num_atoms, s, len, pattern->anchor_end);
+    }
+    
+    for (size_t start = 0; start <= len; start++) {
+        if (match_here(pattern->atoms, pattern->num_atoms, s + start, len - start, pattern->anchor_end)) {
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+// ─── Streaming grep ──────────────────────────────────────────────────────────
+
+void ts_stream_init(ts_stream_t* stream, const ts_pattern_t* pattern, ts_match_func_t on_match, void* ctx) {
+    memset(stream, 0, sizeof(*stream));
+    stream->pattern = pattern;
+    stream->on_match = on_match;
+    stream->ctx = ctx;
+    stream->line_num = 1;
+}
+
+static void stream_emit(ts_stream_t* stream, const char* line, size_t len) {
+    stream->matches++;
+    if (stream->on_match != NULL && stream->on_match(line, len, stream->line_num, stream->ctx)) {
+        stream->stopped = 1;
+    }
+}
+
+static void stream_carry(ts_stream_t* stream, const char* data, size_t len) {
+    // Lines longer than the carry buffer are matched on their prefix only
+    size_t room = TS_MAX_LINE - stream->carry_len;
+    if (len > room) {
+        len = room;
+    }
+    memcpy(stream->carry + stream->carry_len, data, len);
+    stream->carry_len += len;
+}
+
+// Match a region made only of complete lines (it ends with '\n')
+static void stream_scan(ts_stream_t* stream, const char* region, size_t len) {
+    const char* end = region + len;
+    const char* cur = region;
+    
+    if (stream->pattern->is_regex) {
+        while (cur < end && !stream->stopped) {
+            const char* nl = ts_memchr(cur, '\n', end - cur);
+            if (ts_match(stream->pattern, cur, nl - cur)) {
+                stream_emit(stream, cur, nl - cur);
+            }
+            stream->line_num++;
+            cur = nl + 1;
+        }
+        return;
+    }
+    
+    // Literal: search the whole region, then find the line around each hit
+    const char* counted = region;
+    while (cur < end && !stream->stopped) {
+        const char* hit = bmh_find(stream->pattern, cur, end - cur);
+        if (hit == NULL) {
+            break;
+        }
+        
+        const char* line = hit;
+        while (line > cur && line[-1] != '\n') {
+            line--;
+        }
+        const char* nl = ts_memchr(hit, '\n', end - hit);
+        
+        stream->line_num += ts_count_byte(counted, '\n', line - counted);
+        counted = line;
+        stream_emit(stream, line, nl - line);
+        cur = nl + 1;
+    }
+    stream->line_num += ts_count_byte(counted, '\n', end - counted);
+}
+
+void ts_stream_feed(ts_stream_t* stream, const char* data, size_t len) {
+    if (stream == NULL || data == NULL || stream->stopped) {
+        return;
+    }
+    
+    stream->bytes += len;
+    
+    // Complete a line carried over from the previous chunk
+    if (stream->carry_len > 0) {
+        const char* nl = ts_memchr(data, '\n', len);
+        size_t take = nl ? (size_t)(nl - data) : len;
+        stream_carry(stream, data, take);
+        if (nl == NULL) {
+            return;
+        }
+        
+        if (ts_match(stream->pattern, stream->carry, stream->carry_len)) {
+            stream_emit(stream, stream->carry, stream->carry_len);
+        }
+        stream->carry_len = 0;
+        stream->line_num++;
+        data += take + 1;
+        len -= take + 1;
+    }
+    
+    size_t complete = len;
+    while (complete > 0 && data[complete - 1] != '\n') {
+        complete--;
+    }
+    
+    if (complete > 0) {
+        stream_scan(stream, data, complete);
+    }
+    stream_carry(stream, data + complete, len - complete);
+}
+
+void ts_stream_finish(ts_stream_t* stream) {
+    if (stream == NULL || stream->stopped || stream->carry_len == 0) {
+        return;
+    }
+    
+    if (ts_match(stream->pattern, stream->carry, stream->carry_len)) {
+        stream_emit(stream, stream->carry, stream->carry_len);
+    }
+    stream->carry_len = 0;
+    stream->line_num++;
+}
+
+// ─── Word count ──────────────────────────────────────────────────────────────
+
+void ts_wc_init(ts_wc_t* counts) {
+    memset(counts, 0, sizeof(*counts));
+}
+
+void ts_wc_feed(ts_wc_t* counts, const char* data, size_t len) {
+    counts->bytes += len;
+    counts->lines += ts_count_byte(data, '\n', len);
+    
+    int in_word = counts->in_word;
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == ' ' || c == '\t' || c == '\n') {
+            in_word = 0;
+        } else if (!in_word) {
+            in_word = 1;
+            counts->words++;
+        }
+    }
+    counts->in_word = in_word;
+}
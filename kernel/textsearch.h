@@ -0,0 +1,89 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Streaming Text Search
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include "types.h"
+
+#define TS_MAX_PATTERN   64
+#define TS_MAX_ATOMS     32
+#define TS_MAX_LINE      512   // Longest line carried across chunk boundaries
+#define TS_CHUNK_SIZE    1024  // Bytes handed to the stream per read
+
+// Pattern flags
+#define TS_FLAG_REGEX    0x01  // Interpret the pattern as a regex subset
+
+// Error codes
+#define TS_ERROR_PARAM   -1
+#define TS_ERROR_SYNTAX  -2
+#define TS_ERROR_LENGTH  -3
+
+// One regex element: a byte set with a repeat count
+typedef struct {
+    uint32_t set[8];     // 256-bit byte set
+    uint8_t min;         // 0 or 1
+    uint8_t many;        // Unbounded repeat (* or +)
+} ts_atom_t;
+
+// Compiled pattern. Literal patterns use Boyer-Moore-Horspool over whole
+// chunks; the regex subset (. [] [^] * + ? ^ $ and \ escapes) runs per line.
+typedef struct {
+    int is_regex;
+    size_t length;
+    char literal[TS_MAX_PATTERN];
+    uint8_t skip[256];           // BMH bad-character shifts (capped at 255)
+    ts_atom_t atoms[TS_MAX_ATOMS];
+    int num_atoms;
+    int anchor_start;
+    int anchor_end;
+} ts_pattern_t;
+
+// Called for every matching line; return non-zero to stop the search
+typedef int (*ts_match_func_t)(const char* line, size_t len, uint32_t line_num, void* ctx);
+
+// Streaming line matcher. Feed data in chunks of any size; lines spanning
+// chunk boundaries are reassembled in a small carry buffer.
+typedef struct {
+    const ts_pattern_t* pattern;
+    ts_match_func_t on_match;
+    void* ctx;
+    char carry[TS_MAX_LINE];
+    size_t carry_len;
+    uint32_t line_num;           // Number of the line currently being read
+    uint32_t matches;
+    uint64_t bytes;
+    int stopped;
+} ts_stream_t;
+
+// Line, word and byte counts; in_word carries state between chunks
+typedef struct {
+    uint32_t lines;
+    uint32_t words;
+    uint64_t bytes;
+    int in_word;
+} ts_wc_t;
+
+// Compile a pattern. Returns 0 on success or a TS_ERROR_* code.
+int ts_compile(ts_pattern_t* pattern, const char* text, int flags);
+
+// Match a single string (no newlines expected), e.g. a file name
+int ts_match(const ts_pattern_t* pattern, const char* text, size_t len);
+
+// Word-at-a-time byte scanning
+const char* ts_memchr(const char* data, int c, size_t len);
+uint32_t ts_count_byte(const char* data, int c, size_t len);
+
+// Streaming grep
+void ts_stream_init(ts_stream_t* stream, const ts_pattern_t* pattern, ts_match_func_t on_match, void* ctx);
+void ts_stream_feed(ts_stream_t* stream, const char* data, size_t len);
+void ts_stream_finish(ts_stream_t* stream);
+
+// Streaming word count
+void ts_wc_init(ts_wc_t* counts);
+void ts_wc_feed(ts_wc_t* counts, const char* data, size_t len);
+
+#endif // TEXTSEARCH_H
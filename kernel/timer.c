@@ -0,0 +1,135 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Timebase
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "timer.h"
+
+static uint64_t ticks_per_sec = 0;
+static uint64_t ns_per_tick_q16 = 0;  // Nanoseconds per tick, 16.16 fixed point
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define TIMER_SOURCE  "tsc"
+
+// PIT input clock and a ~10 ms one-shot count used to calibrate the TSC
+#define PIT_HZ               1193182
+#define PIT_CALIBRATE_COUNT  11932
+#define PIT_CALIBRATE_PER_SEC 100
+
+static inline void outb(uint16_t port, uint8_t value) {
+    __asm__ volatile ("outb %0, %1" : : "a"(value), "Nd"(port));
+}
+
+static inline uint8_t inb(uint16_t port) {
+    uint8_t ret;
+    __asm__ volatile ("inb %1, %0" : "=a"(ret) : "Nd"(port));
+    return ret;
+}
+
+uint64_t timer_ticks(void) {
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static uint64_t timer_calibrate(void) {
+    // Use PIT channel 2 (speaker gate, speaker output off) in one-shot mode
+    uint8_t gate = inb(0x61);
+    outb(0x61, (gate & ~0x02) | 0x01);
+    outb(0x43, 0xB0);
+    outb(0x42, PIT_CALIBRATE_COUNT & 0xFF);
+    outb(0x42, PIT_CALIBRATE_COUNT >> 8);
+    
+    // Restart the count by toggling the gate, then time it with the TSC
+    gate = inb(0x61);
+    outb(0x61, gate & ~0x01);
+    outb(0x61, gate | 0x01);
+    
+    uint64_t start = timer_ticks();
+    while ((inb(0x61) & 0x20) == 0) {
+        // Wait for OUT2 to go high
+    }
+    uint64_t end = timer_ticks();
+    
+    return (end - start) * PIT_CALIBRATE_PER_SEC;
+}
+
+#elif defined(__aarch64__)
+
+#define TIMER_SOURCE  "cntvct"
+
+uint64_t timer_ticks(void) {
+    uint64_t value;
+    __asm__ volatile ("isb; mrs %0, cntvct_el0" : "=r"(value) : : "memory");
+    return value;
+}
+
+static uint64_t timer_calibrate(void) {
+    uint64_t freq;
+    __asm__ volatile ("mrs %0, cntfrq_el0" : "=r"(freq));
+    return freq;
+}
+
+#elif defined(__riscv)
+
+#define TIMER_SOURCE  "rdtime"
+
+// QEMU virt timebase-frequency; real boards report theirs in the device tree
+#define RISCV_TIMEBASE_HZ 10000000
+
+uint64_t timer_ticks(void) {
+    uint64_t value;
+    __asm__ volatile ("rdtime %0" : "=r"(value));
+    return value;
+}
+
+static uint64_t timer_calibrate(void) {
+    return RISCV_TIMEBASE_HZ;
+}
+
+#else
+#error "Unsupported architecture for the timer"
+#endif
+
+// i386 has no 64-bit divide instruction and we do not link libgcc
+uint64_t timer_div64(uint64_t n, uint64_t d) {
+    if (d == 0) {
+        return 0;
+    }
+#if defined(__i386__)
+    uint64_t q = 0;
+    uint64_t r = 0;
+    for (int i = 63; i >= 0; i--) {
+        r = (r << 1) | ((n >> i) & 1);
+        if (r >= d) {
+            r -= d;
+            q |= (uint64_t)1 << i;
+        }
+    }
+    return q;
+#else
+    return n / d;
+#endif
+}
+
+uint64_t timer_ticks_per_sec(void) {
+    if (ticks_per_sec == 0) {
+        ticks_per_sec = timer_calibrate();
+        if (ticks_per_sec == 0) {
+            ticks_per_sec = 1;
+        }
+        ns_per_tick_q16 = timer_div64(1000000000ULL << 16, ticks_per_sec);
+    }
+    return ticks_per_sec;
+}
+
+uint64_t timer_ticks_to_ns(uint64_t ticks) {
+    timer_ticks_per_sec();
+    return (ticks * ns_per_tick_q16) >> 16;
+}
+
+const char* timer_source(void) {
+    return TIMER_SOURCE;
+}
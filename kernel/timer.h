@@ -0,0 +1,27 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Timebase
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "types.h"
+
+// Read the architecture cycle/timer counter (TSC, CNTVCT or the RISC-V time CSR)
+uint64_t timer_ticks(void);
+
+// Counter frequency in Hz; calibrated against the PIT on x86 on first use
+uint64_t timer_ticks_per_sec(void);
+
+// Convert a counter delta to nanoseconds
+uint64_t timer_ticks_to_ns(uint64_t ticks);
+
+// Name of the counter behind timer_ticks ("tsc", "cntvct" or "rdtime")
+const char* timer_source(void);
+
+// 64-bit unsigned division usable on every architecture (returns 0 if d is 0)
+uint64_t timer_div64(uint64_t n, uint64_t d);
+
+#endif // TIMER_H
@@ -70,6 +70,7 @@
 
 #include "utils.h"
 #include "types.h"
+#include <stdarg.h>
 
 // Convert unsigned integer to string with given base
 int utoa_base(unsigned int value, char* buffer, int base) {
@@ -185,51 +186,77 @@ char* strncpy(char* dest, const char* src, size_t n) {
     return dest;
 }
 
-// Simple sprintf implementation
-int sprintf(char* buffer, const char* format, ...) {
-    // Very basic sprintf - only handles %d, %s, %c
+// Bounded vsprintf: writes at most size - 1 characters and the
+// terminator, dropping the rest. Returns the number of characters written.
+int vsnprintf(char* buffer, size_t size, const char* format, va_list args) {
+    // Very basic - only handles %d, %u, %x, %s, %c
     const char* p = format;
-    char* buf = buffer;
-    int value;
+    size_t pos = 0;
+    char number[34];
     const char* str;
-    char ch;
+    int len;
     
-    // This is a simplified implementation
-    // In a real OS, you'd use va_list properly
-    void** args = (void**)(&format + 1);
-    int arg_index = 0;
+    if (buffer == NULL || size == 0) {
+        return 0;
+    }
     
     while (*p) {
+        str = number;
+        len = 1;
         if (*p == '%' && *(p + 1)) {
             p++;
             switch (*p) {
                 case 'd':
-                    value = (int)(long)args[arg_index++];
-                    buf += my_itoa(value, buf, 10);
+                    len = my_itoa(va_arg(args, int), number, 10);
+                    break;
+                case 'u':
+                    len = utoa_base(va_arg(args, unsigned int), number, 10);
+                    break;
+                case 'x':
+                    len = utoa_base(va_arg(args, unsigned int), number, 16);
                     break;
                 case 's':
-                    str = (const char*)args[arg_index++];
-                    while (*str) {
-                        *buf++ = *str++;
-                    }
+                    str = va_arg(args, const char*);
+                    len = (int)my_strlen(str);
                     break;
                 case 'c':
-                    ch = (char)(long)args[arg_index++];
-                    *buf++ = ch;
+                    number[0] = (char)va_arg(args, int);
                     break;
                 case '%':
-                    *buf++ = '%';
+                    number[0] = '%';
                     break;
                 default:
-                    *buf++ = '%';
-                    *buf++ = *p;
+                    number[0] = '%';
+                    number[1] = *p;
+                    len = 2;
                     break;
             }
         } else {
-            *buf++ = *p;
+            number[0] = *p;
+        }
+        
+        for (int i = 0; i < len && pos < size - 1; i++) {
+            buffer[pos++] = str[i];
         }
         p++;
     }
-    *buf = '\0';
-    return buf - buffer;
-}
\ No newline at end of file
+    buffer[pos] = '\0';
+    
+    return (int)pos;
+}
+
+// Simple vsprintf implementation; the caller's buffer must be big enough
+int vsprintf(char* buffer, const char* format, va_list args) {
+    return vsnprintf(buffer, (size_t)-1, format, args);
+}
+
+// Simple sprintf implementation
+int sprintf(char* buffer, const char* format, ...) {
+    va_list args;
+    
+    va_start(args, format);
+    int len = vsprintf(buffer, format, args);
+    va_end(args);
+    
+    return len;
+}
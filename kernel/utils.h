@@ -10,6 +10,7 @@
 #define UTILS_H
 
 #include "types.h"
+#include <stdarg.h>
 
 // Function declarations
 int utoa_base(unsigned int value, char* buffer, int base);
@@ -17,5 +18,7 @@ int my_itoa(int value, char* buffer, int base);
 size_t my_strlen(const char* str);
 char* my_strcat(char* dest, const char* src);
 char* strcat(char* dest, const char* src);
+int vsprintf(char* buffer, const char* format, va_list args);
+int vsnprintf(char* buffer, size_t size, const char* format, va_list args);
 
 #endif // UTILS_H
\ No newline at end of file
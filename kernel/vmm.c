@@ -0,0 +1,1205 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Virtual Memory Manager
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "vmm.h"
+#include "mmu.h"
+#include "memory.h"
+#include "stdio.h"
+#include "../drivers/serial.h"
+
+#if defined(__aarch64__) || defined(__x86_64__) || (defined(__riscv) && (__riscv_xlen == 64))
+
+// ─── Page-table formats ──────────────────────────────────────────────────────
+//
+// All three use 512-entry tables of 64-bit entries over a 4 KiB granule.
+// Address spaces only ever hold 4 KiB leaves in the VMM window; the kernel
+// mappings above and below it are shared with the kernel's own tables.
+
+#define VMM_ENTRIES             512
+#define VMM_INDEX_BITS          9
+#define VMM_PAGE_MASK           ((uint64_t)PAGE_SIZE - 1)
+#define VMM_OBJECT_INDEX        (VMM_OBJECT_MAX_SIZE / PAGE_SIZE / VMM_ENTRIES)
+
+#if defined(__aarch64__)
+
+// VMSAv8-64 stage 1, 39-bit VA from L1. Spaces switch TTBR0; TTBR1 keeps
+// the kernel table, so the higher half is the same in every space.
+
+#define VMM_ROOT_SHIFT          30
+
+#define PTE_VALID               0x1ull
+#define PTE_TABLE               0x3ull
+#define PTE_PAGE                0x3ull
+#define PTE_SH_INNER            (3ull << 8)
+#define PTE_RDONLY              (1ull << 7)
+#define PTE_AF                  (1ull << 10)
+#define PTE_NG                  (1ull << 11)
+#define PTE_PXN                 (1ull << 53)
+#define PTE_UXN                 (1ull << 54)
+#define PTE_ADDR_MASK           0x0000FFFFFFFFF000ull
+
+// ESR_EL1 exception classes
+#define ESR_EC_IABT_LOWER       0x20
+#define ESR_EC_IABT_CURRENT     0x21
+#define ESR_EC_DABT_LOWER       0x24
+#define ESR_EC_DABT_CURRENT     0x25
+#define ESR_WNR                 (1ull << 6)
+
+extern char exception_vectors[];
+
+static uint64_t pte_table(uint64_t phys) {
+    return phys | PTE_TABLE;
+}
+
+// Write-back memory (MAIR index 0), not global so a TTBR0 switch drops it
+static uint64_t pte_page(uint64_t phys, uint32_t prot) {
+    uint64_t entry = phys | PTE_PAGE | PTE_SH_INNER | PTE_AF | PTE_NG | PTE_UXN;
+    
+    if (!(prot & VMM_PROT_WRITE)) {
+        entry |= PTE_RDONLY;
+    }
+    if (!(prot & VMM_PROT_EXEC)) {
+        entry |= PTE_PXN;
+    }
+    return entry;
+}
+
+static uint64_t pte_phys(uint64_t entry) {
+    return entry & PTE_ADDR_MASK;
+}
+
+static int pte_writable(uint64_t entry) {
+    return (entry & PTE_RDONLY) == 0;
+}
+
+static void tlb_flush_page(uint64_t va) {
+    __asm__ volatile ("dsb ishst; tlbi vaae1is, %0; dsb ish; isb" : : "r"(va >> PAGE_SHIFT) : "memory");
+}
+
+static void space_load(uint64_t root) {
+    __asm__ volatile ("dsb ishst; msr ttbr0_el1, %0; isb; tlbi vmalle1; dsb ish; isb"
+                      : : "r"(root) : "memory");
+}
+
+static int arch_check(void) {
+    return mmu_enabled() ? VMM_SUCCESS : VMM_ERROR_UNSUPPORTED;
+}
+
+// Kernel L1 entries below the window: RAM and MMIO blocks. L1 entries the
+// kernel adds later appear only in the higher half, which stays on TTBR1.
+static void root_init(uint64_t* root) {
+    const uint64_t* kernel = (const uint64_t*)(uintptr_t)mmu_root_table();
+    for (uint32_t i = 0; i < (VMM_BASE >> VMM_ROOT_SHIFT); i++) {
+        root[i] = kernel[i];
+    }
+}
+
+static int arch_install(uint64_t root) {
+    __asm__ volatile ("msr vbar_el1, %0; isb" : : "r"(exception_vectors) : "memory");
+    space_load(root);
+    return VMM_SUCCESS;
+}
+
+#elif defined(__x86_64__)
+
+// 4-level paging. Every space copies the kernel's PML4 entries, which
+// share the kernel's lower-level tables, and owns PML4 entry 1.
+
+#define VMM_ROOT_SHIFT          39
+
+#define PTE_PRESENT             0x001ull
+#define PTE_WRITE               0x002ull
+#define PTE_NX                  (1ull << 63)
+#define PTE_ADDR_MASK           0x000FFFFFFFFFF000ull
+
+// Page-fault error code
+#define PF_WRITE                0x02
+#define PF_RESERVED             0x08
+#define PF_FETCH                0x10
+
+#define MSR_EFER                0xC0000080
+#define EFER_NXE                (1u << 11)
+
+#define IDT_VECTOR_PAGE_FAULT   14
+#define IDT_INTERRUPT_GATE      0x8E    // Present, DPL 0, 64-bit interrupt gate
+
+typedef struct {
+    uint16_t offset_low;
+    uint16_t selector;
+    uint8_t ist;
+    uint8_t type;
+    uint16_t offset_mid;
+    uint32_t offset_high;
+    uint32_t reserved;
+} __attribute__((packed)) idt_gate_t;
+
+typedef struct {
+    uint16_t limit;
+    uint64_t base;
+} __attribute__((packed)) idt_pointer_t;
+
+static idt_gate_t idt[256] __attribute__((aligned(16)));
+static int nx_enabled = 0;
+
+extern char page_fault_entry[];
+
+static uint64_t pte_table(uint64_t phys) {
+    return phys | PTE_PRESENT | PTE_WRITE;
+}
+
+static uint64_t pte_page(uint64_t phys, uint32_t prot) {
+    uint64_t entry = phys | PTE_PRESENT;
+    
+    if (prot & VMM_PROT_WRITE) {
+        entry |= PTE_WRITE;
+    }
+    if (!(prot & VMM_PROT_EXEC) && nx_enabled) {
+        entry |= PTE_NX;
+    }
+    return entry;
+}
+
+static uint64_t pte_phys(uint64_t entry) {
+    return entry & PTE_ADDR_MASK;
+}
+
+static int pte_writable(uint64_t entry) {
+    return (entry & PTE_WRITE) != 0;
+}
+
+// Privileged instructions. The host check in tests/bench replaces these
+// through shim/bind_vmm.h, which defines VMM_HOST_CPU.
+#ifndef VMM_HOST_CPU
+
+static void tlb_flush_page(uint64_t va) {
+    __asm__ volatile ("invlpg (%0)" : : "r"((uintptr_t)va) : "memory");
+}
+
+// Window pages are not global, so a CR3 load drops them
+static void space_load(uint64_t root) {
+    __asm__ volatile ("mov %0, %%cr3" : : "r"(root) : "memory");
+}
+
+static void cpu_id(uint32_t leaf, uint32_t* eax, uint32_t* edx) {
+    uint32_t ebx, ecx;
+    __asm__ volatile ("cpuid" : "=a"(*eax), "=b"(ebx), "=c"(ecx), "=d"(*edx) : "a"(leaf), "c"(0));
+}
+
+static void efer_set(uint32_t bits) {
+    uint32_t low, high;
+    __asm__ volatile ("rdmsr" : "=a"(low), "=d"(high) : "c"(MSR_EFER));
+    __asm__ volatile ("wrmsr" : : "c"(MSR_EFER), "a"(low | bits), "d"(high));
+}
+
+static uint16_t code_segment(void) {
+    uint16_t cs;
+    __asm__ volatile ("mov %%cs, %0" : "=r"(cs));
+    return cs;
+}
+
+static void idt_load(const void* base, uint16_t limit) {
+    idt_pointer_t pointer = {limit, (uint64_t)(uintptr_t)base};
+    __asm__ volatile ("lidt %0" : : "m"(pointer));
+}
+
+#endif // VMM_HOST_CPU
+
+static int arch_check(void) {
+    return mmu_enabled() ? VMM_SUCCESS : VMM_ERROR_UNSUPPORTED;
+}
+
+static void root_init(uint64_t* root) {
+    const uint64_t* kernel = (const uint64_t*)(uintptr_t)mmu_root_table();
+    for (uint32_t i = 0; i < VMM_ENTRIES; i++) {
+        root[i] = kernel[i];
+    }
+    root[(VMM_BASE >> VMM_ROOT_SHIFT) & (VMM_ENTRIES - 1)] = 0;
+}
+
+static int arch_install(uint64_t root) {
+    uint32_t eax, edx;
+    
+    // No-execute for data mappings when the CPU has it
+    cpu_id(0x80000000, &eax, &edx);
+    if (eax >= 0x80000001) {
+        cpu_id(0x80000001, &eax, &edx);
+        if (edx & (1u << 20)) {
+            efer_set(EFER_NXE);
+            nx_enabled = 1;
+        }
+    }
+    
+    // Only the page-fault vector is present; the gate uses the running
+    // code segment, whatever GDT the loader left
+    uint64_t handler = (uint64_t)(uintptr_t)page_fault_entry;
+    idt_gate_t* gate = &idt[IDT_VECTOR_PAGE_FAULT];
+    gate->offset_low = (uint16_t)handler;
+    gate->selector = code_segment();
+    gate->ist = 0;
+    gate->type = IDT_INTERRUPT_GATE;
+    gate->offset_mid = (uint16_t)(handler >> 16);
+    gate->offset_high = (uint32_t)(handler >> 32);
+    gate->reserved = 0;
+    
+    idt_load(idt, sizeof(idt) - 1);
+    
+    space_load(root);
+    return VMM_SUCCESS;
+}
+
+#else
+
+// Sv39. The kernel runs in S-mode (under OpenSBI) with paging off, so every
+// space maps the first 128 GiB 1:1 with gigapages below the window.
+
+#define VMM_ROOT_SHIFT          30
+
+#define PTE_VALID               0x001ull
+#define PTE_READ                0x002ull
+#define PTE_WRITE               0x004ull
+#define PTE_EXEC                0x008ull
+#define PTE_GLOBAL              0x020ull
+#define PTE_ACCESSED            0x040ull
+#define PTE_DIRTY               0x080ull
+#define PTE_PPN_SHIFT           10
+#define PTE_PPN_MASK            0xFFFFFFFFFFFull
+
+#define SATP_MODE_SV39          (8ull << 60)
+
+// scause exception codes
+#define SCAUSE_INTERRUPT        (1ull << 63)
+#define SCAUSE_FETCH_PAGE_FAULT 12
+#define SCAUSE_LOAD_PAGE_FAULT  13
+#define SCAUSE_STORE_PAGE_FAULT 15
+
+extern char trap_entry[];
+
+static uint64_t pte_table(uint64_t phys) {
+    return ((phys >> PAGE_SHIFT) << PTE_PPN_SHIFT) | PTE_VALID;
+}
+
+// A and D are set up front: hardware may fault instead of updating them
+static uint64_t pte_page(uint64_t phys, uint32_t prot) {
+    uint64_t entry = ((phys >> PAGE_SHIFT) << PTE_PPN_SHIFT) | PTE_VALID | PTE_READ | PTE_ACCESSED | PTE_DIRTY;
+    
+    if (prot & VMM_PROT_WRITE) {
+        entry |= PTE_WRITE;
+    }
+    if (prot & VMM_PROT_EXEC) {
+        entry |= PTE_EXEC;
+    }
+    return entry;
+}
+
+static uint64_t pte_phys(uint64_t entry) {
+    return ((entry >> PTE_PPN_SHIFT) & PTE_PPN_MASK) << PAGE_SHIFT;
+}
+
+static int pte_writable(uint64_t entry) {
+    return (entry & PTE_WRITE) != 0;
+}
+
+// Also needed after invalid-to-valid changes, which may be cached
+static void tlb_flush_page(uint64_t va) {
+    __asm__ volatile ("sfence.vma %0, zero" : : "r"(va) : "memory");
+}
+
+static void space_load(uint64_t root) {
+    __asm__ volatile ("sfence.vma; csrw satp, %0; sfence.vma" : : "r"(SATP_MODE_SV39 | (root >> PAGE_SHIFT))
+                      : "memory");
+}
+
+static int arch_check(void) {
+    return VMM_SUCCESS;
+}
+
+static void root_init(uint64_t* root) {
+    for (uint64_t i = 0; i < (VMM_BASE >> VMM_ROOT_SHIFT); i++) {
+        root[i] = ((i << (VMM_ROOT_SHIFT - PAGE_SHIFT)) << PTE_PPN_SHIFT) | PTE_VALID | PTE_READ |
+                  PTE_WRITE | PTE_EXEC | PTE_GLOBAL | PTE_ACCESSED | PTE_DIRTY;
+    }
+}
+
+// satp is WARL: a hart without Sv39 reads the mode back as Bare
+static int arch_install(uint64_t root) {
+    uint64_t satp;
+    
+    __asm__ volatile ("csrw stvec, %0" : : "r"(trap_entry) : "memory");
+    space_load(root);
+    __asm__ volatile ("csrr %0, satp" : "=r"(satp));
+    return (satp & SATP_MODE_SV39) ? VMM_SUCCESS : VMM_ERROR_UNSUPPORTED;
+}
+
+#endif
+
+#define ROOT_WINDOW_FIRST       ((uint32_t)(VMM_BASE >> VMM_ROOT_SHIFT) & (VMM_ENTRIES - 1))
+#define ROOT_WINDOW_LAST        ((uint32_t)((VMM_END - 1) >> VMM_ROOT_SHIFT) & (VMM_ENTRIES - 1))
+
+// ─── State ───────────────────────────────────────────────────────────────────
+
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    uint32_t prot;
+    uint32_t flags;
+    vmm_object_t* object;       // NULL for anonymous memory
+    uint64_t offset;            // Object offset of start
+} vmm_vma_t;
+
+struct vmm_space {
+    int used;
+    uint64_t root;              // Physical address of the top-level table
+    vmm_vma_t vmas[VMM_MAX_VMAS];   // Sorted by address
+    uint32_t vma_count;
+    uint32_t resident;
+    uint32_t tables;
+};
+
+struct vmm_object {
+    uint32_t refs;              // 0: slot free
+    uint64_t size;
+    vmm_pager_t pager;
+    void* ctx;
+    uint64_t index[VMM_OBJECT_INDEX];  // Frames of page addresses, 512 pages each
+    uint32_t resident;
+};
+
+static vmm_space_t spaces[VMM_MAX_SPACES];
+static vmm_object_t objects[VMM_MAX_OBJECTS];
+static vmm_space_t* current_space = NULL;
+static vmm_space_t* kernel_space = NULL;
+static uint64_t zero_page = 0;      // Shared by every untouched anonymous page, not refcounted
+static int vmm_ready = 0;
+static vmm_stats_t counters;
+
+// Frames are reached through the kernel's identity map
+static uint64_t* frame_at(uint64_t phys) {
+    return (uint64_t*)(uintptr_t)phys;
+}
+
+static void put_hex(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    char buffer[19];
+    
+    buffer[0] = '0';
+    buffer[1] = 'x';
+    for (int i = 0; i < 16; i++) {
+        buffer[2 + i] = digits[(value >> (60 - i * 4)) & 0xF];
+    }
+    buffer[18] = '\0';
+    serial_puts(buffer);
+}
+
+// ─── Page tables ─────────────────────────────────────────────────────────────
+
+// Leaf entry for va, creating missing tables when create is set. Returns
+// NULL if a table is missing, or could not be allocated.
+static uint64_t* pte_find(vmm_space_t* space, uint64_t va, int create) {
+    uint64_t* table = frame_at(space->root);
+    
+    for (uint32_t shift = VMM_ROOT_SHIFT; shift > PAGE_SHIFT; shift -= VMM_INDEX_BITS) {
+        uint64_t* entry = &table[(va >> shift) & (VMM_ENTRIES - 1)];
+        if (!(*entry & 1)) {
+            if (!create) {
+                return NULL;
+            }
+            uint64_t phys = page_alloc();
+            if (phys == 0) {
+                return NULL;
+            }
+            memset(frame_at(phys), 0, PAGE_SIZE);
+            *entry = pte_table(phys);
+            space->tables++;
+        }
+        table = frame_at(pte_phys(*entry));
+    }
+    return &table[(va >> PAGE_SHIFT) & (VMM_ENTRIES - 1)];
+}
+
+static void pte_set(vmm_space_t* space, uint64_t* pte, uint64_t va, uint64_t value) {
+    *pte = value;
+    if (space == current_space) {
+        tlb_flush_page(va);
+    }
+}
+
+static void table_free(vmm_space_t* space, uint64_t phys, uint32_t shift) {
+    if (shift > PAGE_SHIFT) {
+        uint64_t* table = frame_at(phys);
+        for (uint32_t i = 0; i < VMM_ENTRIES; i++) {
+            if (table[i] & 1) {
+                table_free(space, pte_phys(table[i]), shift - VMM_INDEX_BITS);
+            }
+        }
+    }
+    page_put(phys);
+    space->tables--;
+}
+
+// Drop the frames mapped in [start, end), skipping ranges with no L3 table
+static void unmap_pages(vmm_space_t* space, uint64_t start, uint64_t end) {
+    uint64_t va = start;
+    
+    while (va < end) {
+        uint64_t* pte = pte_find(space, va, 0);
+        if (pte == NULL) {
+            va = (va | ((1ull << (PAGE_SHIFT + VMM_INDEX_BITS)) - 1)) + 1;
+            continue;
+        }
+        if (*pte & 1) {
+            uint64_t phys = pte_phys(*pte);
+            pte_set(space, pte, va, 0);
+            if (phys != zero_page) {
+                page_put(phys);
+            }
+            space->resident--;
+        }
+        va += PAGE_SIZE;
+    }
+}
+
+// ─── VM objects ──────────────────────────────────────────────────────────────
+
+// Slot holding the frame of an object page, creating its index page if needed
+static uint64_t* object_slot(vmm_object_t* object, uint64_t page, int create) {
+    uint64_t* index = &object->index[page / VMM_ENTRIES];
+    
+    if (*index == 0) {
+        if (!create) {
+            return NULL;
+        }
+        uint64_t phys = page_alloc();
+        if (phys == 0) {
+            return NULL;
+        }
+        memset(frame_at(phys), 0, PAGE_SIZE);
+        *index = phys;
+    }
+    return &frame_at(*index)[page % VMM_ENTRIES];
+}
+
+// Frame holding the object page at offset, read in by the pager on first use
+static int object_page(vmm_object_t* object, uint64_t offset, uint64_t* phys) {
+    uint64_t* slot = object_slot(object, offset >> PAGE_SHIFT, 1);
+    if (slot == NULL) {
+        return VMM_ERROR_NO_MEMORY;
+    }
+    
+    if (*slot == 0) {
+        uint64_t frame = page_alloc();
+        if (frame == 0) {
+            return VMM_ERROR_NO_MEMORY;
+        }
+        if (object->pager == NULL) {
+            memset(frame_at(frame), 0, PAGE_SIZE);
+        } else if (object->pager(object->ctx, offset, frame_at(frame)) != 0) {
+            page_put(frame);
+            return VMM_ERROR_PAGER;
+        }
+        *slot = frame;
+        object->resident++;
+        counters.object_fills++;
+    }
+    *phys = *slot;
+    return VMM_SUCCESS;
+}
+
+vmm_object_t* vmm_object_create(uint64_t size, vmm_pager_t pager, void* ctx) {
+    if (size == 0 || size > VMM_OBJECT_MAX_SIZE) {
+        return NULL;
+    }
+    
+    for (uint32_t i = 0; i < VMM_MAX_OBJECTS; i++) {
+        vmm_object_t* object = &objects[i];
+        if (object->refs == 0) {
+            memset(object, 0, sizeof(*object));
+            object->refs = 1;
+            object->size = (size + VMM_PAGE_MASK) & ~VMM_PAGE_MASK;
+            object->pager = pager;
+            object->ctx = ctx;
+            return object;
+        }
+    }
+    return NULL;
+}
+
+int vmm_object_insert(vmm_object_t* object, uint64_t offset, uint64_t phys) {
+    if (object == NULL || (offset & VMM_PAGE_MASK) != 0 || (phys & VMM_PAGE_MASK) != 0 ||
+        offset >= object->size) {
+        return VMM_ERROR_PARAM;
+    }
+    
+    uint64_t* slot = object_slot(object, offset >> PAGE_SHIFT, 1);
+    if (slot == NULL) {
+        return VMM_ERROR_NO_MEMORY;
+    }
+    if (*slot != 0) {
+        return VMM_ERROR_NO_SPACE;
+    }
+    page_get(phys);
+    *slot = phys;
+    object->resident++;
+    return VMM_SUCCESS;
+}
+
+void vmm_object_get(vmm_object_t* object) {
+    if (object != NULL) {
+        object->refs++;
+    }
+}
+
+void vmm_object_put(vmm_object_t* object) {
+    if (object == NULL || object->refs == 0 || --object->refs != 0) {
+        return;
+    }
+    
+    for (uint32_t i = 0; i < VMM_OBJECT_INDEX; i++) {
+        if (object->index[i] == 0) {
+            continue;
+        }
+        uint64_t* slots = frame_at(object->index[i]);
+        for (uint32_t j = 0; j < VMM_ENTRIES; j++) {
+            if (slots[j] != 0) {
+                page_put(slots[j]);
+            }
+        }
+        page_put(object->index[i]);
+        object->index[i] = 0;
+    }
+    object->resident = 0;
+}
+
+// ─── VMAs ────────────────────────────────────────────────────────────────────
+
+static vmm_vma_t* vma_find(vmm_space_t* space, uint64_t addr) {
+    for (uint32_t i = 0; i < space->vma_count; i++) {
+        vmm_vma_t* vma = &space->vmas[i];
+        if (addr < vma->start) {
+            break;
+        }
+        if (addr < vma->end) {
+            return vma;
+        }
+    }
+    return NULL;
+}
+
+// Lowest free range of size bytes in the window (first fit), or 0
+static uint64_t vma_place(vmm_space_t* space, uint64_t size) {
+    uint64_t start = VMM_BASE;
+    
+    for (uint32_t i = 0; i < space->vma_count; i++) {
+        if (space->vmas[i].start - start >= size) {
+            return start;
+        }
+        start = space->vmas[i].end;
+    }
+    return (VMM_END - start >= size) ? start : 0;
+}
+
+static int vma_overlaps(vmm_space_t* space, uint64_t start, uint64_t end) {
+    for (uint32_t i = 0; i < space->vma_count; i++) {
+        if (space->vmas[i].start < end && start < space->vmas[i].end) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void vma_insert(vmm_space_t* space, const vmm_vma_t* vma) {
+    uint32_t i = space->vma_count;
+    
+    while (i > 0 && space->vmas[i - 1].start > vma->start) {
+        space->vmas[i] = space->vmas[i - 1];
+        i--;
+    }
+    space->vmas[i] = *vma;
+    space->vma_count++;
+}
+
+static void vma_remove(vmm_space_t* space, uint32_t index) {
+    vmm_vma_t* vma = &space->vmas[index];
+    
+    unmap_pages(space, vma->start, vma->end);
+    vmm_object_put(vma->object);
+    for (uint32_t i = index + 1; i < space->vma_count; i++) {
+        space->vmas[i - 1] = space->vmas[i];
+    }
+    space->vma_count--;
+}
+
+// ─── Faults ──────────────────────────────────────────────────────────────────
+
+// First touch of a page: zero page or zeroed frame for (private) anonymous
+// memory, the object's cached page otherwise. Private pages are mapped
+// read-only until written; a write fault copies straight away.
+static int fault_in(vmm_space_t* space, vmm_vma_t* vma, uint64_t va, uint64_t* pte, uint32_t access) {
+    int shared = (vma->flags & VMM_MAP_SHARED) != 0;
+    int write = (access & VMM_ACCESS_WRITE) != 0;
+    uint32_t prot = vma->prot;
+    uint64_t phys;
+    
+    if (vma->object == NULL) {
+        if (!write) {
+            pte_set(space, pte, va, pte_page(zero_page, prot & ~VMM_PROT_WRITE));
+            space->resident++;
+            counters.zero_maps++;
+            return VMM_SUCCESS;
+        }
+        phys = page_alloc();
+        if (phys == 0) {
+            return VMM_ERROR_NO_MEMORY;
+        }
+        memset(frame_at(phys), 0, PAGE_SIZE);
+        counters.zero_fills++;
+    } else {
+        uint64_t page;
+        int status = object_page(vma->object, vma->offset + (va - vma->start), &page);
+        if (status != VMM_SUCCESS) {
+            return status;
+        }
+        
+        if (shared) {
+            page_get(page);
+            phys = page;
+        } else if (write) {
+            phys = page_alloc();
+            if (phys == 0) {
+                return VMM_ERROR_NO_MEMORY;
+            }
+            memcpy(frame_at(phys), frame_at(page), PAGE_SIZE);
+            counters.cow_copies++;
+        } else {
+            page_get(page);
+            phys = page;
+            prot &= ~VMM_PROT_WRITE;
+        }
+    }
+    
+    pte_set(space, pte, va, pte_page(phys, prot));
+    space->resident++;
+    return VMM_SUCCESS;
+}
+
+// Write to a read-only private page: take it over if this mapping holds
+// the only reference, otherwise copy it
+static int cow_break(vmm_space_t* space, vmm_vma_t* vma, uint64_t va, uint64_t* pte) {
+    uint64_t old = pte_phys(*pte);
+    
+    if (old != zero_page && page_refs(old) == 1) {
+        pte_set(space, pte, va, pte_page(old, vma->prot));
+        counters.cow_reuses++;
+        return VMM_SUCCESS;
+    }
+    
+    uint64_t copy = page_alloc();
+    if (copy == 0) {
+        return VMM_ERROR_NO_MEMORY;
+    }
+    if (old == zero_page) {
+        memset(frame_at(copy), 0, PAGE_SIZE);
+        counters.zero_fills++;
+    } else {
+        memcpy(frame_at(copy), frame_at(old), PAGE_SIZE);
+        counters.cow_copies++;
+    }
+    pte_set(space, pte, va, pte_page(copy, vma->prot));
+    if (old != zero_page) {
+        page_put(old);
+    }
+    return VMM_SUCCESS;
+}
+
+static int resolve(vmm_space_t* space, uint64_t addr, uint32_t access) {
+    vmm_vma_t* vma = vma_find(space, addr);
+    if (vma == NULL) {
+        return VMM_ERROR_FAULT;
+    }
+    
+    uint32_t needed = (access & VMM_ACCESS_WRITE) ? VMM_PROT_WRITE :
+                      (access & VMM_ACCESS_EXEC) ? VMM_PROT_EXEC : VMM_PROT_READ;
+    if (!(vma->prot & needed)) {
+        return VMM_ERROR_FAULT;
+    }
+    
+    uint64_t va = addr & ~VMM_PAGE_MASK;
+    uint64_t* pte = pte_find(space, va, 1);
+    if (pte == NULL) {
+        return VMM_ERROR_NO_MEMORY;
+    }
+    
+    if (!(*pte & 1)) {
+        return fault_in(space, vma, va, pte, access);
+    }
+    if ((access & VMM_ACCESS_WRITE) && !pte_writable(*pte)) {
+        return cow_break(space, vma, va, pte);
+    }
+    
+    // Already mapped as needed: a stale TLB entry
+    if (space == current_space) {
+        tlb_flush_page(va);
+    }
+    return VMM_SUCCESS;
+}
+
+int vmm_handle_fault(uint64_t addr, uint32_t access) {
+    if (!vmm_ready) {
+        return VMM_ERROR_UNSUPPORTED;
+    }
+    
+    counters.faults++;
+    int status = resolve(current_space, addr, access);
+    if (status != VMM_SUCCESS) {
+        counters.errors++;
+    }
+    return status;
+}
+
+static void fault_report(const char* what, uint64_t syndrome, uint64_t addr, uint64_t pc) {
+    serial_puts("\nSAGE OS: unhandled ");
+    serial_puts(what);
+    serial_puts(" syndrome ");
+    put_hex(syndrome);
+    serial_puts(" address ");
+    put_hex(addr);
+    serial_puts(" pc ");
+    put_hex(pc);
+    serial_puts("\n");
+}
+
+// Trap entry points (boot code), return 0 to retry the faulting instruction
+
+#if defined(__aarch64__)
+
+int vmm_trap_aarch64(uint64_t esr, uint64_t far, uint64_t elr) {
+    uint32_t ec = (uint32_t)(esr >> 26) & 0x3F;
+    uint32_t fsc = (uint32_t)esr & 0x3F;
+    int abort = ec == ESR_EC_DABT_CURRENT || ec == ESR_EC_DABT_LOWER || ec == ESR_EC_IABT_CURRENT ||
+                ec == ESR_EC_IABT_LOWER;
+    
+    // Translation, access-flag and permission faults at any level
+    if (abort && fsc >= 0x04 && fsc <= 0x0F) {
+        uint32_t access = (ec == ESR_EC_IABT_CURRENT || ec == ESR_EC_IABT_LOWER) ? VMM_ACCESS_EXEC :
+                          (esr & ESR_WNR) ? VMM_ACCESS_WRITE : VMM_ACCESS_READ;
+        if (vmm_handle_fault(far, access) == VMM_SUCCESS) {
+            return 0;
+        }
+    }
+    fault_report("exception", esr, far, elr);
+    return -1;
+}
+
+#elif defined(__x86_64__)
+
+int vmm_trap_x86_64(uint64_t cr2, uint64_t error, uint64_t rip) {
+    if (!(error & PF_RESERVED)) {
+        uint32_t access = (error & PF_WRITE) ? VMM_ACCESS_WRITE :
+                          (error & PF_FETCH) ? VMM_ACCESS_EXEC : VMM_ACCESS_READ;
+        if (vmm_handle_fault(cr2, access) == VMM_SUCCESS) {
+            return 0;
+        }
+    }
+    fault_report("page fault", error, cr2, rip);
+    return -1;
+}
+
+#else
+
+int vmm_trap_riscv64(uint64_t scause, uint64_t stval, uint64_t sepc) {
+    if (!(scause & SCAUSE_INTERRUPT) && (scause == SCAUSE_FETCH_PAGE_FAULT ||
+        scause == SCAUSE_LOAD_PAGE_FAULT || scause == SCAUSE_STORE_PAGE_FAULT)) {
+        uint32_t access = (scause == SCAUSE_STORE_PAGE_FAULT) ? VMM_ACCESS_WRITE :
+                          (scause == SCAUSE_FETCH_PAGE_FAULT) ? VMM_ACCESS_EXEC : VMM_ACCESS_READ;
+        if (vmm_handle_fault(stval, access) == VMM_SUCCESS) {
+            return 0;
+        }
+    }
+    fault_report("trap", scause, stval, sepc);
+    return -1;
+}
+
+#endif
+
+// ─── Address spaces ──────────────────────────────────────────────────────────
+
+static vmm_space_t* space_alloc(void) {
+    for (uint32_t i = 0; i < VMM_MAX_SPACES; i++) {
+        vmm_space_t* space = &spaces[i];
+        if (space->used) {
+            continue;
+        }
+        
+        uint64_t root = page_alloc();
+        if (root == 0) {
+            return NULL;
+        }
+        memset(frame_at(root), 0, PAGE_SIZE);
+        root_init(frame_at(root));
+        
+        space->used = 1;
+        space->root = root;
+        space->vma_count = 0;
+        space->resident = 0;
+        space->tables = 1;
+        return space;
+    }
+    return NULL;
+}
+
+vmm_space_t* vmm_space_create(void) {
+    return vmm_ready ? space_alloc() : NULL;
+}
+
+void vmm_space_destroy(vmm_space_t* space) {
+    if (space == NULL || !space->used || space == kernel_space) {
+        return;
+    }
+    if (space == current_space) {
+        vmm_space_activate(kernel_space);
+    }
+    
+    while (space->vma_count > 0) {
+        vma_remove(space, space->vma_count - 1);
+    }
+    
+    // Only the window's tables belong to the space
+    uint64_t* root = frame_at(space->root);
+    for (uint32_t i = ROOT_WINDOW_FIRST; i <= ROOT_WINDOW_LAST; i++) {
+        if (root[i] & 1) {
+            table_free(space, pte_phys(root[i]), VMM_ROOT_SHIFT - VMM_INDEX_BITS);
+        }
+    }
+    page_put(space->root);
+    space->used = 0;
+}
+
+vmm_space_t* vmm_space_clone(vmm_space_t* source) {
+    if (!vmm_ready || source == NULL || !source->used) {
+        return NULL;
+    }
+    
+    vmm_space_t* clone = space_alloc();
+    if (clone == NULL) {
+        return NULL;
+    }
+    
+    for (uint32_t i = 0; i < source->vma_count; i++) {
+        vmm_vma_t* vma = &source->vmas[i];
+        int shared = (vma->flags & VMM_MAP_SHARED) != 0;
+        
+        vmm_object_get(vma->object);
+        clone->vmas[clone->vma_count++] = *vma;
+        
+        for (uint64_t va = vma->start; va < vma->end; va += PAGE_SIZE) {
+            uint64_t* pte = pte_find(source, va, 0);
+            if (pte == NULL) {
+                va |= (1ull << (PAGE_SHIFT + VMM_INDEX_BITS)) - PAGE_SIZE;
+                continue;
+            }
+            if (!(*pte & 1)) {
+                continue;
+            }
+            
+            uint64_t* copy = pte_find(clone, va, 1);
+            if (copy == NULL) {
+                vmm_space_destroy(clone);
+                return NULL;
+            }
+            
+            // Private pages become read-only in both spaces
+            uint64_t phys = pte_phys(*pte);
+            if (!shared && pte_writable(*pte)) {
+                *pte = pte_page(phys, vma->prot & ~VMM_PROT_WRITE);
+                if (source == current_space) {
+                    tlb_flush_page(va);
+                }
+            }
+            *copy = *pte;
+            if (phys != zero_page) {
+                page_get(phys);
+            }
+            clone->resident++;
+        }
+    }
+    return clone;
+}
+
+void vmm_space_activate(vmm_space_t* space) {
+    if (!vmm_ready || space == NULL || !space->used || space == current_space) {
+        return;
+    }
+    space_load(space->root);
+    current_space = space;
+}
+
+vmm_space_t* vmm_current(void) {
+    return current_space;
+}
+
+// ─── Mappings ────────────────────────────────────────────────────────────────
+
+static int map_range(vmm_space_t* space, uint64_t* addr, uint64_t size, uint32_t prot, uint32_t flags,
+                     vmm_object_t* object, uint64_t offset) {
+    if (!vmm_ready) {
+        return VMM_ERROR_UNSUPPORTED;
+    }
+    if (space == NULL || !space->used || addr == NULL || size == 0 || (size & VMM_PAGE_MASK) != 0 ||
+        size > VMM_END - VMM_BASE) {
+        return VMM_ERROR_PARAM;
+    }
+    if (object != NULL && ((offset & VMM_PAGE_MASK) != 0 || offset > object->size ||
+        size > object->size - offset)) {
+        return VMM_ERROR_PARAM;
+    }
+    if (space->vma_count >= VMM_MAX_VMAS) {
+        return VMM_ERROR_NO_SPACE;
+    }
+    
+    uint64_t start;
+    if (flags & VMM_MAP_FIXED) {
+        start = *addr;
+        if ((start & VMM_PAGE_MASK) != 0 || start < VMM_BASE || start > VMM_END - size) {
+            return VMM_ERROR_PARAM;
+        }
+        if (vma_overlaps(space, start, start + size)) {
+            return VMM_ERROR_NO_SPACE;
+        }
+    } else {
+        start = vma_place(space, size);
+        if (start == 0) {
+            return VMM_ERROR_NO_SPACE;
+        }
+    }
+    
+    // Shared anonymous memory lives in an object of its own, so spaces that
+    // inherit the mapping see the same pages even if faulted in later
+    if (object == NULL && (flags & VMM_MAP_SHARED)) {
+        object = vmm_object_create(size, NULL, NULL);
+        if (object == NULL) {
+            return (size > VMM_OBJECT_MAX_SIZE) ? VMM_ERROR_PARAM : VMM_ERROR_NO_SPACE;
+        }
+    } else {
+        vmm_object_get(object);
+    }
+    
+    vmm_vma_t vma = {start, start + size, prot, flags, object, offset};
+    vma_insert(space, &vma);
+    *addr = start;
+    
+    if (flags & VMM_MAP_POPULATE) {
+        uint32_t access = (prot & VMM_PROT_WRITE) ? VMM_ACCESS_WRITE : VMM_ACCESS_READ;
+        for (uint64_t va = start; va < start + size; va += PAGE_SIZE) {
+            int status = resolve(space, va, access);
+            if (status != VMM_SUCCESS) {
+                vmm_unmap(space, start, size);
+                return status;
+            }
+        }
+    }
+    return VMM_SUCCESS;
+}
+
+int vmm_map_anon(vmm_space_t* space, uint64_t* addr, uint64_t size, uint32_t prot, uint32_t flags) {
+    return map_range(space, addr, size, prot, flags, NULL, 0);
+}
+
+int vmm_map_object(vmm_space_t* space, uint64_t* addr, uint64_t size, uint32_t prot, uint32_t flags,
+                   vmm_object_t* object, uint64_t offset) {
+    if (object == NULL || object->refs == 0) {
+        return VMM_ERROR_PARAM;
+    }
+    return map_range(space, addr, size, prot, flags, object, offset);
+}
+
+int vmm_unmap(vmm_space_t* space, uint64_t addr, uint64_t size) {
+    if (!vmm_ready) {
+        return VMM_ERROR_UNSUPPORTED;
+    }
+    if (space == NULL || !space->used || size == 0 || ((addr | size) & VMM_PAGE_MASK) != 0 ||
+        addr + size < addr) {
+        return VMM_ERROR_PARAM;
+    }
+    
+    uint64_t end = addr + size;
+    for (uint32_t i = 0; i < space->vma_count; i++) {
+        vmm_vma_t* vma = &space->vmas[i];
+        if (vma->start < end && addr < vma->end && (vma->start < addr || vma->end > end)) {
+            return VMM_ERROR_PARAM;     // Would split a mapping
+        }
+    }
+    
+    uint32_t i = 0;
+    while (i < space->vma_count) {
+        if (space->vmas[i].start >= addr && space->vmas[i].end <= end) {
+            vma_remove(space, i);
+        } else {
+            i++;
+        }
+    }
+    return VMM_SUCCESS;
+}
+
+// ─── Setup and statistics ────────────────────────────────────────────────────
+
+int vmm_init(void) {
+    if (vmm_ready) {
+        return VMM_SUCCESS;
+    }
+    
+    int status = arch_check();
+    if (status != VMM_SUCCESS) {
+        return status;
+    }
+    
+    memory_init();
+    zero_page = page_alloc();
+    if (zero_page == 0) {
+        return VMM_ERROR_NO_MEMORY;
+    }
+    memset(frame_at(zero_page), 0, PAGE_SIZE);
+    
+    kernel_space = space_alloc();
+    if (kernel_space == NULL) {
+        page_put(zero_page);
+        return VMM_ERROR_NO_MEMORY;
+    }
+    
+    status = arch_install(kernel_space->root);
+    if (status != VMM_SUCCESS) {
+        page_put(kernel_space->root);
+        kernel_space->used = 0;
+        kernel_space = NULL;
+        page_put(zero_page);
+        return status;
+    }
+    
+    current_space = kernel_space;
+    vmm_ready = 1;
+    return VMM_SUCCESS;
+}
+
+int vmm_enabled(void) {
+    return vmm_ready;
+}
+
+void vmm_get_stats(vmm_stats_t* stats) {
+    *stats = counters;
+    stats->enabled = vmm_ready;
+    stats->spaces = 0;
+    stats->vmas = 0;
+    stats->objects = 0;
+    stats->resident = 0;
+    stats->tables = 0;
+    
+    for (uint32_t i = 0; i < VMM_MAX_SPACES; i++) {
+        if (spaces[i].used) {
+            stats->spaces++;
+            stats->vmas += spaces[i].vma_count;
+            stats->resident += spaces[i].resident;
+            stats->tables += spaces[i].tables;
+        }
+    }
+    for (uint32_t i = 0; i < VMM_MAX_OBJECTS; i++) {
+        if (objects[i].refs != 0) {
+            stats->objects++;
+        }
+    }
+}
+
+#else
+
+// No paging on this architecture
+
+int vmm_init(void) {
+    return VMM_ERROR_UNSUPPORTED;
+}
+
+int vmm_enabled(void) {
+    return 0;
+}
+
+vmm_space_t* vmm_space_create(void) {
+    return NULL;
+}
+
+vmm_space_t* vmm_space_clone(vmm_space_t* source) {
+    (void)source;
+    return NULL;
+}
+
+void vmm_space_destroy(vmm_space_t* space) {
+    (void)space;
+}
+
+void vmm_space_activate(vmm_space_t* space) {
+    (void)space;
+}
+
+vmm_space_t* vmm_current(void) {
+    return NULL;
+}
+
+int vmm_map_anon(vmm_space_t* space, uint64_t* addr, uint64_t size, uint32_t prot, uint32_t flags) {
+    (void)space;
+    (void)addr;
+    (void)size;
+    (void)prot;
+    (void)flags;
+    return VMM_ERROR_UNSUPPORTED;
+}
+
+int vmm_map_object(vmm_space_t* space, uint64_t* addr, uint64_t size, uint32_t prot, uint32_t flags,
+                   vmm_object_t* object, uint64_t offset) {
+    (void)space;
+    (void)addr;
+    (void)size;
+    (void)prot;
+    (void)flags;
+    (void)object;
+    (void)offset;
+    return VMM_ERROR_UNSUPPORTED;
+}
+
+int vmm_unmap(vmm_space_t* space, uint64_t addr, uint64_t size) {
+    (void)space;
+    (void)addr;
+    (void)size;
+    return VMM_ERROR_UNSUPPORTED;
+}
+
+vmm_object_t* vmm_object_create(uint64_t size, vmm_pager_t pager, void* ctx) {
+    (void)size;
+    (void)pager;
+    (void)ctx;
+    return NULL;
+}
+
+int vmm_object_insert(vmm_object_t* object, uint64_t offset, uint64_t phys) {
+    (void)object;
+    (void)offset;
+    (void)phys;
+    return VMM_ERROR_UNSUPPORTED;
+}
+
+void vmm_object_get(vmm_object_t* object) {
+    (void)object;
+}
+
+void vmm_object_put(vmm_object_t* object) {
+    (void)object;
+}
+
+int vmm_handle_fault(uint64_t addr, uint32_t access) {
+    (void)addr;
+    (void)access;
+    return VMM_ERROR_UNSUPPORTED;
+}
+
+void vmm_get_stats(vmm_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
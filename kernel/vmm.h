@@ -0,0 +1,129 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Virtual Memory Manager
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef VMM_H
+#define VMM_H
+
+#include "types.h"
+
+// Address spaces share the kernel mappings and add their own in a window
+// of the lower half. Mappings (VMAs) are anonymous memory or a window onto
+// a VM object such as a model blob or a file; nothing is backed by a frame
+// until it is touched. Reads of untouched anonymous memory map a shared
+// zero page, the first write takes a private copy, and cloned address
+// spaces share every page copy-on-write.
+
+#if defined(__aarch64__)
+#define VMM_BASE                0x4000000000ull     // TTBR0 L1 entries 256-511
+#define VMM_END                 0x8000000000ull
+#elif defined(__x86_64__)
+#define VMM_BASE                0x8000000000ull     // PML4 entry 1
+#define VMM_END                 0x10000000000ull
+#elif defined(__riscv) && (__riscv_xlen == 64)
+#define VMM_BASE                0x2000000000ull     // Sv39 root entries 128-255
+#define VMM_END                 0x4000000000ull
+#else
+#define VMM_BASE                0ull
+#define VMM_END                 0ull
+#endif
+
+#define VMM_MAX_SPACES          8
+#define VMM_MAX_VMAS            32      // Per address space
+#define VMM_MAX_OBJECTS         16
+#define VMM_OBJECT_MAX_SIZE     (128ull * 1024 * 1024)
+
+// Error codes
+#define VMM_SUCCESS             0
+#define VMM_ERROR_UNSUPPORTED   -1  // No paging on this architecture or the MMU is off
+#define VMM_ERROR_PARAM         -2  // Unaligned, empty or outside the VMM window
+#define VMM_ERROR_NO_MEMORY     -3  // Out of page frames
+#define VMM_ERROR_NO_SPACE      -4  // Address range taken, or no free space/VMA/object slot
+#define VMM_ERROR_FAULT         -5  // No mapping, or the access is not permitted
+#define VMM_ERROR_PAGER         -6  // A VM object's pager failed to fill a page
+
+// Protection
+#define VMM_PROT_READ           0x1
+#define VMM_PROT_WRITE          0x2
+#define VMM_PROT_EXEC           0x4
+
+// Mapping flags
+#define VMM_MAP_SHARED          0x1     // Writes go to the shared pages, not private copies
+#define VMM_MAP_FIXED           0x2     // Map exactly at *addr
+#define VMM_MAP_POPULATE        0x4     // Fault every page in now
+
+// Fault access types
+#define VMM_ACCESS_READ         0x0
+#define VMM_ACCESS_WRITE        0x1
+#define VMM_ACCESS_EXEC         0x2
+
+typedef struct vmm_space vmm_space_t;
+typedef struct vmm_object vmm_object_t;
+
+// Fill one page of an object: offset is the byte offset of the page in the
+// object, page points at PAGE_SIZE bytes to fill. Returns 0 on success.
+typedef int (*vmm_pager_t)(void* ctx, uint64_t offset, void* page);
+
+typedef struct {
+    int enabled;
+    uint32_t spaces;
+    uint32_t vmas;
+    uint32_t objects;
+    uint32_t resident;          // Frames mapped across all address spaces
+    uint32_t tables;            // Page-table pages across all address spaces
+    uint32_t faults;
+    uint32_t zero_fills;        // Anonymous pages given a zeroed frame
+    uint32_t zero_maps;         // Reads of untouched memory served by the zero page
+    uint32_t object_fills;      // Object pages read in by their pager
+    uint32_t cow_copies;
+    uint32_t cow_reuses;        // Write faults on a sole remaining reference, no copy
+    uint32_t errors;            // Faults that could not be resolved
+} vmm_stats_t;
+
+// Set up the kernel address space and install the page-fault handler.
+// Needs mmu_init to have succeeded on aarch64 and x86_64.
+int vmm_init(void);
+
+int vmm_enabled(void);
+
+// Address spaces. A new space has only the kernel mappings; a clone shares
+// all of the source's pages, private ones copy-on-write.
+vmm_space_t* vmm_space_create(void);
+vmm_space_t* vmm_space_clone(vmm_space_t* source);
+void vmm_space_destroy(vmm_space_t* space);
+void vmm_space_activate(vmm_space_t* space);
+vmm_space_t* vmm_current(void);
+
+// Map size bytes (page multiple) of zero-filled memory. Without
+// VMM_MAP_FIXED, *addr is ignored and receives the chosen address.
+int vmm_map_anon(vmm_space_t* space, uint64_t* addr, uint64_t size, uint32_t prot, uint32_t flags);
+
+// Map size bytes of an object starting at offset (page multiple). Shared
+// mappings see and make changes to the object's pages; private ones copy
+// a page on its first write. The mapping holds a reference to the object.
+int vmm_map_object(vmm_space_t* space, uint64_t* addr, uint64_t size, uint32_t prot, uint32_t flags,
+                   vmm_object_t* object, uint64_t offset);
+
+// Remove the mappings in [addr, addr + size); each must lie wholly inside it
+int vmm_unmap(vmm_space_t* space, uint64_t addr, uint64_t size);
+
+// VM objects hold pages filled on demand by their pager (or NULL for
+// zeroed pages) and cached for every mapping. Returned with one reference.
+vmm_object_t* vmm_object_create(uint64_t size, vmm_pager_t pager, void* ctx);
+
+// Give an object an existing frame as its page at offset (no copy); the
+// object takes its own reference. Fails if the page is already present.
+int vmm_object_insert(vmm_object_t* object, uint64_t offset, uint64_t phys);
+
+void vmm_object_get(vmm_object_t* object);
+void vmm_object_put(vmm_object_t* object);
+
+// Resolve a fault on addr in the current address space; called by the
+// architecture trap handlers. Returns 0 when the access can be retried.
+int vmm_handle_fault(uint64_t addr, uint32_t access);
+
+void vmm_get_stats(vmm_stats_t* stats);
+
+#endif // VMM_H
@@ -67,32 +67,140 @@
 // Use of this software in critical systems (e.g., medical, nuclear, safety)
 // is entirely at your own risk unless specifically licensed for such purposes.
 //
-// ─────────────────────────────────────────────────────────────────────────────#include "tflite_wrapper.h"
+// ─────────────────────────────────────────────────────────────────────────────
+#include "tflite_wrapper.h"
 
 #ifdef ENABLE_AI
 
 #include <cstdint>
 #include <cstring>
+#include <new>
 
 #include "tensorflow/lite/micro/all_ops_resolver.h"
 #include "tensorflow/lite/micro/micro_error_reporter.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
-// TFLite globals
 namespace {
+    constexpr size_t kArenaAlignment = 16;
+    
+    struct ModelSlot {
+        bool in_use;
+        const tflite::Model* model;
+        tflite::MicroInterpreter* interpreter;
+        size_t arena_offset;
+        size_t arena_size;
+        tflite_model_stats_t stats;
+        alignas(tflite::MicroInterpreter) uint8_t storage[sizeof(tflite::MicroInterpreter)];
+    };
+    
+    // TFLite globals
     tflite::ErrorReporter* error_reporter = nullptr;
-    const tflite::Model* model = nullptr;
-    tflite::MicroInterpreter* interpreter = nullptr;
     tflite::AllOpsResolver resolver;
+    ModelSlot slots[TFLITE_MAX_MODELS];
+    
+    // Arena memory for TFLite, split between the loaded models
+    alignas(kArenaAlignment) uint8_t arena_pool[TFLITE_ARENA_POOL_SIZE];
+    
+    // Microseconds from the ARM generic timer. Other targets have no
+    // architectural timer frequency, so their invoke timings read zero.
+    uint64_t now_us() {
+#if defined(__aarch64__)
+        uint64_t count;
+        uint64_t freq;
+        __asm__ volatile("mrs %0, cntvct_el0" : "=r"(count));
+        __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+        return freq ? (count / freq) * 1000000 + (count % freq) * 1000000 / freq : 0;
+#else
+        return 0;
+#endif
+    }
+    
+    ModelSlot* get_slot(int handle) {
+        if (handle < 0 || handle >= TFLITE_MAX_MODELS || !slots[handle].in_use) {
+            return nullptr;
+        }
+        return &slots[handle];
+    }
+    
+    // Largest unused stretch of the arena pool. Models are few, so every
+    // region end (and the pool start) is simply tried as a gap start.
+    size_t largest_gap(size_t* offset) {
+        size_t best_size = 0;
+        
+        for (int i = -1; i < TFLITE_MAX_MODELS; i++) {
+            size_t start = 0;
+            if (i >= 0) {
+                if (!slots[i].in_use) {
+                    continue;
+                }
+                start = slots[i].arena_offset + slots[i].arena_size;
+            }
+            
+            size_t end = TFLITE_ARENA_POOL_SIZE;
+            bool overlaps = false;
+            for (int j = 0; j < TFLITE_MAX_MODELS; j++) {
+                if (!slots[j].in_use) {
+                    continue;
+                }
+                size_t region_end = slots[j].arena_offset + slots[j].arena_size;
+                if (slots[j].arena_offset <= start && start < region_end) {
+                    overlaps = true;
+                    break;
+                }
+                if (slots[j].arena_offset >= start && slots[j].arena_offset < end) {
+                    end = slots[j].arena_offset;
+                }
+            }
+            
+            if (!overlaps && end - start > best_size) {
+                best_size = end - start;
+                *offset = start;
+            }
+        }
+        
+        return best_size;
+    }
+    
+    int describe_tensor(const TfLiteTensor* source, tflite_tensor_t* tensor) {
+        if (!source) {
+            return TFLITE_ERROR_TENSOR;
+        }
+        
+        switch (source->type) {
+            case kTfLiteFloat32: tensor->type = TFLITE_TYPE_FLOAT32; break;
+            case kTfLiteInt8:    tensor->type = TFLITE_TYPE_INT8; break;
+            case kTfLiteUInt8:   tensor->type = TFLITE_TYPE_UINT8; break;
+            default:             return TFLITE_ERROR_TENSOR;
+        }
+        
+        tensor->data = source->data.raw;
+        tensor->bytes = (uint32_t)source->bytes;
+        tensor->num_dims = 0;
+        for (int i = 0; source->dims && i < source->dims->size && i < TFLITE_MAX_DIMS; i++) {
+            tensor->dims[i] = source->dims->data[i];
+            tensor->num_dims++;
+        }
+        tensor->scale = source->params.scale;
+        tensor->zero_point = source->params.zero_point;
+        
+        return 0;
+    }
     
-    // Arena memory for TFLite
-    constexpr int kTensorArenaSize = 128 * 1024;
-    static uint8_t tensor_arena[kTensorArenaSize];
+    tflite::MicroInterpreter* build_interpreter(ModelSlot* slot, size_t offset, size_t size) {
+        tflite::MicroInterpreter* interpreter = new (slot->storage) tflite::MicroInterpreter(
+            slot->model, resolver, arena_pool + offset, size, error_reporter);
+        
+        if (interpreter->AllocateTensors() != kTfLiteOk) {
+            interpreter->~MicroInterpreter();
+            return nullptr;
+        }
+        return interpreter;
+    }
 }
 
 extern "C" {
-
+    
 int tflite_init(void) {
     // Set up logging
     static tflite::MicroErrorReporter micro_error_reporter;
@@ -100,63 +208,111 @@ int tflite_init(void) {
     
     return 0;
 }
-
-void* tflite_load_model(const unsigned char* model_data, unsigned int model_size) {
+    
+int tflite_load_model(const unsigned char* model_data, unsigned int model_size) {
+    if (!error_reporter || !model_data || model_size == 0) {
+        return TFLITE_ERROR_HANDLE;
+    }
+    
+    int handle = -1;
+    for (int i = 0; i < TFLITE_MAX_MODELS; i++) {
+        if (!slots[i].in_use) {
+            handle = i;
+            break;
+        }
+    }
+    if (handle < 0) {
+        error_reporter->Report("No free model slot!");
+        return TFLITE_ERROR_NO_SLOT;
+    }
+    
+    ModelSlot* slot = &slots[handle];
+    
     // Map the model into a usable data structure
-    model = tflite::GetModel(model_data);
-    if (model->version() != TFLITE_SCHEMA_VERSION) {
+    slot->model = tflite::GetModel(model_data);
+    if (slot->model->version() != TFLITE_SCHEMA_VERSION) {
         error_reporter->Report("Model version mismatch!");
-        return nullptr;
+        return TFLITE_ERROR_MODEL;
     }
     
-    // Build an interpreter to run the model
-    static tflite::MicroInterpreter static_interpreter(
-        model, resolver, tensor_arena, kTensorArenaSize, error_reporter);
-    interpreter = &static_interpreter;
-    
-    // Allocate tensors
-    if (interpreter->AllocateTensors() != kTfLiteOk) {
+    // Plan the tensors in the largest free stretch of the pool to learn how
+    // much arena this model needs
+    size_t offset = 0;
+    size_t available = largest_gap(&offset);
+    tflite::MicroInterpreter* interpreter = build_interpreter(slot, offset, available);
+    if (!interpreter) {
         error_reporter->Report("AllocateTensors() failed");
-        return nullptr;
+        return TFLITE_ERROR_ARENA;
     }
     
-    return (void*)model;
+    size_t needed = (interpreter->arena_used_bytes() + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+    interpreter->~MicroInterpreter();
+    
+    // Rebuild it in just the planned size. The arena start is unchanged, so
+    // the plan carries over; should it not, keep the whole stretch.
+    if (needed > available) {
+        needed = available;
+    }
+    interpreter = build_interpreter(slot, offset, needed);
+    if (!interpreter) {
+        needed = available;
+        interpreter = build_interpreter(slot, offset, needed);
+        if (!interpreter) {
+            error_reporter->Report("AllocateTensors() failed");
+            return TFLITE_ERROR_ARENA;
+        }
+    }
+    
+    slot->in_use = true;
+    slot->interpreter = interpreter;
+    slot->arena_offset = offset;
+    slot->arena_size = needed;
+    
+    std::memset(&slot->stats, 0, sizeof(slot->stats));
+    slot->stats.arena_bytes = (uint32_t)needed;
+    slot->stats.input_bytes = (uint32_t)interpreter->input(0)->bytes;
+    slot->stats.output_bytes = (uint32_t)interpreter->output(0)->bytes;
+    
+    return handle;
 }
-
-int tflite_run_inference(void* model_handle, 
+    
+int tflite_run_inference(int handle,
                          const float* input_data, unsigned int input_size,
                          float* output_data, unsigned int output_size) {
-    if (!interpreter) {
-        return -1;
+    ModelSlot* slot = get_slot(handle);
+    if (!slot) {
+        return TFLITE_ERROR_HANDLE;
     }
     
+    tflite::MicroInterpreter* interpreter = slot->interpreter;
+    
     // Get input tensor
     TfLiteTensor* input = interpreter->input(0);
     
-    // Check input dimensions
+    // Check input type and dimensions
     size_t input_bytes = input->bytes;
-    if (input_bytes != input_size * sizeof(float)) {
+    if (input->type != kTfLiteFloat32 || input_bytes != input_size * sizeof(float)) {
         error_reporter->Report("Input size mismatch!");
-        return -2;
+        return TFLITE_ERROR_INPUT;
     }
     
     // Copy input data
     std::memcpy(input->data.f, input_data, input_bytes);
     
     // Run inference
-    if (interpreter->Invoke() != kTfLiteOk) {
-        error_reporter->Report("Invoke failed!");
-        return -3;
+    int result = tflite_invoke(handle);
+    if (result != 0) {
+        return result;
     }
     
     // Get output tensor
     TfLiteTensor* output = interpreter->output(0);
     
-    // Check output dimensions
+    // Check output type and dimensions
     size_t output_bytes = output->bytes;
-    if (output_bytes != output_size * sizeof(float)) {
+    if (output->type != kTfLiteFloat32 || output_bytes != output_size * sizeof(float)) {
         error_reporter->Report("Output size mismatch!");
-        return -4;
+        return TFLITE_ERROR_OUTPUT;
     }
     
     // Copy output data
@@ -164,13 +320,84 @@ int tflite_run_inference(void* model_handle,
     
     return 0;
 }
-
-void tflite_unload_model(void* model_handle) {
-    // Nothing to do, as we're using static memory
-    model = nullptr;
-    interpreter = nullptr;
+    
+int tflite_get_input(int handle, int index, tflite_tensor_t* tensor) {
+    ModelSlot* slot = get_slot(handle);
+    if (!slot || !tensor) {
+        return TFLITE_ERROR_HANDLE;
+    }
+    if (index < 0 || (size_t)index >= slot->interpreter->inputs_size()) {
+        return TFLITE_ERROR_TENSOR;
+    }
+    
+    return describe_tensor(slot->interpreter->input(index), tensor);
 }
-
+    
+int tflite_get_output(int handle, int index, tflite_tensor_t* tensor) {
+    ModelSlot* slot = get_slot(handle);
+    if (!slot || !tensor) {
+        return TFLITE_ERROR_HANDLE;
+    }
+    if (index < 0 || (size_t)index >= slot->interpreter->outputs_size()) {
+        return TFLITE_ERROR_TENSOR;
+    }
+    
+    return describe_tensor(slot->interpreter->output(index), tensor);
+}
+    
+int tflite_invoke(int handle) {
+    ModelSlot* slot = get_slot(handle);
+    if (!slot) {
+        return TFLITE_ERROR_HANDLE;
+    }
+    
+    uint64_t start = now_us();
+    if (slot->interpreter->Invoke() != kTfLiteOk) {
+        error_reporter->Report("Invoke failed!");
+        return TFLITE_ERROR_INVOKE;
+    }
+    uint64_t elapsed = now_us() - start;
+    
+    tflite_model_stats_t* stats = &slot->stats;
+    stats->last_invoke_us = elapsed;
+    stats->total_invoke_us += elapsed;
+    if (stats->invokes == 0 || elapsed < stats->min_invoke_us) {
+        stats->min_invoke_us = elapsed;
+    }
+    if (elapsed > stats->max_invoke_us) {
+        stats->max_invoke_us = elapsed;
+    }
+    stats->invokes++;
+    
+    return 0;
+}
+    
+int tflite_unload_model(int handle) {
+    ModelSlot* slot = get_slot(handle);
+    if (!slot) {
+        return TFLITE_ERROR_HANDLE;
+    }
+    
+    // The interpreter lives in the slot and its arena in the pool, so
+    // destroying it returns both
+    slot->interpreter->~MicroInterpreter();
+    slot->interpreter = nullptr;
+    slot->model = nullptr;
+    slot->in_use = false;
+    
+    return 0;
+}
+    
+int tflite_get_model_stats(int handle, tflite_model_stats_t* stats) {
+    ModelSlot* slot = get_slot(handle);
+    if (!slot || !stats) {
+        return TFLITE_ERROR_HANDLE;
+    }
+    
+    *stats = slot->stats;
+    return 0;
+}
+    
 } // extern "C"
 
 #else // ENABLE_AI
@@ -178,25 +405,41 @@ void tflite_unload_model(void* model_handle) {
 // Stub implementations when AI is disabled
 
 extern "C" {
-
+    
 int tflite_init(void) {
     return -1;
 }
-
-void* tflite_load_model(const unsigned char* model_data, unsigned int model_size) {
-    return nullptr;
+    
+int tflite_load_model(const unsigned char* model_data, unsigned int model_size) {
+    return TFLITE_ERROR_HANDLE;
 }
-
-int tflite_run_inference(void* model_handle, 
+    
+int tflite_run_inference(int handle,
                          const float* input_data, unsigned int input_size,
                          float* output_data, unsigned int output_size) {
-    return -1;
+    return TFLITE_ERROR_HANDLE;
 }
-
-void tflite_unload_model(void* model_handle) {
-    // Do nothing
+    
+int tflite_get_input(int handle, int index, tflite_tensor_t* tensor) {
+    return TFLITE_ERROR_HANDLE;
 }
-
+    
+int tflite_get_output(int handle, int index, tflite_tensor_t* tensor) {
+    return TFLITE_ERROR_HANDLE;
+}
+    
+int tflite_invoke(int handle) {
+    return TFLITE_ERROR_HANDLE;
+}
+    
+int tflite_unload_model(int handle) {
+    return TFLITE_ERROR_HANDLE;
+}
+    
+int tflite_get_model_stats(int handle, tflite_model_stats_t* stats) {
+    return TFLITE_ERROR_HANDLE;
+}
+    
 } // extern "C"
 
 #endif // ENABLE_AI
\ No newline at end of file
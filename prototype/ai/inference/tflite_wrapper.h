@@ -66,4 +66,93 @@
 //
 // Use of this software in critical systems (e.g., medical, nuclear, safety)
 // is entirely at your own risk unless specifically licensed for such purposes.
-//
\ No newline at end of file
+//
+// ─────────────────────────────────────────────────────────────────────────────
+// TensorFlow Lite Micro wrapper
+//
+// Several models can be loaded at once, each with its own interpreter and a
+// tensor arena carved from a shared pool, sized from that model's allocation
+// plan. Models are addressed by the integer handle tflite_load_model returns.
+
+#ifndef TFLITE_WRAPPER_H
+#define TFLITE_WRAPPER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TFLITE_MAX_MODELS       4
+#define TFLITE_ARENA_POOL_SIZE  (512 * 1024)   // Shared by all loaded models
+
+// Error codes
+#define TFLITE_ERROR_HANDLE     -1   // Bad handle, or AI support compiled out
+#define TFLITE_ERROR_INPUT      -2   // Input size mismatch
+#define TFLITE_ERROR_INVOKE     -3
+#define TFLITE_ERROR_OUTPUT     -4   // Output size mismatch
+#define TFLITE_ERROR_NO_SLOT    -5   // TFLITE_MAX_MODELS already loaded
+#define TFLITE_ERROR_ARENA      -6   // Tensors do not fit in the free arena pool
+#define TFLITE_ERROR_MODEL      -7   // Schema version mismatch
+#define TFLITE_ERROR_TENSOR     -8   // No such tensor, or unsupported type
+
+#define TFLITE_MAX_DIMS         4
+
+// Tensor element types exposed through the zero-copy API
+typedef enum {
+    TFLITE_TYPE_FLOAT32 = 1,
+    TFLITE_TYPE_INT8 = 2,
+    TFLITE_TYPE_UINT8 = 3
+} tflite_type_t;
+
+// A tensor inside a model's arena
+typedef struct {
+    void* data;                 // Writable in place; valid until the model is unloaded
+    uint32_t bytes;
+    tflite_type_t type;
+    uint32_t num_dims;
+    int32_t dims[TFLITE_MAX_DIMS];
+    float scale;                // Quantization of INT8/UINT8 tensors
+    int32_t zero_point;
+} tflite_tensor_t;
+
+typedef struct {
+    uint32_t arena_bytes;       // Arena reserved for this model
+    uint32_t input_bytes;       // Input tensor 0
+    uint32_t output_bytes;      // Output tensor 0
+    uint32_t invokes;
+    uint64_t last_invoke_us;    // Invoke() only, excluding tensor copies
+    uint64_t min_invoke_us;
+    uint64_t max_invoke_us;
+    uint64_t total_invoke_us;
+} tflite_model_stats_t;
+
+int tflite_init(void);
+
+// Build an interpreter for a model. The model data is referenced, not
+// copied, and must stay valid until the model is unloaded. Returns a
+// handle, or a negative error code.
+int tflite_load_model(const unsigned char* model_data, unsigned int model_size);
+
+// Copying interface for float models. Sizes are in floats.
+int tflite_run_inference(int handle,
+                         const float* input_data, unsigned int input_size,
+                         float* output_data, unsigned int output_size);
+
+// Zero-copy interface: fill the input tensors through their data pointers
+// (e.g. DMA a camera frame straight into the arena), call tflite_invoke,
+// then read the outputs in place. The arena is shared between tensors over
+// the course of an invoke, so inputs must be refilled before each call and
+// outputs are only valid until the next one.
+int tflite_get_input(int handle, int index, tflite_tensor_t* tensor);
+int tflite_get_output(int handle, int index, tflite_tensor_t* tensor);
+int tflite_invoke(int handle);
+
+int tflite_unload_model(int handle);
+int tflite_get_model_stats(int handle, tflite_model_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TFLITE_WRAPPER_H
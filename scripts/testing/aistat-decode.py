@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+Decode an `aistat dump` captured from the SAGE OS console.
+
+Reads a console log (file or stdin), finds the hex block between
+"AISTAT BEGIN" and "AISTAT END", checks its size and CRC-32 and prints
+the per-model latency percentiles and per-kernel times as JSON.
+Layout: kernel/ai/ai_profiler.h.
+"""
+
+import json
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = 0x50414753
+OP_NAMES = ["?", "conv2d", "depthwise", "fc", "maxpool", "avgpool", "softmax",
+            "batchnorm", "activation", "reshape"]
+
+
+def bucket_limit(index, sub_bits):
+    sub_buckets = 1 << sub_bits
+    if index < sub_buckets:
+        return index
+    shift = (index >> sub_bits) - 1
+    return ((sub_buckets + (index & (sub_buckets - 1))) << shift) + (1 << shift) - 1
+
+
+def percentile(buckets, count, maximum, permille, sub_bits):
+    if count == 0:
+        return 0
+    rank = max(1, (count * permille + 999) // 1000)
+    seen = 0
+    for index, value in enumerate(buckets):
+        seen += value
+        if seen >= rank:
+            return min(bucket_limit(index, sub_bits), maximum)
+    return maximum
+
+
+def read_histogram(data, offset, buckets, sub_bits):
+    total, count, maximum = struct.unpack_from("<QII", data, offset)
+    values = struct.unpack_from("<%dI" % buckets, data, offset + 16)
+    summary = {
+        "count": count,
+        "mean_us": total // count if count else 0,
+        "max_us": maximum,
+    }
+    for name, permille in (("p50_us", 500), ("p90_us", 900), ("p99_us", 990)):
+        summary[name] = percentile(values, count, maximum, permille, sub_bits)
+    return summary, offset + 16 + 4 * buckets
+
+
+def decode(data):
+    magic, version, models, buckets, sub_bits, _ = struct.unpack_from("<IHHHHI", data, 0)
+    if magic != MAGIC or version != 1:
+        raise ValueError("not an aistat dump (magic %#x, version %d)" % (magic, version))
+
+    offset = 16
+    result = []
+    for _ in range(models):
+        bytes_in, bytes_out, model_id, backend, inferences, errors, batches, _ = \
+            struct.unpack_from("<QQIIIIII", data, offset)
+        offset += 40
+        model = {
+            "id": model_id,
+            "backend": {1: "hat", 2: "cpu", 3: "split"}.get(backend, str(backend)),
+            "inferences": inferences,
+            "errors": errors,
+            "batches": batches,
+            "bytes_in": bytes_in,
+            "bytes_out": bytes_out,
+        }
+        for name in ("wait", "compute", "total"):
+            model[name], offset = read_histogram(data, offset, buckets, sub_bits)
+
+        ops, _ = struct.unpack_from("<II", data, offset)
+        offset += 8
+        model["ops"] = []
+        for _ in range(ops):
+            macs, total_ns, max_ns, op, fused, runs, h, w, c = struct.unpack_from("<QQQIIIIII", data, offset)
+            offset += 48
+            model["ops"].append({
+                "op": OP_NAMES[op] if op < len(OP_NAMES) else str(op),
+                "fused": fused,
+                "out": [h, w, c],
+                "macs": macs,
+                "runs": runs,
+                "avg_us": total_ns // runs // 1000 if runs else 0,
+                "max_us": max_ns // 1000,
+            })
+        result.append(model)
+    return result
+
+
+def main():
+    text = open(sys.argv[1]).read() if len(sys.argv) > 1 else sys.stdin.read()
+    match = re.search(r"AISTAT BEGIN\s*\n(.*?)AISTAT END (\d+) bytes crc32 ([0-9A-Fa-f]+)", text, re.S)
+    if not match:
+        sys.exit("no aistat dump found")
+
+    data = bytes.fromhex("".join(match.group(1).split()))
+    if len(data) != int(match.group(2)) or zlib.crc32(data) != int(match.group(3), 16):
+        sys.exit("dump is truncated or corrupted")
+
+    print(json.dumps(decode(data), indent=2))
+
+
+if __name__ == "__main__":
+    main()
@@ -7,6 +7,10 @@ set -e
 
 ARCH=${1:-i386}
 TARGET=${2:-generic}
+MODE=${3:-boot}           # boot: watch the boot log, bench: run the in-kernel 'bench' command
+BENCH_TIMEOUT=${BENCH_TIMEOUT:-120}
+BENCH_DIR=${BENCH_DIR:-build/bench}
+QEMU_SMP=${QEMU_SMP:-1}   # CPUs to emulate; the kernel starts secondaries on aarch64 virt
 
 echo "🧪 Testing SAGE-OS $ARCH build in QEMU..."
 
@@ -23,6 +27,10 @@ elif [ "$ARCH" = "aarch64" ]; then
     KERNEL_PATH="build/aarch64/kernel.img"
     QEMU_CMD="qemu-system-aarch64"
     QEMU_ARGS="-M virt -cpu cortex-a72 -m 1G -kernel $KERNEL_PATH -nographic -no-reboot"
+elif [ "$ARCH" = "riscv64" ]; then
+    KERNEL_PATH="build/riscv64/kernel.img"
+    QEMU_CMD="qemu-system-riscv64"
+    QEMU_ARGS="-M virt -cpu rv64 -m 1G -kernel $KERNEL_PATH -nographic -no-reboot"
 elif [ "$ARCH" = "arm" ]; then
     KERNEL_PATH="build/arm/kernel.img"
     QEMU_CMD="qemu-system-arm"
@@ -32,12 +40,48 @@ else
     exit 1
 fi
 
+if [ "$QEMU_SMP" -gt 1 ]; then
+    QEMU_ARGS="$QEMU_ARGS -smp $QEMU_SMP"
+fi
+
 if [ ! -f "$KERNEL_PATH" ]; then
     echo "❌ Kernel not found: $KERNEL_PATH"
     echo "   Run: make ARCH=$ARCH"
     exit 1
 fi
 
+if [ "$MODE" = "bench" ]; then
+    mkdir -p "$BENCH_DIR"
+    LOG_FILE="$BENCH_DIR/qemu-$ARCH.log"
+    RESULT_FILE="$BENCH_DIR/qemu-$ARCH.txt"
+
+    echo "⏱️  Running in-kernel benchmarks for $ARCH..."
+    echo "   Command: $QEMU_CMD $QEMU_ARGS"
+    echo "   Log: $LOG_FILE"
+
+    # Wait for the shell prompt, type 'bench', then wait for the summary line
+    (
+        sleep 3
+        printf 'bench\r'
+        for _ in $(seq "$BENCH_TIMEOUT"); do
+            sleep 1
+            grep -q '^BENCH_SUMMARY' "$LOG_FILE" 2>/dev/null && break
+        done
+        printf 'exit\r'
+    ) | timeout "${BENCH_TIMEOUT}s" $QEMU_CMD $QEMU_ARGS > "$LOG_FILE" 2>&1 || true
+
+    SUMMARY=$(tr -d '\r' < "$LOG_FILE" | grep '^BENCH_SUMMARY' | tail -n 1)
+    if [ -z "$SUMMARY" ]; then
+        echo "❌ No BENCH_SUMMARY line found for $ARCH (see $LOG_FILE)"
+        exit 1
+    fi
+
+    echo "$SUMMARY" > "$RESULT_FILE"
+    echo "$SUMMARY"
+    echo "✅ Benchmark results written to $RESULT_FILE"
+    exit 0
+fi
+
 echo "🚀 Starting QEMU for $ARCH..."
 echo "   Kernel: $KERNEL_PATH"
 echo "   Command: $QEMU_CMD $QEMU_ARGS"
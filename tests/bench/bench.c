@@ -0,0 +1,271 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Microbenchmark Harness
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_RESULTS 128
+#define MAX_REPS    31
+
+typedef struct {
+    const bench_case_t* bc;
+    uint64_t iters;
+    double ns_per_op;       // median over repetitions
+    double ns_per_op_min;
+    double bytes_per_sec;   // derived from the median
+} bench_result_t;
+
+static const bench_case_t* const case_tables[] = {
+    bench_fs_cases,
+    bench_string_cases,
+    bench_shell_cases,
+    bench_text_cases,
+    bench_crc_cases,
+    bench_ai_cases,
+    bench_ring_cases,
+    bench_pages_cases,
+    NULL
+};
+
+typedef struct {
+    const char* name;
+    int (*run)(void);
+} bench_check_t;
+
+static const bench_check_t checks[] = {
+    {"text", bench_text_check},
+    {"crc32", bench_crc_check},
+    {NULL, NULL}
+};
+
+static uint64_t paused_ns = 0;
+static uint64_t pause_start_ns = 0;
+static volatile const void* sink;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void bench_pause(void) {
+    pause_start_ns = now_ns();
+}
+
+void bench_resume(void) {
+    paused_ns += now_ns() - pause_start_ns;
+}
+
+void bench_consume(const void* ptr) {
+    sink = ptr;
+}
+
+// Time one repetition of `iters` operations, excluding paused intervals
+static uint64_t time_case(const bench_case_t* bc, uint64_t iters) {
+    if (bc->setup) {
+        bc->setup();
+    }
+    
+    paused_ns = 0;
+    uint64_t start = now_ns();
+    bc->run(iters);
+    uint64_t elapsed = now_ns() - start;
+    elapsed = (elapsed > paused_ns) ? elapsed - paused_ns : 0;
+    
+    if (bc->teardown) {
+        bc->teardown();
+    }
+    
+    return elapsed;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void run_case(const bench_case_t* bc, uint64_t min_time_ns, int reps, bench_result_t* result) {
+    // Grow the iteration count until one repetition fills min_time_ns
+    uint64_t iters = 1;
+    for (;;) {
+        uint64_t elapsed = time_case(bc, iters);
+        if (elapsed >= min_time_ns || iters >= (1ull << 40)) {
+            break;
+        }
+        uint64_t next = (elapsed > 0) ? (uint64_t)((double)iters * 1.2 * (double)min_time_ns / (double)elapsed) : iters * 10;
+        if (next <= iters) {
+            next = iters * 2;
+        }
+        if (next > iters * 10) {
+            next = iters * 10;
+        }
+        iters = next;
+    }
+    
+    double samples[MAX_REPS];
+    for (int r = 0; r < reps; r++) {
+        samples[r] = (double)time_case(bc, iters) / (double)iters;
+    }
+    qsort(samples, reps, sizeof(double), compare_double);
+    
+    result->bc = bc;
+    result->iters = iters;
+    result->ns_per_op = samples[reps / 2];
+    result->ns_per_op_min = samples[0];
+    result->bytes_per_sec = (bc->bytes_per_op && result->ns_per_op > 0.0)
+        ? (double)bc->bytes_per_op * 1e9 / result->ns_per_op : 0.0;
+}
+
+static void print_rate(double bytes_per_sec) {
+    if (bytes_per_sec <= 0.0) {
+        printf("%14s", "-");
+    } else if (bytes_per_sec >= 1e9) {
+        printf("%10.2f GB/s", bytes_per_sec / 1e9);
+    } else {
+        printf("%10.2f MB/s", bytes_per_sec / 1e6);
+    }
+}
+
+static int write_json(const char* path, const char* label, const bench_result_t* results, int count,
+                      uint64_t min_time_ns, int reps) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    
+    fprintf(f, "{\n");
+    fprintf(f, "  \"suite\": \"sage-os-host\",\n");
+    fprintf(f, "  \"label\": \"%s\",\n", label);
+    fprintf(f, "  \"timestamp\": %lld,\n", (long long)time(NULL));
+    fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(f, "  \"min_time_ms\": %llu,\n", (unsigned long long)(min_time_ns / 1000000ull));
+    fprintf(f, "  \"repetitions\": %d,\n", reps);
+    fprintf(f, "  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const bench_result_t* r = &results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"impl\": \"%s\", \"iterations\": %llu, "
+                   "\"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, \"bytes_per_op\": %zu, "
+                   "\"bytes_per_sec\": %.1f}%s\n",
+                r->bc->name, r->bc->impl, (unsigned long long)r->iters,
+                r->ns_per_op, r->ns_per_op_min, r->bc->bytes_per_op,
+                r->bytes_per_sec, (i + 1 < count) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    
+    fclose(f);
+    return 0;
+}
+
+static void usage(const char* prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --json <file>      Write results as JSON for trend tracking\n");
+    printf("  --label <text>     Label stored in the JSON output (e.g. git revision)\n");
+    printf("  --filter <text>    Only run cases whose name contains <text>\n");
+    printf("  --min-time <ms>    Minimum time per repetition (default 100)\n");
+    printf("  --reps <n>         Timed repetitions per case, median reported (default 5)\n");
+    printf("  --list             List available cases and exit\n");
+    printf("  --check            Only run the correctness checks\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* json_path = NULL;
+    const char* label = "";
+    const char* filter = NULL;
+    uint64_t min_time_ns = 100ull * 1000000ull;
+    int reps = 5;
+    int list_only = 0;
+    int check_only = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) {
+            label = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time_ns = strtoull(argv[++i], NULL, 10) * 1000000ull;
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list_only = 1;
+        } else if (strcmp(argv[i], "--check") == 0) {
+            check_only = 1;
+        } else {
+            usage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 2;
+        }
+    }
+    
+    if (reps < 1) reps = 1;
+    if (reps > MAX_REPS) reps = MAX_REPS;
+    
+    // Timing code that gives wrong answers is not worth timing
+    if (!list_only) {
+        int failures = 0;
+        for (const bench_check_t* check = checks; check->name != NULL; check++) {
+            int failed = check->run();
+            printf("check %-22s %s\n", check->name, failed ? "FAIL" : "ok");
+            failures += failed;
+        }
+        if (failures > 0) {
+            fprintf(stderr, "%d check(s) failed\n", failures);
+            return 1;
+        }
+        if (check_only) {
+            return 0;
+        }
+        printf("\n");
+    }
+    
+    static bench_result_t results[MAX_RESULTS];
+    int count = 0;
+    
+    if (!list_only) {
+        printf("%-28s %-22s %14s %14s %14s\n", "benchmark", "impl", "iterations", "ns/op", "throughput");
+        printf("%-28s %-22s %14s %14s %14s\n", "---------", "----", "----------", "-----", "----------");
+    }
+    
+    for (int t = 0; case_tables[t] != NULL; t++) {
+        for (const bench_case_t* bc = case_tables[t]; bc->name != NULL; bc++) {
+            if (filter && !strstr(bc->name, filter) && !strstr(bc->impl, filter)) {
+                continue;
+            }
+            if (list_only) {
+                printf("%s (%s)\n", bc->name, bc->impl);
+                continue;
+            }
+            if (count >= MAX_RESULTS) {
+                fprintf(stderr, "too many benchmark cases\n");
+                return 1;
+            }
+            
+            bench_result_t* r = &results[count++];
+            run_case(bc, min_time_ns, reps, r);
+            printf("%-28s %-22s %14llu %14.2f ", bc->name, bc->impl, (unsigned long long)r->iters, r->ns_per_op);
+            print_rate(r->bytes_per_sec);
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+    
+    if (json_path && !list_only) {
+        if (write_json(json_path, label, results, count, min_time_ns, reps) != 0) {
+            return 1;
+        }
+        printf("\nJSON results written to %s\n", json_path);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,76 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Microbenchmark Harness
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef SAGE_BENCH_H
+#define SAGE_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A single benchmark case. run() performs `iters` operations; setup() and
+// teardown() run once per timed repetition and are not measured.
+typedef struct {
+    const char* name;       // dotted name, e.g. "fs.save"
+    const char* impl;       // implementation under test, e.g. "enhanced_filesystem"
+    size_t bytes_per_op;    // payload bytes per operation (0 = no throughput)
+    void (*setup)(void);
+    void (*run)(uint64_t iters);
+    void (*teardown)(void);
+} bench_case_t;
+
+// Exclude work inside run() from the measurement (e.g. re-creating files
+// that the operation under test consumes).
+void bench_pause(void);
+void bench_resume(void);
+
+// Keep the optimizer from discarding benchmark results.
+void bench_consume(const void* ptr);
+
+// Case tables, one per benchmark source file (NULL-name terminated)
+extern const bench_case_t bench_fs_cases[];
+extern const bench_case_t bench_string_cases[];
+extern const bench_case_t bench_shell_cases[];
+extern const bench_case_t bench_text_cases[];
+extern const bench_case_t bench_crc_cases[];
+extern const bench_case_t bench_ai_cases[];
+extern const bench_case_t bench_ring_cases[];
+extern const bench_case_t bench_pages_cases[];
+
+// Correctness checks, run before anything is timed. Each compares kernel
+// code against a simple reference and returns the number of mismatches
+// after printing them; any mismatch makes sage-bench exit non-zero.
+int bench_text_check(void);
+int bench_crc_check(void);
+
+// ── Kernel symbols under test (prefixed by the shim/bind_*.h headers) ──────
+
+// kernel/stdio.c
+void* kstdio_memcpy(void* dest, const void* src, size_t n);
+void* kstdio_memset(void* ptr, int value, size_t num);
+size_t kstdio_strlen(const char* str);
+int kstdio_strcmp(const char* str1, const char* str2);
+
+// kernel/utils.c
+int kutils_sprintf(char* buffer, const char* format, ...);
+
+// kernel/filesystem.c
+void kfs_fs_init(void);
+int kfs_fs_save(const char* filename, const char* content);
+int kfs_fs_append(const char* filename, const char* content);
+int kfs_fs_cat(const char* filename, char* output, size_t output_size);
+int kfs_fs_delete_file(const char* filename);
+
+// kernel/enhanced_filesystem.c
+void kefs_fs_init(void);
+int kefs_fs_save(const char* filename, const char* content);
+int kefs_fs_append(const char* filename, const char* content);
+int kefs_fs_cat(const char* filename, char* buffer, size_t buffer_size);
+int kefs_fs_delete_file(const char* filename);
+
+// kernel/shell_args.c
+int shell_split_args(char* command, char* argv[], int max_args);
+
+#endif // SAGE_BENCH_H
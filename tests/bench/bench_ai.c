@@ -0,0 +1,67 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Microbenchmarks: CPU inference GEMM
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "bench.h"
+#include "../../kernel/ai/ai_cpu_kernels.h"
+
+// One tile of a 3x3 convolution from 16 to 32 channels
+#define GEMM_M 64
+#define GEMM_N 32
+#define GEMM_K (3 * 3 * 16)
+
+static int8_t a_s8[GEMM_M * GEMM_K];
+static int8_t b_s8[GEMM_N * GEMM_K];
+static int32_t c_s32[GEMM_M * GEMM_N];
+static uint16_t a_f16[GEMM_M * GEMM_K];
+static uint16_t b_f16[GEMM_N * GEMM_K];
+static float c_f32[GEMM_M * GEMM_N];
+
+static void gemm_setup(void) {
+    uint32_t state = 2025;
+    
+    for (int i = 0; i < GEMM_M * GEMM_K; i++) {
+        state = state * 1103515245u + 12345u;
+        a_s8[i] = (int8_t)(state >> 16);
+        a_f16[i] = ai_cpu_float_to_half((float)a_s8[i] / 128.0f);
+    }
+    for (int i = 0; i < GEMM_N * GEMM_K; i++) {
+        state = state * 1103515245u + 12345u;
+        b_s8[i] = (int8_t)((int)((state >> 16) % 255) - 127);
+        b_f16[i] = ai_cpu_float_to_half((float)b_s8[i] / 128.0f);
+    }
+}
+
+static void gemm_s8_run(uint64_t iters) {
+    for (uint64_t n = 0; n < iters; n++) {
+        ai_cpu_gemm_s8(a_s8, b_s8, c_s32, GEMM_M, GEMM_N, GEMM_K);
+    }
+    bench_consume(c_s32);
+}
+
+static void gemm_f16_run(uint64_t iters) {
+    for (uint64_t n = 0; n < iters; n++) {
+        ai_cpu_gemm_f16(a_f16, b_f16, c_f32, GEMM_M, GEMM_N, GEMM_K);
+    }
+    bench_consume(c_f32);
+}
+
+static void isa_scalar(void) {
+    gemm_setup();
+    ai_cpu_set_isa(AI_CPU_ISA_SCALAR);
+}
+
+static void isa_best(void) {
+    gemm_setup();
+    ai_cpu_set_isa(ai_cpu_detect_isa());
+}
+
+const bench_case_t bench_ai_cases[] = {
+    {"gemm_s8.64x32x144",  "scalar", sizeof(a_s8), isa_scalar, gemm_s8_run,  NULL},
+    {"gemm_s8.64x32x144",  "simd",   sizeof(a_s8), isa_best,   gemm_s8_run,  NULL},
+    {"gemm_f16.64x32x144", "scalar", sizeof(a_f16), isa_scalar, gemm_f16_run, NULL},
+    {"gemm_f16.64x32x144", "simd",   sizeof(a_f16), isa_best,   gemm_f16_run, NULL},
+    {NULL, NULL, 0, NULL, NULL, NULL}
+};
@@ -0,0 +1,106 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Microbenchmarks: in-memory file systems
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "bench.h"
+
+#include <string.h>
+
+#define PAYLOAD_SIZE      1024
+#define APPEND_CHUNK      64
+#define APPENDS_PER_FILE  16   // 1 KiB per file, fits both MAX_FILESIZE limits
+
+typedef struct {
+    void (*init)(void);
+    int (*save)(const char* filename, const char* content);
+    int (*append)(const char* filename, const char* content);
+    int (*cat)(const char* filename, char* buffer, size_t buffer_size);
+    int (*delete_file)(const char* filename);
+} fs_ops_t;
+
+static const fs_ops_t filesystem_ops = {
+    kfs_fs_init, kfs_fs_save, kfs_fs_append, kfs_fs_cat, kfs_fs_delete_file
+};
+
+static const fs_ops_t enhanced_filesystem_ops = {
+    kefs_fs_init, kefs_fs_save, kefs_fs_append, kefs_fs_cat, kefs_fs_delete_file
+};
+
+static char payload[PAYLOAD_SIZE + 1];
+static char chunk[APPEND_CHUNK + 1];
+static char read_buffer[4096];
+
+static void fill_text(char* buf, size_t len) {
+    static const char text[] = "SAGE OS benchmark payload line\n";
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = text[i % (sizeof(text) - 1)];
+    }
+    buf[len] = '\0';
+}
+
+static void prepare(const fs_ops_t* ops) {
+    fill_text(payload, PAYLOAD_SIZE);
+    fill_text(chunk, APPEND_CHUNK);
+    ops->init();
+    ops->delete_file("bench.dat");
+}
+
+static void run_save(const fs_ops_t* ops, uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+        ops->save("bench.dat", payload);
+    }
+}
+
+static void run_append(const fs_ops_t* ops, uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+        if (i % APPENDS_PER_FILE == 0) {
+            bench_pause();
+            ops->save("bench.dat", "");
+            bench_resume();
+        }
+        ops->append("bench.dat", chunk);
+    }
+}
+
+static void run_cat(const fs_ops_t* ops, uint64_t iters) {
+    bench_pause();
+    ops->save("bench.dat", payload);
+    bench_resume();
+    for (uint64_t i = 0; i < iters; i++) {
+        ops->cat("bench.dat", read_buffer, sizeof(read_buffer));
+        bench_consume(read_buffer);
+    }
+}
+
+static void run_delete(const fs_ops_t* ops, uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+        bench_pause();
+        ops->save("bench.dat", payload);
+        bench_resume();
+        ops->delete_file("bench.dat");
+    }
+}
+
+#define FS_BENCH_FUNCS(impl)                                                        \
+    static void impl##_setup(void) { prepare(&impl##_ops); }                        \
+    static void impl##_save(uint64_t n) { run_save(&impl##_ops, n); }               \
+    static void impl##_append(uint64_t n) { run_append(&impl##_ops, n); }           \
+    static void impl##_cat(uint64_t n) { run_cat(&impl##_ops, n); }                 \
+    static void impl##_delete(uint64_t n) { run_delete(&impl##_ops, n); }
+
+#define FS_BENCH_CASES(impl)                                                        \
+    {"fs.save",   #impl, PAYLOAD_SIZE, impl##_setup, impl##_save,   NULL},          \
+    {"fs.append", #impl, APPEND_CHUNK, impl##_setup, impl##_append, NULL},          \
+    {"fs.cat",    #impl, PAYLOAD_SIZE, impl##_setup, impl##_cat,    NULL},          \
+    {"fs.delete", #impl, 0,            impl##_setup, impl##_delete, NULL}
+
+FS_BENCH_FUNCS(filesystem)
+FS_BENCH_FUNCS(enhanced_filesystem)
+
+const bench_case_t bench_fs_cases[] = {
+    FS_BENCH_CASES(filesystem),
+    FS_BENCH_CASES(enhanced_filesystem),
+    {NULL, NULL, 0, NULL, NULL, NULL}
+};
@@ -0,0 +1,89 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Microbenchmarks: Page allocator
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "bench.h"
+#include "../../kernel/memory.h"
+#include <pthread.h>
+
+// One operation is one page_alloc/page_put pair. Each thread plays one CPU
+// and holds a burst of frames at a time, so the per-CPU caches see both
+// refills and drains; the operations are split evenly across the threads.
+#define PAGES_BURST         8
+#define PAGES_MAX_THREADS   8
+
+extern __thread uint32_t bench_cpu_id;
+
+typedef struct {
+    uint32_t cpu;
+    uint64_t count;
+} pages_worker_t;
+
+static void cached_setup(void) {
+    memory_set_page_cache(1);
+}
+
+static void locked_setup(void) {
+    memory_set_page_cache(0);
+}
+
+static void* pages_worker(void* arg) {
+    pages_worker_t* worker = (pages_worker_t*)arg;
+    uint64_t frames[PAGES_BURST];
+    
+    bench_cpu_id = worker->cpu;
+    for (uint64_t n = 0; n < worker->count; n += PAGES_BURST) {
+        uint32_t burst = (worker->count - n < PAGES_BURST) ? (uint32_t)(worker->count - n) : PAGES_BURST;
+        for (uint32_t i = 0; i < burst; i++) {
+            frames[i] = page_alloc();
+        }
+        for (uint32_t i = 0; i < burst; i++) {
+            page_put(frames[i]);
+        }
+    }
+    return NULL;
+}
+
+static void run_threads(uint32_t threads, uint64_t iters) {
+    pthread_t ids[PAGES_MAX_THREADS];
+    pages_worker_t workers[PAGES_MAX_THREADS];
+    
+    for (uint32_t i = 0; i < threads; i++) {
+        workers[i].cpu = i;
+        workers[i].count = iters / threads + (i < iters % threads ? 1 : 0);
+        pthread_create(&ids[i], NULL, pages_worker, &workers[i]);
+    }
+    for (uint32_t i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+}
+
+static void pages_1t(uint64_t iters) {
+    run_threads(1, iters);
+}
+
+static void pages_2t(uint64_t iters) {
+    run_threads(2, iters);
+}
+
+static void pages_4t(uint64_t iters) {
+    run_threads(4, iters);
+}
+
+static void pages_8t(uint64_t iters) {
+    run_threads(8, iters);
+}
+
+const bench_case_t bench_pages_cases[] = {
+    {"pages.alloc_free.1t", "kernel/memory.c",   0, cached_setup, pages_1t, NULL},
+    {"pages.alloc_free.1t", "zone-lock-only",    0, locked_setup, pages_1t, NULL},
+    {"pages.alloc_free.2t", "kernel/memory.c",   0, cached_setup, pages_2t, NULL},
+    {"pages.alloc_free.2t", "zone-lock-only",    0, locked_setup, pages_2t, NULL},
+    {"pages.alloc_free.4t", "kernel/memory.c",   0, cached_setup, pages_4t, NULL},
+    {"pages.alloc_free.4t", "zone-lock-only",    0, locked_setup, pages_4t, NULL},
+    {"pages.alloc_free.8t", "kernel/memory.c",   0, cached_setup, pages_8t, NULL},
+    {"pages.alloc_free.8t", "zone-lock-only",    0, locked_setup, pages_8t, NULL},
+    {NULL, NULL, 0, NULL, NULL, NULL}
+};
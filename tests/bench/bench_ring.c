@@ -0,0 +1,236 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Microbenchmarks: Ring buffers
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "bench.h"
+#include "../../kernel/ringbuf.h"
+#include <pthread.h>
+
+// One operation is one 8-byte element passing through the queue
+#define RING_CAPACITY   1024
+#define RING_BATCH      32
+#define RING_PRODUCERS  4     // MPSC
+#define RING_PAIRS      2     // MPMC: producers and as many consumers
+
+static ringbuf_t ring;
+static uint64_t storage[RING_CAPACITY];
+static ringbuf_mpmc_t mpmc;
+static uint8_t mpmc_storage[RINGBUF_MPMC_STORAGE(RING_CAPACITY, sizeof(uint64_t))] __attribute__((aligned(64)));
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t sink;
+
+typedef struct {
+    uint64_t count;     // Elements this thread moves
+    uint32_t batch;
+    uint64_t sum;
+} ring_worker_t;
+
+static void ring_setup(void) {
+    ringbuf_init(&ring, storage, sizeof(uint64_t), RING_CAPACITY);
+    ringbuf_mpmc_init(&mpmc, mpmc_storage, sizeof(uint64_t), RING_CAPACITY);
+}
+
+// ─── One thread ──────────────────────────────────────────────────────────────
+
+static void spsc_local(uint64_t iters) {
+    uint64_t value;
+    
+    for (uint64_t n = 0; n < iters; n++) {
+        ringbuf_spsc_enqueue(&ring, &n, 1);
+        ringbuf_spsc_dequeue(&ring, &value, 1);
+        sink += value;
+    }
+    bench_consume(&sink);
+}
+
+static void spsc_local_batch(uint64_t iters) {
+    uint64_t values[RING_BATCH];
+    
+    for (uint64_t n = 0; n < iters; n += RING_BATCH) {
+        uint32_t count = (iters - n < RING_BATCH) ? (uint32_t)(iters - n) : RING_BATCH;
+        for (uint32_t i = 0; i < count; i++) {
+            values[i] = n + i;
+        }
+        ringbuf_spsc_enqueue(&ring, values, count);
+        ringbuf_spsc_dequeue(&ring, values, count);
+        sink += values[count - 1];
+    }
+    bench_consume(&sink);
+}
+
+static void mpmc_local(uint64_t iters) {
+    uint64_t value;
+    
+    for (uint64_t n = 0; n < iters; n++) {
+        ringbuf_mpmc_enqueue_one(&mpmc, &n);
+        ringbuf_mpmc_dequeue_one(&mpmc, &value);
+        sink += value;
+    }
+    bench_consume(&sink);
+}
+
+// ─── Producer and consumer threads ───────────────────────────────────────────
+
+static void* spsc_producer(void* arg) {
+    ring_worker_t* worker = (ring_worker_t*)arg;
+    uint64_t values[RING_BATCH];
+    
+    for (uint64_t n = 0; n < worker->count;) {
+        uint32_t want = (worker->count - n < worker->batch) ? (uint32_t)(worker->count - n) : worker->batch;
+        for (uint32_t i = 0; i < want; i++) {
+            values[i] = n + i;
+        }
+        uint32_t done = ringbuf_spsc_enqueue(&ring, values, want);
+        if (done == 0) {
+            ringbuf_cpu_relax();
+        }
+        n += done;
+    }
+    return NULL;
+}
+
+static void* mpsc_producer(void* arg) {
+    ring_worker_t* worker = (ring_worker_t*)arg;
+    uint64_t values[RING_BATCH];
+    
+    for (uint64_t n = 0; n < worker->count;) {
+        uint32_t want = (worker->count - n < worker->batch) ? (uint32_t)(worker->count - n) : worker->batch;
+        for (uint32_t i = 0; i < want; i++) {
+            values[i] = n + i;
+        }
+        uint32_t done = ringbuf_mpsc_enqueue(&ring, values, want);
+        if (done == 0) {
+            ringbuf_cpu_relax();
+        }
+        n += done;
+    }
+    return NULL;
+}
+
+static void* mpmc_producer(void* arg) {
+    ring_worker_t* worker = (ring_worker_t*)arg;
+    
+    for (uint64_t n = 0; n < worker->count;) {
+        if (ringbuf_mpmc_enqueue_one(&mpmc, &n)) {
+            n++;
+        } else {
+            ringbuf_cpu_relax();
+        }
+    }
+    return NULL;
+}
+
+static void* mpmc_consumer(void* arg) {
+    ring_worker_t* worker = (ring_worker_t*)arg;
+    uint64_t value;
+    
+    for (uint64_t n = 0; n < worker->count;) {
+        if (ringbuf_mpmc_dequeue_one(&mpmc, &value)) {
+            worker->sum += value;
+            n++;
+        } else {
+            ringbuf_cpu_relax();
+        }
+    }
+    return NULL;
+}
+
+static void* locked_producer(void* arg) {
+    ring_worker_t* worker = (ring_worker_t*)arg;
+    
+    for (uint64_t n = 0; n < worker->count;) {
+        pthread_mutex_lock(&lock);
+        n += ringbuf_spsc_enqueue(&ring, &n, 1);
+        pthread_mutex_unlock(&lock);
+    }
+    return NULL;
+}
+
+// The calling thread consumes what `producers` threads running `producer`
+// enqueue, batch elements at a time
+static void run_threads(void* (*producer)(void*), uint32_t producers, uint64_t iters, uint32_t batch) {
+    pthread_t threads[RING_PRODUCERS];
+    ring_worker_t workers[RING_PRODUCERS];
+    uint64_t values[RING_BATCH];
+    
+    for (uint32_t i = 0; i < producers; i++) {
+        workers[i].count = iters / producers + (i < iters % producers ? 1 : 0);
+        workers[i].batch = batch;
+        pthread_create(&threads[i], NULL, producer, &workers[i]);
+    }
+    
+    for (uint64_t n = 0; n < iters;) {
+        uint32_t done = ringbuf_dequeue(&ring, values, batch);
+        if (done == 0) {
+            ringbuf_cpu_relax();
+            continue;
+        }
+        sink += values[done - 1];
+        n += done;
+    }
+    
+    for (uint32_t i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    bench_consume(&sink);
+}
+
+static void spsc_threads(uint64_t iters) {
+    run_threads(spsc_producer, 1, iters, 1);
+}
+
+static void spsc_threads_batch(uint64_t iters) {
+    run_threads(spsc_producer, 1, iters, RING_BATCH);
+}
+
+static void mpsc_threads(uint64_t iters) {
+    run_threads(mpsc_producer, RING_PRODUCERS, iters, RING_BATCH);
+}
+
+static void locked_threads(uint64_t iters) {
+    pthread_t thread;
+    ring_worker_t worker = {iters, 1, 0};
+    uint64_t value;
+    
+    pthread_create(&thread, NULL, locked_producer, &worker);
+    for (uint64_t n = 0; n < iters;) {
+        pthread_mutex_lock(&lock);
+        uint32_t done = ringbuf_dequeue(&ring, &value, 1);
+        pthread_mutex_unlock(&lock);
+        sink += value * done;
+        n += done;
+    }
+    pthread_join(thread, NULL);
+    bench_consume(&sink);
+}
+
+static void mpmc_threads(uint64_t iters) {
+    pthread_t threads[RING_PAIRS * 2];
+    ring_worker_t workers[RING_PAIRS * 2];
+    
+    for (uint32_t i = 0; i < RING_PAIRS * 2; i++) {
+        workers[i].count = iters / RING_PAIRS + (i % RING_PAIRS < iters % RING_PAIRS ? 1 : 0);
+        workers[i].batch = 1;
+        workers[i].sum = 0;
+        pthread_create(&threads[i], NULL, (i < RING_PAIRS) ? mpmc_producer : mpmc_consumer, &workers[i]);
+    }
+    for (uint32_t i = 0; i < RING_PAIRS * 2; i++) {
+        pthread_join(threads[i], NULL);
+        sink += workers[i].sum;
+    }
+    bench_consume(&sink);
+}
+
+const bench_case_t bench_ring_cases[] = {
+    {"ring.spsc.local",         "kernel/ringbuf.h", sizeof(uint64_t), ring_setup, spsc_local,         NULL},
+    {"ring.spsc.local.batch32", "kernel/ringbuf.h", sizeof(uint64_t), ring_setup, spsc_local_batch,   NULL},
+    {"ring.mpmc.local",         "kernel/ringbuf.h", sizeof(uint64_t), ring_setup, mpmc_local,         NULL},
+    {"ring.spsc.2t",            "kernel/ringbuf.h", sizeof(uint64_t), ring_setup, spsc_threads,       NULL},
+    {"ring.spsc.2t",            "pthread-mutex",    sizeof(uint64_t), ring_setup, locked_threads,     NULL},
+    {"ring.spsc.2t.batch32",    "kernel/ringbuf.h", sizeof(uint64_t), ring_setup, spsc_threads_batch, NULL},
+    {"ring.mpsc.5t.batch32",    "kernel/ringbuf.h", sizeof(uint64_t), ring_setup, mpsc_threads,       NULL},
+    {"ring.mpmc.4t",            "kernel/ringbuf.h", sizeof(uint64_t), ring_setup, mpmc_threads,       NULL},
+    {NULL, NULL, 0, NULL, NULL, NULL}
+};
@@ -0,0 +1,120 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Microbenchmarks: shell command parsing
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "bench.h"
+#include "../../kernel/shell_cmd.h"
+
+#include <string.h>
+
+#define MAX_COMMAND_LENGTH 256
+#define MAX_ARGS 16
+
+static const char short_line[] = "ls";
+static const char long_line[] = "save notes.txt the quick brown fox jumps over the lazy dog again";
+
+static void split(const char* line, size_t len, uint64_t iters) {
+    char command[MAX_COMMAND_LENGTH];
+    char* argv[MAX_ARGS];
+    
+    for (uint64_t i = 0; i < iters; i++) {
+        // The shells parse a private copy of every line, so the copy is part of the cost
+        memcpy(command, line, len + 1);
+        int argc = shell_split_args(command, argv, MAX_ARGS);
+        bench_consume(argv[argc > 0 ? argc - 1 : 0]);
+    }
+}
+
+static void split_short(uint64_t iters) {
+    split(short_line, sizeof(short_line) - 1, iters);
+}
+
+static void split_long(uint64_t iters) {
+    split(long_line, sizeof(long_line) - 1, iters);
+}
+
+// ── Command dispatch ────────────────────────────────────────────────────────
+
+#define DISPATCH_BATCH 100000
+
+static uint64_t dispatched;
+
+static void count_command(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+    dispatched++;
+}
+
+// Same command set as kernel/enhanced_shell.c
+static const shell_command_t dispatch_commands[] = {
+    {"help", "", count_command},    {"echo", "", count_command},
+    {"clear", "", count_command},   {"meminfo", "", count_command},
+    {"reboot", "", count_command},  {"version", "", count_command},
+    {"exit", "", count_command},    {"ls", "", count_command},
+    {"pwd", "", count_command},     {"mkdir", "", count_command},
+    {"touch", "", count_command},   {"cat", "", count_command},
+    {"save", "", count_command},    {"append", "", count_command},
+    {"rm", "", count_command},      {"cp", "", count_command},
+    {"mv", "", count_command},      {"find", "", count_command},
+    {"grep", "", count_command},    {"wc", "", count_command},
+    {"history", "", count_command}, {"bench", "", count_command},
+    {NULL, NULL, NULL}
+};
+
+static shell_cmd_table_t dispatch_table = SHELL_CMD_TABLE_INIT(dispatch_commands);
+
+// A scripted batch: mostly known commands, 1 in 16 unknown
+static const char* dispatch_script[DISPATCH_BATCH];
+
+static void dispatch_setup(void) {
+    static const char* const unknown[] = {"foo", "lsx", "catalog", "make"};
+    uint32_t known = sizeof(dispatch_commands) / sizeof(dispatch_commands[0]) - 1;
+    uint32_t state = 12345;
+    
+    for (int i = 0; i < DISPATCH_BATCH; i++) {
+        state = state * 1103515245u + 12345u;
+        uint32_t pick = state >> 16;
+        if ((pick & 15) == 0) {
+            dispatch_script[i] = unknown[(pick >> 4) & 3];
+        } else {
+            dispatch_script[i] = dispatch_commands[(pick >> 4) % known].name;
+        }
+    }
+}
+
+static void dispatch_hash(uint64_t iters) {
+    for (uint64_t n = 0; n < iters; n++) {
+        for (int i = 0; i < DISPATCH_BATCH; i++) {
+            const shell_command_t* cmd = shell_cmd_lookup(&dispatch_table, dispatch_script[i]);
+            if (cmd != NULL) {
+                cmd->func(0, NULL);
+            }
+        }
+    }
+    bench_consume(&dispatched);
+}
+
+// The previous dispatcher: strcmp down the table until a match
+static void dispatch_linear(uint64_t iters) {
+    for (uint64_t n = 0; n < iters; n++) {
+        for (int i = 0; i < DISPATCH_BATCH; i++) {
+            for (int c = 0; dispatch_commands[c].name != NULL; c++) {
+                if (kstdio_strcmp(dispatch_script[i], dispatch_commands[c].name) == 0) {
+                    dispatch_commands[c].func(0, NULL);
+                    break;
+                }
+            }
+        }
+    }
+    bench_consume(&dispatched);
+}
+
+const bench_case_t bench_shell_cases[] = {
+    {"shell.split_args.short", "kernel/shell_args.c", sizeof(short_line) - 1, NULL, split_short, NULL},
+    {"shell.split_args.long",  "kernel/shell_args.c", sizeof(long_line) - 1,  NULL, split_long,  NULL},
+    {"shell.dispatch.batch100k", "kernel/shell_cmd.c", 0, dispatch_setup, dispatch_hash,   NULL},
+    {"shell.dispatch.batch100k", "linear-strcmp",      0, dispatch_setup, dispatch_linear, NULL},
+    {NULL, NULL, 0, NULL, NULL, NULL}
+};
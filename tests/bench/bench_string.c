@@ -0,0 +1,81 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Microbenchmarks: kernel string and memory routines
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "bench.h"
+
+#include <string.h>
+
+static unsigned char src_buf[65536] __attribute__((aligned(64)));
+static unsigned char dst_buf[65536] __attribute__((aligned(64)));
+static char fmt_buf[256];
+
+static void memory_setup(void) {
+    for (size_t i = 0; i < sizeof(src_buf); i++) {
+        src_buf[i] = (unsigned char)i;
+    }
+}
+
+#define MEMCPY_CASE(size)                                                           \
+    static void kernel_memcpy_##size(uint64_t iters) {                              \
+        for (uint64_t i = 0; i < iters; i++) {                                      \
+            kstdio_memcpy(dst_buf, src_buf, size);                                  \
+            bench_consume(dst_buf);                                                 \
+        }                                                                           \
+    }                                                                               \
+    static void libc_memcpy_##size(uint64_t iters) {                                \
+        for (uint64_t i = 0; i < iters; i++) {                                      \
+            memcpy(dst_buf, src_buf, size);                                         \
+            bench_consume(dst_buf);                                                 \
+        }                                                                           \
+    }
+
+MEMCPY_CASE(64)
+MEMCPY_CASE(1024)
+MEMCPY_CASE(4096)
+MEMCPY_CASE(65536)
+
+static void kernel_memset_4096(uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+        kstdio_memset(dst_buf, (int)i, 4096);
+        bench_consume(dst_buf);
+    }
+}
+
+// Representative of the shell's status lines
+#define SPRINTF_BYTES 40
+
+static void kernel_sprintf(uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+        kutils_sprintf(fmt_buf, "File '%s' saved (%d bytes) %c\n", "welcome.txt", 1234, 'k');
+        bench_consume(fmt_buf);
+    }
+}
+
+static void kernel_strlen(uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+        bench_consume((const void*)(uintptr_t)kstdio_strlen((const char*)src_buf + 1));
+    }
+}
+
+static void strlen_setup(void) {
+    memset(src_buf, 'a', 1025);
+    src_buf[1025] = '\0';
+}
+
+const bench_case_t bench_string_cases[] = {
+    {"memcpy.64",    "kernel/stdio.c", 64,    memory_setup, kernel_memcpy_64,    NULL},
+    {"memcpy.1k",    "kernel/stdio.c", 1024,  memory_setup, kernel_memcpy_1024,  NULL},
+    {"memcpy.4k",    "kernel/stdio.c", 4096,  memory_setup, kernel_memcpy_4096,  NULL},
+    {"memcpy.64k",   "kernel/stdio.c", 65536, memory_setup, kernel_memcpy_65536, NULL},
+    {"memcpy.64",    "host-libc",      64,    memory_setup, libc_memcpy_64,      NULL},
+    {"memcpy.1k",    "host-libc",      1024,  memory_setup, libc_memcpy_1024,    NULL},
+    {"memcpy.4k",    "host-libc",      4096,  memory_setup, libc_memcpy_4096,    NULL},
+    {"memcpy.64k",   "host-libc",      65536, memory_setup, libc_memcpy_65536,   NULL},
+    {"memset.4k",    "kernel/stdio.c", 4096,  NULL,         kernel_memset_4096,  NULL},
+    {"strlen.1k",    "kernel/stdio.c", 1024,  strlen_setup, kernel_strlen,       NULL},
+    {"sprintf",      "kernel/utils.c", SPRINTF_BYTES, NULL, kernel_sprintf,      NULL},
+    {NULL, NULL, 0, NULL, NULL, NULL}
+};
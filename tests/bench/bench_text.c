@@ -0,0 +1,434 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Microbenchmarks: grep/wc text search
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#include "bench.h"
+#include "../../kernel/textsearch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_SIZE 65536
+
+static char log_text[LOG_SIZE];
+static uint64_t sink;
+
+// Synthetic kernel log: timestamped lines, a rare "panic" needle
+static void log_setup(void) {
+    static const char* const words[] = {
+        "init", "irq", "timer", "uart", "mmu", "alloc", "sched", "fs",
+        "ready", "ok", "retry", "spi", "dma", "model", "load", "done"
+    };
+    uint32_t state = 2025;
+    size_t pos = 0;
+    uint32_t line = 0;
+    
+    while (pos < LOG_SIZE - 1) {
+        state = state * 1103515245u + 12345u;
+        const char* word = (line % 97 == 96) ? "panic" : words[(state >> 16) & 15];
+        char entry[64];
+        int len = snprintf(entry, sizeof(entry), "[%6u] %s: value=%u\n", line, word, state >> 20);
+        
+        for (int i = 0; i < len && pos < LOG_SIZE - 1; i++) {
+            log_text[pos++] = entry[i];
+        }
+        line++;
+    }
+    log_text[LOG_SIZE - 1] = '\n';
+}
+
+static int count_match(const char* line, size_t len, uint32_t line_num, void* ctx) {
+    (void)line;
+    (void)len;
+    (void)line_num;
+    (*(uint64_t*)ctx)++;
+    return 0;
+}
+
+static void grep_stream(const char* needle, int flags, uint64_t iters) {
+    ts_pattern_t pattern;
+    ts_stream_t stream;
+    
+    ts_compile(&pattern, needle, flags);
+    for (uint64_t n = 0; n < iters; n++) {
+        ts_stream_init(&stream, &pattern, count_match, &sink);
+        for (size_t pos = 0; pos < LOG_SIZE; pos += TS_CHUNK_SIZE) {
+            ts_stream_feed(&stream, log_text + pos, TS_CHUNK_SIZE);
+        }
+        ts_stream_finish(&stream);
+    }
+    bench_consume(&sink);
+}
+
+static void grep_literal(uint64_t iters) {
+    grep_stream("panic", 0, iters);
+}
+
+static void grep_regex(uint64_t iters) {
+    grep_stream("^\\[ *[0-9]+\\] pan", TS_FLAG_REGEX, iters);
+}
+
+// The previous grep: split into lines, naive substring test per line
+static void grep_naive(uint64_t iters) {
+    static const char needle[] = "panic";
+    size_t needle_len = sizeof(needle) - 1;
+    
+    for (uint64_t n = 0; n < iters; n++) {
+        size_t pos = 0;
+        while (pos < LOG_SIZE) {
+            size_t end = pos;
+            while (end < LOG_SIZE && log_text[end] != '\n') {
+                end++;
+            }
+            for (size_t i = pos; i + needle_len <= end; i++) {
+                size_t j = 0;
+                while (j < needle_len && log_text[i + j] == needle[j]) {
+                    j++;
+                }
+                if (j == needle_len) {
+                    sink++;
+                    break;
+                }
+            }
+            pos = end + 1;
+        }
+    }
+    bench_consume(&sink);
+}
+
+static void lines_word(uint64_t iters) {
+    for (uint64_t n = 0; n < iters; n++) {
+        sink += ts_count_byte(log_text, '\n', LOG_SIZE);
+    }
+    bench_consume(&sink);
+}
+
+static void lines_byte(uint64_t iters) {
+    for (uint64_t n = 0; n < iters; n++) {
+        for (size_t i = 0; i < LOG_SIZE; i++) {
+            sink += (log_text[i] == '\n');
+        }
+    }
+    bench_consume(&sink);
+}
+
+static void wc_stream(uint64_t iters) {
+    ts_wc_t counts;
+    
+    for (uint64_t n = 0; n < iters; n++) {
+        ts_wc_init(&counts);
+        ts_wc_feed(&counts, log_text, LOG_SIZE);
+        sink += counts.words;
+    }
+    bench_consume(&sink);
+}
+
+// ─── Correctness check ───────────────────────────────────────────────────────
+//
+// The stream is compared line by line against a naive matcher, fed in
+// chunks of several sizes so lines and matches straddle chunk boundaries.
+
+#define CHECK_TEXT_SIZE   8192
+#define CHECK_MAX_LINES   4096
+#define CHECK_WHOLE       ((size_t)-1)  // Feed the text in one piece
+
+static char check_text[CHECK_TEXT_SIZE];
+static size_t check_text_len;
+
+// Random lines of 0-300 bytes over a small alphabet, so patterns hit often;
+// the last line has no newline
+static void check_text_setup(void) {
+    static const char alphabet[] = "aab b.x[]\\0";
+    uint32_t state = 7;
+    size_t pos = 0;
+    
+    while (pos < CHECK_TEXT_SIZE - 301) {
+        state = state * 1103515245u + 12345u;
+        uint32_t len = (state >> 16) % 301;
+        for (uint32_t i = 0; i < len; i++) {
+            state = state * 1103515245u + 12345u;
+            check_text[pos++] = alphabet[(state >> 16) % (sizeof(alphabet) - 1)];
+        }
+        check_text[pos++] = '\n';
+    }
+    memcpy(check_text + pos, "tail ab", 7);
+    check_text_len = pos + 7;
+}
+
+// Length of the regex element at p: a byte, an escape, '.' or a class
+static size_t ref_elem_len(const char* p) {
+    if (p[0] == '\\') {
+        return 2;
+    }
+    if (p[0] != '[') {
+        return 1;
+    }
+    size_t i = 1;
+    if (p[i] == '^') {
+        i++;
+    }
+    do {
+        if (p[i] == '\\') {
+            i++;
+        }
+        i++;
+    } while (p[i] != ']');
+    return i + 1;
+}
+
+static int ref_elem_match(const char* p, unsigned char c) {
+    if (p[0] == '.') {
+        return 1;
+    }
+    if (p[0] == '\\') {
+        return c == (unsigned char)p[1];
+    }
+    if (p[0] != '[') {
+        return c == (unsigned char)p[0];
+    }
+    
+    size_t i = 1;
+    int negate = (p[i] == '^');
+    int found = 0;
+    i += negate;
+    do {
+        unsigned char lo = (unsigned char)p[i];
+        if (lo == '\\') {
+            lo = (unsigned char)p[++i];
+        }
+        i++;
+        unsigned char hi = lo;
+        if (p[i] == '-' && p[i + 1] != ']') {
+            hi = (unsigned char)p[i + 1];
+            i += 2;
+        }
+        found |= (c >= lo && c <= hi);
+    } while (p[i] != ']');
+    return found != negate;
+}
+
+// Does pattern p match at the start of s? Tries every repeat count.
+static int ref_match_here(const char* p, const char* s, size_t len) {
+    if (p[0] == '\0') {
+        return 1;
+    }
+    if (p[0] == '$' && p[1] == '\0') {
+        return len == 0;
+    }
+    
+    size_t n = ref_elem_len(p);
+    char quant = p[n];
+    if (quant != '*' && quant != '+' && quant != '?') {
+        return len > 0 && ref_elem_match(p, (unsigned char)s[0]) && ref_match_here(p + n, s + 1, len - 1);
+    }
+    
+    size_t max = (quant == '?') ? 1 : len;
+    for (size_t k = 0; k <= max && k <= len; k++) {
+        if (k > 0 && !ref_elem_match(p, (unsigned char)s[k - 1])) {
+            break;
+        }
+        if ((k > 0 || quant != '+') && ref_match_here(p + n + 1, s + k, len - k)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int ref_match_line(const char* pattern, int regex, const char* line, size_t len) {
+    if (!regex) {
+        size_t m = strlen(pattern);
+        for (size_t i = 0; i + m <= len; i++) {
+            if (memcmp(line + i, pattern, m) == 0) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    
+    if (pattern[0] == '^') {
+        return ref_match_here(pattern + 1, line, len);
+    }
+    for (size_t start = 0; start <= len; start++) {
+        if (ref_match_here(pattern, line + start, len - start)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    uint32_t count;
+    uint32_t lines[CHECK_MAX_LINES];
+    size_t lengths[CHECK_MAX_LINES];
+} check_matches_t;
+
+static int record_match(const char* line, size_t len, uint32_t line_num, void* ctx) {
+    check_matches_t* matches = (check_matches_t*)ctx;
+    (void)line;
+    if (matches->count < CHECK_MAX_LINES) {
+        matches->lines[matches->count] = line_num;
+        matches->lengths[matches->count] = len;
+    }
+    matches->count++;
+    return 0;
+}
+
+// Lines the naive matcher accepts, numbered from 1 as the stream does
+static void ref_grep(const char* text, size_t size, const char* pattern, int regex, check_matches_t* out) {
+    size_t pos = 0;
+    uint32_t line_num = 1;
+    
+    out->count = 0;
+    while (pos < size) {
+        size_t end = pos;
+        while (end < size && text[end] != '\n') {
+            end++;
+        }
+        if (ref_match_line(pattern, regex, text + pos, end - pos)) {
+            record_match(text + pos, end - pos, line_num, out);
+        }
+        line_num++;
+        pos = end + 1;
+    }
+}
+
+static int check_grep(const char* name, const char* text, size_t size, const char* pattern, int regex) {
+    static const size_t chunk_sizes[] = {1, 3, 17, 255, TS_CHUNK_SIZE, CHECK_WHOLE};
+    static check_matches_t expected;
+    static check_matches_t got;
+    ts_pattern_t compiled;
+    ts_stream_t stream;
+    int failures = 0;
+    
+    if (ts_compile(&compiled, pattern, regex ? TS_FLAG_REGEX : 0) != 0) {
+        printf("  %s: '%s' does not compile\n", name, pattern);
+        return 1;
+    }
+    ref_grep(text, size, pattern, regex, &expected);
+    
+    for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+        size_t chunk = chunk_sizes[c] < size ? chunk_sizes[c] : size;
+        got.count = 0;
+        ts_stream_init(&stream, &compiled, record_match, &got);
+        for (size_t pos = 0; pos < size; pos += chunk) {
+            ts_stream_feed(&stream, text + pos, (size - pos < chunk) ? size - pos : chunk);
+        }
+        ts_stream_finish(&stream);
+        
+        int same = got.count == expected.count && got.count <= CHECK_MAX_LINES;
+        for (uint32_t i = 0; same && i < got.count; i++) {
+            same = got.lines[i] == expected.lines[i] && got.lengths[i] == expected.lengths[i];
+        }
+        if (!same) {
+            printf("  %s: '%s' in %zu-byte chunks: matched lines differ (%u found, %u expected)\n",
+                   name, pattern, chunk, got.count, expected.count);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+// Word-at-a-time scanning against byte loops, at every alignment and with
+// bytes that have the high bit set
+static int check_scan(void) {
+    static const int targets[] = {'\n', 'a', 0x00, 0x80, 0xFF};
+    unsigned char buf[160];
+    int failures = 0;
+    
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (unsigned char)((i * 37) ^ (i >> 3));
+    }
+    buf[100] = '\n';
+    buf[101] = 0x80;
+    
+    for (size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); t++) {
+        for (size_t start = 0; start < 16; start++) {
+            for (size_t len = 0; start + len <= sizeof(buf); len++) {
+                const char* data = (const char*)buf + start;
+                uint32_t count = 0;
+                const char* first = NULL;
+                for (size_t i = 0; i < len; i++) {
+                    if ((unsigned char)data[i] == (unsigned char)targets[t]) {
+                        count++;
+                        first = first ? first : data + i;
+                    }
+                }
+                if (ts_count_byte(data, targets[t], len) != count || ts_memchr(data, targets[t], len) != first) {
+                    printf("  scan: byte 0x%02x at offset %zu, length %zu\n", targets[t], start, len);
+                    failures++;
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+static int check_wc(const char* text, size_t size) {
+    uint32_t lines = 0;
+    uint32_t words = 0;
+    int in_word = 0;
+    int failures = 0;
+    
+    for (size_t i = 0; i < size; i++) {
+        char c = text[i];
+        lines += (c == '\n');
+        if (c == ' ' || c == '\t' || c == '\n') {
+            in_word = 0;
+        } else if (!in_word) {
+            in_word = 1;
+            words++;
+        }
+    }
+    
+    for (size_t chunk = 1; chunk <= size; chunk *= 7) {
+        ts_wc_t counts;
+        ts_wc_init(&counts);
+        for (size_t pos = 0; pos < size; pos += chunk) {
+            ts_wc_feed(&counts, text + pos, (size - pos < chunk) ? size - pos : chunk);
+        }
+        if (counts.lines != lines || counts.words != words || counts.bytes != size) {
+            printf("  wc in %zu-byte chunks: %u lines %u words, expected %u %u\n",
+                   chunk, counts.lines, counts.words, lines, words);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int bench_text_check(void) {
+    static const char* const literals[] = {
+        "panic", "value=1", "a", "ab b", "b.x[", "aaaa", "", "tail ab", NULL
+    };
+    static const char* const regexes[] = {
+        "^\\[ *[0-9]+\\] pan", "a.b", "^a*$", "^$", "[^ab ]+x", "b?a+$", "\\[x",
+        "x[a-c]*b", "^[]a]+", "\\\\0", "[.][\\]]", "a+b+a", NULL
+    };
+    int failures = 0;
+    
+    log_setup();
+    check_text_setup();
+    for (int i = 0; literals[i] != NULL; i++) {
+        failures += check_grep("log", log_text, LOG_SIZE, literals[i], 0);
+        failures += check_grep("random", check_text, check_text_len, literals[i], 0);
+    }
+    for (int i = 0; regexes[i] != NULL; i++) {
+        failures += check_grep("log", log_text, LOG_SIZE, regexes[i], 1);
+        failures += check_grep("random", check_text, check_text_len, regexes[i], 1);
+    }
+    failures += check_scan();
+    failures += check_wc(log_text, LOG_SIZE);
+    failures += check_wc(check_text, check_text_len);
+    return failures;
+}
+
+const bench_case_t bench_text_cases[] = {
+    {"text.grep.literal.log64k", "kernel/textsearch.c", LOG_SIZE, log_setup, grep_literal, NULL},
+    {"text.grep.literal.log64k", "naive-per-line",      LOG_SIZE, log_setup, grep_naive,   NULL},
+    {"text.grep.regex.log64k",   "kernel/textsearch.c", LOG_SIZE, log_setup, grep_regex,   NULL},
+    {"text.lines.log64k",        "kernel/textsearch.c", LOG_SIZE, log_setup, lines_word,   NULL},
+    {"text.lines.log64k",        "byte-loop",           LOG_SIZE, log_setup, lines_byte,   NULL},
+    {"text.wc.log64k",           "kernel/textsearch.c", LOG_SIZE, log_setup, wc_stream,    NULL},
+    {NULL, NULL, 0, NULL, NULL, NULL}
+};
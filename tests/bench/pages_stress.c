@@ -0,0 +1,258 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Page Allocator Stress Test
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+// Threads stand in for CPUs (shim/bind_memory.h) and allocate and free
+// frames from kernel/memory.c at random: hot and cold, from both zones, and
+// handed to other threads so frames are freed into a different CPU's cache
+// than the one they came from. An ownership map catches a frame handed out
+// twice; afterwards every frame must be back and the whole pool must be
+// allocatable again, even though the frames were last freed into caches of
+// other CPUs. The caches are also turned off while the threads run, and
+// every thread drains the pool at once repeatedly. Built with
+// -fsanitize=thread by `make -C tests/bench stress`.
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "memory.h"
+
+#define STRESS_THREADS      8           // SMP_MAX_CPUS in bind_memory.h
+#define STRESS_OPS          100000      // Per thread
+#define STRESS_HELD         200         // Frames a thread holds at most
+#define STRESS_HANDOFF      64
+#define STRESS_DRAIN_ROUNDS 20
+#define STRESS_FRAMES       (MEMORY_POOL_SIZE / PAGE_SIZE)
+
+// Kernel symbols kernel/memory.c expects; the pool starts at __end
+__thread uint32_t bench_cpu_id;
+char __end[1];
+
+void uart_puts(const char* str) {
+    fputs(str, stdout);
+}
+
+void uart_printf(const char* format, ...) {
+    (void)format;
+}
+
+static uint64_t pool_start;
+static uint8_t owner[STRESS_FRAMES];            // Thread + 1 holding each frame
+static uint64_t handoff[STRESS_HANDOFF];        // Frames passed between threads
+static int toggle_caches;
+static uint32_t halfway;                        // Threads halfway through a run
+static int errors;
+
+static uint32_t frame_of(uint64_t phys) {
+    return (uint32_t)((phys - pool_start) >> PAGE_SHIFT);
+}
+
+static void claim(uint64_t phys, uint32_t thread) {
+    if (__atomic_exchange_n(&owner[frame_of(phys)], (uint8_t)(thread + 1), __ATOMIC_RELAXED) != 0) {
+        printf("frame %u allocated twice\n", frame_of(phys));
+        __atomic_add_fetch(&errors, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Drop ownership before the frame goes back, or its next owner would race
+static void release(uint64_t phys) {
+    __atomic_store_n(&owner[frame_of(phys)], 0, __ATOMIC_RELAXED);
+}
+
+static void* random_worker(void* arg) {
+    uint32_t thread = (uint32_t)(uintptr_t)arg;
+    uint32_t seed = thread * 7 + 1;
+    uint64_t held[STRESS_HELD];
+    uint32_t count = 0;
+    
+    bench_cpu_id = thread;
+    for (uint32_t op = 0; op < STRESS_OPS; op++) {
+        if (op == STRESS_OPS / 2) {
+            __atomic_add_fetch(&halfway, 1, __ATOMIC_RELAXED);
+        }
+        seed = seed * 1103515245u + 12345u;
+        uint32_t choice = (seed >> 16) & 3;
+        
+        if (choice < 2 && count < STRESS_HELD) {
+            uint64_t phys = ((seed >> 20) & 7) == 0
+                            ? page_alloc_zone(MEMORY_ZONE_DMA, (seed >> 24) & PAGE_ALLOC_COLD)
+                            : page_alloc();
+            if (phys != 0) {
+                claim(phys, thread);
+                held[count++] = phys;
+            }
+        } else if (choice == 2 && count > 0) {
+            uint64_t phys = held[--count];
+            release(phys);
+            if ((seed >> 22) & 1) {
+                page_put_cold(phys);
+            } else {
+                page_put(phys);
+            }
+        } else if (count > 0) {
+            // Swap with a frame another thread left, and free that one here
+            uint64_t phys = held[--count];
+            release(phys);
+            uint64_t other = __atomic_exchange_n(&handoff[(seed >> 8) % STRESS_HANDOFF], phys, __ATOMIC_ACQ_REL);
+            if (other != 0) {
+                claim(other, thread);
+                release(other);
+                page_put(other);
+            }
+        }
+    }
+    
+    while (count > 0) {
+        uint64_t phys = held[--count];
+        release(phys);
+        page_put(phys);
+    }
+    return NULL;
+}
+
+// Turns the caches off once the first thread is halfway through
+static void* toggle_worker(void* arg) {
+    (void)arg;
+    while (__atomic_load_n(&halfway, __ATOMIC_RELAXED) == 0) {
+        sched_yield();
+    }
+    memory_set_page_cache(0);
+    return NULL;
+}
+
+static uint64_t drained[STRESS_THREADS][STRESS_FRAMES];
+static uint32_t drained_count[STRESS_THREADS];
+
+static void* drain_worker(void* arg) {
+    uint32_t thread = (uint32_t)(uintptr_t)arg;
+    uint64_t phys;
+    
+    bench_cpu_id = thread;
+    drained_count[thread] = 0;
+    while ((phys = page_alloc()) != 0) {
+        drained[thread][drained_count[thread]++] = phys;
+    }
+    return NULL;
+}
+
+static void run_threads(void* (*worker)(void*)) {
+    pthread_t threads[STRESS_THREADS];
+    pthread_t toggle;
+    
+    __atomic_store_n(&halfway, 0, __ATOMIC_RELAXED);
+    for (uint32_t i = 0; i < STRESS_THREADS; i++) {
+        pthread_create(&threads[i], NULL, worker, (void*)(uintptr_t)i);
+    }
+    if (toggle_caches) {
+        pthread_create(&toggle, NULL, toggle_worker, NULL);
+    }
+    for (uint32_t i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    if (toggle_caches) {
+        pthread_join(toggle, NULL);
+    }
+}
+
+// Every frame is free again and no CPU can keep one to itself
+static int pool_whole(void) {
+    memory_stats_t stats;
+    
+    for (uint32_t i = 0; i < STRESS_HANDOFF; i++) {
+        if (handoff[i] != 0) {
+            page_put(handoff[i]);
+            handoff[i] = 0;
+        }
+    }
+    memory_get_stats(&stats);
+    if (stats.free_pages != stats.total_pages) {
+        printf("%u of %u frames free\n", stats.free_pages, stats.total_pages);
+        return 0;
+    }
+    
+    bench_cpu_id = 0;
+    uint32_t count = 0;
+    uint64_t phys;
+    while ((phys = page_alloc()) != 0) {
+        drained[0][count++] = phys;
+    }
+    if (count != STRESS_FRAMES) {
+        printf("only %u frames allocatable\n", count);
+    }
+    int whole = count == STRESS_FRAMES;
+    while (count > 0) {
+        page_put(drained[0][--count]);
+    }
+    return whole;
+}
+
+static int run_random(const char* name, int caches, int toggle) {
+    memory_set_page_cache(caches);
+    toggle_caches = toggle;
+    __atomic_store_n(&errors, 0, __ATOMIC_RELAXED);
+    run_threads(random_worker);
+    
+    memory_stats_t stats;
+    memory_get_stats(&stats);
+    int ok = errors == 0 && (!toggle || (!stats.cache_enabled && stats.cached_pages == 0)) && pool_whole();
+    printf("%-24s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// All threads allocate until the pool is dry, at once: between them they
+// must get every frame exactly once
+static int run_drain(void) {
+    static uint8_t seen[STRESS_FRAMES];
+    int ok = 1;
+    
+    memory_set_page_cache(1);
+    toggle_caches = 0;
+    for (uint32_t round = 0; round < STRESS_DRAIN_ROUNDS && ok; round++) {
+        run_threads(drain_worker);
+        
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < STRESS_FRAMES; i++) {
+            seen[i] = 0;
+        }
+        for (uint32_t t = 0; t < STRESS_THREADS; t++) {
+            for (uint32_t i = 0; i < drained_count[t]; i++) {
+                if (seen[frame_of(drained[t][i])]++) {
+                    ok = 0;
+                }
+                total++;
+            }
+        }
+        ok &= total == STRESS_FRAMES;
+        
+        for (uint32_t t = 0; t < STRESS_THREADS; t++) {
+            bench_cpu_id = t;
+            for (uint32_t i = 0; i < drained_count[t]; i++) {
+                page_put(drained[t][i]);
+            }
+        }
+        memory_stats_t stats;
+        memory_get_stats(&stats);
+        ok &= stats.free_pages == stats.total_pages;
+    }
+    printf("%-24s %s\n", "concurrent exhaustion", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    memory_stats_t stats;
+    int ok = 1;
+    
+    memory_init();
+    memory_get_stats(&stats);
+    pool_start = stats.pool_start;
+    
+    ok &= run_random("per-CPU caches", 1, 0);
+    ok &= run_random("zone lock only", 0, 0);
+    ok &= run_random("caches turned off", 1, 1);
+    ok &= run_drain();
+    
+    return ok ? 0 : 1;
+}
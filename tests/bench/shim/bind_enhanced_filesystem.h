@@ -0,0 +1,31 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Benchmark Shim: kernel/enhanced_filesystem.c symbol prefix
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef BENCH_BIND_ENHANCED_FILESYSTEM_H
+#define BENCH_BIND_ENHANCED_FILESYSTEM_H
+
+#include "bind_libc.h"
+
+#define fs_init                  kefs_fs_init
+#define fs_create_file           kefs_fs_create_file
+#define fs_write_file            kefs_fs_write_file
+#define fs_read_file             kefs_fs_read_file
+#define fs_delete_file           kefs_fs_delete_file
+#define fs_get_file_view         kefs_fs_get_file_view
+#define fs_get_file_name         kefs_fs_get_file_name
+#define fs_mmap                  kefs_fs_mmap
+#define fs_munmap                kefs_fs_munmap
+#define fs_list_files            kefs_fs_list_files
+#define fs_file_exists           kefs_fs_file_exists
+#define fs_get_file_size         kefs_fs_get_file_size
+#define fs_get_current_directory kefs_fs_get_current_directory
+#define fs_change_directory      kefs_fs_change_directory
+#define fs_get_memory_info       kefs_fs_get_memory_info
+#define fs_cat                   kefs_fs_cat
+#define fs_save                  kefs_fs_save
+#define fs_append                kefs_fs_append
+
+#endif // BENCH_BIND_ENHANCED_FILESYSTEM_H
@@ -0,0 +1,35 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Benchmark Shim: kernel/filesystem.c symbol prefix
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+// filesystem.c and enhanced_filesystem.c both export the fs_* API, so each
+// one gets its own prefix when linked into the same benchmark binary.
+
+#ifndef BENCH_BIND_FILESYSTEM_H
+#define BENCH_BIND_FILESYSTEM_H
+
+#include "bind_libc.h"
+
+#define get_system_time          kfs_get_system_time
+#define fs_init                  kfs_fs_init
+#define fs_create_file           kfs_fs_create_file
+#define fs_write_file            kfs_fs_write_file
+#define fs_read_file             kfs_fs_read_file
+#define fs_delete_file           kfs_fs_delete_file
+#define fs_get_file_view         kfs_fs_get_file_view
+#define fs_get_file_name         kfs_fs_get_file_name
+#define fs_mmap                  kfs_fs_mmap
+#define fs_munmap                kfs_fs_munmap
+#define fs_list_files            kfs_fs_list_files
+#define fs_file_exists           kfs_fs_file_exists
+#define fs_get_file_size         kfs_fs_get_file_size
+#define fs_get_current_directory kfs_fs_get_current_directory
+#define fs_change_directory      kfs_fs_change_directory
+#define fs_get_memory_info       kfs_fs_get_memory_info
+#define fs_cat                   kfs_fs_cat
+#define fs_save                  kfs_fs_save
+#define fs_append                kfs_fs_append
+
+#endif // BENCH_BIND_FILESYSTEM_H
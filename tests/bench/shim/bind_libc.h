@@ -0,0 +1,31 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Benchmark Shim: kernel string routine bindings
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+// Force-included into every kernel translation unit built for the host.
+// The kernel defines its own strlen/memcpy/sprintf/... which would otherwise
+// collide with (or silently be replaced by) the host C library. Each name is
+// bound to the kernel implementation the bare-metal build links against:
+// memory and basic string routines from kernel/stdio.c, formatting and
+// concatenation from kernel/utils.c.
+
+#ifndef BENCH_BIND_LIBC_H
+#define BENCH_BIND_LIBC_H
+
+#define strlen       kstdio_strlen
+#define strcmp       kstdio_strcmp
+#define strcpy       kstdio_strcpy
+#define strcpy_safe  kstdio_strcpy_safe
+#define strncpy      kstdio_strncpy
+#define memset       kstdio_memset
+#define memcpy       kstdio_memcpy
+#define snprintf     kstdio_snprintf
+
+#define strcat       kutils_strcat
+#define strncmp      kutils_strncmp
+#define sprintf      kutils_sprintf
+#define vsprintf     kutils_vsprintf
+
+#endif // BENCH_BIND_LIBC_H
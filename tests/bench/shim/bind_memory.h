@@ -0,0 +1,31 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Benchmark Shim: page allocator bindings
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+// Force-included into kernel/memory.c. Host threads stand in for CPUs:
+// this replaces kernel/smp.h, whose CPU number comes from a system
+// register, with a thread-local set by each benchmark thread. Waiting on a
+// lock yields, since the host may run more threads than it has cores.
+
+#ifndef BENCH_BIND_MEMORY_H
+#define BENCH_BIND_MEMORY_H
+
+#include <sched.h>
+#include <stdint.h>
+
+#define SMP_H
+#define SMP_MAX_CPUS    8
+
+extern __thread uint32_t bench_cpu_id;
+
+static inline uint32_t smp_cpu_id(void) {
+    return bench_cpu_id;
+}
+
+static inline void smp_relax(void) {
+    sched_yield();
+}
+
+#endif // BENCH_BIND_MEMORY_H
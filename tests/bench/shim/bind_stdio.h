@@ -0,0 +1,20 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Benchmark Shim: kernel/stdio.c symbol prefix
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef BENCH_BIND_STDIO_H
+#define BENCH_BIND_STDIO_H
+
+#define strlen       kstdio_strlen
+#define strcmp       kstdio_strcmp
+#define strcpy       kstdio_strcpy
+#define strcpy_safe  kstdio_strcpy_safe
+#define strncpy      kstdio_strncpy
+#define memset       kstdio_memset
+#define memcpy       kstdio_memcpy
+#define sprintf      kstdio_sprintf
+#define snprintf     kstdio_snprintf
+
+#endif // BENCH_BIND_STDIO_H
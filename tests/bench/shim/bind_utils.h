@@ -0,0 +1,24 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Benchmark Shim: kernel/utils.c symbol prefix
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+#ifndef BENCH_BIND_UTILS_H
+#define BENCH_BIND_UTILS_H
+
+#define utoa_base    kutils_utoa_base
+#define my_itoa      kutils_my_itoa
+#define my_strlen    kutils_my_strlen
+#define my_strcat    kutils_my_strcat
+#define strcat       kutils_strcat
+#define strlen       kutils_strlen
+#define strcmp       kutils_strcmp
+#define strncmp      kutils_strncmp
+#define strcpy       kutils_strcpy
+#define strncpy      kutils_strncpy
+#define sprintf      kutils_sprintf
+#define vsprintf     kutils_vsprintf
+#define vsnprintf    kutils_vsnprintf
+
+#endif // BENCH_BIND_UTILS_H
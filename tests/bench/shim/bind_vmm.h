@@ -0,0 +1,31 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Benchmark Shim: VMM bindings
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+// Force-included into kernel/vmm.c for the host check (vmm_check.c). The
+// x86_64 privileged instructions become no-ops: a CR3 load only records
+// the root for the check's software page walk, and CPUID reports no NX.
+
+#ifndef BENCH_BIND_VMM_H
+#define BENCH_BIND_VMM_H
+
+#include <stdint.h>
+
+#if !defined(__x86_64__)
+#error "the VMM host check walks x86_64 page tables; build it on an x86_64 host"
+#endif
+
+#define VMM_HOST_CPU
+
+extern uint64_t vmm_host_cr3;
+
+#define tlb_flush_page(va)          ((void)(va))
+#define space_load(root)            ((void)(vmm_host_cr3 = (root)))
+#define cpu_id(leaf, eax, edx)      ((void)(leaf), *(eax) = 0, *(edx) = 0)
+#define efer_set(bits)              ((void)(bits))
+#define code_segment()              ((uint16_t)0)
+#define idt_load(base, limit)       ((void)(base), (void)(limit))
+
+#endif // BENCH_BIND_VMM_H
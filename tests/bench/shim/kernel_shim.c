@@ -0,0 +1,106 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Host Benchmark Shim: console drivers, CPUs and VMM
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+// Stand-ins for the UART/serial drivers so kernel code can run as a normal
+// host process. Output is counted and discarded; benchmarks must not be
+// dominated by terminal I/O.
+
+#include <stddef.h>
+#include "../../kernel/vmm.h"
+
+size_t bench_console_bytes = 0;
+
+void serial_init(void) {
+}
+
+void serial_putc(char c) {
+    (void)c;
+    bench_console_bytes++;
+}
+
+void serial_puts(const char* str) {
+    while (*str++) {
+        bench_console_bytes++;
+    }
+}
+
+const char* serial_get_uart_info(void) {
+    return "Host benchmark shim";
+}
+
+void uart_init(void) {
+}
+
+void uart_putc(unsigned char c) {
+    (void)c;
+    bench_console_bytes++;
+}
+
+unsigned char uart_getc(void) {
+    return '\n';
+}
+
+void uart_puts(const char* str) {
+    serial_puts(str);
+}
+
+void uart_printf(const char* format, ...) {
+    serial_puts(format);
+}
+
+// CPU number of the calling thread, see bind_memory.h
+__thread uint32_t bench_cpu_id = 0;
+
+// Linker symbol the page pool starts after. The allocator only does
+// arithmetic on frame addresses and never touches the frames.
+char __end[1];
+
+// No VMM on the host: fs_mmap falls back to in-place views and never
+// reaches the mapping calls
+int vmm_enabled(void) {
+    return 0;
+}
+
+vmm_space_t* vmm_current(void) {
+    return NULL;
+}
+
+vmm_object_t* vmm_object_create(uint64_t size, vmm_pager_t pager, void* ctx) {
+    (void)size;
+    (void)pager;
+    (void)ctx;
+    return NULL;
+}
+
+int vmm_object_insert(vmm_object_t* object, uint64_t offset, uint64_t phys) {
+    (void)object;
+    (void)offset;
+    (void)phys;
+    return VMM_ERROR_UNSUPPORTED;
+}
+
+void vmm_object_put(vmm_object_t* object) {
+    (void)object;
+}
+
+int vmm_map_object(vmm_space_t* space, uint64_t* addr, uint64_t size, uint32_t prot, uint32_t flags,
+                   vmm_object_t* object, uint64_t offset) {
+    (void)space;
+    (void)addr;
+    (void)size;
+    (void)prot;
+    (void)flags;
+    (void)object;
+    (void)offset;
+    return VMM_ERROR_UNSUPPORTED;
+}
+
+int vmm_unmap(vmm_space_t* space, uint64_t addr, uint64_t size) {
+    (void)space;
+    (void)addr;
+    (void)size;
+    return VMM_ERROR_UNSUPPORTED;
+}
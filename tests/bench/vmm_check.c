@@ -0,0 +1,276 @@
+/* ─────────────────────────────────────────────────────────────────────────────
+ * SAGE OS — Virtual Memory Manager Host Check
+ * Copyright (c) 2025 Ashish Vasant Yesale (ashishyesale007@gmail.com)
+ * SPDX-License-Identifier: BSD-3-Clause OR Proprietary
+ * ───────────────────────────────────────────────────────────────────────────── */
+
+// Runs kernel/vmm.c (x86_64 page-table format) and kernel/memory.c on the
+// build host. `make -C tests/bench vmm-check` builds vmm.c with its
+// privileged instructions (CR3 loads, INVLPG, CPUID, LIDT) stubbed out by
+// shim/bind_vmm.h; the MMU is played by translate(), which walks the tables
+// CR3 would point at in software and calls vmm_handle_fault on a missing
+// or read-only entry as the trap would.
+// Covers zero-page reads and zero fills, copy-on-write copies and reuse,
+// shared and private object mappings, clone/destroy and that every frame
+// goes back to the pool.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "vmm.h"
+#include "memory.h"
+
+#define CHECK_ENTRIES       512
+#define CHECK_ADDR_MASK     0x000FFFFFFFFFF000ull
+#define CHECK_PRESENT       0x1ull
+#define CHECK_WRITE         0x2ull
+#define CHECK_KERNEL_ENTRY  0x1234003ull    // Stand-in for the kernel's own mappings
+
+// Written by space_load in shim/bind_vmm.h
+uint64_t vmm_host_cr3;
+
+// What the kernel image and mmu.c would provide. The frame pool starts at
+// __end; the kernel table has two entries outside the VMM window.
+char __end[MEMORY_POOL_SIZE + 8192] __attribute__((aligned(4096)));
+char page_fault_entry[16];
+static uint64_t kernel_root[CHECK_ENTRIES] __attribute__((aligned(4096)));
+
+int mmu_enabled(void) {
+    return 1;
+}
+
+uint64_t mmu_root_table(void) {
+    kernel_root[0] = CHECK_KERNEL_ENTRY;
+    kernel_root[256] = CHECK_KERNEL_ENTRY;
+    return (uint64_t)(uintptr_t)kernel_root;
+}
+
+void serial_puts(const char* str) {
+    fputs(str, stdout);
+}
+
+void uart_puts(const char* str) {
+    (void)str;
+}
+
+void uart_printf(const char* format, ...) {
+    (void)format;
+}
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL line %d: %s\n", __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// Leaf entry for va in the current space, or NULL if a table is missing
+static uint64_t* walk(uint64_t va) {
+    uint64_t* table = (uint64_t*)(uintptr_t)vmm_host_cr3;
+    for (int shift = 39; shift > 12; shift -= 9) {
+        uint64_t entry = table[(va >> shift) & (CHECK_ENTRIES - 1)];
+        if (!(entry & CHECK_PRESENT)) {
+            return NULL;
+        }
+        table = (uint64_t*)(uintptr_t)(entry & CHECK_ADDR_MASK);
+    }
+    return &table[(va >> 12) & (CHECK_ENTRIES - 1)];
+}
+
+// Translate va, faulting until the entry allows the access. Counts the
+// faults taken in *faults when given; NULL if the fault is not resolved.
+static uint8_t* translate(uint64_t va, int write, int* faults) {
+    for (int tries = 0; tries < 3; tries++) {
+        uint64_t* pte = walk(va);
+        if (pte != NULL && (*pte & CHECK_PRESENT) && (!write || (*pte & CHECK_WRITE))) {
+            return (uint8_t*)(uintptr_t)((*pte & CHECK_ADDR_MASK) + (va & (PAGE_SIZE - 1)));
+        }
+        if (faults != NULL) {
+            (*faults)++;
+        }
+        if (vmm_handle_fault(va, write ? VMM_ACCESS_WRITE : VMM_ACCESS_READ) != VMM_SUCCESS) {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static int read_byte(uint64_t va) {
+    uint8_t* p = translate(va, 0, NULL);
+    return p != NULL ? *p : -1;
+}
+
+static int write_byte(uint64_t va, uint8_t value) {
+    uint8_t* p = translate(va, 1, NULL);
+    if (p == NULL) {
+        return -1;
+    }
+    *p = value;
+    return 0;
+}
+
+// Fills each page with its page number plus ctx
+static int pager_calls;
+
+static int test_pager(void* ctx, uint64_t offset, void* page) {
+    pager_calls++;
+    memset(page, (int)(offset / PAGE_SIZE) + (int)(uintptr_t)ctx, PAGE_SIZE);
+    return 0;
+}
+
+static int failing_pager(void* ctx, uint64_t offset, void* page) {
+    (void)ctx;
+    (void)offset;
+    (void)page;
+    return -1;
+}
+
+int main(void) {
+    memory_stats_t mem;
+    vmm_stats_t vs;
+    const uint32_t rw = VMM_PROT_READ | VMM_PROT_WRITE;
+    
+    CHECK(vmm_init() == VMM_SUCCESS);
+    memory_get_stats(&mem);
+    uint32_t base_free = mem.free_pages;
+    
+    // The kernel space copies the kernel entries and leaves the window clear
+    vmm_space_t* kernel = vmm_current();
+    CHECK(kernel != NULL);
+    const uint64_t* root = (const uint64_t*)(uintptr_t)vmm_host_cr3;
+    CHECK(root[0] == CHECK_KERNEL_ENTRY && root[256] == CHECK_KERNEL_ENTRY && root[1] == 0);
+    
+    // Reads map the zero page, the first write takes a zeroed frame
+    uint64_t anon = 0;
+    CHECK(vmm_map_anon(kernel, &anon, 3 * PAGE_SIZE, rw, 0) == VMM_SUCCESS);
+    CHECK(anon == VMM_BASE);
+    CHECK(read_byte(anon) == 0);
+    vmm_get_stats(&vs);
+    CHECK(vs.zero_maps == 1 && vs.zero_fills == 0);
+    CHECK(read_byte(anon + PAGE_SIZE) == 0);
+    CHECK(write_byte(anon, 7) == 0);
+    vmm_get_stats(&vs);
+    CHECK(vs.zero_fills == 1);
+    CHECK(read_byte(anon) == 7 && read_byte(anon + PAGE_SIZE) == 0);
+    CHECK(write_byte(anon + 2 * PAGE_SIZE, 9) == 0);
+    
+    // A clone shares the pages; the first writer copies, the last reuses
+    vmm_space_t* clone = vmm_space_clone(kernel);
+    CHECK(clone != NULL);
+    vmm_space_activate(clone);
+    CHECK(vmm_current() == clone);
+    CHECK(read_byte(anon) == 7 && read_byte(anon + 2 * PAGE_SIZE) == 9);
+    CHECK(write_byte(anon, 8) == 0);
+    vmm_get_stats(&vs);
+    CHECK(vs.cow_copies == 1);
+    CHECK(read_byte(anon) == 8);
+    vmm_space_activate(kernel);
+    CHECK(read_byte(anon) == 7);
+    CHECK(write_byte(anon, 6) == 0);
+    vmm_get_stats(&vs);
+    CHECK(vs.cow_reuses == 1 && vs.cow_copies == 1);
+    CHECK(write_byte(anon + PAGE_SIZE, 5) == 0);
+    vmm_get_stats(&vs);
+    CHECK(vs.zero_fills == 3);
+    vmm_space_activate(clone);
+    CHECK(read_byte(anon + PAGE_SIZE) == 0 && read_byte(anon) == 8);
+    
+    // One object mapped shared in one space and private in the other:
+    // each page is read in once and the frame is shared until written
+    vmm_object_t* object = vmm_object_create(5 * PAGE_SIZE, test_pager, (void*)1);
+    CHECK(object != NULL);
+    uint64_t shared = 0;
+    uint64_t private = 0;
+    CHECK(vmm_map_object(clone, &shared, 4 * PAGE_SIZE, VMM_PROT_READ, VMM_MAP_SHARED,
+                         object, PAGE_SIZE) == VMM_SUCCESS);
+    CHECK(vmm_map_object(kernel, &private, 4 * PAGE_SIZE, rw, 0, object, PAGE_SIZE) == VMM_SUCCESS);
+    vmm_object_put(object);
+    CHECK(read_byte(shared) == 2 && pager_calls == 1);
+    uint8_t* shared_frame = translate(shared, 0, NULL);
+    vmm_space_activate(kernel);
+    CHECK(read_byte(private) == 2 && pager_calls == 1);
+    CHECK(translate(private, 0, NULL) == shared_frame);
+    CHECK(write_byte(private, 42) == 0);
+    CHECK(read_byte(private) == 42);
+    vmm_space_activate(clone);
+    CHECK(read_byte(shared) == 2);
+    
+    // Writes to a read-only mapping and accesses outside any mapping fail
+    CHECK(write_byte(shared, 1) == -1);
+    vmm_get_stats(&vs);
+    CHECK(vs.errors >= 1);
+    CHECK(read_byte(VMM_BASE + 0x100000000ull) == -1);
+    
+    // A first write to an unread private object page copies it directly
+    vmm_space_activate(kernel);
+    CHECK(write_byte(private + PAGE_SIZE, 3) == 0);
+    CHECK(pager_calls == 2);
+    
+    // Shared anonymous memory stays shared across a clone
+    uint64_t shared_anon = 0;
+    CHECK(vmm_map_anon(kernel, &shared_anon, 2 * PAGE_SIZE, rw, VMM_MAP_SHARED) == VMM_SUCCESS);
+    vmm_space_t* clone2 = vmm_space_clone(kernel);
+    CHECK(clone2 != NULL);
+    vmm_space_activate(clone2);
+    CHECK(write_byte(shared_anon, 77) == 0);
+    vmm_space_activate(kernel);
+    CHECK(read_byte(shared_anon) == 77);
+    
+    // Populated mappings take no faults
+    uint64_t populated = 0;
+    int faults = 0;
+    CHECK(vmm_map_anon(clone2, &populated, 16 * PAGE_SIZE, rw, VMM_MAP_POPULATE) == VMM_SUCCESS);
+    vmm_space_activate(clone2);
+    translate(populated + 5 * PAGE_SIZE, 1, &faults);
+    CHECK(faults == 0);
+    
+    // Fixed mappings must not overlap; unmapping must cover whole mappings
+    uint64_t fixed = populated;
+    CHECK(vmm_map_anon(clone2, &fixed, PAGE_SIZE, VMM_PROT_READ, VMM_MAP_FIXED) == VMM_ERROR_NO_SPACE);
+    fixed = VMM_BASE + 0x40000000ull;
+    CHECK(vmm_map_anon(clone2, &fixed, PAGE_SIZE, VMM_PROT_READ, VMM_MAP_FIXED) == VMM_SUCCESS);
+    CHECK(vmm_unmap(clone2, populated, PAGE_SIZE) == VMM_ERROR_PARAM);
+    CHECK(vmm_unmap(clone2, populated, 16 * PAGE_SIZE) == VMM_SUCCESS);
+    
+    // Pager errors are returned from the fault
+    vmm_object_t* failing = vmm_object_create(PAGE_SIZE, failing_pager, NULL);
+    uint64_t failing_addr = 0;
+    CHECK(vmm_map_object(clone2, &failing_addr, PAGE_SIZE, VMM_PROT_READ, 0, failing, 0) == VMM_SUCCESS);
+    vmm_object_put(failing);
+    CHECK(vmm_handle_fault(failing_addr, VMM_ACCESS_READ) == VMM_ERROR_PAGER);
+    
+    // A large sparse mapping only uses what is touched
+    uint64_t sparse = 0;
+    CHECK(vmm_map_anon(clone2, &sparse, 1ull << 33, rw, 0) == VMM_SUCCESS);
+    CHECK(write_byte(sparse + (1ull << 32), 1) == 0);
+    
+    vmm_get_stats(&vs);
+    printf("spaces %u vmas %u objects %u resident %u tables %u faults %u\n",
+           vs.spaces, vs.vmas, vs.objects, vs.resident, vs.tables, vs.faults);
+    printf("zero fills %u zero maps %u object fills %u cow copies %u cow reuses %u errors %u\n",
+           vs.zero_fills, vs.zero_maps, vs.object_fills, vs.cow_copies, vs.cow_reuses, vs.errors);
+    
+    // Destroying the clones and unmapping everything returns every frame
+    // except the kernel space's own tables
+    vmm_space_activate(kernel);
+    vmm_space_destroy(clone2);
+    vmm_space_destroy(clone);
+    CHECK(vmm_unmap(kernel, VMM_BASE, VMM_END - VMM_BASE) == VMM_SUCCESS);
+    vmm_get_stats(&vs);
+    CHECK(vs.spaces == 1 && vs.vmas == 0 && vs.objects == 0 && vs.resident == 0);
+    memory_get_stats(&mem);
+    CHECK(mem.free_pages + (vs.tables - 1) == base_free);
+    
+    // Running out of frames while populating leaves nothing behind
+    uint64_t too_big = 0;
+    CHECK(vmm_map_anon(kernel, &too_big, 32ull << 20, rw, VMM_MAP_POPULATE) == VMM_ERROR_NO_MEMORY);
+    vmm_get_stats(&vs);
+    CHECK(vs.vmas == 0);
+    memory_get_stats(&mem);
+    CHECK(mem.free_pages + (vs.tables - 1) == base_free);
+    
+    printf("vmm check: %s\n", failures == 0 ? "ok" : "FAILED");
+    return failures != 0;
+}